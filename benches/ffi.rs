@@ -0,0 +1,131 @@
+//! Benchmarks of conversion and ownership-transfer costs of the wrapper types.
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use ffi_types::{CBoxedSlice, CBoxedStr, CSliceRef, CStrRef, CharStrRef};
+
+const SIZES: &[usize] = &[0, 16, 256, 4096, 65536, 1 << 20, 16 << 20];
+
+extern "C" {
+    fn _rust_ffi_boxed_bytes_drop(slice: CBoxedSlice<u8>);
+    fn _rust_ffi_boxed_str_drop(string: CBoxedStr);
+}
+
+#[inline(never)]
+extern "C" fn signature_c_slice_ref(c: CSliceRef<u8>) -> CSliceRef<u8> {
+    c
+}
+
+#[inline(never)]
+extern "C" fn signature_c_boxed_slice(c: CBoxedSlice<u8>) -> CBoxedSlice<u8> {
+    c
+}
+
+#[inline(never)]
+extern "C" fn signature_c_str_ref(c: CStrRef) -> CStrRef {
+    c
+}
+
+fn bench_conversion(c: &mut Criterion) {
+    let mut group = c.benchmark_group("conversion");
+    group.bench_function("boxed_slice/round_trip", |b| {
+        let mut boxed = Some(vec![0u8; 64].into_boxed_slice());
+        b.iter(|| {
+            let c = CBoxedSlice::new(boxed.take().unwrap());
+            boxed = Some(black_box(c).into_boxed_slice());
+        })
+    });
+    group.bench_function("boxed_str/round_trip", |b| {
+        let mut boxed = Some(String::from("hello").into_boxed_str());
+        b.iter(|| {
+            let c = CBoxedStr::new(boxed.take().unwrap());
+            boxed = Some(black_box(c).into_boxed_str());
+        })
+    });
+    group.bench_function("slice_ref/round_trip", |b| {
+        let data = [0u8; 64];
+        b.iter(|| {
+            let c = unsafe { CSliceRef::new_unbound(black_box(&data[..])) };
+            black_box(c.into_slice().len())
+        })
+    });
+    group.finish();
+}
+
+fn bench_signature(c: &mut Criterion) {
+    let mut group = c.benchmark_group("signature");
+    group.bench_function("c_slice_ref", |b| {
+        let data = [0u8; 64];
+        let slice = unsafe { CSliceRef::new_unbound(&data[..]) };
+        b.iter(|| black_box(signature_c_slice_ref(black_box(slice))))
+    });
+    group.bench_function("c_boxed_slice", |b| {
+        let mut boxed = Some(CBoxedSlice::new(vec![0u8; 64].into_boxed_slice()));
+        b.iter(|| boxed = Some(signature_c_boxed_slice(black_box(boxed.take().unwrap()))))
+    });
+    group.bench_function("c_str_ref", |b| {
+        let s = CStrRef::new("hello");
+        b.iter(|| black_box(signature_c_str_ref(black_box(s))))
+    });
+    group.finish();
+}
+
+fn bench_drop(c: &mut Criterion) {
+    let mut group = c.benchmark_group("drop");
+    for &size in SIZES.iter().filter(|&&size| size <= 1 << 20) {
+        group.throughput(Throughput::Bytes(size as u64));
+        group.bench_with_input(
+            BenchmarkId::new("boxed_bytes/rust", size),
+            &size,
+            |b, &size| {
+                b.iter_batched(
+                    || CBoxedSlice::new(vec![0u8; size].into_boxed_slice()),
+                    drop,
+                    criterion::BatchSize::SmallInput,
+                )
+            },
+        );
+        group.bench_with_input(
+            BenchmarkId::new("boxed_bytes/ffi", size),
+            &size,
+            |b, &size| {
+                b.iter_batched(
+                    || CBoxedSlice::new(vec![0u8; size].into_boxed_slice()),
+                    |slice| unsafe { _rust_ffi_boxed_bytes_drop(slice) },
+                    criterion::BatchSize::SmallInput,
+                )
+            },
+        );
+    }
+    group.bench_function("boxed_str/ffi", |b| {
+        b.iter_batched(
+            || CBoxedStr::new("hello".into()),
+            |string| unsafe { _rust_ffi_boxed_str_drop(string) },
+            criterion::BatchSize::SmallInput,
+        )
+    });
+    group.finish();
+}
+
+fn bench_char_str_validation(c: &mut Criterion) {
+    let mut group = c.benchmark_group("char_str/into_rust");
+    for &size in SIZES {
+        let text: Vec<u8> = (0..size).map(|i| b'a' + (i % 26) as u8).collect();
+        group.throughput(Throughput::Bytes(size as u64));
+        group.bench_with_input(BenchmarkId::from_parameter(size), &text, |b, text| {
+            let s = unsafe {
+                CharStrRef::new_unbound(&*(text.as_slice() as *const [u8] as *const [_]))
+            };
+            b.iter(|| black_box(black_box(s).into_rust().is_ok()))
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_conversion,
+    bench_signature,
+    bench_drop,
+    bench_char_str_validation
+);
+criterion_main!(benches);
@@ -20,7 +20,40 @@ fn generate_impl() -> anyhow::Result<()> {
     "#
         .to_owned(),
     );
-    for name in &["CBoxedStr", "CBoxedSlice", "CBox", "COptionBox", "SliceRef"] {
+    for name in &[
+        "CBoxedStr",
+        "CCompactStr",
+        "CBoxedCStr",
+        "CStrZRef",
+        "CCowStr",
+        "CCowSlice",
+        "CBoxedSlice",
+        "CBox",
+        "COptionBox",
+        "COption",
+        "CResult",
+        "CArc",
+        "CArena",
+        "SliceRef",
+        "CharStrRef",
+        "CVec",
+        "CForeignBoxedSlice",
+        "CMutSliceRef",
+        "CByteSliceRef",
+        "CIoSliceRef",
+        "CMmapSlice",
+        "CSliceSender",
+        "CSliceReceiver",
+        "CRustIter",
+        "CRustFuture",
+        "MmapAdvice",
+        "PoolStats",
+        "OwnershipStats",
+        "OwnershipSnapshot",
+        "OwnershipShard",
+        "Symbol",
+        "SymbolTable",
+    ] {
         config.export.exclude.push(name.to_string());
         config
             .export
@@ -63,6 +96,112 @@ fn concat_header() -> anyhow::Result<()> {
     out_path.push_str("/rust_types.hxx");
     std::fs::write(out_path, out_content)?;
 
+    // The first part is also shipped alone as the forward declaration header, and the module beside it.
+    for (src, dst) in [
+        ("0fwd.hxx", "rust_types_fwd.hxx"),
+        ("rust_types.cppm", "rust_types.cppm"),
+    ] {
+        let src_path = format!("{}/cxx/{}", crate_dir()?, src);
+        println!("cargo:rerun-if-changed={:?}", src_path);
+        std::fs::copy(src_path, format!("{}/include/{}", crate_dir()?, dst))?;
+    }
+
+    Ok(())
+}
+
+/// `signature_*` functions in `cxx/test.cxx` expected to pass their argument through memory.
+#[allow(dead_code)]
+const MEMORY_PASSED_SIGNATURES: &[&str] = &["signature_c_vec", "signature_c_foreign_boxed_slice"];
+
+/// Returns names of `signature_*` functions which load or store memory in the given assembly.
+///
+/// A register-passed argument returned as it is compiles to register moves only,
+/// so any memory operand means the wrapper is spilled to the stack.
+#[allow(dead_code)]
+fn memory_passed_signatures(asm: &str, memory_operand: char) -> Vec<String> {
+    let mut found = Vec::new();
+    let mut current: Option<&str> = None;
+    for line in asm.lines() {
+        let line = line.trim();
+        if let Some(label) = line.strip_suffix(':') {
+            // Mach-O prefixes C symbols with an underscore.
+            let name = label.strip_prefix('_').unwrap_or(label);
+            if name.starts_with("signature_") {
+                current = Some(name);
+            }
+            continue;
+        }
+        let Some(name) = current else {
+            continue;
+        };
+        if line.is_empty()
+            || line.starts_with('.')
+            || line.starts_with('#')
+            || line.starts_with("//")
+        {
+            continue;
+        }
+        let mut parts = line.splitn(2, char::is_whitespace);
+        let mnemonic = parts.next().unwrap_or_default();
+        let operands = parts.next().unwrap_or_default();
+        if operands.contains(memory_operand) && !found.iter().any(|f| f == name) {
+            found.push(name.to_owned());
+        }
+        if mnemonic.starts_with("ret") {
+            current = None;
+        }
+    }
+    found
+}
+
+/// Compiles `cxx/test.cxx` to assembly and checks C-layout wrappers are passed in registers.
+#[cfg(feature = "__build_header")]
+fn check_abi() -> anyhow::Result<()> {
+    let target = std::env::var("TARGET")?;
+    let memory_operand = if target.starts_with("x86_64") && !target.contains("windows") {
+        '('
+    } else if target.starts_with("aarch64") && !target.contains("msvc") {
+        '['
+    } else {
+        // Win64 passes 16 bytes aggregates by reference. The traits are checked by static_assert instead.
+        return Ok(());
+    };
+
+    let out = std::path::PathBuf::from(std::env::var("OUT_DIR")?).join("test.s");
+    let compiler = cc::Build::new()
+        .std("c++17")
+        .cpp(true)
+        .opt_level(2)
+        .debug(false)
+        .get_compiler();
+    let status = compiler
+        .to_command()
+        .arg("-S")
+        .arg("-o")
+        .arg(&out)
+        .arg("cxx/test.cxx")
+        .status()?;
+    anyhow::ensure!(
+        status.success(),
+        "failed to compile cxx/test.cxx to assembly"
+    );
+
+    let asm = std::fs::read_to_string(&out)?;
+    anyhow::ensure!(
+        asm.contains("signature_"),
+        "no signature_* function in {:?}",
+        out
+    );
+    let spilled: Vec<_> = memory_passed_signatures(&asm, memory_operand)
+        .into_iter()
+        .filter(|name| !MEMORY_PASSED_SIGNATURES.contains(&name.as_str()))
+        .collect();
+    anyhow::ensure!(
+        spilled.is_empty(),
+        "wrappers are not passed in registers on {}: {:?}",
+        target,
+        spilled
+    );
     Ok(())
 }
 
@@ -71,12 +210,44 @@ fn make_header() -> anyhow::Result<()> {
     generate_impl()?;
     concat_header()?;
 
+    for std in ["c++17", "c++20"] {
+        cc::Build::new()
+            .std(std)
+            .file("cxx/header.cxx")
+            .file("cxx/fwd.cxx")
+            .cpp(true)
+            .warnings(true)
+            .extra_warnings(true)
+            .warnings_into_errors(true)
+            .cargo_metadata(false)
+            .compile(&format!("cxx_header_standalone_{}", std.replace('+', "x")));
+    }
+
     cc::Build::new()
         .std("c++17")
         .file("cxx/test.cxx")
         .cpp(true)
         .compile("cxx_header_test");
 
+    cc::Build::new()
+        .std("c++17")
+        .file("cxx/test.cxx")
+        .cpp(true)
+        .define("FFI_TYPES_INLINE_DEALLOC", "1")
+        .define("FFI_TYPES_POINTER_ITERATOR", "1")
+        .define("FFI_TYPES_INSTRUMENT", "1")
+        .cargo_metadata(false)
+        .compile("cxx_header_test_options");
+
+    cc::Build::new()
+        .std("c++17")
+        .file("cxx/bench.cxx")
+        .cpp(true)
+        .opt_level(2)
+        .compile("cxx_header_bench");
+
+    check_abi()?;
+
     Ok(())
 }
 
@@ -0,0 +1,992 @@
+#pragma once
+#ifndef FFI_TYPES_RUST_TYPES_FWD
+#define FFI_TYPES_RUST_TYPES_FWD
+
+//! @file rust_types_fwd.hxx
+//! @brief Forward declarations of the types of `rust_types.hxx` and definitions of the C-prefixed types
+//!        for generated FFI headers.
+//!
+//! A cbindgen or bindgen header declaring functions which take or return C-prefixed types by value,
+//! structs having them as fields, or pointers and references to any type, needs only this header.
+//! Include it there and `rust_types.hxx` only in sources calling the functions or converting the values
+//! to owned types, so most translation units don't parse the standard headers of the full header.
+//!
+//! @note The members of the C-prefixed types and the `_drop()` specializations of cbindgen trailers need
+//!       the full header. Both headers can be included in any order.
+//!       This file is also the first part of `rust_types.hxx`.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace ffi_types {
+
+/// Alias for Rust `std::usize`.
+using usize = uintptr_t;
+
+/// Alias for Rust `[T; N]`. Interpreted as std::array in C++ side.
+template <typename T, usize N>
+using Array = std::array<T, N>;
+
+// boxes
+template <typename T>
+struct OptionBox;
+template <typename T>
+struct Box;
+template <typename T>
+struct CBox;
+/// C++ wrapper for Rust `Option<Box<T>>` as alias of `CBox<T>`.
+///
+/// This is a cbindgen helper to pass `Option<Box<T>>` to C++ side.
+///
+/// @see CBox
+template <typename T>
+using COptionBox = CBox<T>;
+template <typename T>
+struct Arc;
+template <typename T>
+struct CArc;
+class Arena;
+struct CArena;
+template <typename T>
+struct COption;
+template <typename T, typename E>
+struct CResult;
+
+// slices
+template <typename T>
+struct MutSliceRef;
+template <typename T>
+struct SliceRef;
+template <typename T>
+struct CMutSliceRef;
+template <typename T>
+struct CSliceRef;
+using ByteSliceRef = SliceRef<uint8_t>;
+struct CByteSliceRef;
+using IoSliceRef = SliceRef<ByteSliceRef>;
+using CIoSliceRef = CSliceRef<ByteSliceRef>;
+template <typename T>
+class BoxedSlice;
+template <typename T>
+struct CBoxedSlice;
+template <typename T>
+class Vec;
+template <typename T>
+struct CVec;
+template <typename T>
+class ForeignBoxedSlice;
+template <typename T>
+struct CForeignBoxedSlice;
+template <typename T>
+class CowSlice;
+template <typename T>
+struct CCowSlice;
+/// A slice allocated in an `Arena`. It is valid until the arena is reset or dropped.
+/// Unlike `BoxedSlice<T>`, it is not dropped by itself.
+template <typename T>
+using ArenaSlice = MutSliceRef<T>;
+class MmapSlice;
+struct CMmapSlice;
+enum class MmapAdvice : int32_t;
+template <typename T>
+class SliceSender;
+template <typename T>
+struct CSliceSender;
+template <typename T>
+class SliceReceiver;
+template <typename T>
+struct CSliceReceiver;
+template <typename T>
+class RustIter;
+template <typename T>
+struct CRustIter;
+template <typename T>
+class RustFuture;
+template <typename T>
+struct CRustFuture;
+
+// strings
+struct CharStrRef;
+struct StrRef;
+struct CStrRef;
+using ArenaStr = StrRef;
+class BoxedStr;
+struct CBoxedStr;
+class CompactStr;
+struct CCompactStr;
+class CowStr;
+struct CCowStr;
+struct StrZRef;
+struct CStrZRef;
+class BoxedCStr;
+struct CBoxedCStr;
+struct HashedStrRef;
+struct Symbol;
+struct SymbolTable;
+
+// counters
+struct PoolStats;
+struct OwnershipStats;
+struct OwnershipSnapshot;
+struct OwnershipShard;
+
+// internal types of the fields
+template <typename T>
+struct _SliceRange;
+template <typename T>
+struct _ChannelInner;
+struct _ArenaHeader;
+template <typename T>
+struct _FutureVTable;
+template <typename T>
+struct _IterVTable;
+
+// C-prefixed types
+//
+// The layouts are complete to be passed by value and stored in fields.
+// The members converting them from and to the C++ counterparts are defined in `rust_types.hxx`.
+
+#if _MSC_VER
+#define _COPY_DELETE default
+#else
+#define _COPY_DELETE delete
+#endif
+
+/// C++ wrapper for Rust `Box<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CBox {
+    CBox() = _COPY_DELETE;
+    CBox(const CBox&) = _COPY_DELETE;
+    CBox& operator=(const CBox& b) noexcept = _COPY_DELETE;
+
+    T* _ptr;
+
+#if _MSC_VER
+    /// Creates a CBox from a `OptionBox<T>` by moving the value.
+    /// This is a workaround for MSVC constructor limitation.
+    static CBox from(OptionBox<T>&& box) noexcept;
+#else
+    CBox(CBox&&) = default;
+    CBox& operator=(CBox&& b) noexcept = default;
+    CBox(OptionBox<T>&& box) noexcept;
+
+    /// Creates a CBox from a `OptionBox<T>` by moving the value.
+    /// This is a workaround for MSVC constructor limitation.
+    static CBox from(OptionBox<T>&& box) noexcept;
+#endif
+
+    /// Conversion operator to check if the box is not null.
+    explicit operator bool() const noexcept {
+        return _ptr != nullptr;
+    }
+
+    /// Equality operator with nullptr.
+    bool operator==(std::nullptr_t) noexcept {
+        return _ptr == nullptr;
+    }
+
+    /// Conversion operator to `OptionBox<T>`.
+    ///
+    /// Though the creation of `CBox` is always expected to be non-null by Rust Side,
+    /// `CBox` itself still can be a null due to move.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    OptionBox<T> operator()() noexcept;
+
+    T* release() noexcept {
+        auto* ptr = this->_ptr;
+        this->_ptr = nullptr;
+        return ptr;
+    }
+};
+static_assert(sizeof(CBox<int>) == sizeof(int*));
+static_assert(std::is_trivial<CBox<int>>::value);
+static_assert(std::is_standard_layout<CBox<int>>::value);
+
+/// C++ wrapper for Rust `Arc<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CArc {
+    CArc() = _COPY_DELETE;
+    CArc(const CArc&) = _COPY_DELETE;
+    CArc& operator=(const CArc& b) noexcept = _COPY_DELETE;
+
+    const T* _ptr;
+
+#if _MSC_VER
+    /// Creates a CArc from a `Arc<T>` by moving the value.
+    /// This is a workaround for MSVC constructor limitation.
+    static CArc from(Arc<T>&& arc) noexcept;
+#else
+    CArc(CArc&&) = default;
+    CArc& operator=(CArc&& b) noexcept = default;
+    CArc(Arc<T>&& arc) noexcept;
+
+    /// Creates a CArc from a `Arc<T>` by moving the value.
+    /// This is a workaround for MSVC constructor limitation.
+    static CArc from(Arc<T>&& arc) noexcept;
+#endif
+
+    /// Conversion operator to `Arc<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    Arc<T> operator()() noexcept;
+
+    const T* release() noexcept {
+        auto* ptr = this->_ptr;
+        this->_ptr = nullptr;
+        return ptr;
+    }
+};
+static_assert(sizeof(CArc<int>) == sizeof(int*));
+static_assert(std::is_trivial<CArc<int>>::value);
+static_assert(std::is_standard_layout<CArc<int>>::value);
+
+template <typename T>
+struct CMutSliceRef {
+    CMutSliceRef() = _COPY_DELETE;
+    CMutSliceRef(const CMutSliceRef&) = default;
+    CMutSliceRef& operator=(const CMutSliceRef<T>&) = default;
+
+#if _MSC_VER
+    /// Creates a `CMutSliceRef` from a `MutSliceRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CMutSliceRef from(const MutSliceRef<T>& slice) noexcept;
+#else
+    constexpr CMutSliceRef(const MutSliceRef<T>& slice) noexcept;
+    /// Creates a `CMutSliceRef` from a `MutSliceRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CMutSliceRef from(const MutSliceRef<T>& slice) noexcept;
+#endif
+
+    T* _data;
+    usize _size;
+
+    constexpr MutSliceRef<T> operator()() const noexcept;
+};
+static_assert(std::is_trivial<CMutSliceRef<usize>>::value);
+static_assert(std::is_standard_layout<CMutSliceRef<usize>>::value);
+
+template <typename T>
+struct CSliceRef {
+    CSliceRef() = _COPY_DELETE;
+    CSliceRef(const CSliceRef&) = default;
+    CSliceRef& operator=(const CSliceRef<T>&) = default;
+
+#if _MSC_VER
+    /// Creates a `CSliceRef` from a `SliceRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CSliceRef from(const SliceRef<T>& slice) noexcept;
+#else
+    constexpr CSliceRef(const SliceRef<T>& slice) noexcept;
+    /// Creates a `CSliceRef` from a `SliceRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CSliceRef from(const SliceRef<T>& slice) noexcept;
+#endif
+
+    const T* _data;
+    usize _size;
+
+    constexpr SliceRef<T> operator()() const noexcept;
+};
+static_assert(std::is_trivial<CSliceRef<usize>>::value);
+static_assert(std::is_standard_layout<CSliceRef<usize>>::value);
+
+// Alias is not a C type in MSVC, so this line doesn't work.
+// ```c++
+// using CByteSliceRef = CSliceRef<uint8_t>;
+// ```
+struct CByteSliceRef {
+    CByteSliceRef() = _COPY_DELETE;
+    CByteSliceRef(const CByteSliceRef&) = default;
+    CByteSliceRef& operator=(const CByteSliceRef&) = default;
+
+#if _MSC_VER
+    /// Creates a `CByteSliceRef` from a `ByteSliceRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CByteSliceRef from(const ByteSliceRef& slice) noexcept;
+#else
+    constexpr CByteSliceRef(const ByteSliceRef& slice) noexcept;
+    /// Creates a `CByteSliceRef` from a `ByteSliceRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CByteSliceRef from(const ByteSliceRef& slice) noexcept;
+#endif
+
+    const uint8_t* _data;
+    usize _size;
+
+    ByteSliceRef operator()() const noexcept;
+};
+static_assert(std::is_trivial<CByteSliceRef>::value);
+static_assert(std::is_standard_layout<CByteSliceRef>::value);
+
+/// C++ wrapper for a boxed slice with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CBoxedSlice {
+    CBoxedSlice() = _COPY_DELETE;
+    CBoxedSlice(const CBoxedSlice&) = _COPY_DELETE;
+    CBoxedSlice& operator=(const CBoxedSlice<T>&) = _COPY_DELETE;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedSlice from(BoxedSlice<T>&& slice) noexcept;
+#else
+    CBoxedSlice(CBoxedSlice&&) = default;
+    CBoxedSlice& operator=(CBoxedSlice<T>&&) = default;
+    /// Constructs a `CBoxedSlice` by moving a `BoxedSlice`.
+    CBoxedSlice(BoxedSlice<T>&& slice) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedSlice from(BoxedSlice<T>&& slice) noexcept;
+#endif
+
+    T* _data;
+    usize _size;
+
+    /// Conversion operator to `BoxedSlice`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    BoxedSlice<T> operator()() noexcept;
+
+    _SliceRange<T> get() const noexcept;
+
+    _SliceRange<T> release() noexcept;
+};
+static_assert(std::is_trivial<CBoxedSlice<int>>::value);
+static_assert(std::is_standard_layout<CBoxedSlice<int>>::value);
+
+/// C++ wrapper for Rust `Vec<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CVec {
+    CVec() = _COPY_DELETE;
+    CVec(const CVec&) = _COPY_DELETE;
+    CVec& operator=(const CVec<T>&) = _COPY_DELETE;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CVec from(Vec<T>&& vec) noexcept;
+#else
+    CVec(CVec&&) = default;
+    CVec& operator=(CVec<T>&&) = default;
+    /// Constructs a `CVec` by moving a `Vec`.
+    CVec(Vec<T>&& vec) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CVec from(Vec<T>&& vec) noexcept;
+#endif
+
+    T* _data;
+    usize _size;
+    usize _capacity;
+
+    /// Conversion operator to `Vec`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    Vec<T> operator()() noexcept;
+};
+static_assert(std::is_trivial<CVec<int>>::value);
+static_assert(std::is_standard_layout<CVec<int>>::value);
+
+/// C++ wrapper for Rust `ForeignBoxedSlice<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CForeignBoxedSlice {
+    CForeignBoxedSlice() = _COPY_DELETE;
+    CForeignBoxedSlice(const CForeignBoxedSlice&) = _COPY_DELETE;
+    CForeignBoxedSlice& operator=(const CForeignBoxedSlice<T>&) = _COPY_DELETE;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CForeignBoxedSlice from(ForeignBoxedSlice<T>&& slice) noexcept;
+#else
+    CForeignBoxedSlice(CForeignBoxedSlice&&) = default;
+    CForeignBoxedSlice& operator=(CForeignBoxedSlice<T>&&) = default;
+    /// Constructs a `CForeignBoxedSlice` by moving a `ForeignBoxedSlice`.
+    CForeignBoxedSlice(ForeignBoxedSlice<T>&& slice) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CForeignBoxedSlice from(ForeignBoxedSlice<T>&& slice) noexcept;
+#endif
+
+    T* _data;
+    usize _size;
+    /// Same as `ForeignBoxedSlice<T>::drop_fn`.
+    void (*_drop_fn)(void* ctx);
+    void* _ctx;
+
+    /// Conversion operator to `ForeignBoxedSlice`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    ForeignBoxedSlice<T> operator()() noexcept;
+};
+static_assert(sizeof(CForeignBoxedSlice<int>) == 4 * sizeof(void*));
+static_assert(std::is_trivial<CForeignBoxedSlice<int>>::value);
+static_assert(std::is_standard_layout<CForeignBoxedSlice<int>>::value);
+
+/// C++ wrapper for Rust `MmapSlice` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CMmapSlice {
+    CMmapSlice() = _COPY_DELETE;
+    CMmapSlice(const CMmapSlice&) = _COPY_DELETE;
+    CMmapSlice& operator=(const CMmapSlice&) = _COPY_DELETE;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CMmapSlice from(MmapSlice&& slice) noexcept;
+#else
+    CMmapSlice(CMmapSlice&&) = default;
+    CMmapSlice& operator=(CMmapSlice&&) = default;
+    /// Constructs a `CMmapSlice` by moving a `MmapSlice`.
+    CMmapSlice(MmapSlice&& slice) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CMmapSlice from(MmapSlice&& slice) noexcept;
+#endif
+
+    const uint8_t* _data;
+    usize _size;
+
+    /// Conversion operator to `MmapSlice`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    MmapSlice operator()() noexcept;
+};
+static_assert(sizeof(CMmapSlice) == 2 * sizeof(void*));
+static_assert(std::is_trivial<CMmapSlice>::value);
+static_assert(std::is_standard_layout<CMmapSlice>::value);
+
+/// C++ wrapper for a str with C ABI compatible layout.
+struct CStrRef {
+    CStrRef() = _COPY_DELETE;
+    CStrRef(const CStrRef&) = default;
+    CStrRef& operator=(const CStrRef&) = default;
+
+#if _MSC_VER
+    /// Creates a `CStrRef` from a `StrRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CStrRef from(const StrRef& slice) noexcept;
+#else
+    constexpr CStrRef(const StrRef& slice) noexcept;
+    /// Creates a `CStrRef` from a `StrRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CStrRef from(const StrRef& slice) noexcept;
+#endif
+
+    const char* _data;
+    usize _size;
+
+    constexpr StrRef operator()() const noexcept;
+};
+static_assert(std::is_trivial<CStrRef>::value);
+static_assert(std::is_standard_layout<CStrRef>::value);
+
+/// C++ wrapper for Rust `Box<str>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CBoxedStr {
+    CBoxedStr() = _COPY_DELETE;
+    CBoxedStr(const CBoxedStr&) = _COPY_DELETE;
+    CBoxedStr& operator=(const CBoxedStr&) = _COPY_DELETE;
+
+    const char* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedStr from(BoxedStr&& str) noexcept;
+#else
+    CBoxedStr(CBoxedStr&&) = default;
+    CBoxedStr& operator=(CBoxedStr&&) = default;
+    CBoxedStr(BoxedStr&& str) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedStr from(BoxedStr&& slice) noexcept;
+#endif
+
+    BoxedStr operator()() noexcept;
+
+    _SliceRange<const char> release() noexcept;
+};
+static_assert(std::is_trivial<CBoxedStr>::value);
+static_assert(std::is_standard_layout<CBoxedStr>::value);
+
+/// C++ wrapper for Rust `CompactStr` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CCompactStr {
+    CCompactStr() = _COPY_DELETE;
+    CCompactStr(const CCompactStr&) = _COPY_DELETE;
+    CCompactStr& operator=(const CCompactStr&) = _COPY_DELETE;
+
+    const char* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CCompactStr from(CompactStr&& str) noexcept;
+#else
+    CCompactStr(CCompactStr&&) = default;
+    CCompactStr& operator=(CCompactStr&&) = default;
+    CCompactStr(CompactStr&& str) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CCompactStr from(CompactStr&& str) noexcept;
+#endif
+
+    CompactStr operator()() noexcept;
+
+    /// A heap string is a `BoxedStr`, which is counted by `FFI_TYPES_INSTRUMENT`.
+    bool _is_heap() const noexcept;
+};
+static_assert(std::is_trivial<CCompactStr>::value);
+static_assert(std::is_standard_layout<CCompactStr>::value);
+
+/// C++ wrapper for Rust `&CStr` with C ABI compatible layout.
+struct CStrZRef {
+    CStrZRef() = _COPY_DELETE;
+    CStrZRef(const CStrZRef&) = default;
+    CStrZRef& operator=(const CStrZRef&) = default;
+
+#if _MSC_VER
+    /// Creates a `CStrZRef` from a `StrZRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CStrZRef from(const StrZRef& s) noexcept;
+#else
+    constexpr CStrZRef(const StrZRef& s) noexcept;
+    /// Creates a `CStrZRef` from a `StrZRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CStrZRef from(const StrZRef& s) noexcept;
+#endif
+
+    const char* _data;
+    usize _size;
+
+    constexpr StrZRef operator()() const noexcept;
+};
+static_assert(std::is_trivial<CStrZRef>::value);
+static_assert(std::is_standard_layout<CStrZRef>::value);
+
+/// C++ wrapper for Rust `Box<CStr>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CBoxedCStr {
+    CBoxedCStr() = _COPY_DELETE;
+    CBoxedCStr(const CBoxedCStr&) = _COPY_DELETE;
+    CBoxedCStr& operator=(const CBoxedCStr&) = _COPY_DELETE;
+
+    const char* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedCStr from(BoxedCStr&& str) noexcept;
+#else
+    CBoxedCStr(CBoxedCStr&&) = default;
+    CBoxedCStr& operator=(CBoxedCStr&&) = default;
+    CBoxedCStr(BoxedCStr&& str) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedCStr from(BoxedCStr&& str) noexcept;
+#endif
+
+    BoxedCStr operator()() noexcept;
+
+    _SliceRange<const char> release() noexcept;
+};
+static_assert(std::is_trivial<CBoxedCStr>::value);
+static_assert(std::is_standard_layout<CBoxedCStr>::value);
+
+/// C++ wrapper for Rust `SliceSender<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CSliceSender {
+    CSliceSender() = _COPY_DELETE;
+    CSliceSender(const CSliceSender&) = _COPY_DELETE;
+    CSliceSender& operator=(const CSliceSender&) = _COPY_DELETE;
+
+    _ChannelInner<T>* _inner;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CSliceSender from(SliceSender<T>&& sender) noexcept;
+#else
+    CSliceSender(CSliceSender&&) = default;
+    CSliceSender& operator=(CSliceSender&&) = default;
+    CSliceSender(SliceSender<T>&& sender) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CSliceSender from(SliceSender<T>&& sender) noexcept;
+#endif
+
+    /// Conversion operator to `SliceSender<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    SliceSender<T> operator()() noexcept;
+};
+static_assert(sizeof(CSliceSender<int>) == sizeof(void*));
+static_assert(std::is_trivial<CSliceSender<int>>::value);
+static_assert(std::is_standard_layout<CSliceSender<int>>::value);
+
+/// C++ wrapper for Rust `SliceReceiver<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CSliceReceiver {
+    CSliceReceiver() = _COPY_DELETE;
+    CSliceReceiver(const CSliceReceiver&) = _COPY_DELETE;
+    CSliceReceiver& operator=(const CSliceReceiver&) = _COPY_DELETE;
+
+    _ChannelInner<T>* _inner;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CSliceReceiver from(SliceReceiver<T>&& receiver) noexcept;
+#else
+    CSliceReceiver(CSliceReceiver&&) = default;
+    CSliceReceiver& operator=(CSliceReceiver&&) = default;
+    CSliceReceiver(SliceReceiver<T>&& receiver) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CSliceReceiver from(SliceReceiver<T>&& receiver) noexcept;
+#endif
+
+    /// Conversion operator to `SliceReceiver<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    SliceReceiver<T> operator()() noexcept;
+};
+static_assert(sizeof(CSliceReceiver<int>) == sizeof(void*));
+static_assert(std::is_trivial<CSliceReceiver<int>>::value);
+static_assert(std::is_standard_layout<CSliceReceiver<int>>::value);
+
+/// C++ wrapper for Rust `CowStr` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CCowStr {
+    CCowStr() = _COPY_DELETE;
+    CCowStr(const CCowStr&) = _COPY_DELETE;
+    CCowStr& operator=(const CCowStr&) = _COPY_DELETE;
+
+    const char* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CCowStr from(CowStr&& str) noexcept;
+#else
+    CCowStr(CCowStr&&) = default;
+    CCowStr& operator=(CCowStr&&) = default;
+    CCowStr(CowStr&& str) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CCowStr from(CowStr&& str) noexcept;
+#endif
+
+    CowStr operator()() noexcept;
+};
+static_assert(std::is_trivial<CCowStr>::value);
+static_assert(std::is_standard_layout<CCowStr>::value);
+
+/// C++ wrapper for Rust `CowSlice<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CCowSlice {
+    CCowSlice() = _COPY_DELETE;
+    CCowSlice(const CCowSlice&) = _COPY_DELETE;
+    CCowSlice& operator=(const CCowSlice&) = _COPY_DELETE;
+
+    const T* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CCowSlice from(CowSlice<T>&& slice) noexcept;
+#else
+    CCowSlice(CCowSlice&&) = default;
+    CCowSlice& operator=(CCowSlice&&) = default;
+    CCowSlice(CowSlice<T>&& slice) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CCowSlice from(CowSlice<T>&& slice) noexcept;
+#endif
+
+    CowSlice<T> operator()() noexcept;
+};
+static_assert(std::is_trivial<CCowSlice<int>>::value);
+static_assert(std::is_standard_layout<CCowSlice<int>>::value);
+
+/// C++ wrapper for Rust `Arena` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CArena {
+    CArena() = _COPY_DELETE;
+    CArena(const CArena&) = _COPY_DELETE;
+    CArena& operator=(const CArena&) = _COPY_DELETE;
+
+    _ArenaHeader* _inner;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CArena from(Arena&& arena) noexcept;
+#else
+    CArena(CArena&&) = default;
+    CArena& operator=(CArena&&) = default;
+    CArena(Arena&& arena) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CArena from(Arena&& arena) noexcept;
+#endif
+
+    /// Conversion operator to `Arena`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    Arena operator()() noexcept;
+};
+static_assert(sizeof(CArena) == sizeof(void*));
+static_assert(std::is_trivial<CArena>::value);
+static_assert(std::is_standard_layout<CArena>::value);
+
+/// C-prefixed types of which the first field is a data pointer never null for a valid value.
+/// Same as Rust `NullNiche`.
+template <typename T>
+struct _HasNullNiche : std::false_type {};
+template <typename T>
+struct _HasNullNiche<CSliceRef<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CMutSliceRef<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CBoxedSlice<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CVec<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CForeignBoxedSlice<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CArc<T>> : std::true_type {};
+template <>
+struct _HasNullNiche<CByteSliceRef> : std::true_type {};
+template <>
+struct _HasNullNiche<CharStrRef> : std::true_type {};
+template <>
+struct _HasNullNiche<CStrRef> : std::true_type {};
+template <>
+struct _HasNullNiche<CBoxedStr> : std::true_type {};
+
+/// C++ wrapper for Rust `COption<T>` with the layout of `T`.
+///
+/// A null data pointer of `T` stands for none, so `COption<CBoxedSlice<T>>` is still 2 words
+/// and returned in registers.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] COption {
+    static_assert(_HasNullNiche<T>::value, "T must be a C-prefixed type with a non-null data pointer");
+
+    COption() = _COPY_DELETE;
+    COption(const COption&) = _COPY_DELETE;
+    COption& operator=(const COption&) = _COPY_DELETE;
+
+    union {
+        T _value;
+        /// The data pointer of `T`, which is null for none.
+        const void* _niche;
+    };
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static COption from(T&& value) noexcept;
+
+    static COption none() noexcept;
+#else
+    COption(COption&&) = default;
+    COption& operator=(COption&&) = default;
+    COption(T&& value) noexcept;
+    COption(std::nullptr_t) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static COption from(T&& value) noexcept;
+
+    static COption none() noexcept;
+#endif
+
+    bool is_some() const noexcept;
+    explicit operator bool() const noexcept {
+        return this->is_some();
+    }
+
+    /// Borrows the value. Call `operator()()` of the value to own it.
+    T& unwrap() noexcept;
+
+    /// Conversion operator to `std::optional` of the owned type of `T`, e.g. `BoxedSlice<T>` for `CBoxedSlice<T>`.
+    /// The value of `this` will be invalidated to none.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    auto operator()() noexcept;
+};
+static_assert(sizeof(COption<CBoxedSlice<int>>) == sizeof(CBoxedSlice<int>));
+static_assert(std::is_trivial<COption<CBoxedSlice<int>>>::value);
+static_assert(std::is_standard_layout<COption<CBoxedSlice<int>>>::value);
+
+/// C++ wrapper for Rust `CResult<T, E>`, a tagged union of `T` and `E`.
+///
+/// The tag is a byte before the union, so a result of 2-word `T` is 3 words and returned through memory.
+/// Use `COption<T>` with an out-parameter of the error to return in registers.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T, typename E>
+struct [[nodiscard]] CResult {
+    enum class Tag : uint8_t {
+        Ok = 0,
+        Err = 1,
+    };
+
+    CResult() = _COPY_DELETE;
+    CResult(const CResult&) = _COPY_DELETE;
+    CResult& operator=(const CResult&) = _COPY_DELETE;
+
+    Tag _tag;
+    union {
+        T _ok;
+        E _err;
+    };
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CResult ok(T&& value) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CResult err(E&& error) noexcept;
+#else
+    CResult(CResult&&) = default;
+    CResult& operator=(CResult&&) = default;
+
+    static CResult ok(T&& value) noexcept;
+
+    static CResult err(E&& error) noexcept;
+
+private:
+    CResult(Tag tag, T&& value) noexcept;
+    CResult(E&& error) noexcept;
+
+public:
+#endif
+
+    bool is_ok() const noexcept {
+        return this->_tag == Tag::Ok;
+    }
+    bool is_err() const noexcept {
+        return this->_tag == Tag::Err;
+    }
+
+    /// Borrows the `Ok` value. Call `operator()()` of the value to own it.
+    T& unwrap() noexcept;
+
+    /// Borrows the `Err` value. Call `operator()()` of the value to own it.
+    E& unwrap_err() noexcept;
+};
+static_assert(sizeof(CResult<uint32_t, int32_t>) == 2 * sizeof(uint32_t));
+static_assert(sizeof(CResult<CBoxedSlice<int>, int32_t>) == 3 * sizeof(usize));
+static_assert(std::is_trivial<CResult<CBoxedSlice<int>, int32_t>>::value);
+static_assert(std::is_standard_layout<CResult<CBoxedSlice<int>, int32_t>>::value);
+
+/// C++ wrapper for Rust `RustFuture<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CRustFuture {
+    CRustFuture() = _COPY_DELETE;
+    CRustFuture(const CRustFuture&) = _COPY_DELETE;
+    CRustFuture& operator=(const CRustFuture&) = _COPY_DELETE;
+
+    void* _state;
+    const _FutureVTable<T>* _vtable;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CRustFuture from(RustFuture<T>&& future) noexcept;
+#else
+    CRustFuture(CRustFuture&&) = default;
+    CRustFuture& operator=(CRustFuture&&) = default;
+    CRustFuture(RustFuture<T>&& future) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CRustFuture from(RustFuture<T>&& future) noexcept;
+#endif
+
+    /// Conversion operator to `RustFuture<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    RustFuture<T> operator()() noexcept;
+};
+static_assert(sizeof(CRustFuture<int>) == 2 * sizeof(void*));
+static_assert(std::is_trivial<CRustFuture<int>>::value);
+static_assert(std::is_standard_layout<CRustFuture<int>>::value);
+
+/// C++ wrapper for Rust `RustIter<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CRustIter {
+    CRustIter() = _COPY_DELETE;
+    CRustIter(const CRustIter&) = _COPY_DELETE;
+    CRustIter& operator=(const CRustIter&) = _COPY_DELETE;
+
+    void* _state;
+    const _IterVTable<T>* _vtable;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CRustIter from(RustIter<T>&& iter) noexcept;
+#else
+    CRustIter(CRustIter&&) = default;
+    CRustIter& operator=(CRustIter&&) = default;
+    CRustIter(RustIter<T>&& iter) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CRustIter from(RustIter<T>&& iter) noexcept;
+#endif
+
+    /// Conversion operator to `RustIter<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    RustIter<T> operator()() noexcept;
+};
+static_assert(sizeof(CRustIter<int>) == 2 * sizeof(void*));
+static_assert(std::is_trivial<CRustIter<int>>::value);
+static_assert(std::is_standard_layout<CRustIter<int>>::value);
+
+#undef _COPY_DELETE
+
+}  // namespace ffi_types
+
+#endif  // FFI_TYPES_RUST_TYPES_FWD
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
 #include <string>
 #include <vector>
 #if __cpp_lib_ranges
@@ -15,6 +21,28 @@
 #include <span>
 #endif
 #include <type_traits>
+#if __cpp_impl_three_way_comparison
+#include <compare>
+#endif
+#if __cpp_impl_coroutine
+#include <coroutine>
+#endif
+#if __unix__ || __APPLE__
+#include <sys/uio.h>
+#endif
+#if FFI_TYPES_PARALLEL
+#include <execution>
+#endif
+#if __AVX2__
+#include <immintrin.h>
+#elif __SSE2__ || _M_X64
+#include <emmintrin.h>
+#elif __ARM_NEON
+#include <arm_neon.h>
+#endif
+#if _MSC_VER
+#include <intrin.h>
+#endif
 
 //! @file rust_types.hh
 //! @brief This file contains matching C++ types for `ffi_types` crate.
@@ -65,18 +93,46 @@
 //!          3. Returning from C++ function. Note that this case will be very unlikely to happen because Box must be
 //!          created from Rust side.
 //!
-//! @note allocate or deallocate a boxed type in C++ side is not allowed.
-
-namespace ffi_types {
-
-/// Alias for Rust `std::usize`.
-using usize = uintptr_t;
-
-/// Alias for Rust `[T; N]`. Interpreted as std::array in C++ side.
-template <typename T, usize N>
-using Array = std::array<T, N>;
+//! @note A boxed type must be allocated by the Rust global allocator. Memory from `new` or `malloc` is not allowed.
+//!       To allocate a boxed type in C++ side, use `BoxedSlice<T>::with_capacity_uninit()`
+//!       or `BoxedStr::from_utf8_copy()`.
+//!
+//! @note Define `FFI_TYPES_INLINE_DEALLOC` to 1 to drop `BoxedStr`, `BoxedSlice<T>` and `Vec<T>` in the header.
+//!       The memory is freed by `_rust_ffi_dealloc()` with the layout from `sizeof(T)` and `alignof(T)`,
+//!       so no `_drop()` specialization is needed for a trivially destructible `T`.
+//!       The C++ layout of `T` must match the Rust layout and the Rust type must not implement `Drop`.
+//!       With cross-language LTO, the whole drop is inlined to a call of the Rust global allocator.
+//!
+//! @note Define `FFI_TYPES_PARALLEL` to 1 to run `par_for_each_chunk()` by `std::execution::par`.
+//!       The standard library may need a parallel backend to link, e.g. `-ltbb` for libstdc++.
+//!
+//! @note Define `FFI_TYPES_POINTER_ITERATOR` to 1 to make `iterator` of every slice and string type a raw pointer
+//!       instead of `std::span<T>::iterator` or `std::string_view::iterator`, which may be checked iterators in
+//!       debug builds. A pointer is a contiguous iterator in every standard, so std algorithms like `std::find()`
+//!       and `std::copy()` can be lowered to `memchr()` and `memmove()`.
+//!
+//! @note Define `FFI_TYPES_INSTRUMENT` to 1 to count values of `BoxedStr`, `BoxedSlice<T>` and `OptionBox<T>`
+//!       taken by `operator()()` of C-prefixed types or C++ allocations, then given up by `into()`, `release()`
+//!       or `_drop()`. `instrument::snapshot()` sums the counters of every thread to find leaks of C-prefixed
+//!       values. Rust side must be built with `instrument` feature. Without the flag, counting compiles to nothing.
+//!
+//! @warning `FFI_TYPES_INLINE_DEALLOC` changes the bodies of inline functions, `FFI_TYPES_INSTRUMENT` those of
+//!          the constructors, destructors, `into()` and `release()` of owned types, `FFI_TYPES_PARALLEL` that of
+//!          `par_for_each_chunk()`, and `FFI_TYPES_POINTER_ITERATOR` changes the `iterator` types, so each must be
+//!          defined the same in every translation unit of a program. Mixing the settings is an ODR violation.
 
-}  // namespace ffi_types
+#ifndef FFI_TYPES_INLINE_DEALLOC
+#define FFI_TYPES_INLINE_DEALLOC 0
+#endif
+#ifndef FFI_TYPES_PARALLEL
+#define FFI_TYPES_PARALLEL 0
+#endif
+#ifndef FFI_TYPES_POINTER_ITERATOR
+#define FFI_TYPES_POINTER_ITERATOR 0
+#endif
+#ifndef FFI_TYPES_INSTRUMENT
+#define FFI_TYPES_INSTRUMENT 0
+#endif
 
 #if _MSC_VER
 #define _COPY_DELETE default
@@ -0,0 +1,146 @@
+namespace ffi_types {
+
+/// Counters of a C++ owned type. Same as Rust `instrument::OwnershipStats`.
+struct OwnershipStats {
+    /// Values taken by C++ owned types, e.g. by `operator()()` of C-prefixed types or C++ allocations.
+    uint64_t acquired;
+    /// Values converted to C-prefixed types by `into()`, e.g. to be passed to Rust side.
+    uint64_t into;
+    /// Values given up by `release()`.
+    uint64_t released;
+    /// Values dropped by `_drop()`.
+    uint64_t dropped;
+    /// Values owned by C++ side now.
+    int64_t live;
+    /// Bytes of values owned by C++ side now. Values of `OptionBox<T>` have no bytes because `T` may be opaque.
+    int64_t live_bytes;
+};
+
+/// Counters of every C++ owned type summed over all threads. Same as Rust `instrument::OwnershipSnapshot`.
+struct OwnershipSnapshot {
+    OwnershipStats boxed_str;
+    OwnershipStats boxed_slice;
+    OwnershipStats option_box;
+};
+
+/// Counters of a thread indexed by type and event. Same as Rust `instrument::OwnershipShard`.
+/// Only the owner thread writes a shard.
+struct alignas(64) OwnershipShard {
+    std::atomic<uint64_t> counters[3][5];
+};
+static_assert(sizeof(OwnershipShard) == 2 * 64);
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t));
+
+namespace instrument {
+
+enum class _Kind : usize {
+    boxed_str = 0,
+    boxed_slice = 1,
+    option_box = 2,
+};
+
+enum class _Event : usize {
+    acquired = 0,
+    into = 1,
+    released = 2,
+    dropped = 3,
+    live_bytes = 4,
+};
+
+#if FFI_TYPES_INSTRUMENT
+/// Set while `_drop()` runs not to count `into()` or `release()` called by `_drop()` again.
+inline thread_local bool _dropping = false;
+inline thread_local OwnershipShard* _shard = nullptr;
+
+inline OwnershipShard& _thread_shard() noexcept;
+
+inline void _add(_Kind kind, _Event event, uint64_t n) noexcept {
+    auto& counter = _thread_shard().counters[static_cast<usize>(kind)][static_cast<usize>(event)];
+    // Only the current thread writes its shard, so a relaxed load and store are enough.
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/// Sums the counters of every thread. Rust side must be built with `instrument` feature.
+inline OwnershipSnapshot snapshot() noexcept;
+#endif
+
+/// Counts a value of `bytes` bytes taken by a C++ owned type.
+inline void _acquire(_Kind kind, bool owned, usize bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+    if (owned) {
+        _add(kind, _Event::acquired, 1);
+        _add(kind, _Event::live_bytes, bytes);
+    }
+#else
+    (void)kind, (void)owned, (void)bytes;
+#endif
+}
+
+/// Counts a value of `bytes` bytes given up by `into()` or `release()` out of `_drop()`.
+inline void _give_up(_Kind kind, _Event event, bool owned, usize bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+    if (owned && !_dropping) {
+        _add(kind, event, 1);
+        _add(kind, _Event::live_bytes, -static_cast<uint64_t>(bytes));
+    }
+#else
+    (void)kind, (void)event, (void)owned, (void)bytes;
+#endif
+}
+
+/// Counts a drop of a value of `bytes` bytes.
+inline void _dropped(_Kind kind, bool owned, usize bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+    if (owned) {
+        _add(kind, _Event::dropped, 1);
+        _add(kind, _Event::live_bytes, -static_cast<uint64_t>(bytes));
+    }
+#else
+    (void)kind, (void)owned, (void)bytes;
+#endif
+}
+
+/// Counts a reallocation of a value. An empty value is not owned.
+inline void _resize(_Kind kind, usize old_bytes, usize new_bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+    if (old_bytes == 0) {
+        _acquire(kind, new_bytes > 0, new_bytes);
+        return;
+    }
+    if (new_bytes == 0) {
+        _dropped(kind, true, old_bytes);
+        return;
+    }
+    _add(kind, _Event::live_bytes, static_cast<uint64_t>(new_bytes) - old_bytes);
+#else
+    (void)kind, (void)old_bytes, (void)new_bytes;
+#endif
+}
+
+/// Counts a drop of a value of `bytes` bytes while `_drop()` runs in the scope.
+class _DropScope {
+public:
+    _DropScope(_Kind kind, usize bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+        _dropped(kind, true, bytes);
+        this->_previous = _dropping;
+        _dropping = true;
+#else
+        (void)kind, (void)bytes;
+#endif
+    }
+    _DropScope(const _DropScope&) = delete;
+    _DropScope& operator=(const _DropScope&) = delete;
+#if FFI_TYPES_INSTRUMENT
+    ~_DropScope() noexcept {
+        _dropping = this->_previous;
+    }
+
+private:
+    bool _previous;
+#endif
+};
+
+}  // namespace instrument
+
+}  // namespace ffi_types
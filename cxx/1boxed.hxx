@@ -19,14 +19,17 @@ struct OptionBox {
     // constructors
     OptionBox() = delete;
     OptionBox(OptionBox&) = delete;
-    OptionBox(OptionBox&& b) noexcept : _ptr(b.release()) {}
+    OptionBox(OptionBox&& b) noexcept : _ptr(b._take()) {}
     explicit OptionBox(std::nullptr_t) noexcept : _ptr(nullptr) {}
 
-    explicit OptionBox(pointer p) noexcept : _ptr(p) {}
+    explicit OptionBox(pointer p) noexcept : _ptr(p) {
+        instrument::_acquire(instrument::_Kind::option_box, p != nullptr, 0);
+    }
 
     // destructor and helper
     ~OptionBox() noexcept {
         if (this->get()) {
+            instrument::_DropScope scope(instrument::_Kind::option_box, 0);
             this->_drop();
         }
     }
@@ -34,7 +37,7 @@ struct OptionBox {
 
     // assignment
     OptionBox& operator=(OptionBox&& b) noexcept {
-        this->_ptr = b.release();
+        this->_ptr = b._take();
         return *this;
     }
 
@@ -78,16 +81,24 @@ struct OptionBox {
 
     // modifiers
     T* release() noexcept {
-        auto* ptr = this->_ptr;
-        this->_ptr = 0;
-        return ptr;
+        instrument::_give_up(instrument::_Kind::option_box, instrument::_Event::released, this->get() != nullptr, 0);
+        return this->_take();
     }
     void reset(pointer p) noexcept {
         if (this->get()) {
+            instrument::_DropScope scope(instrument::_Kind::option_box, 0);
             this->_drop();
         }
+        instrument::_acquire(instrument::_Kind::option_box, p != nullptr, 0);
         this->_ptr = p;
     }
+
+    /// Same as `release()` but the ownership stays in C++ side, e.g. moved to another owned value.
+    T* _take() noexcept {
+        auto* ptr = this->_ptr;
+        this->_ptr = 0;
+        return ptr;
+    }
 };
 static_assert(sizeof(OptionBox<int>) == sizeof(int*));
 static_assert(std::is_standard_layout<OptionBox<int>>::value);
@@ -103,87 +114,143 @@ struct Box : public OptionBox<T> {
     }
 };
 
-/// C++ wrapper for Rust `Box<T>` with C ABI compatible layout.
+template <typename T>
+inline CBox<T> OptionBox<T>::into() noexcept {
+    return CBox<T>::from(std::move(*this));
+}
+
+template <typename T>
+struct CArc;
+
+/// C++ counterpart for Rust `std::sync::Arc<T>` sharing the reference count with Rust side.
+///
+/// Copying and destroying a non-last reference update the counter of Rust `ArcInner<T>` inline.
+/// Only the last reference crosses the FFI boundary by `_drop()`.
+/// Like `OptionBox<T>`, a moved value is a null.
 ///
-/// @warning This type does *NOT* implement a safe destructor.
-///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+/// @warning The underlying memory must be allocated by Rust `Arc::new()`.
+///          Implement template specialization for `_drop()`, which must call `std::mem::drop()` from Rust side.
 template <typename T>
-struct [[nodiscard]] CBox {
-    CBox() = _COPY_DELETE;
-    CBox(const CBox&) = _COPY_DELETE;
-    CBox& operator=(const CBox& b) noexcept = _COPY_DELETE;
+struct Arc {
+    using element_type = const T;
+    using pointer = const T*;
 
-    T* _ptr;
+    const T* _ptr;
 
-#if _MSC_VER
-    /// Creates a CBox from a `OptionBox<T>` by moving the value.
-    /// This is a workaround for MSVC constructor limitation.
-    static CBox from(OptionBox<T>&& box) noexcept {
-        CBox cbox;
-        cbox._ptr = box.release();
-        return cbox;
+    // constructors
+    Arc() = delete;
+    Arc(const Arc& a) noexcept : _ptr(a._ptr) {
+        if (this->_ptr) {
+            this->_increment();
+        }
     }
-#else
-    CBox(CBox&&) = default;
-    CBox& operator=(CBox&& b) noexcept = default;
-    CBox(OptionBox<T>&& box) noexcept : _ptr(box.release()) {}
+    Arc(Arc&& a) noexcept : _ptr(a.release()) {}
+    explicit Arc(std::nullptr_t) noexcept : _ptr(nullptr) {}
+
+    /// Takes a reference owned by the return value of Rust `Arc::into_raw()`.
+    explicit Arc(pointer p) noexcept : _ptr(p) {}
 
-    /// Creates a CBox from a `OptionBox<T>` by moving the value.
-    /// This is a workaround for MSVC constructor limitation.
-    static CBox from(OptionBox<T>&& box) noexcept {
-        return CBox(std::move(box));
+    // destructor and helper
+    ~Arc() noexcept {
+        if (this->get()) {
+            this->_release();
+        }
     }
-#endif
+    void _drop() noexcept;
 
-    /// Conversion operator to check if the box is not null.
-    explicit operator bool() const noexcept {
-        return _ptr != nullptr;
+    /// The strong counter of Rust `ArcInner<T>`, which is `#[repr(C)] { strong, weak, data }`.
+    std::atomic<usize>& _strong() const noexcept {
+        constexpr usize offset = (2 * sizeof(usize) + alignof(T) - 1) / alignof(T) * alignof(T);
+        auto* inner = reinterpret_cast<const char*>(this->_ptr) - offset;
+        return *reinterpret_cast<std::atomic<usize>*>(const_cast<char*>(inner));
     }
 
-    /// Equality operator with nullptr.
-    bool operator==(std::nullptr_t) noexcept {
-        return _ptr == nullptr;
+    void _increment() const noexcept {
+        // Same as Rust `Arc::clone()`, which aborts before the counter overflows.
+        auto old = this->_strong().fetch_add(1, std::memory_order_relaxed);
+        if (old > static_cast<usize>(INTPTR_MAX)) {
+            std::abort();
+        }
     }
 
-    /// Conversion operator to `OptionBox<T>`.
-    ///
-    /// Though the creation of `CBox` is always expected to be non-null by Rust Side,
-    /// `CBox` itself still can be a null due to move.
-    ///
-    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
-    OptionBox<T> operator()() noexcept {
-        auto box = OptionBox<T>(nullptr);
-        box.reset(this->_ptr);
-        this->_ptr = nullptr;
-        return box;
+    void _release() noexcept {
+        auto& strong = this->_strong();
+        auto count = strong.load(std::memory_order_relaxed);
+        while (count > 1) {
+            if (strong.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed)) {
+                this->_ptr = nullptr;
+                return;
+            }
+        }
+        // The last reference. Rust side decrements it again with the proper fences and frees the memory.
+        this->_drop();
     }
 
-    T* release() noexcept {
+    // assignment
+    Arc& operator=(const Arc& a) noexcept {
+        if (this != &a) {
+            *this = Arc(a);
+        }
+        return *this;
+    }
+    Arc& operator=(Arc&& a) noexcept {
+        this->reset(a.release());
+        return *this;
+    }
+
+    /// Converts to `CArc<T>` by moving the value.
+    /// The value of `this` will be invalidated to null.
+    CArc<T> into() noexcept;
+
+    // observers
+    const T& operator*() const {
+        return *get();
+    }
+    pointer operator->() const {
+        return get();
+    }
+    pointer get() const {
+        return this->_ptr;
+    }
+    explicit operator bool() const noexcept {
+        return get() != nullptr;
+    }
+    /// Same as Rust `Arc::strong_count()`.
+    usize strong_count() const noexcept {
+        return this->_strong().load(std::memory_order_relaxed);
+    }
+
+    // operators
+    bool operator==(std::nullptr_t) const {
+        return this->get() == nullptr;
+    }
+    bool operator!=(std::nullptr_t) const {
+        return this->get() != nullptr;
+    }
+
+    // modifiers
+    pointer release() noexcept {
         auto* ptr = this->_ptr;
         this->_ptr = nullptr;
         return ptr;
     }
+    void reset(pointer p) noexcept {
+        if (this->get()) {
+            this->_release();
+        }
+        this->_ptr = p;
+    }
 };
-static_assert(sizeof(CBox<int>) == sizeof(int*));
-static_assert(std::is_trivial<CBox<int>>::value);
-static_assert(std::is_standard_layout<CBox<int>>::value);
+static_assert(sizeof(Arc<int>) == sizeof(int*));
+static_assert(std::is_standard_layout<Arc<int>>::value);
+static_assert(sizeof(std::atomic<usize>) == sizeof(usize));
 
-/// C++ wrapper for Rust `Option<Box<T>>` as alias of `CBox<T>`.
-///
-/// This is a cbindgen helper to pass `Option<Box<T>>` to C++ side.
-///
-/// @see CBox
 template <typename T>
-using COptionBox = CBox<T>;
-
-template <typename T>
-inline CBox<T> OptionBox<T>::into() noexcept {
-    return CBox<T>::from(std::move(*this));
+inline CArc<T> Arc<T>::into() noexcept {
+    return CArc<T>::from(std::move(*this));
 }
 
 // specializations to prohibit void box drop
-template struct CBox<void>;
-
 template <>
 inline void OptionBox<void>::_drop() noexcept {
     assert("void box doesn't support drop" && false);
@@ -3,7 +3,7 @@ namespace ffi_types {
 #define EMPTY_SLICE_BEGIN(T) reinterpret_cast<T*>(1)
 
 template <typename T>
-T* _wrap_null(T* ptr) {
+constexpr T* _wrap_null(T* ptr) noexcept {
     return ptr ? ptr : reinterpret_cast<T*>(1);
 }
 
@@ -17,7 +17,7 @@ using std::ranges::size;
 #else
 namespace ranges {
 template <typename C>
-auto data(C& x) noexcept {
+auto _data_from_begin(C& x) noexcept {
     auto begin = x.begin();
 
     using iterator_type = decltype(begin);
@@ -38,27 +38,491 @@ auto data(C& x) noexcept {
     }
 }
 
+/// `true` if `C::data()` returns a pointer.
+template <typename C, typename = void>
+struct _has_data : std::false_type {};
 template <typename C>
-size_t size(C& x) noexcept {
-    return x.end() - x.begin();
+struct _has_data<C, std::void_t<decltype(std::declval<C&>().data())>>
+    : std::is_pointer<decltype(std::declval<C&>().data())> {};
+
+template <typename C>
+constexpr auto data(C& x) noexcept {
+    if constexpr (std::is_array_v<C>) {
+        return static_cast<std::remove_extent_t<C>*>(x);
+    } else if constexpr (_has_data<C>::value) {
+        return x.data();
+    } else {
+        return _data_from_begin(x);
+    }
+}
+
+template <typename C>
+constexpr size_t size(C& x) noexcept {
+    if constexpr (std::is_array_v<C>) {
+        return std::extent_v<C>;
+    } else {
+        return x.end() - x.begin();
+    }
 }
 }  // namespace ranges
 // R&& is not safe without actual ranges
 #define SAFE_R const R&
 #endif
 
+// UTF-8 validation following Rust `std::str::from_utf8`.
+namespace _utf8 {
+
+#if __AVX2__
+inline constexpr usize ASCII_BLOCK = 32;
+#else
+inline constexpr usize ASCII_BLOCK = 16;
+#endif
+
+/// Checks if `ASCII_BLOCK * N` bytes from `s` are all ASCII.
+template <usize N>
+inline bool _is_ascii_block(const uint8_t* s) noexcept {
+#if __AVX2__
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    for (usize k = 1; k < N; ++k) {
+        v = _mm256_or_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + k * ASCII_BLOCK)));
+    }
+    return _mm256_movemask_epi8(v) == 0;
+#elif __SSE2__ || _M_X64
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    for (usize k = 1; k < N; ++k) {
+        v = _mm_or_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + k * ASCII_BLOCK)));
+    }
+    return _mm_movemask_epi8(v) == 0;
+#elif __ARM_NEON && __aarch64__
+    auto v = vld1q_u8(s);
+    for (usize k = 1; k < N; ++k) {
+        v = vorrq_u8(v, vld1q_u8(s + k * ASCII_BLOCK));
+    }
+    return vmaxvq_u8(v) < 0x80;
+#else
+    uint64_t words[N * 2];
+    std::memcpy(words, s, sizeof(words));
+    uint64_t v = 0;
+    for (usize k = 0; k < N * 2; ++k) {
+        v |= words[k];
+    }
+    return (v & 0x8080808080808080ull) == 0;
+#endif
+}
+
+constexpr bool _is_continuation(uint8_t c) noexcept {
+    return (c & 0xc0) == 0x80;
+}
+
+/// Returns the width of a valid multi-byte character at `data[i]`, or 0 if it is invalid.
+constexpr usize _multi_byte_width(const char* data, usize size, usize i) noexcept {
+    const auto byte = [&](usize j) { return static_cast<uint8_t>(data[i + j]); };
+    const uint8_t c = byte(0);
+    const usize remaining = size - i;
+    if (c >= 0xc2 && c <= 0xdf) {
+        if (remaining < 2 || !_is_continuation(byte(1))) {
+            return 0;
+        }
+        return 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        if (remaining < 3) {
+            return 0;
+        }
+        const uint8_t c1 = byte(1);
+        // reject overlong encodings and surrogates
+        const bool valid1 = c == 0xe0 ? (c1 >= 0xa0 && c1 <= 0xbf)
+                            : c == 0xed ? (c1 >= 0x80 && c1 <= 0x9f)
+                                        : _is_continuation(c1);
+        if (!valid1 || !_is_continuation(byte(2))) {
+            return 0;
+        }
+        return 3;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        if (remaining < 4) {
+            return 0;
+        }
+        const uint8_t c1 = byte(1);
+        // reject overlong encodings and code points over U+10FFFF
+        const bool valid1 = c == 0xf0 ? (c1 >= 0x90 && c1 <= 0xbf)
+                            : c == 0xf4 ? (c1 >= 0x80 && c1 <= 0x8f)
+                                        : _is_continuation(c1);
+        if (!valid1 || !_is_continuation(byte(2)) || !_is_continuation(byte(3))) {
+            return 0;
+        }
+        return 4;
+    }
+    return 0;
+}
+
+/// Validates a string with vectorized ASCII blocks and scalar multi-byte characters.
+inline bool validate(const char* data, usize size) noexcept {
+    const auto* s = reinterpret_cast<const uint8_t*>(data);
+    usize i = 0;
+    while (i < size) {
+        while (size - i >= ASCII_BLOCK * 4 && _is_ascii_block<4>(s + i)) {
+            i += ASCII_BLOCK * 4;
+        }
+        while (size - i >= ASCII_BLOCK && _is_ascii_block<1>(s + i)) {
+            i += ASCII_BLOCK;
+        }
+        while (i < size && s[i] < 0x80) {
+            i += 1;
+        }
+        if (i == size) {
+            break;
+        }
+        const usize width = _multi_byte_width(data, size, i);
+        if (width == 0) {
+            return false;
+        }
+        i += width;
+    }
+    return true;
+}
+
+/// Validates a string without vector instructions, so that it can be evaluated at compile time.
+constexpr bool validate_constexpr(const char* data, usize size) noexcept {
+    usize i = 0;
+    while (i < size) {
+        if (static_cast<uint8_t>(data[i]) < 0x80) {
+            i += 1;
+            continue;
+        }
+        const usize width = _multi_byte_width(data, size, i);
+        if (width == 0) {
+            return false;
+        }
+        i += width;
+    }
+    return true;
+}
+
+}  // namespace _utf8
+
+// Byte search kernels of `CharStrRef` following Rust `str` methods.
+namespace _str {
+
+#if __AVX2__
+inline constexpr usize BLOCK = 32;
+#else
+inline constexpr usize BLOCK = 16;
+#endif
+#define _STR_SIMD (__AVX2__ || __SSE2__ || _M_X64 || (__ARM_NEON && __aarch64__))
+
+inline unsigned _lowest_bit(uint32_t mask) noexcept {
+#if _MSC_VER && !__clang__
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+inline unsigned _highest_bit(uint32_t mask) noexcept {
+#if _MSC_VER && !__clang__
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return 31 - static_cast<unsigned>(__builtin_clz(mask));
+#endif
+}
+
+#if _STR_SIMD
+/// Returns a mask of `i` in `[0, BLOCK)` where `s[i] == c`.
+inline uint32_t _eq_mask(const uint8_t* s, uint8_t c) noexcept {
+#if __AVX2__
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(c)))));
+#elif __SSE2__ || _M_X64
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(c)))));
+#else
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const auto bits = vandq_u8(vceqq_u8(vld1q_u8(s), vdupq_n_u8(c)), vld1q_u8(weights));
+    return vaddv_u8(vget_low_u8(bits)) | static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8;
+#endif
+}
+
+/// Checks if `BLOCK` bytes of `a` and `b` are equal after ASCII lowercasing.
+inline bool _eq_ignore_ascii_case_block(const uint8_t* a, const uint8_t* b) noexcept {
+#if __AVX2__
+    const auto lower = [](const uint8_t* s) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        // 'A'..'Z' is shifted to the lowest signed values to be compared at once.
+        const auto shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+        const auto upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + 26)), shifted);
+        return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    };
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(lower(a), lower(b))) == -1;
+#elif __SSE2__ || _M_X64
+    const auto lower = [](const uint8_t* s) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        // 'A'..'Z' is shifted to the lowest signed values to be compared at once.
+        const auto shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+        const auto upper = _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(0x80 + 26)), shifted);
+        return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    };
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(lower(a), lower(b))) == 0xffff;
+#else
+    const auto lower = [](const uint8_t* s) {
+        const auto v = vld1q_u8(s);
+        const auto upper = vcltq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8(26));
+        return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+    };
+    return vminvq_u8(vceqq_u8(lower(a), lower(b))) == 0xff;
+#endif
+}
+#endif
+
+inline constexpr usize NOT_FOUND = ~usize(0);
+
+/// Returns the first index of `needle` in `haystack` like Rust `str::find`, or `NOT_FOUND`.
+///
+/// Blocks of candidates are filtered by the first and the last bytes of `needle` before comparing the rest.
+inline usize find(const char* haystack, usize size, const char* needle, usize needle_size) noexcept {
+    if (needle_size == 0) {
+        return 0;
+    }
+    if (needle_size > size) {
+        return NOT_FOUND;
+    }
+    if (needle_size == 1) {
+        const auto* found = std::memchr(haystack, needle[0], size);
+        return found ? static_cast<const char*>(found) - haystack : NOT_FOUND;
+    }
+    const auto* h = reinterpret_cast<const uint8_t*>(haystack);
+    const auto* n = reinterpret_cast<const uint8_t*>(needle);
+    const usize last = needle_size - 1;
+    usize i = 0;
+#if _STR_SIMD
+    for (; i + last + BLOCK <= size; i += BLOCK) {
+        auto mask = _eq_mask(h + i, n[0]) & _eq_mask(h + i + last, n[last]);
+        while (mask != 0) {
+            const usize j = i + _lowest_bit(mask);
+            if (needle_size == 2 || std::memcmp(h + j + 1, n + 1, needle_size - 2) == 0) {
+                return j;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + last < size; ++i) {
+        if (h[i] == n[0] && h[i + last] == n[last] && std::memcmp(h + i + 1, n + 1, needle_size - 2) == 0) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+/// Returns the last index of `needle` in `haystack` like Rust `str::rfind`, or `NOT_FOUND`.
+inline usize rfind(const char* haystack, usize size, const char* needle, usize needle_size) noexcept {
+    if (needle_size == 0) {
+        return size;
+    }
+    if (needle_size > size) {
+        return NOT_FOUND;
+    }
+    const auto* h = reinterpret_cast<const uint8_t*>(haystack);
+    const auto* n = reinterpret_cast<const uint8_t*>(needle);
+    const usize last = needle_size - 1;
+    // candidates are `[0, end)`
+    usize end = size - last;
+#if _STR_SIMD
+    for (; end >= BLOCK; end -= BLOCK) {
+        const usize i = end - BLOCK;
+        auto mask = _eq_mask(h + i, n[0]) & _eq_mask(h + i + last, n[last]);
+        while (mask != 0) {
+            const unsigned bit = _highest_bit(mask);
+            if (needle_size <= 2 || std::memcmp(h + i + bit + 1, n + 1, needle_size - 2) == 0) {
+                return i + bit;
+            }
+            mask &= ~(uint32_t(1) << bit);
+        }
+    }
+#endif
+    while (end-- > 0) {
+        if (h[end] == n[0] && h[end + last] == n[last] &&
+            (needle_size <= 2 || std::memcmp(h + end + 1, n + 1, needle_size - 2) == 0)) {
+            return end;
+        }
+    }
+    return NOT_FOUND;
+}
+
+/// Returns the first index of any of `set` in `haystack`, or `NOT_FOUND`.
+inline usize find_any(const char* haystack, usize size, const char* set, usize set_size) noexcept {
+    const auto* h = reinterpret_cast<const uint8_t*>(haystack);
+    const auto* s = reinterpret_cast<const uint8_t*>(set);
+    usize i = 0;
+#if _STR_SIMD
+    for (; i + BLOCK <= size; i += BLOCK) {
+        uint32_t mask = 0;
+        for (usize k = 0; k < set_size; ++k) {
+            mask |= _eq_mask(h + i, s[k]);
+        }
+        if (mask != 0) {
+            return i + _lowest_bit(mask);
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (set_size > 0 && std::memchr(set, h[i], set_size)) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+constexpr uint8_t _to_ascii_lowercase(uint8_t c) noexcept {
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+/// Checks if two strings are equal after ASCII lowercasing like Rust `str::eq_ignore_ascii_case`.
+inline bool eq_ignore_ascii_case(const char* a, const char* b, usize size) noexcept {
+    const auto* x = reinterpret_cast<const uint8_t*>(a);
+    const auto* y = reinterpret_cast<const uint8_t*>(b);
+    usize i = 0;
+#if _STR_SIMD
+    for (; i + BLOCK <= size; i += BLOCK) {
+        if (!_eq_ignore_ascii_case_block(x + i, y + i)) {
+            return false;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (_to_ascii_lowercase(x[i]) != _to_ascii_lowercase(y[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace _str
+
+/// A forward range of the parts of a string split by any byte of a set, returned by `split()`.
+///
+/// The parts are the same as Rust `str::split(&[char])` of the ASCII characters: a separator at either end
+/// makes an empty part, and an empty string is one empty part. `S` is `StrRef` for UTF-8 strings.
+template <typename S>
+struct _StrSplit {
+    const char* _data;
+    usize _size;
+    const char* _set;
+    usize _set_size;
+
+    /// Keeps the end and the separators of the string, so it may outlive the range.
+    ///
+    /// `reference` is a part made on dereference, so the iterator is only an input iterator before C++20.
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+#if __cplusplus >= 202002L
+        using iterator_concept = std::forward_iterator_tag;
+#endif
+        using value_type = S;
+        using difference_type = intptr_t;
+        using pointer = void;
+        using reference = S;
+
+        /// The start of the part, or null at the end.
+        const char* _start;
+        usize _part_size;
+        const char* _end;
+        const char* _set;
+        usize _set_size;
+
+        void _find() noexcept {
+            const usize rest = this->_end - this->_start;
+            const usize found = _str::find_any(this->_start, rest, this->_set, this->_set_size);
+            this->_part_size = found == _str::NOT_FOUND ? rest : found;
+        }
+
+        reference operator*() const noexcept {
+            return S::_from_parts(this->_start, this->_part_size);
+        }
+        iterator& operator++() noexcept {
+            const auto* part_end = this->_start + this->_part_size;
+            if (part_end == this->_end) {
+                this->_start = nullptr;
+            } else {
+                this->_start = part_end + 1;
+                this->_find();
+            }
+            return *this;
+        }
+        iterator operator++(int) noexcept {
+            auto it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const iterator& other) const noexcept {
+            return this->_start == other._start;
+        }
+        bool operator!=(const iterator& other) const noexcept {
+            return this->_start != other._start;
+        }
+    };
+
+    iterator begin() const noexcept {
+        auto it = iterator{this->_data, 0, this->_data + this->_size, this->_set, this->_set_size};
+        it._find();
+        return it;
+    }
+    iterator end() const noexcept {
+        return iterator{nullptr, 0, this->_data + this->_size, this->_set, this->_set_size};
+    }
+};
+
+/// Hashes bytes by the same function as Rust `ffi_types::hash_bytes`.
+///
+/// The result is stable only in the same process. Words are loaded in native endian.
+inline uint64_t hash_bytes(const void* data, usize size) noexcept {
+    constexpr uint64_t K = 0x9e3779b97f4a7c15;
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t h = static_cast<uint64_t>(size) * K;
+    uint64_t word;
+    for (; size >= 8; size -= 8, p += 8) {
+        std::memcpy(&word, p, 8);
+        h = ((h << 5 | h >> 59) ^ word) * K;
+    }
+    if (size > 0) {
+        word = 0;
+        std::memcpy(&word, p, size);
+        h = ((h << 5 | h >> 59) ^ word) * K;
+    }
+    // finalizer of MurmurHash3
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccd;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53;
+    h ^= h >> 33;
+    return h;
+}
+
 struct CharStrRef;
 struct StrRef;
 struct CStrRef;
 struct CByteSliceRef;
 class BoxedStr;
+class BoxedCStr;
 
+template <typename T>
+struct MutSliceRef;
+template <typename T>
+struct SliceRef;
 template <typename T>
 struct CMutSliceRef;
 template <typename T>
 struct CSliceRef;
 template <typename T>
 struct CBoxedSlice;
+template <typename T>
+struct CVec;
+template <typename T>
+struct CForeignBoxedSlice;
+struct CMmapSlice;
 
 /// A minimal range type of slices to be compatible with internal ranges.
 template <typename T>
@@ -74,6 +538,128 @@ struct _SliceRange {
     }
 };
 
+/// A view to a part of a slice of `T`. `SliceRef<U>` if `T` is `const U`, `MutSliceRef<T>` otherwise.
+template <typename T>
+using _SliceView = std::conditional_t<std::is_const_v<T>, SliceRef<std::remove_const_t<T>>, MutSliceRef<T>>;
+
+/// A random access range of views returned by `chunks()`, `chunks_exact()` or `windows()`.
+///
+/// The `i`-th view starts at `i * _step` and has `_width` elements, or less for the last view of `chunks()`.
+/// The partition is the same as Rust `slice::chunks()`, `slice::chunks_exact()` and `slice::windows()`.
+template <typename T>
+struct _SliceChunks {
+    T* _data;
+    /// The number of elements covered by the views.
+    usize _size;
+    /// The number of elements after the covered ones. Only `chunks_exact()` leaves a remainder.
+    usize _rest;
+    usize _step;
+    usize _width;
+    usize _count;
+
+    /// `reference` is a view made on dereference, so the iterator is only an input iterator before C++20.
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+#if __cplusplus >= 202002L
+        using iterator_concept = std::random_access_iterator_tag;
+#endif
+        using value_type = _SliceView<T>;
+        using difference_type = intptr_t;
+        using pointer = void;
+        using reference = value_type;
+
+        _SliceChunks<T> _chunks;
+        usize _index;
+
+        reference operator*() const noexcept {
+            return this->_chunks[this->_index];
+        }
+        reference operator[](difference_type n) const noexcept {
+            return this->_chunks[this->_index + n];
+        }
+        iterator& operator++() noexcept {
+            ++this->_index;
+            return *this;
+        }
+        iterator operator++(int) noexcept {
+            auto it = *this;
+            ++this->_index;
+            return it;
+        }
+        iterator& operator--() noexcept {
+            --this->_index;
+            return *this;
+        }
+        iterator operator--(int) noexcept {
+            auto it = *this;
+            --this->_index;
+            return it;
+        }
+        iterator& operator+=(difference_type n) noexcept {
+            this->_index += n;
+            return *this;
+        }
+        iterator& operator-=(difference_type n) noexcept {
+            this->_index -= n;
+            return *this;
+        }
+        friend iterator operator+(iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+        friend iterator operator+(difference_type n, iterator it) noexcept {
+            return it += n;
+        }
+        friend iterator operator-(iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+        friend difference_type operator-(const iterator& a, const iterator& b) noexcept {
+            return static_cast<difference_type>(a._index - b._index);
+        }
+        friend bool operator==(const iterator& a, const iterator& b) noexcept {
+            return a._index == b._index;
+        }
+        friend bool operator!=(const iterator& a, const iterator& b) noexcept {
+            return a._index != b._index;
+        }
+        friend bool operator<(const iterator& a, const iterator& b) noexcept {
+            return a._index < b._index;
+        }
+        friend bool operator<=(const iterator& a, const iterator& b) noexcept {
+            return a._index <= b._index;
+        }
+        friend bool operator>(const iterator& a, const iterator& b) noexcept {
+            return a._index > b._index;
+        }
+        friend bool operator>=(const iterator& a, const iterator& b) noexcept {
+            return a._index >= b._index;
+        }
+    };
+
+    usize size() const noexcept {
+        return this->_count;
+    }
+    bool empty() const noexcept {
+        return this->_count == 0;
+    }
+    _SliceView<T> operator[](usize idx) const noexcept {
+        assert(idx < this->_count);
+        const auto offset = idx * this->_step;
+        return _SliceView<T>(this->_data + offset, std::min(this->_width, this->_size - offset));
+    }
+    iterator begin() const noexcept {
+        return iterator{*this, 0};
+    }
+    iterator end() const noexcept {
+        return iterator{*this, this->_count};
+    }
+
+    /// Returns the elements not covered by `chunks_exact()`. Empty for the others.
+    _SliceView<T> remainder() const noexcept {
+        return _SliceView<T>(this->_data + this->_size, this->_rest);
+    }
+};
+
 /// Common C++ STL-like interface for &[T] and &str.
 /// @see std::span
 template <typename T, template <typename _> typename I>
@@ -87,7 +673,7 @@ struct _SliceInterface {
     using const_pointer = const element_type*;
     using reference = element_type&;
     using const_reference = const element_type&;
-#if __cpp_lib_span
+#if __cpp_lib_span && !FFI_TYPES_POINTER_ITERATOR
     using iterator = typename std::span<element_type>::iterator;
 #else
     using iterator = pointer;
@@ -95,33 +681,33 @@ struct _SliceInterface {
     using reverse_iterator = std::reverse_iterator<iterator>;
 
     // observers
-    size_type size() const noexcept {
+    constexpr size_type size() const noexcept {
         return static_cast<const I<T>*>(this)->_size;
     }
-    size_type size_bytes() const noexcept {
+    constexpr size_type size_bytes() const noexcept {
         return this->size() * sizeof(element_type);
     }
-    bool empty() const noexcept {
+    constexpr bool empty() const noexcept {
         return this->size() == 0;
     }
 
     // element access
-    reference operator[](size_type idx) const noexcept {
+    constexpr reference operator[](size_type idx) const noexcept {
         assert(idx < this->size());
         return this->data()[idx];
     }
-    reference front() const noexcept {
+    constexpr reference front() const noexcept {
         return this->data()[0];
     }
-    reference back() const noexcept {
+    constexpr reference back() const noexcept {
         return this->data()[size() - 1];
     }
-    pointer data() const noexcept {
+    constexpr pointer data() const noexcept {
         return static_cast<const I<T>*>(this)->_data;
     }
 
     // iterator
-#if __cpp_lib_span
+#if __cpp_lib_span && !FFI_TYPES_POINTER_ITERATOR
     iterator begin() const noexcept {
         return span().begin();
     }
@@ -144,6 +730,49 @@ struct _SliceInterface {
         return {data(), size()};
     }
 
+    // subviews, following Rust `[T]` methods
+    /// Returns the first `count` elements.
+    _SliceView<T> first(size_type count) const noexcept {
+        assert(count <= size());
+        return _SliceView<T>(data(), count);
+    }
+    /// Returns the last `count` elements.
+    _SliceView<T> last(size_type count) const noexcept {
+        assert(count <= size());
+        return _SliceView<T>(data() + (size() - count), count);
+    }
+    /// Returns `count` elements from `offset`, or the rest of the slice by default.
+    _SliceView<T> subslice(size_type offset, size_type count = SIZE_MAX) const noexcept {
+        assert(offset <= size());
+        if (count == SIZE_MAX) {
+            count = size() - offset;
+        }
+        assert(count <= size() - offset);
+        return _SliceView<T>(data() + offset, count);
+    }
+    /// Divides the slice into `[0, mid)` and `[mid, size())`.
+    std::pair<_SliceView<T>, _SliceView<T>> split_at(size_type mid) const noexcept {
+        assert(mid <= size());
+        return {_SliceView<T>(data(), mid), _SliceView<T>(data() + mid, size() - mid)};
+    }
+    /// Returns views of `chunk_size` elements. The last chunk is shorter if `chunk_size` doesn't divide the size.
+    _SliceChunks<T> chunks(size_type chunk_size) const noexcept {
+        assert(chunk_size > 0);
+        return {data(), size(), 0, chunk_size, chunk_size, size() / chunk_size + (size() % chunk_size != 0)};
+    }
+    /// Returns views of exactly `chunk_size` elements. The rest is left to `remainder()`.
+    _SliceChunks<T> chunks_exact(size_type chunk_size) const noexcept {
+        assert(chunk_size > 0);
+        const auto count = size() / chunk_size;
+        return {data(), count * chunk_size, size() - count * chunk_size, chunk_size, chunk_size, count};
+    }
+    /// Returns all overlapping views of `window_size` elements.
+    _SliceChunks<T> windows(size_type window_size) const noexcept {
+        assert(window_size > 0);
+        const auto count = size() >= window_size ? size() - window_size + 1 : 0;
+        return {data(), size(), 0, 1, window_size, count};
+    }
+
 #if __cpp_lib_span
     /// Returns the slice as a `std::span`.
     std::span<element_type> span() const noexcept {
@@ -152,6 +781,48 @@ struct _SliceInterface {
 #endif
 };
 
+// comparisons of slices with the same element type, e.g. `SliceRef<T>`, `MutSliceRef<T>`, `BoxedSlice<T>` or `Vec<T>`.
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator==(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    static_assert(std::is_same_v<std::remove_cv_t<T>, std::remove_cv_t<U>>, "comparing slices of different types");
+    if (a.size() != b.size()) {
+        return false;
+    }
+    if constexpr (std::has_unique_object_representations_v<std::remove_cv_t<T>>) {
+        return a.empty() || std::memcmp(a.data(), b.data(), a.size_bytes()) == 0;
+    } else {
+        return std::equal(a.data(), a.data() + a.size(), b.data());
+    }
+}
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator!=(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return !(a == b);
+}
+#if __cpp_lib_three_way_comparison
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline auto operator<=>(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return std::lexicographical_compare_three_way(
+            a.data(), a.data() + a.size(), b.data(), b.data() + b.size());
+}
+#else
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator<(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return std::lexicographical_compare(a.data(), a.data() + a.size(), b.data(), b.data() + b.size());
+}
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator<=(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return !(b < a);
+}
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator>(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return b < a;
+}
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator>=(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return !(a < b);
+}
+#endif
+
 /// C++ counterpart of Rust `&mut [T]` and &[T]`.
 /// The interface is following `std::span` design.
 template <typename T>
@@ -162,9 +833,9 @@ struct MutSliceRef : public _SliceInterface<T, MutSliceRef> {
     MutSliceRef() noexcept : _data(EMPTY_SLICE_BEGIN(T)), _size(0) {}
     MutSliceRef(const MutSliceRef&) = default;
     MutSliceRef(MutSliceRef&&) = default;
-    explicit MutSliceRef(T* head, usize size) noexcept : _data(_wrap_null(head)), _size(size) {}
+    constexpr explicit MutSliceRef(T* head, usize size) noexcept : _data(_wrap_null(head)), _size(size) {}
     template <class R>
-    MutSliceRef(SAFE_R range) noexcept
+    constexpr MutSliceRef(SAFE_R range) noexcept
         : _data(_wrap_null(ranges::data(range))), _size(static_cast<usize>(ranges::size(range))) {}
 
     MutSliceRef& operator=(const MutSliceRef<T>&) = default;
@@ -196,9 +867,9 @@ struct SliceRef : public MutSliceRef<const T> {
     SliceRef() noexcept : MutSliceRef<const T>(){};
     SliceRef(const SliceRef&) = default;
     SliceRef(SliceRef&&) = default;
-    explicit SliceRef(const T* head, usize size) noexcept : MutSliceRef<const T>(head, size) {}
+    constexpr explicit SliceRef(const T* head, usize size) noexcept : MutSliceRef<const T>(head, size) {}
     template <class R>
-    SliceRef(SAFE_R range) noexcept : MutSliceRef<const T>(range) {}
+    constexpr SliceRef(SAFE_R range) noexcept : MutSliceRef<const T>(range) {}
 
     SliceRef& operator=(const SliceRef<T>&) = default;
     SliceRef& operator=(SliceRef<T>&&) = default;
@@ -217,123 +888,6 @@ static_assert(std::is_standard_layout<SliceRef<usize>>::value);
 /// This alias is useful to pass `&[u8]` in cbindgen without configuration and boilerplate.
 using ByteSliceRef = SliceRef<uint8_t>;
 
-template <typename T>
-struct CMutSliceRef {
-    CMutSliceRef() = _COPY_DELETE;
-    CMutSliceRef(const CMutSliceRef&) = default;
-    CMutSliceRef& operator=(const CMutSliceRef<T>&) = default;
-
-#if _MSC_VER
-    /// Creates a `CMutSliceRef` from a `MutSliceRef`.
-    /// This is a workaround for MSVC constructor limitation.
-    static CMutSliceRef from(const MutSliceRef<T>& slice) noexcept {
-        CMutSliceRef s;
-        s._data = slice._data;
-        s._size = slice._size;
-        return s;
-    }
-#else
-    CMutSliceRef(const MutSliceRef<T>& slice) noexcept {
-        this->_data = slice._data;
-        this->_size = slice._size;
-    }
-    /// Creates a `CMutSliceRef` from a `MutSliceRef`.
-    /// This is a workaround for MSVC constructor limitation.
-    static CMutSliceRef from(const MutSliceRef<T>& slice) noexcept {
-        return CMutSliceRef(slice);
-    }
-#endif
-
-    T* _data;
-    usize _size;
-
-    MutSliceRef<T> operator()() const noexcept {
-        return MutSliceRef<T>(this->_data, this->_size);
-    }
-};
-static_assert(std::is_trivial<CMutSliceRef<usize>>::value);
-static_assert(std::is_standard_layout<CMutSliceRef<usize>>::value);
-
-template <typename T>
-struct CSliceRef {
-    CSliceRef() = _COPY_DELETE;
-    CSliceRef(const CSliceRef&) = default;
-    CSliceRef& operator=(const CSliceRef<T>&) = default;
-
-#if _MSC_VER
-    /// Creates a `CSliceRef` from a `SliceRef`.
-    /// This is a workaround for MSVC constructor limitation.
-    static CSliceRef from(const SliceRef<T>& slice) noexcept {
-        CSliceRef s;
-        s._data = slice._data;
-        s._size = slice._size;
-        return s;
-    }
-#else
-    CSliceRef(const SliceRef<T>& slice) noexcept {
-        this->_data = slice._data;
-        this->_size = slice._size;
-    }
-    /// Creates a `CSliceRef` from a `SliceRef`.
-    /// This is a workaround for MSVC constructor limitation.
-    static CSliceRef from(const SliceRef<T>& slice) noexcept {
-        return CSliceRef(slice);
-    }
-#endif
-
-    const T* _data;
-    usize _size;
-
-    SliceRef<T> operator()() const noexcept {
-        return SliceRef<T>(this->_data, this->_size);
-    }
-};
-static_assert(std::is_trivial<CSliceRef<usize>>::value);
-static_assert(std::is_standard_layout<CSliceRef<usize>>::value);
-
-// Alias is not a C type in MSVC, so this line doesn't work.
-// ```c++
-// using CByteSliceRef = CSliceRef<uint8_t>;
-// ```
-struct CByteSliceRef {
-    CByteSliceRef() = _COPY_DELETE;
-    CByteSliceRef(const CByteSliceRef&) = default;
-    CByteSliceRef& operator=(const CByteSliceRef&) = default;
-
-#if _MSC_VER
-    /// Creates a `CByteSliceRef` from a `ByteSliceRef`.
-    /// This is a workaround for MSVC constructor limitation.
-    static CByteSliceRef from(const ByteSliceRef& slice) noexcept {
-        CByteSliceRef s;
-        s._data = slice._data;
-        s._size = slice._size;
-        return s;
-    }
-#else
-    CByteSliceRef(const ByteSliceRef& slice) noexcept {
-        this->_data = slice._data;
-        this->_size = slice._size;
-    }
-    /// Creates a `CByteSliceRef` from a `ByteSliceRef`.
-    /// This is a workaround for MSVC constructor limitation.
-    static CByteSliceRef from(const ByteSliceRef& slice) noexcept {
-        return CByteSliceRef(slice);
-    }
-#endif
-
-    const uint8_t* _data;
-    usize _size;
-
-    ByteSliceRef operator()() const noexcept {
-        ByteSliceRef slice;
-        slice._data = this->_data;
-        slice._size = this->_size;
-        return slice;
-    }
-};
-static_assert(std::is_trivial<CByteSliceRef>::value);
-static_assert(std::is_standard_layout<CByteSliceRef>::value);
-
 /// C++ counterpart of `Box<T>`
 /// The ownership API is following `std::unique_ptr` design and the slice API is following `std::span` design.
 template <typename T>
@@ -348,16 +902,46 @@ public:
     BoxedSlice(std::nullptr_t) noexcept : MutSliceRef<T>() {}
     ~BoxedSlice() noexcept {
         if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_slice, sizeof(T) * this->_size);
             this->_drop();
         }
     }
     BoxedSlice<T>& operator=(BoxedSlice<T>&& b) noexcept {
-        this->reset(b.release());
+        this->_reset(b._take());
         return *this;
     }
 
     void _drop() noexcept;
 
+    /// Drops every item of `items`. The items are left empty.
+    /// Specialize this function to drop the items by a single call to Rust side.
+    static void _drop_many(MutSliceRef<BoxedSlice<T>> items) noexcept {
+        for (auto& item : items) {
+            auto dropped = std::move(item);
+        }
+    }
+
+    /// Allocates a boxed slice of `size` uninitialized elements from the Rust global allocator.
+    /// The layout is the same as Rust `Box<[T]>` so that the value can be dropped in either side.
+    ///
+    /// @warning Every element must be written before it is read or the value is passed to Rust side.
+    static BoxedSlice<T> with_capacity_uninit(usize size) noexcept;
+
+    /// Allocates a byte slice of `size` uninitialized bytes from the buffer pool of the current thread.
+    ///
+    /// Only a power of two size from 1 KiB to 1 MiB is pooled. The other sizes are allocated as usual.
+    /// The Rust drop function returns a buffer of such a size to the pool of the dropping thread.
+    /// Pools are disabled until `pool::set_limit()` is called.
+    ///
+    /// @note `FFI_TYPES_INLINE_DEALLOC` drops bypass pools.
+    /// @warning Every byte must be written before it is read or the value is passed to Rust side.
+    template <typename U = T>
+    static std::enable_if_t<std::is_same_v<U, uint8_t>, BoxedSlice<uint8_t>> from_pool(usize size) noexcept;
+
+    /// Reallocates the boxed slice to `size` elements.
+    /// Existing elements are kept up to `size` and new elements are uninitialized.
+    void resize_uninit(usize size) noexcept;
+
     CBoxedSlice<T> into() noexcept;
     const CBoxedSlice<T>& as_c() const noexcept {
         return *reinterpret_cast<const CBoxedSlice<T>*>(this);
@@ -367,14 +951,28 @@ public:
     }
 
     void reset(_SliceRange<T> s) noexcept {
+        instrument::_acquire(instrument::_Kind::boxed_slice, s._size > 0, sizeof(T) * s._size);
+        this->_reset(s);
+    }
+
+    _SliceRange<T> release() noexcept {
+        instrument::_give_up(
+                instrument::_Kind::boxed_slice, instrument::_Event::released, this->_size > 0, sizeof(T) * this->_size);
+        return this->_take();
+    }
+
+    /// Same as `reset()` for a value already owned by C++ side, e.g. moved from another owned value.
+    void _reset(_SliceRange<T> s) noexcept {
         if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_slice, sizeof(T) * this->_size);
             this->_drop();
         }
         this->_data = s._data;
         this->_size = s._size;
     }
 
-    _SliceRange<T> release() noexcept {
+    /// Same as `release()` but the ownership stays in C++ side, e.g. moved to another owned value.
+    _SliceRange<T> _take() noexcept {
         const auto range = this->get();
         this->_data = EMPTY_SLICE_BEGIN(T);
         this->_size = 0;
@@ -394,68 +992,285 @@ public:
 static_assert(sizeof(usize) * 2 == sizeof(BoxedSlice<int>));
 static_assert(std::is_standard_layout<BoxedSlice<usize>>::value);
 
-/// C++ wrapper for a boxed slice with C ABI compatible layout.
+/// C++ counterpart of Rust `Vec<T>`.
+/// The ownership API is following `std::unique_ptr` design and the container API is following `std::vector` design.
 ///
-/// @warning This type does *NOT* implement a safe destructor.
-///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+/// The storage grows by Rust global allocator, so the value can be passed to Rust side without reallocation.
+/// Elements are moved by `realloc`, so `T` must be trivially copyable.
 template <typename T>
-struct [[nodiscard]] CBoxedSlice {
-    CBoxedSlice() = _COPY_DELETE;
-    CBoxedSlice(const CBoxedSlice&) = _COPY_DELETE;
-    CBoxedSlice& operator=(const CBoxedSlice<T>&) = _COPY_DELETE;
-
-#if _MSC_VER
-    /// This is a workaround for MSVC constructor limitation.
-    static CBoxedSlice from(BoxedSlice<T>&& slice) noexcept {
-        auto r = slice.release();
-        CBoxedSlice s;
-        s._data = r._data;
-        s._size = r._size;
-        return s;
-    }
-#else
-    CBoxedSlice(CBoxedSlice&&) = default;
-    CBoxedSlice& operator=(CBoxedSlice<T>&&) = default;
-    /// Constructs a `CBoxedSlice` by moving a `BoxedSlice`.
-    CBoxedSlice(BoxedSlice<T>&& slice) noexcept {
-        auto r = slice.release();
-        this->_data = r._data;
-        this->_size = r._size;
-    }
-
-    /// This is a workaround for MSVC constructor limitation.
-    static CBoxedSlice from(BoxedSlice<T>&& slice) noexcept {
-        return CBoxedSlice(std::move(slice));
-    }
-#endif
-
+class Vec : public _SliceInterface<T, Vec> {
+public:
     T* _data;
     usize _size;
+    usize _capacity;
+
+    Vec() = delete;
+    Vec(const Vec<T>&) = delete;
+    Vec(Vec<T>&& v) noexcept : _data(v._data), _size(v._size), _capacity(v._capacity) {
+        v._data = EMPTY_SLICE_BEGIN(T);
+        v._size = 0;
+        v._capacity = 0;
+    }
+    Vec(std::nullptr_t) noexcept : _data(EMPTY_SLICE_BEGIN(T)), _size(0), _capacity(0) {}
+    ~Vec() noexcept {
+        if (this->_capacity > 0) {
+            this->_drop();
+        }
+    }
+    Vec<T>& operator=(Vec<T>&& v) noexcept {
+        if (this->_capacity > 0) {
+            this->_drop();
+        }
+        this->_data = v._data;
+        this->_size = v._size;
+        this->_capacity = v._capacity;
+        v._data = EMPTY_SLICE_BEGIN(T);
+        v._size = 0;
+        v._capacity = 0;
+        return *this;
+    }
 
-    /// Conversion operator to `BoxedSlice`.
-    ///
-    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
-    BoxedSlice<T> operator()() noexcept {
-        auto slice = BoxedSlice<T>(nullptr);
-        auto r = this->release();
-        slice._data = r._data;
-        slice._size = r._size;
-        return slice;
+    void _drop() noexcept;
+
+    CVec<T> into() noexcept;
+    const CVec<T>& as_c() const noexcept {
+        return *reinterpret_cast<const CVec<T>*>(this);
+    }
+    CVec<T>& as_c() noexcept {
+        return *reinterpret_cast<CVec<T>*>(this);
     }
 
-    _SliceRange<T> get() const noexcept {
-        return {this->_data, this->_size};
+    usize capacity() const noexcept {
+        return this->_capacity;
     }
 
-    _SliceRange<T> release() noexcept {
-        const auto range = this->get();
+    /// Reserves capacity for at least `additional` more elements by Rust `Vec::reserve` growth strategy.
+    void reserve(usize additional) noexcept;
+
+    void push_back(const T& value) noexcept {
+        this->reserve(1);
+        this->_data[this->_size++] = value;
+    }
+
+    void pop_back() noexcept {
+        assert(this->_size > 0);
+        this->_size -= 1;
+    }
+
+    /// Appends all elements of `values` by copying.
+    void extend(SliceRef<std::remove_cv_t<T>> values) noexcept {
+        if (values.empty()) {
+            return;
+        }
+        this->reserve(values.size());
+        std::memcpy(this->_data + this->_size, values.data(), values.size_bytes());
+        this->_size += values.size();
+    }
+
+    void clear() noexcept {
+        this->_size = 0;
+    }
+
+    /// Returns a mutable slice of the vector.
+    auto as_slice() noexcept {
+        return MutSliceRef<T>(this->_data, this->_size);
+    }
+
+    /// Returns a read-only slice of the vector.
+    auto as_slice() const noexcept {
+        return SliceRef<T>(this->_data, this->_size);
+    }
+};
+static_assert(sizeof(usize) * 3 == sizeof(Vec<int>));
+static_assert(std::is_standard_layout<Vec<usize>>::value);
+
+/// C++ counterpart for Rust `ForeignBoxedSlice<T>`, a slice owned by C++ side and visible to Rust side.
+///
+/// Rust side calls `_drop_fn(_ctx)` back to free the buffer when the value is dropped.
+/// Use `from_container()` to move the storage of a `std::vector` or a `std::string` to Rust without copying.
+///
+/// @warning `_drop_fn` may be called from any thread of Rust side.
+template <typename T>
+class ForeignBoxedSlice : public _SliceInterface<T, ForeignBoxedSlice> {
+public:
+    using drop_fn = void (*)(void* ctx);
+
+    T* _data;
+    usize _size;
+    drop_fn _drop_fn;
+    void* _ctx;
+
+    ForeignBoxedSlice() = delete;
+    ForeignBoxedSlice(const ForeignBoxedSlice<T>&) = delete;
+    ForeignBoxedSlice(ForeignBoxedSlice<T>&& s) noexcept
+        : _data(s._data), _size(s._size), _drop_fn(s._drop_fn), _ctx(s._ctx) {
+        s._reset_empty();
+    }
+    ForeignBoxedSlice(std::nullptr_t) noexcept
+        : _data(EMPTY_SLICE_BEGIN(T)), _size(0), _drop_fn(nullptr), _ctx(nullptr) {}
+    /// Takes the ownership of `data`. `drop(ctx)` is called once to free it.
+    ForeignBoxedSlice(T* data, usize size, drop_fn drop, void* ctx) noexcept
+        : _data(_wrap_null(data)), _size(size), _drop_fn(drop), _ctx(ctx) {}
+    ~ForeignBoxedSlice() noexcept {
+        this->_drop();
+    }
+    ForeignBoxedSlice<T>& operator=(ForeignBoxedSlice<T>&& s) noexcept {
+        if (this != &s) {
+            this->_drop();
+            this->_data = s._data;
+            this->_size = s._size;
+            this->_drop_fn = s._drop_fn;
+            this->_ctx = s._ctx;
+            s._reset_empty();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept {
+        if (this->_drop_fn) {
+            this->_drop_fn(this->_ctx);
+        }
+        this->_reset_empty();
+    }
+    void _reset_empty() noexcept {
         this->_data = EMPTY_SLICE_BEGIN(T);
         this->_size = 0;
-        return range;
+        this->_drop_fn = nullptr;
+        this->_ctx = nullptr;
     }
+
+    /// Moves `container` to the heap and owns its storage.
+    ///
+    /// Only the container object is allocated. Elements are neither copied nor moved,
+    /// so the storage of `std::vector` or a long `std::string` stays at the same address.
+    template <class C>
+    static ForeignBoxedSlice<T> from_container(C&& container) {
+        using container_type = std::remove_cv_t<std::remove_reference_t<C>>;
+        static_assert(!std::is_lvalue_reference_v<C>, "the container must be moved");
+        static_assert(
+                std::is_same_v<std::remove_cv_t<T>, typename container_type::value_type>,
+                "the element type must be the same");
+        auto* owned = new container_type(std::move(container));
+        return ForeignBoxedSlice<T>(
+                const_cast<T*>(owned->data()),
+                owned->size(),
+                [](void* ctx) { delete static_cast<container_type*>(ctx); },
+                owned);
+    }
+
+    CForeignBoxedSlice<T> into() noexcept;
+
+    /// Returns a mutable slice of the buffer.
+    auto as_slice() noexcept {
+        return MutSliceRef<T>(this->_data, this->_size);
+    }
+
+    /// Returns a read-only slice of the buffer.
+    auto as_slice() const noexcept {
+        return SliceRef<T>(this->_data, this->_size);
+    }
+};
+
+/// Counters of the buffer pool of a thread. Same as Rust `PoolStats`.
+/// @see `BoxedSlice<uint8_t>::from_pool()`
+struct PoolStats {
+    /// Allocations served by the pool.
+    uint64_t hits;
+    /// Allocations of a size class served by the global allocator.
+    uint64_t misses;
+    /// Buffers returned to the pool.
+    uint64_t recycled;
+    /// Buffers of a size class freed because the pool was full.
+    uint64_t released;
+};
+static_assert(std::is_trivial<PoolStats>::value);
+static_assert(std::is_standard_layout<PoolStats>::value);
+
+/// Access pattern hints for `MmapSlice::advise()`. Same as Rust `MmapAdvice` and `madvise(2)`.
+enum class MmapAdvice : int32_t {
+    Normal = 0,
+    Random = 1,
+    Sequential = 2,
+    WillNeed = 3,
+    DontNeed = 4,
 };
-static_assert(std::is_trivial<CBoxedSlice<int>>::value);
-static_assert(std::is_standard_layout<CBoxedSlice<int>>::value);
+
+/// C++ counterpart for Rust `MmapSlice`, a read-only memory-mapped file as an owned byte slice.
+///
+/// The mapping is created and released by Rust side, so a single mapping can be passed between both sides.
+/// An empty file is not mapped and results in an empty slice.
+///
+/// @warning The file is mapped by `MAP_SHARED`. Writes to the file by any process change the bytes of the slice,
+///          and reading pages of a truncated file raises `SIGBUS`. Map only files nobody modifies while mapped.
+/// @note This type is available only on unix platforms.
+class MmapSlice : public SliceRef<uint8_t> {
+public:
+    MmapSlice() = delete;
+    MmapSlice(const MmapSlice&) = delete;
+    MmapSlice(MmapSlice&& s) noexcept : SliceRef<uint8_t>(s) {
+        s._data = EMPTY_SLICE_BEGIN(uint8_t);
+        s._size = 0;
+    }
+    MmapSlice(std::nullptr_t) noexcept : SliceRef<uint8_t>() {}
+    ~MmapSlice() noexcept {
+        if (this->_size > 0) {
+            this->_drop();
+        }
+    }
+    MmapSlice& operator=(MmapSlice&& s) noexcept {
+        if (this != &s) {
+            if (this->_size > 0) {
+                this->_drop();
+            }
+            this->_data = s._data;
+            this->_size = s._size;
+            s._data = EMPTY_SLICE_BEGIN(uint8_t);
+            s._size = 0;
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Maps the whole file of `path` as read-only.
+    /// Returns `std::nullopt` on failure and stores the `errno` value to `error` if given.
+    static std::optional<MmapSlice> open(CharStrRef path, int32_t* error = nullptr) noexcept;
+
+    /// Gives a hint of the access pattern of the whole mapping. Returns 0 on success or an `errno` value.
+    int32_t advise(MmapAdvice advice) const noexcept {
+        return this->advise(0, this->_size, advice);
+    }
+
+    /// Gives a hint of the access pattern of `size` bytes from `offset`. The range is extended to page boundaries.
+    int32_t advise(usize offset, usize size, MmapAdvice advice) const noexcept;
+
+    /// Asks the kernel to read `size` bytes from `offset` of the file ahead.
+    int32_t prefetch(usize offset, usize size) const noexcept {
+        return this->advise(offset, size, MmapAdvice::WillNeed);
+    }
+
+    /// Returns the mapping as a slice of `T`, e.g. a table of fixed size records.
+    ///
+    /// The mapping is page-aligned, so only the size must be a multiple of `sizeof(T)`.
+    template <typename T>
+    SliceRef<T> as_slice() const noexcept {
+        static_assert(std::is_trivially_copyable<T>::value, "the mapping is read as raw bytes");
+        assert(this->_size % sizeof(T) == 0);
+        assert(reinterpret_cast<uintptr_t>(this->_data) % alignof(T) == 0);
+        return SliceRef<T>(reinterpret_cast<const T*>(this->_data), this->_size / sizeof(T));
+    }
+
+    CMmapSlice into() noexcept;
+};
+static_assert(sizeof(MmapSlice) == 2 * sizeof(void*));
+static_assert(std::is_standard_layout<MmapSlice>::value);
+
+/// A list of byte slices for vectored I/O, same as Rust `IoSliceRef`.
+///
+/// On unix, the elements have the same layout as `struct iovec`, so the list is passed to `writev()` or `io_uring`
+/// by `as_iovec()` without copying.
+using IoSliceRef = SliceRef<ByteSliceRef>;
+using CIoSliceRef = CSliceRef<ByteSliceRef>;
 
 /// C++ unsafe counterpart of Rust `&str`.
 ///
@@ -467,9 +1282,10 @@ struct CharStrRef {
     CharStrRef(const CharStrRef&) = default;
     CharStrRef& operator=(const CharStrRef&) = default;
     // #if !_MSC_VER
-    CharStrRef(const char* head, usize size) noexcept : _data(_wrap_null(head)), _size(size) {}
+    constexpr CharStrRef(const char* head, usize size) noexcept : _data(_wrap_null(head)), _size(size) {}
     template <class R>
-    CharStrRef(SAFE_R range) noexcept : _data(_wrap_null(ranges::data(range))), _size(ranges::size(range)) {}
+    constexpr CharStrRef(SAFE_R range) noexcept
+        : _data(_wrap_null(ranges::data(range))), _size(ranges::size(range)) {}
     CharStrRef(std::nullptr_t) noexcept : _data(EMPTY_SLICE_BEGIN(const char)), _size(0) {}
     // #endif
 
@@ -485,39 +1301,49 @@ struct CharStrRef {
     using const_pointer = const element_type*;
     using reference = element_type&;
     using const_reference = const element_type&;
+#if FFI_TYPES_POINTER_ITERATOR
+    using iterator = pointer;
+#else
     using iterator = typename std::string_view::iterator;
+#endif
     using reverse_iterator = std::reverse_iterator<iterator>;
 
     // observers
-    size_type size() const noexcept {
+    constexpr size_type size() const noexcept {
         return this->_size;
     }
-    size_type size_bytes() const noexcept {
+    constexpr size_type size_bytes() const noexcept {
         return this->size() * sizeof(element_type);
     }
-    bool empty() const noexcept {
+    constexpr bool empty() const noexcept {
         return this->size() == 0;
     }
 
     // element access
-    reference operator[](size_type idx) const noexcept {
+    constexpr reference operator[](size_type idx) const noexcept {
         assert(idx < this->size());
         return this->data()[idx];
     }
-    reference front() const noexcept {
+    constexpr reference front() const noexcept {
         return this->data()[0];
     }
-    reference back() const noexcept {
+    constexpr reference back() const noexcept {
         return this->data()[size() - 1];
     }
-    pointer data() const noexcept {
+    constexpr pointer data() const noexcept {
         return this->_data;
     }
 
     // iterator
+#if FFI_TYPES_POINTER_ITERATOR
+    iterator begin() const noexcept {
+        return data();
+    }
+#else
     iterator begin() const noexcept {
         return view().begin();
     }
+#endif
     iterator end() const noexcept {
         return begin() + size();
     }
@@ -541,12 +1367,22 @@ struct CharStrRef {
 
     StrRef as_str_unchecked() const noexcept;
 
+    /// Checks if the string is a valid UTF-8 string by the same rule as Rust `std::str::from_utf8`.
+    bool is_utf8() const noexcept {
+        return _utf8::validate(this->_data, this->_size);
+    }
+
+    /// Convert to Rust string wrapper with UTF-8 validation.
+    /// The result can be passed to Rust side as `&str` without validating again.
+    /// @return `std::nullopt` if the string is not a valid UTF-8 string.
+    std::optional<StrRef> as_str() const noexcept;
+
 #if __cpp_lib_string_view
     /// Constructs a `CharStrRef` from a null-terminated string.
-    CharStrRef(const char* s) noexcept : CharStrRef(std::string_view(s)) {}
+    constexpr CharStrRef(const char* s) noexcept : CharStrRef(std::string_view(s)) {}
 
     /// Returns a `std::string_view` of the string.
-    std::string_view view() const noexcept {
+    constexpr std::string_view view() const noexcept {
         return std::string_view(this->data(), this->size());
     }
 
@@ -560,6 +1396,134 @@ struct CharStrRef {
     std::string to_string() const noexcept {
         return std::string(this->view());
     }
+#endif
+
+    static CharStrRef _from_parts(const char* head, usize size) noexcept {
+        return CharStrRef(head, size);
+    }
+
+    // Allocation-free searches with the same results as Rust `str` methods, e.g. an empty needle is found at 0 by
+    // `find()` and at `size()` by `rfind()`. Found indices are byte offsets.
+
+    /// Returns the byte index of the first `needle`, or `std::nullopt`. Same as Rust `str::find`.
+    std::optional<usize> find(const CharStrRef& needle) const noexcept {
+        const usize i = _str::find(this->_data, this->_size, needle._data, needle._size);
+        return i == _str::NOT_FOUND ? std::nullopt : std::optional<usize>(i);
+    }
+    std::optional<usize> find(char needle) const noexcept {
+        return this->find(CharStrRef(&needle, 1));
+    }
+
+    /// Returns the byte index of the last `needle`, or `std::nullopt`. Same as Rust `str::rfind`.
+    std::optional<usize> rfind(const CharStrRef& needle) const noexcept {
+        const usize i = _str::rfind(this->_data, this->_size, needle._data, needle._size);
+        return i == _str::NOT_FOUND ? std::nullopt : std::optional<usize>(i);
+    }
+    std::optional<usize> rfind(char needle) const noexcept {
+        return this->rfind(CharStrRef(&needle, 1));
+    }
+
+    bool contains(const CharStrRef& needle) const noexcept {
+        return _str::find(this->_data, this->_size, needle._data, needle._size) != _str::NOT_FOUND;
+    }
+    bool contains(char needle) const noexcept {
+        return this->contains(CharStrRef(&needle, 1));
+    }
+
+    bool starts_with(const CharStrRef& prefix) const noexcept {
+        return prefix._size <= this->_size && _equal(CharStrRef(this->_data, prefix._size), prefix);
+    }
+    bool ends_with(const CharStrRef& suffix) const noexcept {
+        return suffix._size <= this->_size &&
+               _equal(CharStrRef(this->_data + this->_size - suffix._size, suffix._size), suffix);
+    }
+
+    /// Checks if the strings are equal after ASCII lowercasing. Same as Rust `str::eq_ignore_ascii_case`.
+    bool eq_ignore_ascii_case(const CharStrRef& other) const noexcept {
+        return this->_size == other._size && _str::eq_ignore_ascii_case(this->_data, other._data, this->_size);
+    }
+
+    /// Splits the string by any byte of `separators`. Both strings must outlive the range.
+    _StrSplit<CharStrRef> split(const CharStrRef& separators) const noexcept {
+        return {this->_data, this->_size, separators._data, separators._size};
+    }
+
+    /// Compares bytes like `memcmp`, then sizes. Same order as Rust `str` and `std::string_view`.
+    static int _compare(const CharStrRef& a, const CharStrRef& b) noexcept {
+        const auto size = std::min(a.size(), b.size());
+        const int r = size > 0 ? std::memcmp(a.data(), b.data(), size) : 0;
+        if (r != 0) {
+            return r;
+        }
+        return a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0;
+    }
+
+    static const CharStrRef& _ref(const CharStrRef& s) noexcept {
+        return s;
+    }
+#if __cpp_lib_string_view
+    template <typename S>
+    static CharStrRef _ref(const S& s) noexcept {
+        if constexpr (std::is_convertible_v<const S&, std::string_view>) {
+            const auto view = std::string_view(s);
+            return CharStrRef(view.data(), view.size());
+        } else {
+            // owned strings not derived from `CharStrRef`, e.g. `CompactStr`
+            return s.as_str();
+        }
+    }
+    template <typename S>
+    using _if_other_str = std::enable_if_t<
+            !std::is_base_of_v<CharStrRef, S> && std::is_convertible_v<const S&, std::string_view>,
+            int>;
+    template <typename S>
+    using _if_str = std::enable_if_t<
+            std::is_base_of_v<CharStrRef, S> || std::is_convertible_v<const S&, std::string_view>,
+            int>;
+#endif
+
+    static bool _equal(const CharStrRef& a, const CharStrRef& b) noexcept {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+    }
+
+// comparisons of `CharStrRef`, `StrRef` and `BoxedStr` with each other or with any string convertible to
+// `std::string_view`. The latter is a template to be an exact match and preferred over `std::string_view` operators.
+// Owned strings not derived from `CharStrRef` define the same operators by this macro, which is undefined at the end.
+#if __cpp_impl_three_way_comparison
+#define _STR_COMPARISONS(A, B, ...)                                                                                    \
+    __VA_ARGS__ friend bool operator==(A a, B b) noexcept {                                                            \
+        return CharStrRef::_equal(CharStrRef::_ref(a), CharStrRef::_ref(b));                                           \
+    }                                                                                                                  \
+    __VA_ARGS__ friend std::strong_ordering operator<=>(A a, B b) noexcept {                                           \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) <=> 0;                                   \
+    }
+#else
+#define _STR_COMPARISONS(A, B, ...)                                                                                    \
+    __VA_ARGS__ friend bool operator==(A a, B b) noexcept {                                                            \
+        return CharStrRef::_equal(CharStrRef::_ref(a), CharStrRef::_ref(b));                                           \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator!=(A a, B b) noexcept {                                                            \
+        return !CharStrRef::_equal(CharStrRef::_ref(a), CharStrRef::_ref(b));                                          \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator<(A a, B b) noexcept {                                                             \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) < 0;                                     \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator<=(A a, B b) noexcept {                                                            \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) <= 0;                                    \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator>(A a, B b) noexcept {                                                             \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) > 0;                                     \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator>=(A a, B b) noexcept {                                                            \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) >= 0;                                    \
+    }
+#endif
+    _STR_COMPARISONS(const CharStrRef&, const CharStrRef&, inline)
+#if __cpp_lib_string_view
+    _STR_COMPARISONS(const CharStrRef&, const S&, template <typename S, _if_other_str<S> = 0>)
+#if !__cpp_impl_three_way_comparison
+    _STR_COMPARISONS(const S&, const CharStrRef&, template <typename S, _if_other_str<S> = 0>)
+#endif
 #endif
 };
 static_assert(sizeof(SliceRef<char>) == sizeof(CharStrRef));
@@ -579,36 +1543,59 @@ struct StrRef : public CharStrRef {
     StrRef(const BoxedStr&) noexcept;
     StrRef(std::nullptr_t) noexcept : CharStrRef(EMPTY_SLICE_BEGIN(const char), 0) {}
 
+    /// Tag of the constructor without UTF-8 checking.
+    struct _Unchecked {};
+    /// Creates a `StrRef` without UTF-8 checking. Use `_rs` literal for string literals.
+    ///
+    /// @warning Safety: Only when the data is a valid UTF-8 string.
+    constexpr StrRef(_Unchecked, const char* head, usize size) noexcept : CharStrRef(head, size) {}
+
     StrRef& operator=(const StrRef&) = default;
+
+    /// A `StrRef` is always a valid UTF-8 string.
+    StrRef as_str() const noexcept {
+        return *this;
+    }
+
+    static StrRef _from_parts(const char* head, usize size) noexcept {
+        return StrRef(_Unchecked{}, head, size);
+    }
+
+    /// Splits the string by any ASCII character of `separators` into `StrRef` parts. Same as Rust
+    /// `str::split(&[char])`. Both strings must outlive the range.
+    _StrSplit<StrRef> split(const CharStrRef& separators) const noexcept {
+        // a non-ASCII separator would split a multi-byte character
+        assert(std::all_of(separators.data(), separators.data() + separators.size(),
+                           [](char c) { return static_cast<uint8_t>(c) < 0x80; }));
+        return {this->_data, this->_size, separators._data, separators._size};
+    }
 };
 static_assert(std::is_trivially_copyable<StrRef>::value);
 static_assert(std::is_standard_layout<StrRef>::value);
 
-/// C++ wrapper for a str with C ABI compatible layout.
-struct CStrRef {
-    CStrRef() = _COPY_DELETE;
-    CStrRef(const CStrRef&) = default;
-    CStrRef& operator=(const CStrRef&) = default;
+/// Fails the constant evaluation of `_rs` literal of an invalid UTF-8 string.
+inline void _invalid_utf8_literal() noexcept {
+    assert(false && "invalid UTF-8 literal");
+    std::abort();
+}
 
-#if !_MSC_VER
-    CStrRef(const StrRef& slice) noexcept {
-        this->_data = slice.data();
-        this->_size = slice.size();
-    }
+inline namespace literals {
+/// Creates a `StrRef` of a string literal, e.g. `"key"_rs`.
+/// The literal is validated at compile time in C++20 and in constant expressions of C++17,
+/// so it can initialize `constexpr` or `constinit` tables of `StrRef` and `CStrRef` without dynamic initializers.
+#if __cpp_consteval
+#define _RS_LITERAL consteval
+#else
+#define _RS_LITERAL constexpr
 #endif
-
-    const char* _data;
-    usize _size;
-
-    StrRef operator()() const noexcept {
-        auto s = StrRef(nullptr);
-        s._data = this->_data;
-        s._size = this->_size;
-        return s;
+_RS_LITERAL StrRef operator""_rs(const char* s, size_t size) noexcept {
+    if (!_utf8::validate_constexpr(s, size)) {
+        _invalid_utf8_literal();
     }
-};
-static_assert(std::is_trivial<CStrRef>::value);
-static_assert(std::is_standard_layout<CStrRef>::value);
+    return StrRef(StrRef::_Unchecked{}, s, size);
+}
+#undef _RS_LITERAL
+}  // namespace literals
 
 /// C++ counterpart of Rust `Box<str>`.
 class BoxedStr : public StrRef {
@@ -623,26 +1610,43 @@ public:
 
     ~BoxedStr() noexcept {
         if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
             this->_drop();
         }
     }
 
     BoxedStr& operator=(BoxedStr&& b) noexcept {
-        this->reset(b.release());
+        this->_reset(b._take());
         return *this;
     }
 
     void _drop() noexcept;
 
+    /// Drops every item of `items` by a single call to Rust side. The items are left empty.
+    static void _drop_many(MutSliceRef<BoxedStr> items) noexcept;
+
     void reset(_SliceRange<const char> s) noexcept {
+        instrument::_acquire(instrument::_Kind::boxed_str, s._size > 0, s._size);
+        this->_reset(s);
+    }
+
+    _SliceRange<const char> release() noexcept {
+        instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::released, this->_size > 0, this->_size);
+        return this->_take();
+    }
+
+    /// Same as `reset()` for a value already owned by C++ side, e.g. moved from another owned value.
+    void _reset(_SliceRange<const char> s) noexcept {
         if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
             this->_drop();
         }
         this->_data = s._data;
         this->_size = s._size;
     }
 
-    _SliceRange<const char> release() noexcept {
+    /// Same as `release()` but the ownership stays in C++ side, e.g. moved to another owned value.
+    _SliceRange<const char> _take() noexcept {
         const auto range = this->get();
         this->_data = EMPTY_SLICE_BEGIN(const char);
         this->_size = 0;
@@ -652,63 +1656,401 @@ public:
     StrRef as_str() const noexcept {
         return this->as_str_unchecked();
     }
+
+    /// Creates a `BoxedStr` by copying `s` into memory from the Rust global allocator.
+    /// @return `std::nullopt` if `s` is not a valid UTF-8 string.
+    static std::optional<BoxedStr> from_utf8_copy(CharStrRef s) noexcept;
 };
 static_assert(sizeof(StrRef) == sizeof(BoxedStr));
 static_assert(std::is_standard_layout<BoxedStr>::value);
 
-/// C++ wrapper for Rust `Box<str>` with C ABI compatible layout.
-///
-/// @warning This type does *NOT* implement a safe destructor.
-///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
-struct [[nodiscard]] CBoxedStr {
-    CBoxedStr() = _COPY_DELETE;
-    CBoxedStr(const CBoxedStr&) = _COPY_DELETE;
-    CBoxedStr& operator=(const CBoxedStr&) = _COPY_DELETE;
+struct CCompactStr;
 
+/// C++ counterpart for Rust `CompactStr`, a `BoxedStr` storing short strings inline.
+///
+/// A string up to `inline_capacity` bytes is stored in the `{ptr, len}` footprint itself.
+/// The highest bit of the length word tags an inline string, and the rest of its highest byte is the length.
+/// Longer strings are exactly `BoxedStr`.
+///
+/// @note A `StrRef` of an inline string borrows the `CompactStr` itself. It is invalidated by moving the value.
+class CompactStr {
+public:
     const char* _data;
     usize _size;
 
-#if _MSC_VER
-    /// This is a workaround for MSVC constructor limitation.
-    static CBoxedStr from(BoxedStr&& str) noexcept {
-        auto r = str.release();
-        CBoxedStr s;
-        s._data = r._data;
-        s._size = r._size;
-        return s;
-    }
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    /// Inline strings need the tag byte at the end, which is only true for little-endian.
+    static constexpr usize inline_capacity = 0;
 #else
-    CBoxedStr(CBoxedStr&&) = default;
-    CBoxedStr& operator=(CBoxedStr&&) = default;
-    CBoxedStr(BoxedStr&& str) noexcept {
-        auto r = str.release();
+    static constexpr usize inline_capacity = 2 * sizeof(usize) - 1;
+#endif
+    static constexpr usize _INLINE_TAG = usize(1) << (sizeof(usize) * 8 - 1);
+    static constexpr usize _LEN_SHIFT = (sizeof(usize) - 1) * 8;
+
+    CompactStr() = delete;
+    CompactStr(const CompactStr&) = delete;
+    CompactStr(CompactStr&& s) noexcept {
+        std::memcpy(static_cast<void*>(this), &s, sizeof(CompactStr));
+        s._set_inline_size(0);
+    }
+    /// Creates an empty inline string.
+    CompactStr(std::nullptr_t) noexcept : _data(nullptr), _size(_INLINE_TAG) {}
+    /// Takes the ownership of `s` without copying it.
+    explicit CompactStr(BoxedStr&& s) noexcept {
+        auto r = s._take();
         this->_data = r._data;
         this->_size = r._size;
     }
 
-    /// This is a workaround for MSVC constructor limitation.
-    static CBoxedStr from(BoxedStr&& slice) noexcept {
-        return CBoxedStr(std::move(slice));
+    ~CompactStr() noexcept {
+        if (!this->is_inline() && this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+            this->_drop();
+        }
+    }
+
+    CompactStr& operator=(CompactStr&& s) noexcept {
+        if (this != &s) {
+            if (!this->is_inline() && this->_size > 0) {
+                instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+                this->_drop();
+            }
+            std::memcpy(static_cast<void*>(this), &s, sizeof(CompactStr));
+            s._set_inline_size(0);
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Sets the highest byte only. The other bytes of the length word are inline data.
+    void _set_inline_size(usize size) noexcept {
+        assert(size <= inline_capacity);
+        constexpr usize mask = usize(0xff) << _LEN_SHIFT;
+        this->_size = (this->_size & ~mask) | _INLINE_TAG | (size << _LEN_SHIFT);
+    }
+
+    bool is_inline() const noexcept {
+        return (this->_size & _INLINE_TAG) != 0;
     }
+
+    const char* data() const noexcept {
+        return this->is_inline() ? reinterpret_cast<const char*>(this) : this->_data;
+    }
+    usize size() const noexcept {
+        return this->is_inline() ? (this->_size >> _LEN_SHIFT) & 0x7f : this->_size;
+    }
+    bool empty() const noexcept {
+        return this->size() == 0;
+    }
+    const char* begin() const noexcept {
+        return this->data();
+    }
+    const char* end() const noexcept {
+        return this->data() + this->size();
+    }
+
+    StrRef as_str() const noexcept {
+        auto s = StrRef(nullptr);
+        s._data = this->data();
+        s._size = this->size();
+        return s;
+    }
+    operator StrRef() const noexcept {
+        return this->as_str();
+    }
+
+    /// Converts to `CCompactStr` by moving the value.
+    /// The value of `this` will be invalidated to an empty string.
+    CCompactStr into() noexcept;
+
+    /// Creates a `CompactStr` by copying `s`.
+    /// Only a string longer than `inline_capacity` is allocated from the Rust global allocator.
+    /// @return `std::nullopt` if `s` is not a valid UTF-8 string.
+    static std::optional<CompactStr> from_utf8_copy(CharStrRef s) noexcept;
+
+    // comparisons between `CompactStr`
+    friend bool operator==(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() == b.as_str();
+    }
+    friend bool operator!=(const CompactStr& a, const CompactStr& b) noexcept {
+        return !(a == b);
+    }
+#if __cpp_impl_three_way_comparison
+    friend std::strong_ordering operator<=>(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() <=> b.as_str();
+    }
+#else
+    friend bool operator<(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() < b.as_str();
+    }
+    friend bool operator<=(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() <= b.as_str();
+    }
+    friend bool operator>(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() > b.as_str();
+    }
+    friend bool operator>=(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() >= b.as_str();
+    }
+#endif
+    // comparisons with the other strings, which don't find the operators of `CharStrRef` by ADL
+    _STR_COMPARISONS(const CompactStr&, const S&, template <typename S, CharStrRef::_if_str<S> = 0>)
+#if !__cpp_impl_three_way_comparison
+    _STR_COMPARISONS(const S&, const CompactStr&, template <typename S, CharStrRef::_if_str<S> = 0>)
 #endif
+};
+static_assert(sizeof(CompactStr) == sizeof(BoxedStr));
+static_assert(std::is_standard_layout<CompactStr>::value);
+
+static_assert(sizeof(CCompactStr) == sizeof(CompactStr));
+
+/// C++ counterpart of Rust `&CStr`, a string followed by a NUL terminator which is excluded from `size()`.
+///
+/// `c_str()` passes the string to C APIs taking `const char*` without copying it to add the terminator.
+/// The bytes may not be UTF-8 as Rust `CStr`, so `as_str()` validates them as `CharStrRef` does.
+struct StrZRef : public CharStrRef {
+    StrZRef() = delete;
+    StrZRef(const StrZRef&) = default;
+    StrZRef(const BoxedCStr&) noexcept;
+    StrZRef(std::nullptr_t) noexcept : CharStrRef("", 0) {}
+    /// Creates a `StrZRef` of a null-terminated string, e.g. a string literal.
+    constexpr StrZRef(const char* s) noexcept : CharStrRef(s) {}
+    /// Creates a `StrZRef` of `s.c_str()`. `s` must not contain NUL.
+    StrZRef(const std::string& s) noexcept : CharStrRef(s.c_str(), s.size()) {
+        assert(std::memchr(s.data(), 0, s.size()) == nullptr);
+    }
+
+    /// Tag of the constructor without checking the terminator.
+    struct _Terminated {};
+    /// Creates a `StrZRef` without checking the terminator.
+    ///
+    /// @warning Safety: Only when `head[size]` is NUL and no byte before it is NUL.
+    constexpr StrZRef(_Terminated, const char* head, usize size) noexcept : CharStrRef(head, size) {}
+
+    StrZRef& operator=(const StrZRef&) = default;
+
+    /// Returns the string terminated by NUL at `size()`.
+    constexpr const char* c_str() const noexcept {
+        return this->_data;
+    }
+};
+static_assert(sizeof(StrZRef) == sizeof(CharStrRef));
+static_assert(std::is_trivially_copyable<StrZRef>::value);
+static_assert(std::is_standard_layout<StrZRef>::value);
 
-    BoxedStr operator()() noexcept {
-        auto slice = BoxedStr(nullptr);
-        auto r = this->release();
-        slice._data = r._data;
-        slice._size = r._size;
-        return slice;
+/// C++ counterpart of Rust `Box<CStr>`. The NUL terminator is owned with the string and excluded from `size()`.
+///
+/// An empty string points to a static terminator and owns nothing, same as an empty `BoxedStr`.
+class BoxedCStr : public StrZRef {
+public:
+    BoxedCStr() = delete;
+    BoxedCStr(BoxedCStr&) = delete;
+    BoxedCStr(BoxedCStr&& s) noexcept : StrZRef(s) {
+        s._data = "";
+        s._size = 0;
+    }
+    BoxedCStr(std::nullptr_t) noexcept : StrZRef(nullptr) {}
+
+    ~BoxedCStr() noexcept {
+        if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+            this->_drop();
+        }
+    }
+
+    BoxedCStr& operator=(BoxedCStr&& b) noexcept {
+        this->_reset(b._take());
+        return *this;
     }
 
+    void _drop() noexcept;
+
+    /// Takes the ownership of `s`, which is followed by a NUL terminator.
+    void reset(_SliceRange<const char> s) noexcept {
+        instrument::_acquire(instrument::_Kind::boxed_str, s._size > 0, s._size);
+        this->_reset(s);
+    }
+
+    /// Gives up the ownership. The returned range excludes the NUL terminator.
     _SliceRange<const char> release() noexcept {
-        const auto range = _SliceRange<const char>{_data, _size};
-        this->_data = EMPTY_SLICE_BEGIN(const char);
+        instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::released, this->_size > 0, this->_size);
+        return this->_take();
+    }
+
+    /// Same as `reset()` for a value already owned by C++ side, e.g. moved from another owned value.
+    void _reset(_SliceRange<const char> s) noexcept {
+        if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+            this->_drop();
+        }
+        this->_data = s._data;
+        this->_size = s._size;
+    }
+
+    /// Same as `release()` but the ownership stays in C++ side, e.g. moved to another owned value.
+    _SliceRange<const char> _take() noexcept {
+        const auto range = this->get();
+        this->_data = "";
         this->_size = 0;
         return range;
     }
+
+    /// Creates a `BoxedCStr` by copying `s` with a NUL terminator into memory from the Rust global allocator.
+    /// @return `std::nullopt` if `s` contains NUL.
+    static std::optional<BoxedCStr> from_copy(CharStrRef s) noexcept;
+};
+static_assert(sizeof(StrZRef) == sizeof(BoxedCStr));
+static_assert(std::is_standard_layout<BoxedCStr>::value);
+
+/// Drops every boxed value in a contiguous `range` of `BoxedStr` or `BoxedSlice<T>`.
+///
+/// Dropping is done by a single call to Rust side where `_drop_many()` is specialized.
+/// The values are left empty, so destructing them later is a no-op.
+template <class R>
+inline void drop_all(R& range) noexcept {
+    using value_type = std::remove_reference_t<decltype(*std::data(range))>;
+    value_type::_drop_many(MutSliceRef<value_type>(std::data(range), std::size(range)));
+}
+
+/// A counting iterator of indices of `_SliceChunks<T>`.
+///
+/// Parallel algorithms run in parallel only for iterators of which `iterator_category` is random access,
+/// which `_SliceChunks<T>::iterator` isn't because the views are made on dereference.
+/// `reference` is bound to the index in the iterator, as counting iterators of other libraries do.
+struct _IndexIterator {
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = usize;
+    using difference_type = intptr_t;
+    using pointer = const usize*;
+    using reference = const usize&;
+
+    usize _index;
+
+    reference operator*() const noexcept {
+        return this->_index;
+    }
+    value_type operator[](difference_type n) const noexcept {
+        return this->_index + n;
+    }
+    _IndexIterator& operator++() noexcept {
+        ++this->_index;
+        return *this;
+    }
+    _IndexIterator operator++(int) noexcept {
+        auto it = *this;
+        ++this->_index;
+        return it;
+    }
+    _IndexIterator& operator--() noexcept {
+        --this->_index;
+        return *this;
+    }
+    _IndexIterator operator--(int) noexcept {
+        auto it = *this;
+        --this->_index;
+        return it;
+    }
+    _IndexIterator& operator+=(difference_type n) noexcept {
+        this->_index += n;
+        return *this;
+    }
+    _IndexIterator& operator-=(difference_type n) noexcept {
+        this->_index -= n;
+        return *this;
+    }
+    friend _IndexIterator operator+(_IndexIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend _IndexIterator operator+(difference_type n, _IndexIterator it) noexcept {
+        return it += n;
+    }
+    friend _IndexIterator operator-(_IndexIterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+    friend difference_type operator-(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return static_cast<difference_type>(a._index - b._index);
+    }
+    friend bool operator==(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index == b._index;
+    }
+    friend bool operator!=(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index != b._index;
+    }
+    friend bool operator<(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index < b._index;
+    }
+    friend bool operator<=(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index <= b._index;
+    }
+    friend bool operator>(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index > b._index;
+    }
+    friend bool operator>=(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index >= b._index;
+    }
 };
-static_assert(std::is_trivial<CBoxedStr>::value);
-static_assert(std::is_standard_layout<CBoxedStr>::value);
+
+/// Calls `f` with each view of `slice.chunks(chunk_size)`, the same partition as Rust `par_chunks()` of rayon.
+///
+/// The chunks run by `std::execution::par` if `FFI_TYPES_PARALLEL` is 1, or sequentially otherwise.
+/// The algorithm runs over the indices of the chunks, and each view is made by `chunks[i]`.
+template <typename T, template <typename> typename I, typename F>
+inline void par_for_each_chunk(const _SliceInterface<T, I>& slice, usize chunk_size, F&& f) {
+    const auto chunks = slice.chunks(chunk_size);
+    const auto call = [&chunks, &f](usize i) { f(chunks[i]); };
+#if FFI_TYPES_PARALLEL && __cpp_lib_execution
+    std::for_each(std::execution::par, _IndexIterator{0}, _IndexIterator{chunks.size()}, call);
+#else
+    std::for_each(_IndexIterator{0}, _IndexIterator{chunks.size()}, call);
+#endif
+}
+
+/// `true` if `T` is a byte buffer laid out as `{ptr, len}`, which is the layout of `struct iovec` on unix.
+template <typename T>
+struct _is_io_buf : std::false_type {};
+template <>
+struct _is_io_buf<ByteSliceRef> : std::true_type {};
+template <>
+struct _is_io_buf<MutSliceRef<uint8_t>> : std::true_type {};
+template <>
+struct _is_io_buf<CByteSliceRef> : std::true_type {};
+template <>
+struct _is_io_buf<BoxedSlice<uint8_t>> : std::true_type {};
+template <>
+struct _is_io_buf<CBoxedSlice<uint8_t>> : std::true_type {};
+template <>
+struct _is_io_buf<MmapSlice> : std::true_type {};
+template <>
+struct _is_io_buf<CMmapSlice> : std::true_type {};
+template <>
+struct _is_io_buf<StrRef> : std::true_type {};
+template <>
+struct _is_io_buf<CStrRef> : std::true_type {};
+template <>
+struct _is_io_buf<BoxedStr> : std::true_type {};
+template <>
+struct _is_io_buf<CBoxedStr> : std::true_type {};
+template <>
+struct _is_io_buf<CharStrRef> : std::true_type {};
+
+#if __unix__ || __APPLE__
+static_assert(sizeof(struct iovec) == sizeof(ByteSliceRef), "iovec must be {ptr, len}");
+static_assert(alignof(struct iovec) == alignof(ByteSliceRef), "iovec must be {ptr, len}");
+static_assert(offsetof(struct iovec, iov_base) == 0, "iovec must be {ptr, len}");
+static_assert(offsetof(struct iovec, iov_len) == sizeof(void*), "iovec must be {ptr, len}");
+
+/// Views a contiguous `range` of byte buffers, e.g. `IoSliceRef` or `std::vector<BoxedSlice<uint8_t>>`,
+/// as `iovec`s without copying. The count of the elements is `std::size(range)`.
+///
+/// @note `writev()` takes a non-const `iovec*` but writes to neither the `iovec`s nor the buffers.
+template <class R>
+inline struct iovec* as_iovec(const R& range) noexcept {
+    using value_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(range))>>;
+    static_assert(_is_io_buf<value_type>::value, "the elements must be byte buffers laid out as {ptr, len}");
+    return reinterpret_cast<struct iovec*>(const_cast<value_type*>(std::data(range)));
+}
+#endif
 
 template <typename T>
 inline CMutSliceRef<T> MutSliceRef<T>::into() const noexcept {
@@ -730,11 +2072,126 @@ inline CBoxedSlice<T> BoxedSlice<T>::into() noexcept {
     return CBoxedSlice<T>::from(std::move(*this));
 }
 
+template <typename T>
+inline CVec<T> Vec<T>::into() noexcept {
+    return CVec<T>::from(std::move(*this));
+}
+
+template <typename T>
+inline CForeignBoxedSlice<T> ForeignBoxedSlice<T>::into() noexcept {
+    return CForeignBoxedSlice<T>::from(std::move(*this));
+}
+
+inline CMmapSlice MmapSlice::into() noexcept {
+    return CMmapSlice::from(std::move(*this));
+}
+
+/// A `StrRef` carrying its hash by `hash_bytes()`.
+///
+/// C++ `HashedStrRef` and Rust `HashedStrRef` share the layout and the hash function,
+/// so a key hashed once in either side is looked up in both sides without hashing it again.
+struct HashedStrRef {
+    HashedStrRef() = _COPY_DELETE;
+    HashedStrRef(const HashedStrRef&) = default;
+    HashedStrRef& operator=(const HashedStrRef&) = default;
+    explicit HashedStrRef(const StrRef& s) noexcept
+        : _data(s.data()), _size(s.size()), _hash(hash_bytes(s.data(), s.size())) {}
+
+    const char* _data;
+    usize _size;
+    uint64_t _hash;
+
+    const char* data() const noexcept {
+        return this->_data;
+    }
+    usize size() const noexcept {
+        return this->_size;
+    }
+    bool empty() const noexcept {
+        return this->_size == 0;
+    }
+    const char* begin() const noexcept {
+        return this->_data;
+    }
+    const char* end() const noexcept {
+        return this->_data + this->_size;
+    }
+    uint64_t hash() const noexcept {
+        return this->_hash;
+    }
+
+    StrRef as_str() const noexcept {
+        return CharStrRef(this->_data, this->_size).as_str_unchecked();
+    }
+    operator StrRef() const noexcept {
+        return this->as_str();
+    }
+
+    friend bool operator==(const HashedStrRef& a, const HashedStrRef& b) noexcept {
+        return a._hash == b._hash && a.as_str() == b.as_str();
+    }
+    friend bool operator!=(const HashedStrRef& a, const HashedStrRef& b) noexcept {
+        return !(a == b);
+    }
+};
+static_assert(std::is_trivially_copyable<HashedStrRef>::value);
+static_assert(std::is_standard_layout<HashedStrRef>::value);
+
+/// Transparent hasher of strings for heterogeneous lookup.
+///
+/// `std::unordered_map<BoxedStr, V, StrHash, StrEqual>` can be looked up by `StrRef`, `CharStrRef`,
+/// `std::string_view` or `HashedStrRef` without allocation. `HashedStrRef` reuses its hash.
+struct StrHash {
+    using is_transparent = void;
+
+    template <typename S>
+    size_t operator()(const S& s) const noexcept {
+        const auto str = CharStrRef(s);
+        return static_cast<size_t>(hash_bytes(str.data(), str.size()));
+    }
+    size_t operator()(const HashedStrRef& s) const noexcept {
+        return static_cast<size_t>(s.hash());
+    }
+};
+
+/// Transparent equality of strings for heterogeneous lookup.
+/// @see StrHash
+struct StrEqual {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const noexcept {
+        return CharStrRef(a) == CharStrRef(b);
+    }
+};
+
+/// Hasher of slices as bytes for `std::hash`.
+template <typename S>
+struct _SliceHash {
+    size_t operator()(const S& s) const noexcept {
+        static_assert(
+                std::has_unique_object_representations_v<typename S::value_type>,
+                "only slices of values with unique object representations can be hashed as bytes");
+        return static_cast<size_t>(hash_bytes(s.data(), s.size_bytes()));
+    }
+};
+
+inline CCompactStr CompactStr::into() noexcept {
+    return CCompactStr::from(std::move(*this));
+}
+
 inline StrRef::StrRef(const BoxedStr& owned) noexcept : CharStrRef(owned._data, owned._size) {}
+inline StrZRef::StrZRef(const BoxedCStr& owned) noexcept : CharStrRef(owned._data, owned._size) {}
 
 inline StrRef CharStrRef::as_str_unchecked() const noexcept {
     return *reinterpret_cast<const StrRef*>(this);
 }
+inline std::optional<StrRef> CharStrRef::as_str() const noexcept {
+    if (!this->is_utf8()) {
+        return std::nullopt;
+    }
+    return this->as_str_unchecked();
+}
 template <>
 template <>
 inline CharStrRef MutSliceRef<const uint8_t>::as_char_str<const uint8_t>() const noexcept {
@@ -746,7 +2203,57 @@ inline StrRef MutSliceRef<const uint8_t>::as_str_unchecked<const uint8_t>() cons
     return as_char_str().as_str_unchecked();
 }
 
+#if __cpp_lib_ranges
+// std algorithms are lowered to `memchr()` or `memmove()` only for contiguous iterators.
+static_assert(std::contiguous_iterator<MutSliceRef<int>::iterator>);
+static_assert(std::contiguous_iterator<SliceRef<int>::iterator>);
+static_assert(std::contiguous_iterator<BoxedSlice<int>::iterator>);
+static_assert(std::contiguous_iterator<Vec<int>::iterator>);
+static_assert(std::contiguous_iterator<CharStrRef::iterator>);
+static_assert(std::contiguous_iterator<StrRef::iterator>);
+static_assert(std::contiguous_iterator<BoxedStr::iterator>);
+static_assert(std::ranges::contiguous_range<SliceRef<int>>);
+static_assert(std::ranges::contiguous_range<Vec<int>>);
+static_assert(std::ranges::contiguous_range<StrRef>);
+static_assert(std::ranges::contiguous_range<CompactStr>);
+#endif
+#if FFI_TYPES_POINTER_ITERATOR
+static_assert(std::is_pointer_v<SliceRef<int>::iterator>);
+static_assert(std::is_pointer_v<StrRef::iterator>);
+#endif
+
 #undef SAFE_R
-#undef EMPTY_SLICE_BEGIN
 
 }  // namespace ffi_types
+
+namespace std {
+
+template <>
+struct hash<ffi_types::CharStrRef> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::StrRef> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::BoxedStr> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::CompactStr> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::HashedStrRef> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::StrZRef> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::BoxedCStr> : ffi_types::StrHash {};
+
+template <typename T>
+struct hash<ffi_types::MutSliceRef<T>> : ffi_types::_SliceHash<ffi_types::MutSliceRef<T>> {};
+template <typename T>
+struct hash<ffi_types::SliceRef<T>> : ffi_types::_SliceHash<ffi_types::SliceRef<T>> {};
+template <typename T>
+struct hash<ffi_types::BoxedSlice<T>> : ffi_types::_SliceHash<ffi_types::BoxedSlice<T>> {};
+template <typename T>
+struct hash<ffi_types::Vec<T>> : ffi_types::_SliceHash<ffi_types::Vec<T>> {};
+template <typename T>
+struct hash<ffi_types::ForeignBoxedSlice<T>> : ffi_types::_SliceHash<ffi_types::ForeignBoxedSlice<T>> {};
+
+}  // namespace std
+
+#undef _STR_SIMD
@@ -0,0 +1,177 @@
+namespace ffi_types {
+
+template <typename T>
+struct CSliceSender;
+template <typename T>
+struct CSliceReceiver;
+
+/// An index owned by one side with a cached copy of the index of the other side.
+/// Same layout as Rust `Cursor`.
+struct alignas(64) _ChannelCursor {
+    std::atomic<usize> index;
+    usize cached;
+};
+
+/// Same layout as Rust `ChannelInner<T>`. The channel is allocated and freed by Rust side.
+template <typename T>
+struct _ChannelInner {
+    /// The next slot to receive, written by the receiver.
+    _ChannelCursor head;
+    /// The next slot to send, written by the sender.
+    _ChannelCursor tail;
+    CBoxedSlice<T>* slots;
+    usize mask;
+    std::atomic<usize> refs;
+};
+static_assert(sizeof(_ChannelInner<int>) == 3 * 64);
+static_assert(std::atomic<usize>::is_always_lock_free);
+
+/// C++ counterpart for Rust `SliceSender<T>`, the sending half of a lock-free single-producer single-consumer
+/// channel of `BoxedSlice<T>`.
+///
+/// Sending is inline and moves the ownership of the slice without copying the elements.
+/// Only one thread may send at once.
+///
+/// @note Specialize `_drop()` to release the channel in Rust side. `SliceSender<uint8_t>` is specialized by default.
+template <typename T>
+class SliceSender {
+public:
+    _ChannelInner<T>* _inner;
+
+    SliceSender() = delete;
+    SliceSender(const SliceSender<T>&) = delete;
+    SliceSender(SliceSender<T>&& s) noexcept : _inner(s.release()) {}
+    SliceSender(std::nullptr_t) noexcept : _inner(nullptr) {}
+    explicit SliceSender(_ChannelInner<T>* inner) noexcept : _inner(inner) {}
+    ~SliceSender() noexcept {
+        if (this->_inner) {
+            this->_drop();
+        }
+    }
+    SliceSender<T>& operator=(SliceSender<T>&& s) noexcept {
+        if (this != &s) {
+            if (this->_inner) {
+                this->_drop();
+            }
+            this->_inner = s.release();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Sends `value` without blocking. Returns `false` and leaves `value` as it is if the channel is full.
+    bool try_send(BoxedSlice<T>&& value) noexcept {
+        auto& inner = *this->_inner;
+        const auto tail = inner.tail.index.load(std::memory_order_relaxed);
+        if (tail - inner.tail.cached > inner.mask) {
+            inner.tail.cached = inner.head.index.load(std::memory_order_acquire);
+            if (tail - inner.tail.cached > inner.mask) {
+                return false;
+            }
+        }
+        inner.slots[tail & inner.mask] = CBoxedSlice<T>::from(std::move(value));
+        inner.tail.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns `true` if the receiver is dropped.
+    bool is_disconnected() const noexcept {
+        return this->_inner->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    explicit operator bool() const noexcept {
+        return this->_inner != nullptr;
+    }
+
+    CSliceSender<T> into() noexcept;
+
+    _ChannelInner<T>* release() noexcept {
+        auto* inner = this->_inner;
+        this->_inner = nullptr;
+        return inner;
+    }
+};
+static_assert(sizeof(SliceSender<int>) == sizeof(void*));
+static_assert(std::is_standard_layout<SliceSender<int>>::value);
+
+/// C++ counterpart for Rust `SliceReceiver<T>`, the receiving half of a lock-free single-producer single-consumer
+/// channel of `BoxedSlice<T>`.
+///
+/// Receiving is inline and moves the ownership of the slice without copying the elements.
+/// Only one thread may receive at once.
+///
+/// @note Specialize `_drop()` to release the channel in Rust side. `SliceReceiver<uint8_t>` is specialized by default.
+template <typename T>
+class SliceReceiver {
+public:
+    _ChannelInner<T>* _inner;
+
+    SliceReceiver() = delete;
+    SliceReceiver(const SliceReceiver<T>&) = delete;
+    SliceReceiver(SliceReceiver<T>&& s) noexcept : _inner(s.release()) {}
+    SliceReceiver(std::nullptr_t) noexcept : _inner(nullptr) {}
+    explicit SliceReceiver(_ChannelInner<T>* inner) noexcept : _inner(inner) {}
+    ~SliceReceiver() noexcept {
+        if (this->_inner) {
+            this->_drop();
+        }
+    }
+    SliceReceiver<T>& operator=(SliceReceiver<T>&& s) noexcept {
+        if (this != &s) {
+            if (this->_inner) {
+                this->_drop();
+            }
+            this->_inner = s.release();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Receives a value without blocking. Returns `std::nullopt` if the channel is empty.
+    std::optional<BoxedSlice<T>> try_recv() noexcept {
+        auto& inner = *this->_inner;
+        const auto head = inner.head.index.load(std::memory_order_relaxed);
+        if (head == inner.head.cached) {
+            inner.head.cached = inner.tail.index.load(std::memory_order_acquire);
+            if (head == inner.head.cached) {
+                return std::nullopt;
+            }
+        }
+        auto value = inner.slots[head & inner.mask]();
+        inner.head.index.store(head + 1, std::memory_order_release);
+        return std::optional<BoxedSlice<T>>(std::move(value));
+    }
+
+    /// Returns `true` if the sender is dropped. Values sent before are still received.
+    bool is_disconnected() const noexcept {
+        return this->_inner->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    explicit operator bool() const noexcept {
+        return this->_inner != nullptr;
+    }
+
+    CSliceReceiver<T> into() noexcept;
+
+    _ChannelInner<T>* release() noexcept {
+        auto* inner = this->_inner;
+        this->_inner = nullptr;
+        return inner;
+    }
+};
+static_assert(sizeof(SliceReceiver<int>) == sizeof(void*));
+static_assert(std::is_standard_layout<SliceReceiver<int>>::value);
+
+template <typename T>
+inline CSliceSender<T> SliceSender<T>::into() noexcept {
+    return CSliceSender<T>::from(std::move(*this));
+}
+
+template <typename T>
+inline CSliceReceiver<T> SliceReceiver<T>::into() noexcept {
+    return CSliceReceiver<T>::from(std::move(*this));
+}
+
+}  // namespace ffi_types
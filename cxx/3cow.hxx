@@ -0,0 +1,263 @@
+namespace ffi_types {
+
+struct CCowStr;
+template <typename T>
+struct CCowSlice;
+
+/// The highest bit of the length word of `CowStr` and `CowSlice<T>`, which tags an owned value.
+inline constexpr usize _COW_OWNED_TAG = usize(1) << (sizeof(usize) * 8 - 1);
+
+/// C++ counterpart for Rust `CowStr`, a string either borrowed from Rust storage or owned.
+///
+/// An owned string is exactly a `BoxedStr` with the highest bit of the length word set,
+/// and the destructor drops only an owned string. Both are read as `StrRef` without branching on the data.
+///
+/// @note A borrowed string is valid as long as the storage Rust side borrowed it from.
+class CowStr {
+public:
+    const char* _data;
+    usize _size;
+
+    CowStr() = delete;
+    CowStr(const CowStr&) = delete;
+    CowStr(CowStr&& s) noexcept : _data(s._data), _size(s._size) {
+        s._reset_empty();
+    }
+    CowStr(std::nullptr_t) noexcept : _data(reinterpret_cast<const char*>(1)), _size(0) {}
+    /// Borrows `s` without copying it.
+    explicit CowStr(const StrRef& s) noexcept : _data(s.data()), _size(s.size()) {
+        assert((s.size() & _COW_OWNED_TAG) == 0);
+    }
+    /// Takes the ownership of `s` without copying it.
+    explicit CowStr(BoxedStr&& s) noexcept {
+        auto r = s._take();
+        this->_data = r._data;
+        this->_size = r._size > 0 ? r._size | _COW_OWNED_TAG : 0;
+    }
+
+    ~CowStr() noexcept {
+        this->_drop();
+    }
+
+    CowStr& operator=(CowStr&& s) noexcept {
+        if (this != &s) {
+            this->_drop();
+            this->_data = s._data;
+            this->_size = s._size;
+            s._reset_empty();
+        }
+        return *this;
+    }
+
+    /// Drops an owned string as a `BoxedStr`. A borrowed string is left as it is.
+    void _drop() noexcept {
+        if (this->is_owned()) {
+            auto owned = BoxedStr(nullptr);
+            owned._reset({this->_data, this->size()});
+            this->_reset_empty();
+        }
+    }
+    void _reset_empty() noexcept {
+        this->_data = reinterpret_cast<const char*>(1);
+        this->_size = 0;
+    }
+
+    bool is_owned() const noexcept {
+        return (this->_size & _COW_OWNED_TAG) != 0;
+    }
+
+    const char* data() const noexcept {
+        return this->_data;
+    }
+    usize size() const noexcept {
+        return this->_size & ~_COW_OWNED_TAG;
+    }
+    bool empty() const noexcept {
+        return this->size() == 0;
+    }
+    const char* begin() const noexcept {
+        return this->data();
+    }
+    const char* end() const noexcept {
+        return this->data() + this->size();
+    }
+
+    StrRef as_str() const noexcept {
+        return StrRef::_from_parts(this->data(), this->size());
+    }
+    operator StrRef() const noexcept {
+        return this->as_str();
+    }
+
+    /// Returns the owned string, copying a borrowed one. `this` is left empty.
+    BoxedStr into_owned() && noexcept {
+        if (!this->is_owned()) {
+            auto owned = this->to_owned();
+            this->_reset_empty();
+            return owned;
+        }
+        auto owned = BoxedStr(nullptr);
+        owned._reset({this->_data, this->size()});
+        this->_reset_empty();
+        return owned;
+    }
+
+    /// Returns a copy of the string owned by C++ side.
+    BoxedStr to_owned() const noexcept;
+
+    /// Converts to `CCowStr` by moving the value.
+    /// The value of `this` will be invalidated to an empty string.
+    CCowStr into() noexcept;
+
+    // comparisons between `CowStr`
+    friend bool operator==(const CowStr& a, const CowStr& b) noexcept {
+        return a.as_str() == b.as_str();
+    }
+    friend bool operator!=(const CowStr& a, const CowStr& b) noexcept {
+        return !(a == b);
+    }
+    // comparisons with the other strings, which don't find the operators of `CharStrRef` by ADL
+    _STR_COMPARISONS(const CowStr&, const S&, template <typename S, CharStrRef::_if_str<S> = 0>)
+#if !__cpp_impl_three_way_comparison
+    _STR_COMPARISONS(const S&, const CowStr&, template <typename S, CharStrRef::_if_str<S> = 0>)
+#endif
+};
+static_assert(sizeof(CowStr) == sizeof(BoxedStr));
+static_assert(std::is_standard_layout<CowStr>::value);
+
+static_assert(sizeof(CCowStr) == sizeof(CowStr));
+
+inline CCowStr CowStr::into() noexcept {
+    return CCowStr::from(std::move(*this));
+}
+
+/// C++ counterpart for Rust `CowSlice<T>`, a slice either borrowed from Rust storage or owned.
+///
+/// An owned slice is exactly a `BoxedSlice<T>` with the highest bit of the length word set,
+/// and the destructor drops only an owned slice. Both are read as `SliceRef<T>`.
+///
+/// @note An owned slice is dropped by `BoxedSlice<T>::_drop()`, which must be specialized for `T`.
+template <typename T>
+class CowSlice {
+public:
+    const T* _data;
+    usize _size;
+
+    CowSlice() = delete;
+    CowSlice(const CowSlice<T>&) = delete;
+    CowSlice(CowSlice<T>&& s) noexcept : _data(s._data), _size(s._size) {
+        s._reset_empty();
+    }
+    CowSlice(std::nullptr_t) noexcept : _data(reinterpret_cast<const T*>(alignof(T))), _size(0) {}
+    /// Borrows `s` without copying it.
+    explicit CowSlice(const SliceRef<T>& s) noexcept : _data(s.data()), _size(s.size()) {
+        assert((s.size() & _COW_OWNED_TAG) == 0);
+    }
+    /// Takes the ownership of `s` without copying it.
+    explicit CowSlice(BoxedSlice<T>&& s) noexcept {
+        auto r = s._take();
+        this->_data = r._data;
+        this->_size = r._size > 0 ? r._size | _COW_OWNED_TAG : 0;
+    }
+
+    ~CowSlice() noexcept {
+        this->_drop();
+    }
+
+    CowSlice<T>& operator=(CowSlice<T>&& s) noexcept {
+        if (this != &s) {
+            this->_drop();
+            this->_data = s._data;
+            this->_size = s._size;
+            s._reset_empty();
+        }
+        return *this;
+    }
+
+    /// Drops an owned slice as a `BoxedSlice<T>`. A borrowed slice is left as it is.
+    void _drop() noexcept {
+        if (this->is_owned()) {
+            auto owned = BoxedSlice<T>(nullptr);
+            owned._reset({const_cast<T*>(this->_data), this->size()});
+            this->_reset_empty();
+        }
+    }
+    void _reset_empty() noexcept {
+        this->_data = reinterpret_cast<const T*>(alignof(T));
+        this->_size = 0;
+    }
+
+    bool is_owned() const noexcept {
+        return (this->_size & _COW_OWNED_TAG) != 0;
+    }
+
+    const T* data() const noexcept {
+        return this->_data;
+    }
+    usize size() const noexcept {
+        return this->_size & ~_COW_OWNED_TAG;
+    }
+    bool empty() const noexcept {
+        return this->size() == 0;
+    }
+    const T* begin() const noexcept {
+        return this->data();
+    }
+    const T* end() const noexcept {
+        return this->data() + this->size();
+    }
+    const T& operator[](usize idx) const noexcept {
+        assert(idx < this->size());
+        return this->_data[idx];
+    }
+
+    SliceRef<T> as_slice() const noexcept {
+        return SliceRef<T>(this->data(), this->size());
+    }
+    operator SliceRef<T>() const noexcept {
+        return this->as_slice();
+    }
+
+    /// Returns the owned slice, copying a borrowed one. `this` is left empty.
+    BoxedSlice<T> into_owned() && noexcept {
+        if (!this->is_owned()) {
+            auto owned = this->to_owned();
+            this->_reset_empty();
+            return owned;
+        }
+        auto owned = BoxedSlice<T>(nullptr);
+        owned._reset({const_cast<T*>(this->_data), this->size()});
+        this->_reset_empty();
+        return owned;
+    }
+
+    /// Returns a copy of the slice allocated from the Rust global allocator.
+    BoxedSlice<T> to_owned() const noexcept {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable elements are copied");
+        auto owned = BoxedSlice<T>::with_capacity_uninit(this->size());
+        if (!this->empty()) {
+            std::memcpy(static_cast<void*>(owned.data()), this->_data, sizeof(T) * this->size());
+        }
+        return owned;
+    }
+
+    CCowSlice<T> into() noexcept;
+};
+static_assert(sizeof(CowSlice<int>) == sizeof(BoxedSlice<int>));
+static_assert(std::is_standard_layout<CowSlice<int>>::value);
+
+static_assert(sizeof(CCowSlice<int>) == sizeof(CowSlice<int>));
+
+template <typename T>
+inline CCowSlice<T> CowSlice<T>::into() noexcept {
+    return CCowSlice<T>::from(std::move(*this));
+}
+
+}  // namespace ffi_types
+
+namespace std {
+
+template <>
+struct hash<ffi_types::CowStr> : ffi_types::StrHash {};
+
+}  // namespace std
@@ -0,0 +1,61 @@
+namespace ffi_types {
+
+/// Segments of interned strings indexed by symbols. Same as Rust `interner::SymbolTable`.
+///
+/// Segment `k` holds `FIRST_SEGMENT << k` strings and is never moved once it is published,
+/// so a `StrRef` of a symbol is stable until the process exits.
+struct SymbolTable {
+    static constexpr usize FIRST_SEGMENT = usize(1) << 10;
+    static constexpr usize SEGMENT_COUNT = 22;
+
+    std::atomic<const CStrRef*> segments[SEGMENT_COUNT];
+};
+static_assert(sizeof(SymbolTable) == SymbolTable::SEGMENT_COUNT * sizeof(void*));
+static_assert(std::atomic<const CStrRef*>::is_always_lock_free);
+
+/// A string interned by Rust side. Same as Rust `interner::Symbol`.
+///
+/// Equal strings have the same symbol in the process, so comparing and hashing symbols touch no string.
+/// `str()` resolves a symbol by an inline lookup of the table without an FFI call.
+struct Symbol {
+    uint32_t _id;
+
+    /// Returns the symbol of `s`, interning it if it is new.
+    static Symbol intern(const StrRef& s) noexcept;
+    /// Interns every string of `strs` into `out` of the same size by one FFI call.
+    static void intern_all(SliceRef<CStrRef> strs, MutSliceRef<Symbol> out) noexcept;
+
+    uint32_t id() const noexcept {
+        return this->_id;
+    }
+
+    /// Returns the interned string.
+    StrRef str() const noexcept;
+
+    friend bool operator==(const Symbol& a, const Symbol& b) noexcept {
+        return a._id == b._id;
+    }
+    friend bool operator!=(const Symbol& a, const Symbol& b) noexcept {
+        return a._id != b._id;
+    }
+    /// Orders symbols by the interning order, not by the strings.
+    friend bool operator<(const Symbol& a, const Symbol& b) noexcept {
+        return a._id < b._id;
+    }
+};
+static_assert(sizeof(Symbol) == sizeof(uint32_t));
+static_assert(std::is_trivial<Symbol>::value);
+static_assert(std::is_standard_layout<Symbol>::value);
+
+}  // namespace ffi_types
+
+namespace std {
+
+template <>
+struct hash<ffi_types::Symbol> {
+    size_t operator()(const ffi_types::Symbol& s) const noexcept {
+        return std::hash<uint32_t>()(s._id);
+    }
+};
+
+}  // namespace std
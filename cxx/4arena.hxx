@@ -0,0 +1,125 @@
+namespace ffi_types {
+
+struct CArena;
+
+/// A string allocated in an `Arena`. It is valid until the arena is reset or dropped.
+/// Unlike `BoxedStr`, it is not dropped by itself.
+using ArenaStr = StrRef;
+
+/// The first 2 fields of Rust `ArenaInner`.
+struct _ArenaHeader {
+    uint8_t* cursor;
+    uint8_t* end;
+};
+
+/// C++ counterpart for Rust `Arena`, a bump allocator for values living together, e.g. in a request.
+///
+/// Allocation is inline until the current chunk is full. Dropping or resetting the arena frees every value at once,
+/// so no drop call crosses FFI per value. Only trivially destructible values are allocated.
+///
+/// @warning An arena is not thread-safe. Move it to share between threads.
+class Arena {
+public:
+    _ArenaHeader* _inner;
+
+    Arena() = delete;
+    Arena(const Arena&) = delete;
+    Arena(Arena&& a) noexcept : _inner(a._inner) {
+        a._inner = nullptr;
+    }
+    Arena(std::nullptr_t) noexcept : _inner(nullptr) {}
+    ~Arena() noexcept {
+        if (this->_inner) {
+            this->_drop();
+        }
+    }
+    Arena& operator=(Arena&& a) noexcept {
+        if (this != &a) {
+            if (this->_inner) {
+                this->_drop();
+            }
+            this->_inner = a._inner;
+            a._inner = nullptr;
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Creates an arena allocating chunks of `chunk_size` bytes first. Zero means the default size.
+    static Arena create(usize chunk_size = 0) noexcept;
+
+    /// Allocates `size` bytes aligned by `align`, which must be a power of two. Zero-sized blocks are dangling.
+    uint8_t* alloc(usize size, usize align) noexcept {
+        assert(align > 0 && (align & (align - 1)) == 0);
+        const auto cursor = reinterpret_cast<uintptr_t>(this->_inner->cursor);
+        const auto aligned = (cursor + align - 1) & ~(align - 1);
+        const auto end = reinterpret_cast<uintptr_t>(this->_inner->end);
+        if (aligned >= cursor && aligned <= end && size <= end - aligned && cursor != 0) {
+            // keep the provenance of the chunk
+            auto* ptr = this->_inner->cursor + (aligned - cursor);
+            this->_inner->cursor = ptr + size;
+            return ptr;
+        }
+        return this->_alloc_slow(size, align);
+    }
+
+    uint8_t* _alloc_slow(usize size, usize align) noexcept;
+
+    /// Allocates a slice of `size` uninitialized elements.
+    ///
+    /// @warning Every element must be written before it is read.
+    template <typename T>
+    ArenaSlice<T> alloc_slice_uninit(usize size) noexcept {
+        static_assert(std::is_trivially_destructible<T>::value, "the arena never drops values");
+        assert(size <= SIZE_MAX / sizeof(T));
+        return ArenaSlice<T>(reinterpret_cast<T*>(this->alloc(sizeof(T) * size, alignof(T))), size);
+    }
+
+    /// Copies `slice` to the arena.
+    template <typename T>
+    ArenaSlice<T> alloc_slice_copy(SliceRef<T> slice) noexcept {
+        static_assert(std::is_trivially_copyable<T>::value, "elements are copied by memcpy");
+        auto* data = this->alloc(slice.size_bytes(), alignof(T));
+        if (!slice.empty()) {
+            std::memcpy(data, slice.data(), slice.size_bytes());
+        }
+        return ArenaSlice<T>(reinterpret_cast<T*>(data), slice.size());
+    }
+
+    /// Copies `s` to the arena.
+    ArenaStr alloc_str(StrRef s) noexcept {
+        auto bytes = this->alloc_slice_uninit<char>(s.size());
+        if (!s.empty()) {
+            std::memcpy(bytes.data(), s.data(), s.size());
+        }
+        return CharStrRef(bytes.data(), bytes.size()).as_str_unchecked();
+    }
+
+    /// Copies `s` to the arena if it is a valid UTF-8 string.
+    std::optional<ArenaStr> alloc_str_from_utf8(CharStrRef s) noexcept {
+        if (!s.is_utf8()) {
+            return std::nullopt;
+        }
+        return this->alloc_str(s.as_str_unchecked());
+    }
+
+    /// Frees every value at once. The current chunk is kept to be reused.
+    void reset() noexcept;
+
+    CArena into() noexcept;
+    const CArena& as_c() const noexcept {
+        return *reinterpret_cast<const CArena*>(this);
+    }
+    CArena& as_c() noexcept {
+        return *reinterpret_cast<CArena*>(this);
+    }
+};
+static_assert(sizeof(Arena) == sizeof(void*));
+static_assert(std::is_standard_layout<Arena>::value);
+
+inline CArena Arena::into() noexcept {
+    return CArena::from(std::move(*this));
+}
+
+}  // namespace ffi_types
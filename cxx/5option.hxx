@@ -0,0 +1,19 @@
+namespace ffi_types {
+
+/// The C++ counterpart converted by `operator()()` of a C-prefixed type, or the type itself.
+template <typename T, typename = void>
+struct _Owned {
+    using type = T;
+    static type take(T& value) noexcept {
+        return std::move(value);
+    }
+};
+template <typename T>
+struct _Owned<T, std::void_t<decltype(std::declval<T&>()())>> {
+    using type = decltype(std::declval<T&>()());
+    static type take(T& value) noexcept {
+        return value();
+    }
+};
+
+}  // namespace ffi_types
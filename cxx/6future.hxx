@@ -0,0 +1,283 @@
+namespace ffi_types {
+
+template <typename T>
+struct CRustFuture;
+
+/// Functions of a waker of C++ side. Same as Rust `WakerVTable`.
+///
+/// `data` points to an object starting with a pointer to the vtable. The object is reference counted by the owner.
+struct _WakerVTable {
+    /// Adds a reference to the waker.
+    void (*clone)(const void* data);
+    /// Wakes the task without consuming a reference. May be called from any thread.
+    void (*wake)(const void* data);
+    /// Removes a reference to the waker.
+    void (*drop)(const void* data);
+};
+
+/// Functions of a `RustFuture<T>`. Same as Rust `FutureVTable<T>`.
+template <typename T>
+struct _FutureVTable {
+    /// Polls the future once with a borrowed `waker`. Returns `true` and moves the output to `out` when ready.
+    /// Otherwise `waker` is woken when the future should be polled again.
+    /// The future must not be polled after it is ready.
+    bool (*poll)(void* state, const void* waker, T* out);
+    /// Drops the future, even if it is not ready yet.
+    void (*drop)(void* state);
+};
+
+#if __cpp_impl_coroutine
+/// An executor of C++ side resuming coroutines which await `RustFuture<T>`, e.g. an event loop.
+///
+/// A wake from Rust side only calls `schedule(context, run, task)`, which must arrange `run(task)` to be called
+/// once on the executor, e.g. by posting it to the loop, and return without calling it.
+/// `run(task)` polls the future again and resumes the coroutine if the output is ready.
+///
+/// @note `schedule` may be called from any thread, e.g. a worker thread of a Rust runtime holding its locks,
+///       so it must be cheap and must not call Rust side.
+struct FutureExecutor {
+    void (*schedule)(void* context, void (*run)(void* task), void* task);
+    void* context;
+};
+
+template <typename T>
+class _FutureAwaiter;
+#endif
+
+/// C++ counterpart for Rust `RustFuture<T>`, a future of Rust side polled by a waker of C++ side.
+///
+/// `T` is the C-prefixed type of the Rust output, e.g. `CBoxedStr` for `BoxedStr`.
+/// In C++20, `co_await std::move(future).on(executor)` suspends the coroutine until the output is ready
+/// and returns the owned type, e.g. `BoxedStr`. The coroutine resumes on `executor`, see `FutureExecutor`.
+///
+/// The vtable is called inline, so no `_drop()` specialization is needed.
+template <typename T>
+class RustFuture {
+public:
+    void* _state;
+    const _FutureVTable<T>* _vtable;
+
+    RustFuture() = delete;
+    RustFuture(const RustFuture<T>&) = delete;
+    RustFuture(RustFuture<T>&& f) noexcept : _state(f._state), _vtable(f._vtable) {
+        f._reset_empty();
+    }
+    RustFuture(std::nullptr_t) noexcept : _state(nullptr), _vtable(nullptr) {}
+    /// Takes the ownership of `state`. `vtable->drop(state)` is called once to free it.
+    explicit RustFuture(void* state, const _FutureVTable<T>* vtable) noexcept : _state(state), _vtable(vtable) {}
+    ~RustFuture() noexcept {
+        this->_drop();
+    }
+    RustFuture<T>& operator=(RustFuture<T>&& f) noexcept {
+        if (this != &f) {
+            this->_drop();
+            this->_state = f._state;
+            this->_vtable = f._vtable;
+            f._reset_empty();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept {
+        if (this->_vtable) {
+            this->_vtable->drop(this->_state);
+        }
+        this->_reset_empty();
+    }
+    void _reset_empty() noexcept {
+        this->_state = nullptr;
+        this->_vtable = nullptr;
+    }
+
+    /// Polls the future once. Returns `true` and writes `out` without destroying it when ready.
+    /// Otherwise `waker` is woken when the future should be polled again.
+    ///
+    /// @note `waker` points to an object starting with a pointer to `_WakerVTable`.
+    ///       The future must not be polled after it is ready.
+    bool poll(const void* waker, T* out) noexcept {
+        return this->_vtable->poll(this->_state, waker, out);
+    }
+
+    explicit operator bool() const noexcept {
+        return this->_vtable != nullptr;
+    }
+
+    CRustFuture<T> into() noexcept;
+
+#if __cpp_impl_coroutine
+    /// Returns an awaiter polling the future again and resuming the coroutine on `executor`.
+    _FutureAwaiter<T> on(FutureExecutor executor) && noexcept;
+#endif
+};
+static_assert(sizeof(RustFuture<int>) == 2 * sizeof(void*));
+static_assert(std::is_standard_layout<RustFuture<int>>::value);
+
+template <typename T>
+inline CRustFuture<T> RustFuture<T>::into() noexcept {
+    return CRustFuture<T>::from(std::move(*this));
+}
+
+#if __cpp_impl_coroutine
+/// A reference counted waker owning a `RustFuture<T>` awaited by a coroutine.
+///
+/// Rust side may keep clones of the waker after the coroutine is gone, so the future lives until the last clone
+/// is dropped. A wake schedules a task polling the future on the executor, which keeps a reference until it runs.
+/// A wake while the task is scheduled is merged into it, and a wake while the future is polled makes the poller
+/// poll again instead of polling concurrently.
+template <typename T>
+struct _FutureWaker {
+    enum Status : uint8_t {
+        idle = 0,
+        polling = 1,
+        /// Woken while polling.
+        notified = 2,
+        ready = 3,
+        /// The coroutine is gone without the output.
+        closed = 4,
+        /// Woken and waiting for the task on the executor.
+        scheduled = 5,
+    };
+
+    /// The first field to be a waker of Rust side.
+    const _WakerVTable* _vtable;
+    std::atomic<usize> _refs;
+    std::atomic<uint8_t> _status;
+    RustFuture<T> _future;
+    FutureExecutor _executor;
+    std::coroutine_handle<> _handle;
+    union _Output {
+        _Output() noexcept {}
+        T value;
+    } _output;
+
+    static const _WakerVTable VTABLE;
+
+    explicit _FutureWaker(RustFuture<T>&& future, FutureExecutor executor) noexcept
+        : _vtable(&VTABLE),
+          _refs(1),
+          _status(polling),
+          _future(std::move(future)),
+          _executor(executor),
+          _handle(nullptr) {}
+
+    /// Polls until the future is ready or no wake is left. `_status` must be `polling`.
+    /// Returns `true` if the future is ready.
+    bool _run() noexcept {
+        while (true) {
+            if (this->_future.poll(this, &this->_output.value)) {
+                // Resources of the future are released as soon as it is ready.
+                this->_future._drop();
+                this->_status.store(ready, std::memory_order_release);
+                return true;
+            }
+            uint8_t expected = polling;
+            if (this->_status.compare_exchange_strong(expected, idle, std::memory_order_acq_rel)) {
+                return false;
+            }
+            this->_status.store(polling, std::memory_order_relaxed);
+        }
+    }
+
+    static void _clone(const void* data) noexcept {
+        auto* waker = const_cast<_FutureWaker*>(static_cast<const _FutureWaker*>(data));
+        waker->_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Only schedules `_poll_task()`, so the future is polled and the coroutine resumes on the executor.
+    static void _wake(const void* data) noexcept {
+        auto* waker = const_cast<_FutureWaker*>(static_cast<const _FutureWaker*>(data));
+        auto status = waker->_status.load(std::memory_order_acquire);
+        while (true) {
+            if (status == idle) {
+                if (waker->_status.compare_exchange_weak(status, scheduled, std::memory_order_acq_rel)) {
+                    // The scheduled task keeps a reference until it runs.
+                    _clone(waker);
+                    waker->_executor.schedule(waker->_executor.context, _poll_task, waker);
+                    return;
+                }
+            } else if (status == polling) {
+                if (waker->_status.compare_exchange_weak(status, notified, std::memory_order_acq_rel)) {
+                    return;
+                }
+            } else {
+                return;
+            }
+        }
+    }
+
+    /// Runs on the executor. The wake is dropped if the coroutine is destroyed after it is scheduled.
+    static void _poll_task(void* task) noexcept {
+        auto* waker = static_cast<_FutureWaker*>(task);
+        uint8_t expected = scheduled;
+        if (waker->_status.compare_exchange_strong(expected, polling, std::memory_order_acq_rel) && waker->_run()) {
+            waker->_handle.resume();
+        }
+        _release(waker);
+    }
+
+    static void _release(const void* data) noexcept {
+        auto* waker = const_cast<_FutureWaker*>(static_cast<const _FutureWaker*>(data));
+        if (waker->_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete waker;
+        }
+    }
+};
+
+template <typename T>
+const _WakerVTable _FutureWaker<T>::VTABLE = {_FutureWaker<T>::_clone, _FutureWaker<T>::_wake,
+                                              _FutureWaker<T>::_release};
+
+/// An awaiter of a `RustFuture<T>` returning the owned type of `T`, e.g. `BoxedStr` for `CBoxedStr`.
+///
+/// The future is polled first on the awaiting thread, and then only by tasks on the executor,
+/// so the coroutine resumes either without suspending or on the executor.
+template <typename T>
+class _FutureAwaiter {
+public:
+    _FutureWaker<T>* _waker;
+
+    explicit _FutureAwaiter(RustFuture<T>&& future, FutureExecutor executor) noexcept
+        : _waker(new _FutureWaker<T>(std::move(future), executor)) {}
+    _FutureAwaiter(const _FutureAwaiter&) = delete;
+    _FutureAwaiter& operator=(const _FutureAwaiter&) = delete;
+    /// Drops the future and ignores later wakes and the scheduled task if the coroutine is destroyed while suspended.
+    ///
+    /// @warning Destroying the coroutine while the future is polled by another thread is undefined behavior,
+    ///          same as destroying any coroutine being resumed.
+    ~_FutureAwaiter() noexcept {
+        auto* waker = this->_waker;
+        auto status = waker->_status.load(std::memory_order_acquire);
+        while (status == _FutureWaker<T>::idle || status == _FutureWaker<T>::scheduled) {
+            if (waker->_status.compare_exchange_weak(status, _FutureWaker<T>::closed, std::memory_order_acq_rel)) {
+                // No one polls a closed future, and dropping it drops the clones of the waker it keeps.
+                waker->_future._drop();
+                break;
+            }
+        }
+        _FutureWaker<T>::_release(waker);
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    /// Polls first on the awaiting thread. Does not suspend if the output is ready.
+    bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        auto* waker = this->_waker;
+        waker->_handle = handle;
+        // The coroutine may be resumed by another thread once `_run()` returns, so `this` is not used after it.
+        return !waker->_run();
+    }
+
+    typename _Owned<T>::type await_resume() noexcept {
+        return _Owned<T>::take(this->_waker->_output.value);
+    }
+};
+
+template <typename T>
+inline _FutureAwaiter<T> RustFuture<T>::on(FutureExecutor executor) && noexcept {
+    return _FutureAwaiter<T>(std::move(*this), executor);
+}
+#endif
+
+}  // namespace ffi_types
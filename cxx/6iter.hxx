@@ -0,0 +1,161 @@
+namespace ffi_types {
+
+template <typename T>
+struct CRustIter;
+
+/// Functions of a `RustIter<T>`. Same as Rust `IterVTable<T>`.
+template <typename T>
+struct _IterVTable {
+    /// Moves up to `buffer._size` items to the front of `buffer` and returns the count.
+    /// Zero means the end of the iterator. The moved items are owned by the caller.
+    usize (*next_batch)(void* state, CMutSliceRef<T> buffer);
+    /// Drops the iterator with the items not moved yet.
+    void (*drop)(void* state);
+};
+
+template <typename T>
+class RustIter;
+
+/// An input range of the items of a `RustIter<T>` pulled into a buffer. Returned by `RustIter<T>::items()`.
+///
+/// Items are referenced in the buffer and owned by the caller. Call `operator()()` of C-prefixed items to own them.
+///
+/// @warning Items pulled but not visited yet are left in `remaining()` when the loop breaks.
+template <typename T>
+struct _IterItems {
+    RustIter<T>* _iter;
+    MutSliceRef<T> _buffer;
+    usize _index;
+    usize _count;
+
+    bool _fill() noexcept {
+        this->_index = 0;
+        this->_count = this->_iter->next_batch(this->_buffer);
+        return this->_count > 0;
+    }
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = intptr_t;
+        using pointer = T*;
+        using reference = T&;
+
+        /// Null at the end.
+        _IterItems<T>* _items;
+
+        reference operator*() const noexcept {
+            return this->_items->_buffer._data[this->_items->_index];
+        }
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+        iterator& operator++() noexcept {
+            if (++this->_items->_index == this->_items->_count && !this->_items->_fill()) {
+                this->_items = nullptr;
+            }
+            return *this;
+        }
+        void operator++(int) noexcept {
+            ++*this;
+        }
+        bool operator==(const iterator& other) const noexcept {
+            return this->_items == other._items;
+        }
+        bool operator!=(const iterator& other) const noexcept {
+            return this->_items != other._items;
+        }
+    };
+
+    iterator begin() noexcept {
+        if (this->_index == this->_count && !this->_fill()) {
+            return iterator{nullptr};
+        }
+        return iterator{this};
+    }
+    iterator end() noexcept {
+        return iterator{nullptr};
+    }
+
+    /// Returns the items pulled into the buffer but not visited yet.
+    MutSliceRef<T> remaining() const noexcept {
+        return MutSliceRef<T>(this->_buffer._data + this->_index, this->_count - this->_index);
+    }
+};
+
+/// C++ counterpart for Rust `RustIter<T>`, an iterator of Rust side pulled in batches.
+///
+/// `next_batch()` moves items into a buffer of the caller, so streaming a large result takes the memory
+/// of the buffer only and crosses FFI once per batch. `T` is the C-prefixed type of the Rust item,
+/// e.g. `CBoxedStr` for `BoxedStr`.
+///
+/// The vtable is called inline, so no `_drop()` specialization is needed.
+template <typename T>
+class RustIter {
+public:
+    void* _state;
+    const _IterVTable<T>* _vtable;
+
+    RustIter() = delete;
+    RustIter(const RustIter<T>&) = delete;
+    RustIter(RustIter<T>&& it) noexcept : _state(it._state), _vtable(it._vtable) {
+        it._reset_empty();
+    }
+    RustIter(std::nullptr_t) noexcept : _state(nullptr), _vtable(nullptr) {}
+    /// Takes the ownership of `state`. `vtable->drop(state)` is called once to free it.
+    explicit RustIter(void* state, const _IterVTable<T>* vtable) noexcept : _state(state), _vtable(vtable) {}
+    ~RustIter() noexcept {
+        this->_drop();
+    }
+    RustIter<T>& operator=(RustIter<T>&& it) noexcept {
+        if (this != &it) {
+            this->_drop();
+            this->_state = it._state;
+            this->_vtable = it._vtable;
+            it._reset_empty();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept {
+        if (this->_vtable) {
+            this->_vtable->drop(this->_state);
+        }
+        this->_reset_empty();
+    }
+    void _reset_empty() noexcept {
+        this->_state = nullptr;
+        this->_vtable = nullptr;
+    }
+
+    /// Moves up to `buffer.size()` items to the front of `buffer` and returns the count.
+    /// Zero means the end of the iterator. The moved items are owned by the caller.
+    ///
+    /// @note `buffer` is written without destroying the old elements.
+    usize next_batch(MutSliceRef<T> buffer) noexcept {
+        return this->_vtable->next_batch(this->_state, CMutSliceRef<T>::from(buffer));
+    }
+
+    /// Returns an input range of the items pulled into `buffer` batch by batch.
+    /// `buffer` must not be empty and must outlive the range.
+    _IterItems<T> items(MutSliceRef<T> buffer) noexcept {
+        assert(!buffer.empty());
+        return _IterItems<T>{this, buffer, 0, 0};
+    }
+
+    explicit operator bool() const noexcept {
+        return this->_vtable != nullptr;
+    }
+
+    CRustIter<T> into() noexcept;
+};
+static_assert(sizeof(RustIter<int>) == 2 * sizeof(void*));
+static_assert(std::is_standard_layout<RustIter<int>>::value);
+
+template <typename T>
+inline CRustIter<T> RustIter<T>::into() noexcept {
+    return CRustIter<T>::from(std::move(*this));
+}
+
+}  // namespace ffi_types
@@ -8,9 +8,128 @@ namespace ffi_types {
 
 extern "C" {
 
-void _rust_ffi_boxed_str_drop(ffi_types::CBoxedStr _string);
+void _rust_ffi_boxed_str_drop(ffi_types::CBoxedStr string);
 
-void _rust_ffi_boxed_bytes_drop(ffi_types::CBoxedSlice<uint8_t> _slice);
+void _rust_ffi_boxed_c_str_drop(ffi_types::CBoxedCStr string);
+
+/// Returns `slice` to the buffer pool of the current thread if it is of a size class.
+void _rust_ffi_boxed_bytes_drop(ffi_types::CBoxedSlice<uint8_t> slice);
+
+/// Drops every string of `strings` at once.
+/// The caller must not use or drop the items after this call.
+void _rust_ffi_boxed_str_drop_many(ffi_types::CMutSliceRef<ffi_types::CBoxedStr> strings);
+
+/// Drops every slice of `slices` at once.
+/// The caller must not use or drop the items after this call.
+void _rust_ffi_boxed_bytes_drop_many(ffi_types::CMutSliceRef<ffi_types::CBoxedSlice<uint8_t>> slices);
+
+/// Enables or disables deferred drop of boxed values in the current thread.
+/// Returns the previous state.
+///
+/// In deferred mode, drop functions push values to a reclaimer thread instead of deallocating them.
+bool _rust_ffi_reclaim_set_deferred(bool enabled);
+
+/// Drops every deferred value before returning.
+void _rust_ffi_reclaim_flush();
+
+/// Returns the number of values deferred but not dropped yet.
+uintptr_t _rust_ffi_reclaim_pending();
+
+/// Returns the number of values ever deferred.
+uintptr_t _rust_ffi_reclaim_deferred_count();
+
+/// Allocates a byte slice of `size` uninitialized bytes.
+/// A buffer of a size class is taken from the buffer pool of the current thread if one is available.
+ffi_types::CBoxedSlice<uint8_t> _rust_ffi_pool_alloc(uintptr_t size);
+
+/// Sets the maximum bytes kept by each size class of each thread. Zero disables buffer pools.
+/// Returns the previous limit.
+uintptr_t _rust_ffi_pool_set_limit(uintptr_t bytes_per_class);
+
+/// Returns the counters of the buffer pool of the current thread.
+ffi_types::PoolStats _rust_ffi_pool_thread_stats();
+
+/// Frees every buffer in the buffer pool of the current thread.
+void _rust_ffi_pool_clear();
+
+/// Returns the counters of the current thread, which C++ `FFI_TYPES_INSTRUMENT` writes inline.
+const ffi_types::OwnershipShard *_rust_ffi_instrument_thread_shard();
+
+/// Sums the counters of C++ ownership transfers of every thread.
+ffi_types::OwnershipSnapshot _rust_ffi_instrument_snapshot();
+
+void _rust_ffi_vec_bytes_drop(ffi_types::CVec<uint8_t> vec);
+
+/// Reserves capacity for at least `additional` more elements.
+///
+/// This is a type-erased `Vec::reserve` for elements of `elem_size` bytes aligned by `align`.
+/// `len` and `cap` of `vec` are counted by elements, not bytes.
+void _rust_ffi_vec_reserve(ffi_types::CVec<uint8_t> *vec, uintptr_t additional, uintptr_t elem_size, uintptr_t align);
+
+/// Allocates `size` bytes aligned by `align` from the Rust global allocator.
+///
+/// The memory can be owned by a boxed type only if the layout is the one Rust deallocates it with.
+/// e.g. `size_of::<T>() * len` and `align_of::<T>()` for `Box<[T]>`.
+/// Zero-sized allocation returns a dangling pointer.
+uint8_t *_rust_ffi_alloc(uintptr_t size, uintptr_t align);
+
+/// Resizes a memory block from [`alloc`] or a boxed type from `old_size` to `new_size` bytes.
+///
+/// Either size can be zero. The returned pointer is dangling when `new_size` is zero.
+uint8_t *_rust_ffi_realloc(uint8_t *ptr, uintptr_t old_size, uintptr_t align, uintptr_t new_size);
+
+/// Deallocates a memory block from [`alloc`] or [`realloc`]. Zero-sized blocks are ignored.
+void _rust_ffi_dealloc(uint8_t *ptr, uintptr_t size, uintptr_t align);
+
+/// Checks whether `string` is a valid UTF-8 string.
+bool _rust_ffi_utf8_validate(ffi_types::CharStrRef string);
+
+/// Hashes `bytes` by the same function as C++ `ffi_types::hash_bytes()`.
+uint64_t _rust_ffi_hash_bytes(ffi_types::CByteSliceRef bytes);
+
+/// Returns the symbol of `string`, interning it if it is new.
+ffi_types::Symbol _rust_ffi_intern(ffi_types::CStrRef string);
+
+/// Interns every string of `strings` into `out` of the same length.
+void _rust_ffi_intern_all(ffi_types::CSliceRef<ffi_types::CStrRef> strings,
+                          ffi_types::CMutSliceRef<ffi_types::Symbol> out);
+
+/// Returns the table which C++ `Symbol::str()` resolves symbols with inline.
+const ffi_types::SymbolTable *_rust_ffi_symbol_table();
+
+/// Creates an arena allocating chunks of `chunk_size` bytes first. Zero means the default size.
+ffi_types::CArena _rust_ffi_arena_new(uintptr_t chunk_size);
+
+void _rust_ffi_arena_drop(ffi_types::CArena _arena);
+
+/// Allocates `size` bytes aligned by `align` from `arena`.
+/// This is the slow path of C++ `Arena::alloc()` when the current chunk is full.
+uint8_t *_rust_ffi_arena_alloc(const ffi_types::CArena *arena, uintptr_t size, uintptr_t align);
+
+/// Frees every value of `arena` at once.
+void _rust_ffi_arena_reset(ffi_types::CArena *arena);
+
+/// Creates a channel of byte slices holding up to `capacity` slices in flight.
+/// The capacity is rounded up to a power of two.
+void _rust_ffi_byte_channel_new(uintptr_t capacity,
+                                ffi_types::CSliceSender<uint8_t> *sender,
+                                ffi_types::CSliceReceiver<uint8_t> *receiver);
+
+void _rust_ffi_byte_sender_drop(ffi_types::CSliceSender<uint8_t> _sender);
+
+void _rust_ffi_byte_receiver_drop(ffi_types::CSliceReceiver<uint8_t> _receiver);
+
+/// Maps the whole file of `path` as read-only to `out`.
+/// Returns 0 on success or an `errno` value. `out` is not written on failure.
+///
+/// The file must not be modified or truncated while the mapping is alive. See Rust `MmapSlice::open`.
+int32_t _rust_ffi_mmap_open(ffi_types::CharStrRef path, ffi_types::CMmapSlice *out);
+
+void _rust_ffi_mmap_drop(ffi_types::CMmapSlice _mmap);
+
+/// Gives a hint of the access pattern of `bytes`, which must be a part of a mapping.
+/// Returns 0 on success or an `errno` value.
+int32_t _rust_ffi_mmap_advise(ffi_types::CByteSliceRef bytes, ffi_types::MmapAdvice advice);
 
 } // extern "C"
 
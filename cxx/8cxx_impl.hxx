@@ -1,12 +1,1041 @@
 namespace ffi_types {
 
+// members of the C-prefixed types defined in `rust_types_fwd.hxx`
+
+#if _MSC_VER
+template <typename T>
+inline CBox<T> CBox<T>::from(OptionBox<T>&& box) noexcept {
+    CBox cbox;
+    cbox._ptr = box._take();
+    instrument::_give_up(instrument::_Kind::option_box, instrument::_Event::into, cbox._ptr != nullptr, 0);
+    return cbox;
+}
+#else
+template <typename T>
+inline CBox<T>::CBox(OptionBox<T>&& box) noexcept : _ptr(box._take()) {
+    instrument::_give_up(instrument::_Kind::option_box, instrument::_Event::into, this->_ptr != nullptr, 0);
+}
+
+template <typename T>
+inline CBox<T> CBox<T>::from(OptionBox<T>&& box) noexcept {
+    return CBox(std::move(box));
+}
+#endif
+
+template <typename T>
+inline OptionBox<T> CBox<T>::operator()() noexcept {
+    auto box = OptionBox<T>(nullptr);
+    box.reset(this->_ptr);
+    this->_ptr = nullptr;
+    return box;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CArc<T> CArc<T>::from(Arc<T>&& arc) noexcept {
+    CArc carc;
+    carc._ptr = arc.release();
+    return carc;
+}
+#else
+template <typename T>
+inline CArc<T>::CArc(Arc<T>&& arc) noexcept : _ptr(arc.release()) {}
+
+template <typename T>
+inline CArc<T> CArc<T>::from(Arc<T>&& arc) noexcept {
+    return CArc(std::move(arc));
+}
+#endif
+
+template <typename T>
+inline Arc<T> CArc<T>::operator()() noexcept {
+    return Arc<T>(this->release());
+}
+
+// checks the members of a void box, which is still passed to Rust side
+template struct CBox<void>;
+
+#if _MSC_VER
+template <typename T>
+constexpr CMutSliceRef<T> CMutSliceRef<T>::from(const MutSliceRef<T>& slice) noexcept {
+    CMutSliceRef s{};
+    s._data = slice._data;
+    s._size = slice._size;
+    return s;
+}
+#else
+template <typename T>
+constexpr CMutSliceRef<T>::CMutSliceRef(const MutSliceRef<T>& slice) noexcept
+    : _data(slice._data), _size(slice._size) {}
+
+template <typename T>
+constexpr CMutSliceRef<T> CMutSliceRef<T>::from(const MutSliceRef<T>& slice) noexcept {
+    return CMutSliceRef(slice);
+}
+#endif
+
+template <typename T>
+constexpr MutSliceRef<T> CMutSliceRef<T>::operator()() const noexcept {
+    return MutSliceRef<T>(this->_data, this->_size);
+}
+
+#if _MSC_VER
+template <typename T>
+constexpr CSliceRef<T> CSliceRef<T>::from(const SliceRef<T>& slice) noexcept {
+    CSliceRef s{};
+    s._data = slice._data;
+    s._size = slice._size;
+    return s;
+}
+#else
+template <typename T>
+constexpr CSliceRef<T>::CSliceRef(const SliceRef<T>& slice) noexcept : _data(slice._data), _size(slice._size) {}
+
+template <typename T>
+constexpr CSliceRef<T> CSliceRef<T>::from(const SliceRef<T>& slice) noexcept {
+    return CSliceRef(slice);
+}
+#endif
+
+template <typename T>
+constexpr SliceRef<T> CSliceRef<T>::operator()() const noexcept {
+    return SliceRef<T>(this->_data, this->_size);
+}
+
+#if _MSC_VER
+constexpr CByteSliceRef CByteSliceRef::from(const ByteSliceRef& slice) noexcept {
+    CByteSliceRef s{};
+    s._data = slice._data;
+    s._size = slice._size;
+    return s;
+}
+#else
+constexpr CByteSliceRef::CByteSliceRef(const ByteSliceRef& slice) noexcept : _data(slice._data), _size(slice._size) {}
+
+constexpr CByteSliceRef CByteSliceRef::from(const ByteSliceRef& slice) noexcept {
+    return CByteSliceRef(slice);
+}
+#endif
+
+inline ByteSliceRef CByteSliceRef::operator()() const noexcept {
+    ByteSliceRef slice;
+    slice._data = this->_data;
+    slice._size = this->_size;
+    return slice;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CBoxedSlice<T> CBoxedSlice<T>::from(BoxedSlice<T>&& slice) noexcept {
+    auto r = slice._take();
+    instrument::_give_up(
+            instrument::_Kind::boxed_slice, instrument::_Event::into, r._size > 0, sizeof(T) * r._size);
+    CBoxedSlice s;
+    s._data = r._data;
+    s._size = r._size;
+    return s;
+}
+#else
+template <typename T>
+inline CBoxedSlice<T>::CBoxedSlice(BoxedSlice<T>&& slice) noexcept {
+    auto r = slice._take();
+    instrument::_give_up(
+            instrument::_Kind::boxed_slice, instrument::_Event::into, r._size > 0, sizeof(T) * r._size);
+    this->_data = r._data;
+    this->_size = r._size;
+}
+
+template <typename T>
+inline CBoxedSlice<T> CBoxedSlice<T>::from(BoxedSlice<T>&& slice) noexcept {
+    return CBoxedSlice(std::move(slice));
+}
+#endif
+
+template <typename T>
+inline BoxedSlice<T> CBoxedSlice<T>::operator()() noexcept {
+    auto slice = BoxedSlice<T>(nullptr);
+    slice.reset(this->release());
+    return slice;
+}
+
+template <typename T>
+inline _SliceRange<T> CBoxedSlice<T>::get() const noexcept {
+    return {this->_data, this->_size};
+}
+
+template <typename T>
+inline _SliceRange<T> CBoxedSlice<T>::release() noexcept {
+    const auto range = this->get();
+    this->_data = EMPTY_SLICE_BEGIN(T);
+    this->_size = 0;
+    return range;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CVec<T> CVec<T>::from(Vec<T>&& vec) noexcept {
+    CVec v;
+    v._data = vec._data;
+    v._size = vec._size;
+    v._capacity = vec._capacity;
+    vec._data = EMPTY_SLICE_BEGIN(T);
+    vec._size = 0;
+    vec._capacity = 0;
+    return v;
+}
+#else
+template <typename T>
+inline CVec<T>::CVec(Vec<T>&& vec) noexcept : _data(vec._data), _size(vec._size), _capacity(vec._capacity) {
+    vec._data = EMPTY_SLICE_BEGIN(T);
+    vec._size = 0;
+    vec._capacity = 0;
+}
+
+template <typename T>
+inline CVec<T> CVec<T>::from(Vec<T>&& vec) noexcept {
+    return CVec(std::move(vec));
+}
+#endif
+
+template <typename T>
+inline Vec<T> CVec<T>::operator()() noexcept {
+    auto vec = Vec<T>(nullptr);
+    vec._data = this->_data;
+    vec._size = this->_size;
+    vec._capacity = this->_capacity;
+    this->_data = EMPTY_SLICE_BEGIN(T);
+    this->_size = 0;
+    this->_capacity = 0;
+    return vec;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CForeignBoxedSlice<T> CForeignBoxedSlice<T>::from(ForeignBoxedSlice<T>&& slice) noexcept {
+    CForeignBoxedSlice s;
+    s._data = slice._data;
+    s._size = slice._size;
+    s._drop_fn = slice._drop_fn;
+    s._ctx = slice._ctx;
+    slice._reset_empty();
+    return s;
+}
+#else
+template <typename T>
+inline CForeignBoxedSlice<T>::CForeignBoxedSlice(ForeignBoxedSlice<T>&& slice) noexcept
+    : _data(slice._data), _size(slice._size), _drop_fn(slice._drop_fn), _ctx(slice._ctx) {
+    slice._reset_empty();
+}
+
+template <typename T>
+inline CForeignBoxedSlice<T> CForeignBoxedSlice<T>::from(ForeignBoxedSlice<T>&& slice) noexcept {
+    return CForeignBoxedSlice(std::move(slice));
+}
+#endif
+
+template <typename T>
+inline ForeignBoxedSlice<T> CForeignBoxedSlice<T>::operator()() noexcept {
+    auto slice = ForeignBoxedSlice<T>(this->_data, this->_size, this->_drop_fn, this->_ctx);
+    this->_data = EMPTY_SLICE_BEGIN(T);
+    this->_size = 0;
+    this->_drop_fn = nullptr;
+    this->_ctx = nullptr;
+    return slice;
+}
+
+#if _MSC_VER
+inline CMmapSlice CMmapSlice::from(MmapSlice&& slice) noexcept {
+    CMmapSlice s;
+    s._data = slice._data;
+    s._size = slice._size;
+    slice._data = EMPTY_SLICE_BEGIN(uint8_t);
+    slice._size = 0;
+    return s;
+}
+#else
+inline CMmapSlice::CMmapSlice(MmapSlice&& slice) noexcept : _data(slice._data), _size(slice._size) {
+    slice._data = EMPTY_SLICE_BEGIN(uint8_t);
+    slice._size = 0;
+}
+
+inline CMmapSlice CMmapSlice::from(MmapSlice&& slice) noexcept {
+    return CMmapSlice(std::move(slice));
+}
+#endif
+
+inline MmapSlice CMmapSlice::operator()() noexcept {
+    auto slice = MmapSlice(nullptr);
+    slice._data = this->_data;
+    slice._size = this->_size;
+    this->_data = EMPTY_SLICE_BEGIN(uint8_t);
+    this->_size = 0;
+    return slice;
+}
+
+#if _MSC_VER
+constexpr CStrRef CStrRef::from(const StrRef& slice) noexcept {
+    CStrRef s{};
+    s._data = slice.data();
+    s._size = slice.size();
+    return s;
+}
+#else
+constexpr CStrRef::CStrRef(const StrRef& slice) noexcept : _data(slice.data()), _size(slice.size()) {}
+
+constexpr CStrRef CStrRef::from(const StrRef& slice) noexcept {
+    return CStrRef(slice);
+}
+#endif
+
+constexpr StrRef CStrRef::operator()() const noexcept {
+    return StrRef(StrRef::_Unchecked{}, this->_data, this->_size);
+}
+
+#if _MSC_VER
+inline CBoxedStr CBoxedStr::from(BoxedStr&& str) noexcept {
+    auto r = str._take();
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, r._size > 0, r._size);
+    CBoxedStr s;
+    s._data = r._data;
+    s._size = r._size;
+    return s;
+}
+#else
+inline CBoxedStr::CBoxedStr(BoxedStr&& str) noexcept {
+    auto r = str._take();
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, r._size > 0, r._size);
+    this->_data = r._data;
+    this->_size = r._size;
+}
+
+inline CBoxedStr CBoxedStr::from(BoxedStr&& slice) noexcept {
+    return CBoxedStr(std::move(slice));
+}
+#endif
+
+inline BoxedStr CBoxedStr::operator()() noexcept {
+    auto slice = BoxedStr(nullptr);
+    slice.reset(this->release());
+    return slice;
+}
+
+inline _SliceRange<const char> CBoxedStr::release() noexcept {
+    const auto range = _SliceRange<const char>{_data, _size};
+    this->_data = EMPTY_SLICE_BEGIN(const char);
+    this->_size = 0;
+    return range;
+}
+
+#if _MSC_VER
+inline CCompactStr CCompactStr::from(CompactStr&& str) noexcept {
+    CCompactStr s;
+    std::memcpy(&s, &str, sizeof(CCompactStr));
+    str._set_inline_size(0);
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, s._is_heap(), s._size);
+    return s;
+}
+#else
+inline CCompactStr::CCompactStr(CompactStr&& str) noexcept {
+    std::memcpy(static_cast<void*>(this), &str, sizeof(CCompactStr));
+    str._set_inline_size(0);
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, this->_is_heap(), this->_size);
+}
+
+inline CCompactStr CCompactStr::from(CompactStr&& str) noexcept {
+    return CCompactStr(std::move(str));
+}
+#endif
+
+inline CompactStr CCompactStr::operator()() noexcept {
+    auto str = CompactStr(nullptr);
+    std::memcpy(static_cast<void*>(&str), this, sizeof(CCompactStr));
+    instrument::_acquire(instrument::_Kind::boxed_str, this->_is_heap(), this->_size);
+    this->_size = CompactStr::_INLINE_TAG;
+    return str;
+}
+
+inline bool CCompactStr::_is_heap() const noexcept {
+    return (this->_size & CompactStr::_INLINE_TAG) == 0 && this->_size > 0;
+}
+
+#if _MSC_VER
+constexpr CStrZRef CStrZRef::from(const StrZRef& s) noexcept {
+    CStrZRef r{};
+    r._data = s.data();
+    r._size = s.size();
+    return r;
+}
+#else
+constexpr CStrZRef::CStrZRef(const StrZRef& s) noexcept : _data(s.data()), _size(s.size()) {}
+
+constexpr CStrZRef CStrZRef::from(const StrZRef& s) noexcept {
+    return CStrZRef(s);
+}
+#endif
+
+constexpr StrZRef CStrZRef::operator()() const noexcept {
+    return StrZRef(StrZRef::_Terminated{}, this->_data, this->_size);
+}
+
+#if _MSC_VER
+inline CBoxedCStr CBoxedCStr::from(BoxedCStr&& str) noexcept {
+    auto r = str._take();
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, r._size > 0, r._size);
+    CBoxedCStr s;
+    s._data = r._data;
+    s._size = r._size;
+    return s;
+}
+#else
+inline CBoxedCStr::CBoxedCStr(BoxedCStr&& str) noexcept {
+    auto r = str._take();
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, r._size > 0, r._size);
+    this->_data = r._data;
+    this->_size = r._size;
+}
+
+inline CBoxedCStr CBoxedCStr::from(BoxedCStr&& str) noexcept {
+    return CBoxedCStr(std::move(str));
+}
+#endif
+
+inline BoxedCStr CBoxedCStr::operator()() noexcept {
+    auto str = BoxedCStr(nullptr);
+    str.reset(this->release());
+    return str;
+}
+
+inline _SliceRange<const char> CBoxedCStr::release() noexcept {
+    const auto range = _SliceRange<const char>{_data, _size};
+    this->_data = "";
+    this->_size = 0;
+    return range;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CSliceSender<T> CSliceSender<T>::from(SliceSender<T>&& sender) noexcept {
+    CSliceSender s;
+    s._inner = sender.release();
+    return s;
+}
+#else
+template <typename T>
+inline CSliceSender<T>::CSliceSender(SliceSender<T>&& sender) noexcept : _inner(sender.release()) {}
+
+template <typename T>
+inline CSliceSender<T> CSliceSender<T>::from(SliceSender<T>&& sender) noexcept {
+    return CSliceSender(std::move(sender));
+}
+#endif
+
+template <typename T>
+inline SliceSender<T> CSliceSender<T>::operator()() noexcept {
+    auto* inner = this->_inner;
+    this->_inner = nullptr;
+    return SliceSender<T>(inner);
+}
+
+#if _MSC_VER
+template <typename T>
+inline CSliceReceiver<T> CSliceReceiver<T>::from(SliceReceiver<T>&& receiver) noexcept {
+    CSliceReceiver s;
+    s._inner = receiver.release();
+    return s;
+}
+#else
+template <typename T>
+inline CSliceReceiver<T>::CSliceReceiver(SliceReceiver<T>&& receiver) noexcept : _inner(receiver.release()) {}
+
+template <typename T>
+inline CSliceReceiver<T> CSliceReceiver<T>::from(SliceReceiver<T>&& receiver) noexcept {
+    return CSliceReceiver(std::move(receiver));
+}
+#endif
+
+template <typename T>
+inline SliceReceiver<T> CSliceReceiver<T>::operator()() noexcept {
+    auto* inner = this->_inner;
+    this->_inner = nullptr;
+    return SliceReceiver<T>(inner);
+}
+
+#if _MSC_VER
+inline CCowStr CCowStr::from(CowStr&& str) noexcept {
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, str.is_owned(), str.size());
+    CCowStr s;
+    s._data = str._data;
+    s._size = str._size;
+    str._reset_empty();
+    return s;
+}
+#else
+inline CCowStr::CCowStr(CowStr&& str) noexcept : _data(str._data), _size(str._size) {
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, str.is_owned(), str.size());
+    str._reset_empty();
+}
+
+inline CCowStr CCowStr::from(CowStr&& str) noexcept {
+    return CCowStr(std::move(str));
+}
+#endif
+
+inline CowStr CCowStr::operator()() noexcept {
+    auto str = CowStr(nullptr);
+    str._data = this->_data;
+    str._size = this->_size;
+    instrument::_acquire(instrument::_Kind::boxed_str, str.is_owned(), str.size());
+    this->_data = reinterpret_cast<const char*>(1);
+    this->_size = 0;
+    return str;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CCowSlice<T> CCowSlice<T>::from(CowSlice<T>&& slice) noexcept {
+    instrument::_give_up(instrument::_Kind::boxed_slice, instrument::_Event::into, slice.is_owned(),
+                         sizeof(T) * slice.size());
+    CCowSlice s;
+    s._data = slice._data;
+    s._size = slice._size;
+    slice._reset_empty();
+    return s;
+}
+#else
+template <typename T>
+inline CCowSlice<T>::CCowSlice(CowSlice<T>&& slice) noexcept : _data(slice._data), _size(slice._size) {
+    instrument::_give_up(instrument::_Kind::boxed_slice, instrument::_Event::into, slice.is_owned(),
+                         sizeof(T) * slice.size());
+    slice._reset_empty();
+}
+
+template <typename T>
+inline CCowSlice<T> CCowSlice<T>::from(CowSlice<T>&& slice) noexcept {
+    return CCowSlice(std::move(slice));
+}
+#endif
+
+template <typename T>
+inline CowSlice<T> CCowSlice<T>::operator()() noexcept {
+    auto slice = CowSlice<T>(nullptr);
+    slice._data = this->_data;
+    slice._size = this->_size;
+    instrument::_acquire(instrument::_Kind::boxed_slice, slice.is_owned(), sizeof(T) * slice.size());
+    this->_data = reinterpret_cast<const T*>(alignof(T));
+    this->_size = 0;
+    return slice;
+}
+
+#if _MSC_VER
+inline CArena CArena::from(Arena&& arena) noexcept {
+    CArena a;
+    a._inner = arena._inner;
+    arena._inner = nullptr;
+    return a;
+}
+#else
+inline CArena::CArena(Arena&& arena) noexcept : _inner(arena._inner) {
+    arena._inner = nullptr;
+}
+
+inline CArena CArena::from(Arena&& arena) noexcept {
+    return CArena(std::move(arena));
+}
+#endif
+
+inline Arena CArena::operator()() noexcept {
+    auto arena = Arena(nullptr);
+    arena._inner = this->_inner;
+    this->_inner = nullptr;
+    return arena;
+}
+
+#if _MSC_VER
+template <typename T>
+inline COption<T> COption<T>::from(T&& value) noexcept {
+    COption o;
+    o._value = std::move(value);
+    return o;
+}
+
+template <typename T>
+inline COption<T> COption<T>::none() noexcept {
+    COption o;
+    o._niche = nullptr;
+    return o;
+}
+#else
+template <typename T>
+inline COption<T>::COption(T&& value) noexcept : _value(std::move(value)) {}
+
+template <typename T>
+inline COption<T>::COption(std::nullptr_t) noexcept : _niche(nullptr) {}
+
+template <typename T>
+inline COption<T> COption<T>::from(T&& value) noexcept {
+    return COption(std::move(value));
+}
+
+template <typename T>
+inline COption<T> COption<T>::none() noexcept {
+    return COption(nullptr);
+}
+#endif
+
+template <typename T>
+inline bool COption<T>::is_some() const noexcept {
+    const void* data;
+    std::memcpy(&data, this, sizeof(data));
+    return data != nullptr;
+}
+
+template <typename T>
+inline T& COption<T>::unwrap() noexcept {
+    assert(this->is_some());
+    return this->_value;
+}
+
+// The return type is deduced for the forward declaration header not to include `<optional>`.
+template <typename T>
+inline auto COption<T>::operator()() noexcept {
+    auto owned = std::optional<typename _Owned<T>::type>();
+    if (this->is_some()) {
+        owned.emplace(_Owned<T>::take(this->_value));
+        this->_niche = nullptr;
+    }
+    return owned;
+}
+
+#if _MSC_VER
+template <typename T, typename E>
+inline CResult<T, E> CResult<T, E>::ok(T&& value) noexcept {
+    CResult r;
+    r._tag = Tag::Ok;
+    r._ok = std::move(value);
+    return r;
+}
+
+template <typename T, typename E>
+inline CResult<T, E> CResult<T, E>::err(E&& error) noexcept {
+    CResult r;
+    r._tag = Tag::Err;
+    r._err = std::move(error);
+    return r;
+}
+#else
+template <typename T, typename E>
+inline CResult<T, E> CResult<T, E>::ok(T&& value) noexcept {
+    return CResult(Tag::Ok, std::move(value));
+}
+
+template <typename T, typename E>
+inline CResult<T, E> CResult<T, E>::err(E&& error) noexcept {
+    return CResult(std::move(error));
+}
+
+template <typename T, typename E>
+inline CResult<T, E>::CResult(Tag tag, T&& value) noexcept : _tag(tag), _ok(std::move(value)) {}
+
+template <typename T, typename E>
+inline CResult<T, E>::CResult(E&& error) noexcept : _tag(Tag::Err), _err(std::move(error)) {}
+#endif
+
+template <typename T, typename E>
+inline T& CResult<T, E>::unwrap() noexcept {
+    assert(this->is_ok());
+    return this->_ok;
+}
+
+template <typename T, typename E>
+inline E& CResult<T, E>::unwrap_err() noexcept {
+    assert(this->is_err());
+    return this->_err;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CRustFuture<T> CRustFuture<T>::from(RustFuture<T>&& future) noexcept {
+    CRustFuture f;
+    f._state = future._state;
+    f._vtable = future._vtable;
+    future._reset_empty();
+    return f;
+}
+#else
+template <typename T>
+inline CRustFuture<T>::CRustFuture(RustFuture<T>&& future) noexcept : _state(future._state), _vtable(future._vtable) {
+    future._reset_empty();
+}
+
+template <typename T>
+inline CRustFuture<T> CRustFuture<T>::from(RustFuture<T>&& future) noexcept {
+    return CRustFuture(std::move(future));
+}
+#endif
+
+template <typename T>
+inline RustFuture<T> CRustFuture<T>::operator()() noexcept {
+    auto future = RustFuture<T>(this->_state, this->_vtable);
+    this->_state = nullptr;
+    this->_vtable = nullptr;
+    return future;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CRustIter<T> CRustIter<T>::from(RustIter<T>&& iter) noexcept {
+    CRustIter it;
+    it._state = iter._state;
+    it._vtable = iter._vtable;
+    iter._reset_empty();
+    return it;
+}
+#else
+template <typename T>
+inline CRustIter<T>::CRustIter(RustIter<T>&& iter) noexcept : _state(iter._state), _vtable(iter._vtable) {
+    iter._reset_empty();
+}
+
+template <typename T>
+inline CRustIter<T> CRustIter<T>::from(RustIter<T>&& iter) noexcept {
+    return CRustIter(std::move(iter));
+}
+#endif
+
+template <typename T>
+inline RustIter<T> CRustIter<T>::operator()() noexcept {
+    auto iter = RustIter<T>(this->_state, this->_vtable);
+    this->_state = nullptr;
+    this->_vtable = nullptr;
+    return iter;
+}
+
+#if FFI_TYPES_INLINE_DEALLOC
+// The layout is known at compile time, so the drop is a single call to the Rust global allocator.
+// Deferred reclamation of `reclaim::DeferredScope` doesn't apply to these drops.
+
+inline void BoxedStr::_drop() noexcept {
+    auto s = this->release();
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(const_cast<char*>(s._data)), s._size, 1);
+}
+
+inline void BoxedCStr::_drop() noexcept {
+    auto s = this->release();
+    // the terminator is a part of the allocation of `Box<CStr>`
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(const_cast<char*>(s._data)), s._size + 1, 1);
+}
+
+template <typename T>
+inline void BoxedSlice<T>::_drop() noexcept {
+    static_assert(std::is_trivially_destructible<T>::value, "specialize _drop() to drop the elements in Rust side");
+    auto s = this->release();
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(s._data), sizeof(T) * s._size, alignof(T));
+}
+#else
 inline void BoxedStr::_drop() noexcept {
     ffi_types::_rust_ffi_boxed_str_drop(CBoxedStr::from(std::move(*this)));
 }
 
+inline void BoxedCStr::_drop() noexcept {
+    ffi_types::_rust_ffi_boxed_c_str_drop(CBoxedCStr::from(std::move(*this)));
+}
+
 template <>
 inline void BoxedSlice<uint8_t>::_drop() noexcept {
     ffi_types::_rust_ffi_boxed_bytes_drop(CBoxedSlice<uint8_t>::from(std::move(*this)));
 }
+#endif
+
+inline void BoxedStr::_drop_many(MutSliceRef<BoxedStr> items) noexcept {
+    if (items.empty()) {
+        return;
+    }
+    auto strings = MutSliceRef<CBoxedStr>(reinterpret_cast<CBoxedStr*>(items.data()), items.size());
+    ffi_types::_rust_ffi_boxed_str_drop_many(strings.into());
+    for (auto& item : items) {
+        instrument::_dropped(instrument::_Kind::boxed_str, item._size > 0, item._size);
+        item._take();
+    }
+}
+
+template <>
+inline void BoxedSlice<uint8_t>::_drop_many(MutSliceRef<BoxedSlice<uint8_t>> items) noexcept {
+    if (items.empty()) {
+        return;
+    }
+    auto slices =
+            MutSliceRef<CBoxedSlice<uint8_t>>(reinterpret_cast<CBoxedSlice<uint8_t>*>(items.data()), items.size());
+    ffi_types::_rust_ffi_boxed_bytes_drop_many(slices.into());
+    for (auto& item : items) {
+        instrument::_dropped(instrument::_Kind::boxed_slice, item._size > 0, item._size);
+        item._take();
+    }
+}
+
+template <>
+inline void SliceSender<uint8_t>::_drop() noexcept {
+    ffi_types::_rust_ffi_byte_sender_drop(CSliceSender<uint8_t>::from(std::move(*this)));
+}
+
+template <>
+inline void SliceReceiver<uint8_t>::_drop() noexcept {
+    ffi_types::_rust_ffi_byte_receiver_drop(CSliceReceiver<uint8_t>::from(std::move(*this)));
+}
+
+/// Creates a lock-free single-producer single-consumer channel of byte slices
+/// holding up to `capacity` slices in flight. The capacity is rounded up to a power of two.
+inline std::pair<SliceSender<uint8_t>, SliceReceiver<uint8_t>> byte_channel(usize capacity) noexcept {
+    auto sender = CSliceSender<uint8_t>::from(SliceSender<uint8_t>(nullptr));
+    auto receiver = CSliceReceiver<uint8_t>::from(SliceReceiver<uint8_t>(nullptr));
+    ffi_types::_rust_ffi_byte_channel_new(capacity, &sender, &receiver);
+    return {sender(), receiver()};
+}
+
+inline Symbol Symbol::intern(const StrRef& s) noexcept {
+    return ffi_types::_rust_ffi_intern(CStrRef::from(s));
+}
+
+inline void Symbol::intern_all(SliceRef<CStrRef> strs, MutSliceRef<Symbol> out) noexcept {
+    assert(strs.size() == out.size());
+    ffi_types::_rust_ffi_intern_all(CSliceRef<CStrRef>::from(strs), CMutSliceRef<Symbol>::from(out));
+}
+
+inline StrRef Symbol::str() const noexcept {
+    static const SymbolTable* const table = ffi_types::_rust_ffi_symbol_table();
+    const auto block = static_cast<uint32_t>(this->_id / SymbolTable::FIRST_SEGMENT + 1);
+    const auto segment = _str::_highest_bit(block);
+    const auto offset = this->_id - SymbolTable::FIRST_SEGMENT * ((usize(1) << segment) - 1);
+    // A symbol is created only after its segment is published.
+    return table->segments[segment].load(std::memory_order_acquire)[offset]();
+}
+
+inline void Arena::_drop() noexcept {
+    ffi_types::_rust_ffi_arena_drop(CArena::from(std::move(*this)));
+}
+
+inline Arena Arena::create(usize chunk_size) noexcept {
+    return ffi_types::_rust_ffi_arena_new(chunk_size)();
+}
+
+inline uint8_t* Arena::_alloc_slow(usize size, usize align) noexcept {
+    return ffi_types::_rust_ffi_arena_alloc(&this->as_c(), size, align);
+}
+
+inline void Arena::reset() noexcept {
+    ffi_types::_rust_ffi_arena_reset(&this->as_c());
+}
+
+namespace reclaim {
+
+/// Defers drops of boxed values in the current thread while the scope is alive.
+///
+/// Values dropped by Rust drop functions, e.g. `BoxedStr::_drop()` or `BoxedSlice<uint8_t>::_drop()`,
+/// are pushed to a lock-free queue and deallocated by a reclaimer thread in Rust side.
+class DeferredScope {
+public:
+    DeferredScope() noexcept : _previous(ffi_types::_rust_ffi_reclaim_set_deferred(true)) {}
+    DeferredScope(const DeferredScope&) = delete;
+    DeferredScope& operator=(const DeferredScope&) = delete;
+    ~DeferredScope() noexcept {
+        ffi_types::_rust_ffi_reclaim_set_deferred(this->_previous);
+    }
+
+private:
+    bool _previous;
+};
+
+/// Drops every deferred value before returning.
+inline void flush() noexcept {
+    ffi_types::_rust_ffi_reclaim_flush();
+}
+
+/// Returns the number of values deferred but not dropped yet.
+inline usize pending() noexcept {
+    return ffi_types::_rust_ffi_reclaim_pending();
+}
+
+/// Returns the number of values ever deferred in any thread.
+inline usize deferred_count() noexcept {
+    return ffi_types::_rust_ffi_reclaim_deferred_count();
+}
+
+}  // namespace reclaim
+
+namespace pool {
+
+/// Sets the maximum bytes kept by each size class of each thread. Zero disables buffer pools.
+/// Returns the previous limit.
+inline usize set_limit(usize bytes_per_class) noexcept {
+    return ffi_types::_rust_ffi_pool_set_limit(bytes_per_class);
+}
+
+/// Returns the counters of the buffer pool of the current thread.
+inline PoolStats thread_stats() noexcept {
+    return ffi_types::_rust_ffi_pool_thread_stats();
+}
+
+/// Frees every buffer in the buffer pool of the current thread.
+inline void clear() noexcept {
+    ffi_types::_rust_ffi_pool_clear();
+}
+
+}  // namespace pool
+
+#if FFI_TYPES_INSTRUMENT
+namespace instrument {
+
+inline OwnershipShard& _thread_shard() noexcept {
+    if (!_shard) {
+        // Atomic counters are written through the shared reference as in Rust side.
+        _shard = const_cast<OwnershipShard*>(ffi_types::_rust_ffi_instrument_thread_shard());
+    }
+    return *_shard;
+}
+
+inline OwnershipSnapshot snapshot() noexcept {
+    return ffi_types::_rust_ffi_instrument_snapshot();
+}
+
+}  // namespace instrument
+#endif
+
+template <>
+template <>
+inline BoxedSlice<uint8_t> BoxedSlice<uint8_t>::from_pool<uint8_t>(usize size) noexcept {
+    return ffi_types::_rust_ffi_pool_alloc(size)();
+}
+
+template <typename T>
+inline BoxedSlice<T> BoxedSlice<T>::with_capacity_uninit(usize size) noexcept {
+    auto slice = BoxedSlice<T>(nullptr);
+    slice.resize_uninit(size);
+    return slice;
+}
+
+template <typename T>
+inline void BoxedSlice<T>::resize_uninit(usize size) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "elements are moved by realloc");
+    assert(size <= SIZE_MAX / sizeof(T));
+    if (size == this->_size) {
+        return;
+    }
+    // realloc ignores the dangling pointer of an empty slice
+    auto* data = ffi_types::_rust_ffi_realloc(
+            reinterpret_cast<uint8_t*>(this->_data), sizeof(T) * this->_size, alignof(T), sizeof(T) * size);
+    instrument::_resize(instrument::_Kind::boxed_slice, sizeof(T) * this->_size, sizeof(T) * size);
+    this->_data = size > 0 ? reinterpret_cast<T*>(data) : reinterpret_cast<T*>(1);
+    this->_size = size;
+}
+
+#if FFI_TYPES_INLINE_DEALLOC
+template <typename T>
+inline void Vec<T>::_drop() noexcept {
+    static_assert(std::is_trivially_destructible<T>::value, "specialize _drop() to drop the elements in Rust side");
+    auto v = CVec<T>::from(std::move(*this));
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(v._data), sizeof(T) * v._capacity, alignof(T));
+}
+#else
+template <>
+inline void Vec<uint8_t>::_drop() noexcept {
+    ffi_types::_rust_ffi_vec_bytes_drop(CVec<uint8_t>::from(std::move(*this)));
+}
+#endif
+
+template <typename T>
+inline void Vec<T>::reserve(usize additional) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "elements are moved by realloc");
+    if (this->_capacity - this->_size < additional) {
+        ffi_types::_rust_ffi_vec_reserve(reinterpret_cast<CVec<uint8_t>*>(this), additional, sizeof(T), alignof(T));
+    }
+}
+
+inline std::optional<BoxedStr> BoxedStr::from_utf8_copy(CharStrRef s) noexcept {
+    if (!s.is_utf8()) {
+        return std::nullopt;
+    }
+    // the layout of `Box<str>`
+    auto* data = ffi_types::_rust_ffi_alloc(s.size(), 1);
+    if (!s.empty()) {
+        std::memcpy(data, s.data(), s.size());
+    }
+    auto str = BoxedStr(nullptr);
+    str.reset({reinterpret_cast<const char*>(data), s.size()});
+    return std::optional<BoxedStr>(std::move(str));
+}
+
+inline BoxedStr CowStr::to_owned() const noexcept {
+    // the layout of `Box<str>`
+    auto* data = ffi_types::_rust_ffi_alloc(this->size(), 1);
+    if (!this->empty()) {
+        std::memcpy(data, this->_data, this->size());
+    }
+    auto str = BoxedStr(nullptr);
+    str.reset({reinterpret_cast<const char*>(data), this->size()});
+    return str;
+}
+
+inline std::optional<BoxedCStr> BoxedCStr::from_copy(CharStrRef s) noexcept {
+    if (s.empty()) {
+        return std::optional<BoxedCStr>(BoxedCStr(nullptr));
+    }
+    if (std::memchr(s.data(), 0, s.size()) != nullptr) {
+        return std::nullopt;
+    }
+    // the layout of `Box<CStr>`
+    auto* data = ffi_types::_rust_ffi_alloc(s.size() + 1, 1);
+    std::memcpy(data, s.data(), s.size());
+    data[s.size()] = 0;
+    auto str = BoxedCStr(nullptr);
+    str.reset({reinterpret_cast<const char*>(data), s.size()});
+    return std::optional<BoxedCStr>(std::move(str));
+}
+
+inline void CompactStr::_drop() noexcept {
+    // A heap string is a `BoxedStr`.
+    auto boxed = BoxedStr(nullptr);
+    boxed._reset({this->_data, this->_size});
+    this->_set_inline_size(0);
+    boxed._drop();
+}
+
+inline std::optional<CompactStr> CompactStr::from_utf8_copy(CharStrRef s) noexcept {
+    if (s.size() > inline_capacity) {
+        auto boxed = BoxedStr::from_utf8_copy(s);
+        if (!boxed) {
+            return std::nullopt;
+        }
+        return std::optional<CompactStr>(CompactStr(std::move(*boxed)));
+    }
+    if (!s.is_utf8()) {
+        return std::nullopt;
+    }
+    auto str = CompactStr(nullptr);
+    if (!s.empty()) {
+        std::memcpy(static_cast<void*>(&str), s.data(), s.size());
+    }
+    str._set_inline_size(s.size());
+    return std::optional<CompactStr>(std::move(str));
+}
+
+inline void MmapSlice::_drop() noexcept {
+    ffi_types::_rust_ffi_mmap_drop(CMmapSlice::from(std::move(*this)));
+}
+
+inline std::optional<MmapSlice> MmapSlice::open(CharStrRef path, int32_t* error) noexcept {
+    CMmapSlice c = CMmapSlice::from(MmapSlice(nullptr));
+    const auto result = ffi_types::_rust_ffi_mmap_open(path, &c);
+    if (error) {
+        *error = result;
+    }
+    if (result != 0) {
+        return std::nullopt;
+    }
+    return std::optional<MmapSlice>(c());
+}
+
+inline int32_t MmapSlice::advise(usize offset, usize size, MmapAdvice advice) const noexcept {
+    assert(offset <= this->_size && size <= this->_size - offset);
+    return ffi_types::_rust_ffi_mmap_advise(SliceRef<uint8_t>(this->_data + offset, size).into(), advice);
+}
 
 }  // namespace ffi_types
\ No newline at end of file
@@ -1,5 +1,7 @@
 
 #undef _COPY_DELETE
+#undef _STR_COMPARISONS
+#undef EMPTY_SLICE_BEGIN
 
 namespace rust {
 using namespace ffi_types;
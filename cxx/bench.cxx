@@ -0,0 +1,258 @@
+//! Micro benchmarks for the C++ side of `ffi_types`.
+//!
+//! This file is compiled by `build.rs` with `__build_header` feature to ensure it builds.
+//! To run it, link it with the crate:
+//! ```sh
+//! cargo build --release
+//! c++ -O2 -std=c++17 -Iinclude cxx/bench.cxx target/release/libffi_types.a -lpthread -ldl -o bench && ./bench
+//! ```
+//! `algorithm/*` compares std algorithms on slice iterators with `memchr()` and `memmove()`.
+//! Note that libstdc++ lowers `std::copy()` but not `std::find()`. `string_view::find()` calls `memchr()`.
+//! Build with `-DFFI_TYPES_POINTER_ITERATOR=1` or a debug standard library, e.g. `-D_GLIBCXX_DEBUG`, to compare.
+
+#include "0fwd.hxx"
+#include "0header.hxx"
+#include "0instrument.hxx"
+#include "1boxed.hxx"
+#include "2slice.hxx"
+#include "3channel.hxx"
+#include "3cow.hxx"
+#include "3interner.hxx"
+#include "4arena.hxx"
+#include "5option.hxx"
+#include "6future.hxx"
+#include "6iter.hxx"
+#include "7rust_impl.hxx"
+#include "8cxx_impl.hxx"
+#include "9footer.hxx"
+
+#include <chrono>
+#include <cstdio>
+
+#if _MSC_VER
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+extern "C" {
+NOINLINE ffi_types::CSliceRef<uint8_t> bench_signature_c_slice_ref(ffi_types::CSliceRef<uint8_t> c) {
+    return c;
+}
+NOINLINE ffi_types::CBoxedSlice<uint8_t> bench_signature_c_boxed_slice(ffi_types::CBoxedSlice<uint8_t> c) {
+    return c;
+}
+NOINLINE ffi_types::CStrRef bench_signature_c_str_ref(ffi_types::CStrRef c) {
+    return c;
+}
+}
+
+namespace {
+
+using ffi_types::usize;
+
+/// Prevents the compiler from optimizing away `value`.
+template <typename T>
+void do_not_optimize(const T& value) {
+#if _MSC_VER
+    static volatile const T* sink;
+    sink = &value;
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+/// Runs `f` repeatedly for about 100ms and prints the throughput of `bytes` per call.
+template <typename F>
+void bench(const char* name, usize bytes, F&& f) {
+    using clock = std::chrono::steady_clock;
+    const auto budget = std::chrono::milliseconds(100);
+    usize iterations = 0;
+    const auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+    do {
+        for (int i = 0; i < 16; ++i) {
+            f();
+        }
+        iterations += 16;
+        elapsed = clock::now() - start;
+    } while (elapsed < budget);
+
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    const double gbps = bytes > 0 ? bytes / ns : 0.0;
+    std::printf("%-40s %10zu B %12.1f ns %8.2f GB/s\n", name, static_cast<size_t>(bytes), ns, gbps);
+}
+
+const usize SIZES[] = {0, 16, 256, 4096, 65536, 1 << 20, 16 << 20};
+
+std::string make_text(usize size, bool ascii) {
+    std::string text;
+    text.reserve(size + 4);
+    while (text.size() < size) {
+        if (ascii || text.size() % 64 != 0) {
+            text.push_back('a' + text.size() % 26);
+        } else {
+            text.append("\xea\xb0\x80");  // U+AC00
+        }
+    }
+    text.resize(size);
+    // keep the last character complete
+    while (!text.empty() && !ffi_types::CharStrRef(text).is_utf8()) {
+        text.back() = 'z';
+    }
+    return text;
+}
+
+void bench_utf8() {
+    for (bool ascii : {true, false}) {
+        for (usize size : SIZES) {
+            const auto text = make_text(size, ascii);
+            const auto str = ffi_types::CharStrRef(text);
+            bench(ascii ? "utf8/ascii/cxx" : "utf8/mixed/cxx", size, [&] { do_not_optimize(str.is_utf8()); });
+            bench(ascii ? "utf8/ascii/rust" : "utf8/mixed/rust", size, [&] {
+                do_not_optimize(ffi_types::_rust_ffi_utf8_validate(str));
+            });
+        }
+    }
+}
+
+void bench_conversion() {
+    auto boxed = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(64);
+    bench("conversion/boxed_slice/round_trip", 0, [&] {
+        auto c = boxed.into();
+        do_not_optimize(c._data);
+        boxed = c();
+    });
+    auto str = ffi_types::BoxedStr::from_utf8_copy("hello").value();
+    bench("conversion/boxed_str/round_trip", 0, [&] {
+        auto c = ffi_types::CBoxedStr::from(std::move(str));
+        do_not_optimize(c._data);
+        str = c();
+    });
+    const uint8_t data[64] = {};
+    const auto slice = ffi_types::SliceRef<uint8_t>(data, 64);
+    bench("conversion/slice_ref/round_trip", 0, [&] {
+        auto c = ffi_types::CSliceRef<uint8_t>::from(slice);
+        do_not_optimize(c._data);
+        do_not_optimize(c().size());
+    });
+}
+
+void bench_signature() {
+    const uint8_t data[64] = {};
+    auto slice = ffi_types::CSliceRef<uint8_t>::from(ffi_types::SliceRef<uint8_t>(data, 64));
+    bench("signature/c_slice_ref", 0, [&] {
+        slice = bench_signature_c_slice_ref(slice);
+        do_not_optimize(slice._data);
+    });
+    auto boxed = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(64);
+    bench("signature/c_boxed_slice", 0, [&] {
+        boxed = bench_signature_c_boxed_slice(boxed.into())();
+        do_not_optimize(boxed._data);
+    });
+    auto str = ffi_types::CStrRef::from(ffi_types::CharStrRef("hello").as_str_unchecked());
+    bench("signature/c_str_ref", 0, [&] {
+        str = bench_signature_c_str_ref(str);
+        do_not_optimize(str._data);
+    });
+}
+
+void bench_drop() {
+    for (usize size : SIZES) {
+        if (size > (1 << 20)) {
+            break;
+        }
+        bench("drop/boxed_bytes/alloc_and_drop", size, [&] {
+            auto bytes = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(size);
+            do_not_optimize(bytes._data);
+        });
+    }
+
+    constexpr usize count = 1024;
+    auto slices = std::vector<ffi_types::BoxedSlice<uint8_t>>();
+    slices.reserve(count);
+    bench("drop/boxed_bytes/each x1024", 0, [&] {
+        for (usize i = 0; i < count; ++i) {
+            slices.push_back(ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(64));
+        }
+        slices.clear();
+    });
+    bench("drop/boxed_bytes/drop_all x1024", 0, [&] {
+        for (usize i = 0; i < count; ++i) {
+            slices.push_back(ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(64));
+        }
+        ffi_types::drop_all(slices);
+        slices.clear();
+    });
+    const auto previous = ffi_types::pool::set_limit(1 << 20);
+    for (usize size : {usize(4096), usize(65536)}) {
+        bench("drop/boxed_bytes/from_pool_and_drop", size, [&] {
+            auto bytes = ffi_types::BoxedSlice<uint8_t>::from_pool(size);
+            do_not_optimize(bytes._data);
+        });
+    }
+    ffi_types::pool::clear();
+    ffi_types::pool::set_limit(previous);
+
+    auto arena = ffi_types::Arena::create();
+    bench("drop/arena_bytes/reset x1024", 0, [&] {
+        for (usize i = 0; i < count; ++i) {
+            do_not_optimize(arena.alloc_slice_uninit<uint8_t>(64).data());
+        }
+        arena.reset();
+    });
+}
+
+void bench_algorithm() {
+    for (usize size : SIZES) {
+        auto source = std::vector<uint8_t>(size, 'a');
+        auto target = std::vector<uint8_t>(size);
+        const auto slice = ffi_types::SliceRef<uint8_t>(source);
+        const auto str = ffi_types::CharStrRef(reinterpret_cast<const char*>(source.data()), size);
+        bench("algorithm/find/slice_ref", size, [&] {
+            do_not_optimize(std::find(slice.begin(), slice.end(), 'b'));
+        });
+        bench("algorithm/find/char_str_ref", size, [&] { do_not_optimize(std::find(str.begin(), str.end(), 'b')); });
+        bench("algorithm/find/string_view", size, [&] { do_not_optimize(str.view().find('b')); });
+        bench("algorithm/find/memchr", size, [&] { do_not_optimize(std::memchr(source.data(), 'b', size)); });
+        bench("algorithm/copy/slice_ref", size, [&] {
+            do_not_optimize(std::copy(slice.begin(), slice.end(), target.data()));
+        });
+        bench("algorithm/copy/memmove", size, [&] {
+            if (size > 0) {
+                do_not_optimize(std::memmove(target.data(), source.data(), size));
+            }
+        });
+    }
+}
+
+void bench_str() {
+    for (usize size : SIZES) {
+        const auto text = make_text(size, true);
+        const auto str = ffi_types::CharStrRef(text);
+        const auto upper = [&] {
+            auto s = text;
+            std::transform(s.begin(), s.end(), s.begin(), [](char c) { return c & ~0x20; });
+            return s;
+        }();
+        bench("str/find_needle/char_str_ref", size, [&] { do_not_optimize(str.find("needle")); });
+        bench("str/find_needle/string_view", size, [&] { do_not_optimize(str.view().find("needle")); });
+        bench("str/rfind_needle/char_str_ref", size, [&] { do_not_optimize(str.rfind("needle")); });
+        bench("str/rfind_needle/string_view", size, [&] { do_not_optimize(str.view().rfind("needle")); });
+        bench("str/eq_ignore_ascii_case", size, [&] {
+            do_not_optimize(str.eq_ignore_ascii_case(ffi_types::CharStrRef(upper)));
+        });
+    }
+}
+
+}  // namespace
+
+int main() {
+    bench_conversion();
+    bench_signature();
+    bench_drop();
+    bench_utf8();
+    bench_algorithm();
+    bench_str();
+    return 0;
+}
@@ -0,0 +1,19 @@
+// Compiles the generated `include/rust_types_fwd.hxx` alone, as a generated FFI header includes it,
+// and `include/rust_types.hxx` after it.
+#include "../include/rust_types_fwd.hxx"
+
+// C-prefixed types are complete as fields by value.
+struct FwdRecord {
+    ffi_types::CBoxedStr name;
+    ffi_types::COption<ffi_types::CBoxedSlice<uint8_t>> payload;
+    ffi_types::CResult<ffi_types::CVec<uint32_t>, int32_t> values;
+};
+static_assert(sizeof(FwdRecord) == 8 * sizeof(ffi_types::usize));
+
+extern "C" FwdRecord fwd_record_new(ffi_types::CStrRef name);
+
+#include "../include/rust_types.hxx"
+
+ffi_types::BoxedStr fwd_record_name(FwdRecord& record) {
+    return record.name();
+}
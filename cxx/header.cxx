@@ -0,0 +1,5 @@
+// Compiles the generated `include/rust_types.hxx` alone.
+// `test.cxx` includes the parts one by one, so it doesn't catch errors made by concatenating them.
+// The second inclusion checks the include guard.
+#include "../include/rust_types.hxx"
+#include "../include/rust_types.hxx"
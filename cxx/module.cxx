@@ -0,0 +1,27 @@
+// Imports the module of `include/rust_types.cppm`, which must be built before.
+// Names used here must be found through the module only, so no header of this crate is included.
+#include <cstdint>
+#include <functional>
+
+import ffi_types;
+
+using namespace ffi_types::literals;
+
+ffi_types::CBoxedStr module_pass_through(ffi_types::CBoxedStr s) {
+    return s;
+}
+
+bool module_import(ffi_types::CBoxedSlice<uint8_t> c) {
+    const ffi_types::usize size = c._size;
+    auto bytes = c();
+    auto key = "key"_rs;
+    auto symbol = ffi_types::Symbol::intern(key);
+    auto hash = std::hash<ffi_types::StrRef>{}(key) ^ ffi_types::hash_bytes(bytes.data(), bytes.size());
+    auto arena = ffi_types::Arena::create();
+    auto values = arena.alloc_slice_uninit<uint64_t>(1);
+    values[0] = hash;
+    for (auto chunk : bytes.chunks(2)) {
+        values[0] += chunk.front();
+    }
+    return symbol.str() == key && bytes.size() == size && values[0] != ffi_types::pool::thread_stats().hits;
+}
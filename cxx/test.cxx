@@ -1,19 +1,58 @@
+#include "0fwd.hxx"
 #include "0header.hxx"
+#include "0instrument.hxx"
 #include "1boxed.hxx"
 #include "2slice.hxx"
+#include "3channel.hxx"
+#include "3cow.hxx"
+#include "3interner.hxx"
+#include "4arena.hxx"
+#include "5option.hxx"
+#include "6future.hxx"
+#include "6iter.hxx"
 #include "7rust_impl.hxx"
 #include "8cxx_impl.hxx"
 #include "9footer.hxx"
 
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#if __unix__ || __APPLE__
+#include <unistd.h>
+#endif
+
 void ffi_types::_rust_ffi_boxed_str_drop(ffi_types::CBoxedStr) {}
 
+// Rust side of the tests, built by `__test` feature
+namespace ffi_types {
+extern "C" {
+void _rust_ffi_test_byte_producer(CSliceSender<uint8_t> sender, uintptr_t count);
+CRustIter<uint64_t> _rust_ffi_test_iter_squares(uint64_t count);
+uintptr_t _rust_ffi_test_iter_squares_drops();
+}
+}  // namespace ffi_types
+
 template struct ffi_types::CBox<char>;
 template <>
 void ffi_types::OptionBox<char>::_drop() noexcept {}
 
+template struct ffi_types::CArc<int>;
+static int arc_dropped = 0;
+template <>
+void ffi_types::Arc<int>::_drop() noexcept {
+    arc_dropped += 1;
+    this->release();
+}
+
 template struct ffi_types::CMutSliceRef<char>;
 template struct ffi_types::CSliceRef<char>;
 template struct ffi_types::CBoxedSlice<char>;
+template struct ffi_types::CVec<char>;
+template struct ffi_types::CForeignBoxedSlice<char>;
 template <>
 void ffi_types::BoxedSlice<char>::_drop() noexcept {}
 
@@ -21,6 +60,9 @@ extern "C" {
 ffi_types::CBox<char> signature_c_box(ffi_types::CBox<char> c) {
     return c;
 }
+ffi_types::CArc<int> signature_c_arc(ffi_types::CArc<int> c) {
+    return c;
+}
 ffi_types::CMutSliceRef<char> signature_c_mut_slice_ref(ffi_types::CMutSliceRef<char> c) {
     return c;
 }
@@ -30,6 +72,24 @@ ffi_types::CSliceRef<char> signature_c_slice_ref(ffi_types::CSliceRef<char> c) {
 ffi_types::CBoxedSlice<char> signature_c_boxed_slice(ffi_types::CBoxedSlice<char> c) {
     return c;
 }
+ffi_types::CVec<char> signature_c_vec(ffi_types::CVec<char> c) {
+    return c;
+}
+ffi_types::CForeignBoxedSlice<char> signature_c_foreign_boxed_slice(ffi_types::CForeignBoxedSlice<char> c) {
+    return c;
+}
+ffi_types::CMmapSlice signature_c_mmap_slice(ffi_types::CMmapSlice c) {
+    return c;
+}
+ffi_types::CSliceSender<char> signature_c_slice_sender(ffi_types::CSliceSender<char> c) {
+    return c;
+}
+ffi_types::CSliceReceiver<char> signature_c_slice_receiver(ffi_types::CSliceReceiver<char> c) {
+    return c;
+}
+ffi_types::CArena signature_c_arena(ffi_types::CArena c) {
+    return c;
+}
 ffi_types::CByteSliceRef signature_byte_slice_ref(ffi_types::CByteSliceRef c) {
     return c;
 }
@@ -39,10 +99,83 @@ ffi_types::CStrRef signature_c_str_ref(ffi_types::CStrRef c) {
 ffi_types::CBoxedStr signature_c_boxed_str(ffi_types::CBoxedStr c) {
     return c;
 }
+ffi_types::CStrZRef signature_c_str_z_ref(ffi_types::CStrZRef c) {
+    return c;
+}
+ffi_types::CBoxedCStr signature_c_boxed_c_str(ffi_types::CBoxedCStr c) {
+    return c;
+}
+ffi_types::CCowStr signature_c_cow_str(ffi_types::CCowStr c) {
+    return c;
+}
+ffi_types::CCowSlice<uint32_t> signature_c_cow_slice(ffi_types::CCowSlice<uint32_t> c) {
+    return c;
+}
+ffi_types::CCompactStr signature_c_compact_str(ffi_types::CCompactStr c) {
+    return c;
+}
 ffi_types::CharStrRef signature_char_str_ref(ffi_types::CharStrRef c) {
     return c;
 }
+ffi_types::COption<ffi_types::CBoxedSlice<char>> signature_c_option_boxed_slice(
+        ffi_types::COption<ffi_types::CBoxedSlice<char>> c) {
+    return c;
 }
+ffi_types::COption<ffi_types::CStrRef> signature_c_option_str_ref(ffi_types::COption<ffi_types::CStrRef> c) {
+    return c;
+}
+ffi_types::CResult<uint32_t, int32_t> signature_c_result_u32(ffi_types::CResult<uint32_t, int32_t> c) {
+    return c;
+}
+ffi_types::CRustIter<uint32_t> signature_c_rust_iter(ffi_types::CRustIter<uint32_t> c) {
+    return c;
+}
+ffi_types::CRustFuture<uint32_t> signature_c_rust_future(ffi_types::CRustFuture<uint32_t> c) {
+    return c;
+}
+ffi_types::Symbol signature_symbol(ffi_types::Symbol c) {
+    return c;
+}
+}
+
+// The `signature_*` functions above are also compiled to assembly by `build.rs`,
+// which fails when any of them touches memory on x86-64 SysV or AArch64.
+// Win64 always passes 16 bytes aggregates by reference, so only these traits are checked there.
+template <typename T>
+constexpr bool is_register_passable() {
+    return std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value &&
+           std::is_standard_layout<T>::value && sizeof(T) <= 2 * sizeof(void*);
+}
+
+static_assert(is_register_passable<ffi_types::CBox<char>>(), "CBox must be passed in registers");
+static_assert(is_register_passable<ffi_types::CArc<int>>(), "CArc must be passed in registers");
+static_assert(is_register_passable<ffi_types::CMutSliceRef<char>>(), "CMutSliceRef must be passed in registers");
+static_assert(is_register_passable<ffi_types::CSliceRef<char>>(), "CSliceRef must be passed in registers");
+static_assert(is_register_passable<ffi_types::CBoxedSlice<char>>(), "CBoxedSlice must be passed in registers");
+static_assert(is_register_passable<ffi_types::CMmapSlice>(), "CMmapSlice must be passed in registers");
+static_assert(is_register_passable<ffi_types::CSliceSender<char>>(), "CSliceSender must be passed in registers");
+static_assert(is_register_passable<ffi_types::CSliceReceiver<char>>(), "CSliceReceiver must be passed in registers");
+static_assert(is_register_passable<ffi_types::CArena>(), "CArena must be passed in registers");
+static_assert(is_register_passable<ffi_types::CByteSliceRef>(), "CByteSliceRef must be passed in registers");
+static_assert(is_register_passable<ffi_types::CStrRef>(), "CStrRef must be passed in registers");
+static_assert(is_register_passable<ffi_types::CBoxedStr>(), "CBoxedStr must be passed in registers");
+static_assert(is_register_passable<ffi_types::CStrZRef>(), "CStrZRef must be passed in registers");
+static_assert(is_register_passable<ffi_types::CBoxedCStr>(), "CBoxedCStr must be passed in registers");
+static_assert(is_register_passable<ffi_types::CCowStr>(), "CCowStr must be passed in registers");
+static_assert(is_register_passable<ffi_types::CCowSlice<uint32_t>>(), "CCowSlice must be passed in registers");
+static_assert(is_register_passable<ffi_types::CCompactStr>(), "CCompactStr must be passed in registers");
+static_assert(is_register_passable<ffi_types::CharStrRef>(), "CharStrRef must be passed in registers");
+static_assert(is_register_passable<ffi_types::COption<ffi_types::CBoxedSlice<char>>>(),
+              "COption must be passed in registers");
+static_assert(is_register_passable<ffi_types::CResult<uint32_t, int32_t>>(), "CResult must be passed in registers");
+static_assert(is_register_passable<ffi_types::CRustIter<uint32_t>>(), "CRustIter must be passed in registers");
+static_assert(is_register_passable<ffi_types::CRustFuture<uint32_t>>(), "CRustFuture must be passed in registers");
+static_assert(is_register_passable<ffi_types::Symbol>(), "Symbol must be passed in registers");
+// `CVec` and `CForeignBoxedSlice` are larger than two words and passed in memory by design.
+static_assert(sizeof(ffi_types::CVec<char>) == 3 * sizeof(void*), "CVec must be {ptr, len, cap}");
+static_assert(
+        sizeof(ffi_types::CForeignBoxedSlice<char>) == 4 * sizeof(void*),
+        "CForeignBoxedSlice must be {ptr, len, drop, ctx}");
 
 void test_box() {
     char* x = nullptr;
@@ -50,6 +183,48 @@ void test_box() {
     assert(b.release() == x + 50);
 }
 
+void test_arc() {
+    // same layout as Rust `ArcInner<i32>` created by `Arc::new()`
+    struct {
+        std::atomic<ffi_types::usize> strong;
+        std::atomic<ffi_types::usize> weak;
+        int data;
+    } inner = {{1}, {1}, 42};
+
+    auto a = ffi_types::Arc<int>(&inner.data);
+    assert(*a == 42);
+    assert(a.strong_count() == 1);
+    {
+        auto b = a;
+        assert(a.strong_count() == 2);
+        auto c = ffi_types::CArc<int>::from(std::move(b));
+        assert(b == nullptr);
+        auto d = c();
+        assert(d.get() == a.get());
+        assert(a.strong_count() == 2);
+    }
+    assert(a.strong_count() == 1);
+    assert(arc_dropped == 0);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([a] {
+            for (int j = 0; j < 1000; ++j) {
+                auto copied = a;
+                assert(*copied == 42);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(a.strong_count() == 1);
+
+    a = ffi_types::Arc<int>(nullptr);
+    assert(arc_dropped == 1);
+    assert(inner.strong == 1);  // Rust side decrements the last reference
+}
+
 template <typename C>
 void test_iterator_begin() {
     C c(nullptr, 0);
@@ -60,6 +235,52 @@ void test_iterator_begin() {
     assert(data == c.data());
 }
 
+void test_contiguous_iterator() {
+    const auto text = std::string("hello, world");
+    assert(ffi_types::ranges::data(text) == text.data());
+
+    auto str = ffi_types::CharStrRef(text);
+    assert(std::find(str.begin(), str.end(), ',') - str.begin() == 5);
+    assert(&*str.begin() == text.data());
+
+    auto bytes = ffi_types::SliceRef<char>(text);
+    auto copied = std::string(bytes.size(), ' ');
+    std::copy(bytes.begin(), bytes.end(), copied.begin());
+    assert(copied == text);
+}
+
+using namespace ffi_types::literals;
+
+constexpr int CONSTANT_INTS[] = {1, 2, 3};
+constexpr auto CONSTANT_SLICE = ffi_types::SliceRef<int>(CONSTANT_INTS);
+static_assert(CONSTANT_SLICE.size() == 3 && CONSTANT_SLICE[2] == 3);
+constexpr auto CONSTANT_C_SLICE = ffi_types::CSliceRef<int>::from(CONSTANT_SLICE);
+static_assert(CONSTANT_C_SLICE._size == 3);
+constexpr auto CONSTANT_CHAR_STR = ffi_types::CharStrRef("hello");
+static_assert(CONSTANT_CHAR_STR.size() == 5 && CONSTANT_CHAR_STR.view() == "hello");
+static_assert("\xea\xb0\x80"_rs.size() == 3);
+static_assert(ffi_types::_utf8::validate_constexpr("\xf4\x8f\xbf\xbf", 4));
+static_assert(!ffi_types::_utf8::validate_constexpr("\xed\xa0\x80", 3));
+
+// a static table readable by Rust as `[StrRef; 3]` without a dynamic initializer
+#if __cpp_constinit
+constinit
+#endif
+        const ffi_types::CStrRef CONSTANT_KEYS[] = {
+                ffi_types::CStrRef::from("id"_rs),
+                ffi_types::CStrRef::from("name"_rs),
+                ffi_types::CStrRef::from(""_rs),
+};
+
+void test_constexpr_str() {
+    assert(CONSTANT_KEYS[0]().view() == "id");
+    assert(CONSTANT_KEYS[1]().view() == "name");
+    assert(CONSTANT_KEYS[2]().empty());
+    assert(ffi_types::_rust_ffi_utf8_validate(CONSTANT_KEYS[1]()));
+    constexpr auto key = "key"_rs;
+    assert(key == "key");
+}
+
 void test_char_str() {
     auto str1 = ffi_types::CharStrRef("hello");
     assert(str1.view() == "hello");
@@ -140,14 +361,1138 @@ void test_move_boxed_str() {
     assert(fake_boxed.size() == 0);
     assert(moved_boxed[0] == 'h');
     assert(moved_boxed.size() == 5);
+    // the buffer is not from the Rust global allocator
+    moved_boxed.release();
+}
+
+void test_alloc_boxed_slice() {
+    auto bytes = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(5);
+    assert(bytes.size() == 5);
+    std::memcpy(bytes.data(), "hello", 5);
+
+    bytes.resize_uninit(10);
+    assert(bytes.size() == 10);
+    assert(std::memcmp(bytes.data(), "hello", 5) == 0);
+
+    bytes.resize_uninit(0);
+    assert(bytes.empty());
+    assert(bytes.data() == reinterpret_cast<uint8_t*>(1));
+
+    auto empty = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(0);
+    assert(empty.empty());
+}
+
+void test_slice_views() {
+    const int values[] = {0, 1, 2, 3, 4, 5, 6};
+    auto slice = ffi_types::SliceRef<int>(values, 7);
+    static_assert(std::is_same_v<decltype(slice.first(2)), ffi_types::SliceRef<int>>);
+    assert(slice.first(2) == ffi_types::SliceRef<int>(values, 2));
+    assert(slice.last(3) == ffi_types::SliceRef<int>(values + 4, 3));
+    assert(slice.subslice(2).size() == 5);
+    assert(slice.subslice(2, 3) == ffi_types::SliceRef<int>(values + 2, 3));
+    auto [left, right] = slice.split_at(3);
+    assert(left.size() == 3 && right.front() == 3);
+
+    auto chunks = slice.chunks(3);
+    assert(chunks.size() == 3);
+    assert(chunks.end() - chunks.begin() == 3);
+    assert(chunks[2] == ffi_types::SliceRef<int>(values + 6, 1));
+    // A dereferenced view is a prvalue, which only an input iterator may return before C++20.
+    static_assert(std::is_same_v<std::iterator_traits<decltype(chunks.begin())>::iterator_category,
+                                 std::input_iterator_tag>);
+#if __cplusplus >= 202002L
+    static_assert(std::random_access_iterator<decltype(chunks.begin())>);
+#endif
+    auto exact = slice.chunks_exact(3);
+    assert(exact.size() == 2);
+    assert(exact[1].size() == 3 && exact.remainder().front() == 6);
+    auto windows = slice.windows(5);
+    assert(windows.size() == 3);
+    assert(windows[2] == slice.last(5));
+    assert(slice.windows(8).empty());
+    assert(slice.first(0).chunks(4).empty());
+
+    int sum = 0;
+    for (auto chunk : slice.chunks(2)) {
+        sum += chunk.back();
+    }
+    assert(sum == 1 + 3 + 5 + 6);
+
+    int mutable_values[] = {1, 2, 3, 4, 5};
+    auto mut_slice = ffi_types::MutSliceRef<int>(mutable_values, 5);
+    std::atomic<int> visited = 0;
+    ffi_types::par_for_each_chunk(mut_slice, 2, [&](ffi_types::MutSliceRef<int> chunk) {
+        for (auto& value : chunk) {
+            value *= 10;
+        }
+        visited += 1;
+    });
+    assert(visited == 3);
+    assert(mutable_values[4] == 50);
+
+    // The parallel algorithm is run only for random access iterators.
+    static_assert(std::is_same_v<std::iterator_traits<ffi_types::_IndexIterator>::iterator_category,
+                                 std::random_access_iterator_tag>);
+#if FFI_TYPES_PARALLEL && __cpp_lib_execution && defined(_PSTL_VERSION)
+    static_assert(decltype(__pstl::__internal::__is_parallelization_preferred<
+                           const std::execution::parallel_policy&, ffi_types::_IndexIterator>(
+            std::execution::par))::value);
+#endif
+}
+
+void test_buffer_pool() {
+    const auto previous = ffi_types::pool::set_limit(16 * 4096);
+    const auto before = ffi_types::pool::thread_stats();
+    // only compared when the pool takes the drop, which inline deallocation skips
+    [[maybe_unused]] const uint8_t* data = nullptr;
+    {
+        auto bytes = ffi_types::BoxedSlice<uint8_t>::from_pool(4096);
+        assert(bytes.size() == 4096);
+        data = bytes.data();
+    }
+    auto reused = ffi_types::BoxedSlice<uint8_t>::from_pool(4096);
+    auto unpooled = ffi_types::BoxedSlice<uint8_t>::from_pool(4000);
+    assert(unpooled.size() == 4000);
+    const auto after = ffi_types::pool::thread_stats();
+#if !FFI_TYPES_INLINE_DEALLOC
+    assert(reused.data() == data);
+    assert(after.hits - before.hits == 1);
+    assert(after.recycled - before.recycled == 1);
+#endif
+    assert(after.misses - before.misses >= 1);
+    ffi_types::pool::clear();
+    ffi_types::pool::set_limit(previous);
+}
+
+void test_inline_dealloc() {
+#if FFI_TYPES_INLINE_DEALLOC
+    // no `_drop()` specialization for trivially destructible elements
+    auto ints = ffi_types::BoxedSlice<uint32_t>::with_capacity_uninit(4);
+    std::fill(ints.begin(), ints.end(), 7);
+    assert(ints[3] == 7);
+    {
+        auto dropped = std::move(ints);
+    }
+    assert(ints.empty());
+
+    auto longs = ffi_types::Vec<uint64_t>(nullptr);
+    longs.push_back(1);
+    longs.push_back(2);
+    assert(longs.capacity() >= 2);
+#endif
+}
+
+void test_instrument() {
+#if FFI_TYPES_INSTRUMENT
+    const auto before = ffi_types::instrument::snapshot();
+    auto str = *ffi_types::BoxedStr::from_utf8_copy("instrument");
+    auto bytes = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(8);
+    bytes.resize_uninit(16);
+    {
+        auto dropped = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(4);
+        auto moved = std::move(dropped);
+    }
+    std::thread([] { auto dropped = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(32); }).join();
+    char value = 'c';
+    auto box = ffi_types::OptionBox<char>(&value);
+
+    auto in_flight = bytes.into();
+    auto released = str.release();
+    box.reset(nullptr);
+    const auto after = ffi_types::instrument::snapshot();
+    assert(after.boxed_str.acquired - before.boxed_str.acquired == 1);
+    assert(after.boxed_str.released - before.boxed_str.released == 1);
+    assert(after.boxed_str.live == before.boxed_str.live);
+    assert(after.boxed_slice.acquired - before.boxed_slice.acquired == 3);
+    assert(after.boxed_slice.into - before.boxed_slice.into == 1);
+    assert(after.boxed_slice.dropped - before.boxed_slice.dropped == 2);
+    assert(after.boxed_slice.live == before.boxed_slice.live);
+    assert(after.boxed_slice.live_bytes == before.boxed_slice.live_bytes);
+    assert(after.option_box.acquired - before.option_box.acquired == 1);
+    assert(after.option_box.dropped - before.option_box.dropped == 1);
+
+    // taken back from C-prefixed values
+    bytes = in_flight();
+    str.reset(released);
+    const auto taken = ffi_types::instrument::snapshot();
+    assert(taken.boxed_str.live - before.boxed_str.live == 1);
+    assert(taken.boxed_str.live_bytes - before.boxed_str.live_bytes == 10);
+    assert(taken.boxed_slice.live - before.boxed_slice.live == 1);
+    assert(taken.boxed_slice.live_bytes - before.boxed_slice.live_bytes == 16);
+#endif
+}
+
+void test_option() {
+    auto some = ffi_types::COption<ffi_types::CBoxedSlice<uint8_t>>(
+            ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(4).into());
+    assert(some.is_some());
+    assert(some.unwrap()._size == 4);
+    auto owned = some();
+    assert(owned && owned->size() == 4);
+    assert(!some.is_some());
+    assert(!some().has_value());
+
+    // an empty slice is still some
+    auto empty = ffi_types::COption<ffi_types::CBoxedSlice<uint8_t>>(ffi_types::BoxedSlice<uint8_t>(nullptr).into());
+    assert(empty.is_some());
+    assert(empty()->empty());
+    auto none = ffi_types::COption<ffi_types::CStrRef>::none();
+    assert(!none);
+    auto chars = ffi_types::COption<ffi_types::CharStrRef>(ffi_types::CharStrRef("abc"));
+    assert(chars()->size() == 3);
+
+    auto ok = ffi_types::CResult<ffi_types::CharStrRef, int32_t>::ok(ffi_types::CharStrRef("ok"));
+    assert(ok.is_ok());
+    assert(ok.unwrap().size() == 2);
+    auto err = ffi_types::CResult<ffi_types::CharStrRef, int32_t>::err(22);
+    assert(err.is_err());
+    assert(err.unwrap_err() == 22);
+}
+
+/// An iterator of `[next, end)` implemented by C++ side in place of a Rust iterator.
+struct CountingIter {
+    uint32_t next;
+    uint32_t end;
+    int* drops;
+};
+
+const ffi_types::_IterVTable<uint32_t> COUNTING_ITER_VTABLE = {
+        [](void* state, ffi_types::CMutSliceRef<uint32_t> buffer) -> size_t {
+            auto* it = static_cast<CountingIter*>(state);
+            size_t count = 0;
+            for (; count < buffer._size && it->next < it->end; ++count) {
+                buffer._data[count] = it->next++;
+            }
+            return count;
+        },
+        [](void* state) {
+            auto* it = static_cast<CountingIter*>(state);
+            ++*it->drops;
+            delete it;
+        },
+};
+
+void test_rust_iter() {
+    int drops = 0;
+    auto iter = ffi_types::RustIter<uint32_t>(new CountingIter{0, 1000, &drops}, &COUNTING_ITER_VTABLE);
+    uint32_t buffer[256];
+    assert(iter.next_batch(ffi_types::MutSliceRef<uint32_t>(buffer, 3)) == 3);
+    assert(buffer[2] == 2);
+
+    // through C ABI and back
+    auto moved = iter.into()();
+    assert(!iter);
+    uint64_t sum = 0;
+    size_t count = 0;
+    for (auto& i : moved.items(ffi_types::MutSliceRef<uint32_t>(buffer, 256))) {
+        sum += i;
+        ++count;
+    }
+    assert(count == 997);
+    assert(sum == 999 * 1000 / 2 - 3);
+    assert(moved.next_batch(ffi_types::MutSliceRef<uint32_t>(buffer, 256)) == 0);
+
+    auto partial = ffi_types::RustIter<uint32_t>(new CountingIter{0, 10, &drops}, &COUNTING_ITER_VTABLE);
+    auto items = partial.items(ffi_types::MutSliceRef<uint32_t>(buffer, 4));
+    auto it = items.begin();
+    assert(*it == 0);
+    ++it;
+    assert(items.remaining().size() == 3 && items.remaining()[0] == 1);
+    partial = nullptr;
+    assert(drops == 1);
+    moved._drop();
+    assert(drops == 2);
+
+    auto empty = ffi_types::RustIter<uint32_t>(new CountingIter{0, 0, &drops}, &COUNTING_ITER_VTABLE);
+    for (auto& i : empty.items(ffi_types::MutSliceRef<uint32_t>(buffer, 256))) {
+        (void)i;
+        assert(false);
+    }
+}
+
+void test_rust_iter_from_rust() {
+    const auto drops = ffi_types::_rust_ffi_test_iter_squares_drops();
+    auto iter = ffi_types::_rust_ffi_test_iter_squares(1000)();
+    uint64_t buffer[64];
+    assert(iter.next_batch(ffi_types::MutSliceRef<uint64_t>(buffer, 64)) == 64);
+    assert(buffer[63] == 63 * 63);
+    assert(ffi_types::_rust_ffi_test_iter_squares_drops() == drops);
+    uint64_t sum = 0;
+    size_t count = 0;
+    for (auto& i : iter.items(ffi_types::MutSliceRef<uint64_t>(buffer, 64))) {
+        sum += i;
+        ++count;
+    }
+    assert(count == 1000 - 64);
+    assert(sum == 999 * 1000 * 1999 / 6 - 63 * 64 * 127 / 6);
+    // fused, so the Rust iterator is dropped at the end
+    assert(iter.next_batch(ffi_types::MutSliceRef<uint64_t>(buffer, 64)) == 0);
+    assert(ffi_types::_rust_ffi_test_iter_squares_drops() == drops + 1);
+    iter = nullptr;
+
+    // dropped before the end through C ABI
+    {
+        auto partial = ffi_types::_rust_ffi_test_iter_squares(10)();
+        assert(partial.next_batch(ffi_types::MutSliceRef<uint64_t>(buffer, 3)) == 3);
+        assert(buffer[2] == 4);
+    }
+    assert(ffi_types::_rust_ffi_test_iter_squares_drops() == drops + 2);
+}
+
+/// A future completed by `complete()`, implemented by C++ side in place of a Rust future.
+struct ManualFuture {
+    std::mutex lock;
+    bool ready;
+    uint32_t value;
+    /// A clone of the last waker.
+    const void* waker;
+
+    static const ffi_types::_WakerVTable& waker_vtable(const void* waker) {
+        return **static_cast<const ffi_types::_WakerVTable* const*>(waker);
+    }
+
+    /// Completes the future. The future may be dropped by the wake, so `this` is not used after it.
+    void complete(uint32_t result) {
+        const void* waker;
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+            this->ready = true;
+            this->value = result;
+            waker = this->waker;
+            this->waker = nullptr;
+        }
+        if (waker) {
+            waker_vtable(waker).wake(waker);
+            waker_vtable(waker).drop(waker);
+        }
+    }
+};
+
+int manual_future_drops = 0;
+
+const ffi_types::_FutureVTable<uint32_t> MANUAL_FUTURE_VTABLE = {
+        [](void* state, const void* waker, uint32_t* out) -> bool {
+            auto* future = static_cast<ManualFuture*>(state);
+            std::lock_guard<std::mutex> guard(future->lock);
+            if (future->ready) {
+                *out = future->value;
+                return true;
+            }
+            if (!future->waker) {
+                ManualFuture::waker_vtable(waker).clone(waker);
+                future->waker = waker;
+            }
+            return false;
+        },
+        [](void* state) {
+            auto* future = static_cast<ManualFuture*>(state);
+            if (future->waker) {
+                ManualFuture::waker_vtable(future->waker).drop(future->waker);
+            }
+            delete future;
+            ++manual_future_drops;
+        },
+};
+
+struct CountingWaker {
+    const ffi_types::_WakerVTable* vtable;
+    int refs;
+    int wakes;
+};
+
+const ffi_types::_WakerVTable COUNTING_WAKER_VTABLE = {
+        [](const void* data) { ++static_cast<CountingWaker*>(const_cast<void*>(data))->refs; },
+        [](const void* data) { ++static_cast<CountingWaker*>(const_cast<void*>(data))->wakes; },
+        [](const void* data) { --static_cast<CountingWaker*>(const_cast<void*>(data))->refs; },
+};
+
+#if __cpp_impl_coroutine
+/// An event loop running the scheduled tasks when drained.
+struct TaskQueue {
+    std::mutex lock;
+    std::vector<std::pair<void (*)(void*), void*>> tasks;
+
+    ffi_types::FutureExecutor executor() {
+        return {[](void* context, void (*run)(void*), void* task) {
+                    auto* queue = static_cast<TaskQueue*>(context);
+                    std::lock_guard<std::mutex> guard(queue->lock);
+                    queue->tasks.emplace_back(run, task);
+                },
+                this};
+    }
+
+    /// Runs the tasks scheduled until now on the calling thread. Returns the number of them.
+    size_t drain() {
+        std::vector<std::pair<void (*)(void*), void*>> tasks;
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+            tasks.swap(this->tasks);
+        }
+        for (auto [run, task] : tasks) {
+            run(task);
+        }
+        return tasks.size();
+    }
+};
+
+/// A coroutine started eagerly and destroyed at the end.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            std::abort();
+        }
+    };
+};
+
+DetachedTask await_future(
+        ffi_types::RustFuture<uint32_t> future, TaskQueue* queue, std::atomic<uint32_t>* result,
+        std::thread::id* resumed_on) {
+    result->store(co_await std::move(future).on(queue->executor()));
+    *resumed_on = std::this_thread::get_id();
+}
+
+/// A coroutine started eagerly and destroyed by the owner, even if it is suspended.
+struct OwnedTask {
+    struct promise_type {
+        OwnedTask get_return_object() noexcept {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            std::abort();
+        }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    ~OwnedTask() {
+        this->handle.destroy();
+    }
+};
+
+OwnedTask await_future_owned(ffi_types::RustFuture<uint32_t> future, TaskQueue* queue, std::atomic<uint32_t>* result) {
+    result->store(co_await std::move(future).on(queue->executor()));
+}
+#endif
+
+void test_rust_future() {
+    auto waker = CountingWaker{&COUNTING_WAKER_VTABLE, 1, 0};
+    auto* state = new ManualFuture{{}, false, 0, nullptr};
+    auto future = ffi_types::RustFuture<uint32_t>(state, &MANUAL_FUTURE_VTABLE).into()();
+    uint32_t out = 0;
+    assert(!future.poll(&waker, &out));
+    assert(waker.refs == 2);
+    state->complete(42);
+    assert(waker.refs == 1 && waker.wakes == 1);
+    assert(future.poll(&waker, &out) && out == 42);
+    future._drop();
+
+#if __cpp_impl_coroutine
+    // ready at the first poll
+    TaskQueue queue;
+    std::atomic<uint32_t> result{0};
+    std::thread::id resumed_on;
+    await_future(
+            ffi_types::RustFuture<uint32_t>(new ManualFuture{{}, true, 7, nullptr}, &MANUAL_FUTURE_VTABLE), &queue,
+            &result, &resumed_on);
+    assert(result == 7 && queue.drain() == 0);
+
+    // The thread completing the future only schedules the task, which resumes the coroutine on the executor.
+    state = new ManualFuture{{}, false, 0, nullptr};
+    await_future(ffi_types::RustFuture<uint32_t>(state, &MANUAL_FUTURE_VTABLE), &queue, &result, &resumed_on);
+    std::thread([state] { state->complete(42); }).join();
+    assert(result == 7);
+    assert(queue.drain() == 1);
+    assert(result == 42 && resumed_on == std::this_thread::get_id());
+
+    // destroyed while suspended, with a clone of the waker kept by the future
+    const auto drops = manual_future_drops;
+    {
+        state = new ManualFuture{{}, false, 0, nullptr};
+        auto task = await_future_owned(ffi_types::RustFuture<uint32_t>(state, &MANUAL_FUTURE_VTABLE), &queue, &result);
+        assert(state->waker && !task.handle.done());
+    }
+    assert(manual_future_drops == drops + 1);
+
+    // destroyed after a wake is scheduled, so the task neither polls nor resumes
+    {
+        state = new ManualFuture{{}, false, 0, nullptr};
+        auto task = await_future_owned(ffi_types::RustFuture<uint32_t>(state, &MANUAL_FUTURE_VTABLE), &queue, &result);
+        std::thread([state] { state->complete(9); }).join();
+    }
+    assert(manual_future_drops == drops + 2);
+    assert(queue.drain() == 1);
+    assert(result == 42);
+#endif
+}
+
+void test_str_search() {
+    // same results as Rust `str` methods, checked against `std::string_view` in every alignment of a SIMD block
+    std::string text;
+    for (int i = 0; i < 300; ++i) {
+        text.push_back("abcab"[i % 5]);
+    }
+    text.replace(200, 3, "xyz");
+    for (const char* needle : {"", "a", "ab", "abc", "bca", "xyz", "cabx", "zab", "q", "abcabcabcabd"}) {
+        for (size_t start : {0, 1, 7, 150, 199, 299, 300}) {
+            const auto view = std::string_view(text).substr(start);
+            const auto str = ffi_types::CharStrRef(view);
+            const auto found = view.find(needle);
+            const auto rfound = view.rfind(needle);
+            assert(str.find(needle) == (found == std::string_view::npos ? std::nullopt : std::optional<size_t>(found)));
+            assert(str.rfind(needle) ==
+                   (rfound == std::string_view::npos ? std::nullopt : std::optional<size_t>(rfound)));
+            assert(str.contains(needle) == (found != std::string_view::npos));
+        }
+    }
+    const auto str = ffi_types::CharStrRef("hello world");
+    assert(str.find("") == 0 && str.rfind("") == 11);
+    assert(str.find('o') == 4 && str.rfind('o') == 7 && !str.contains('z'));
+    assert(str.starts_with("hello") && str.starts_with("") && !str.starts_with("hello world!"));
+    assert(str.ends_with("world") && !str.ends_with("hello"));
+
+    assert(ffi_types::CharStrRef("Content-Type").eq_ignore_ascii_case("content-TYPE"));
+    assert(!ffi_types::CharStrRef("Content-Type").eq_ignore_ascii_case("content-typ"));
+    // only ASCII letters are folded
+    assert(!ffi_types::CharStrRef("@[`{").eq_ignore_ascii_case("`{@["));
+    const auto upper = std::string(100, 'Z') + "\xc3\x89";
+    const auto lower = std::string(100, 'z') + "\xc3\x89";
+    assert(ffi_types::CharStrRef(upper).eq_ignore_ascii_case(lower));
+    assert(!ffi_types::CharStrRef(upper).eq_ignore_ascii_case(std::string(100, 'z') + "\xc3\xa9"));
+
+    std::vector<std::string> parts;
+    for (auto part : ffi_types::CharStrRef(",a,,b;c,").split(",;")) {
+        parts.push_back(part.to_string());
+    }
+    assert((parts == std::vector<std::string>{"", "a", "", "b", "c", ""}));
+    parts.clear();
+    for (ffi_types::StrRef part : "\xea\xb0\x80 \xea\xb0\x81"_rs.split(" ")) {
+        assert(part.is_utf8());
+        parts.push_back(part.to_string());
+    }
+    assert((parts == std::vector<std::string>{"\xea\xb0\x80", "\xea\xb0\x81"}));
+    const auto empty = ffi_types::CharStrRef("").split(",");
+    assert(std::distance(empty.begin(), empty.end()) == 1 && (*empty.begin()).empty());
+    const auto long_text = std::string(1000, 'x') + "|" + std::string(10, 'y');
+    const auto long_parts = ffi_types::CharStrRef(long_text).split("|");
+    assert(std::distance(long_parts.begin(), long_parts.end()) == 2);
+    assert((*++long_parts.begin()).size() == 10);
+    // the iterator outlives the range
+    auto it = ffi_types::CharStrRef("a,b").split(",").begin();
+    ++it;
+    assert((*it).to_string() == "b");
+    assert(++it == long_parts.end());
+    static_assert(std::is_same_v<std::iterator_traits<decltype(it)>::iterator_category, std::input_iterator_tag>);
+#if __cplusplus >= 202002L
+    static_assert(std::forward_iterator<decltype(it)>);
+#endif
+}
+
+void test_boxed_str_from_utf8_copy() {
+    auto str = ffi_types::BoxedStr::from_utf8_copy("hello");
+    assert(str.has_value());
+    assert(str->view() == "hello");
+
+    auto empty = ffi_types::BoxedStr::from_utf8_copy(nullptr);
+    assert(empty.has_value());
+    assert(empty->empty());
+
+    auto invalid = ffi_types::BoxedStr::from_utf8_copy("\xff");
+    assert(!invalid.has_value());
+}
+
+void test_compact_str() {
+    static_assert(ffi_types::CompactStr::inline_capacity == 2 * sizeof(void*) - 1);
+
+    for (const char* s : {"", "hello", "0123456789abcde"}) {
+        auto str = ffi_types::CompactStr::from_utf8_copy(s);
+        assert(str.has_value());
+        assert(str->is_inline());
+        assert(str->as_str().view() == s);
+
+        auto moved = std::move(*str);
+        assert(str->is_inline() && str->empty());
+        assert(moved.as_str().view() == s);
+
+        auto c = moved.into();
+        assert(moved.empty());
+        auto back = c();
+        assert(back.as_str().view() == s);
+    }
+    assert(!ffi_types::CompactStr::from_utf8_copy("\xff").has_value());
+    assert(!ffi_types::CompactStr::from_utf8_copy("0123456789abcdef\xff").has_value());
+
+    const auto* buffer = "0123456789abcdef";
+    auto boxed = ffi_types::BoxedStr::from_utf8_copy(buffer);
+    const auto* data = boxed->data();
+    auto heap = ffi_types::CompactStr(std::move(*boxed));
+    assert(!heap.is_inline());
+    assert(heap.data() == data);
+    assert(heap.size() == 16);
+    ffi_types::StrRef ref = heap;
+    assert(ref.view() == buffer);
+
+    // mixed comparisons with the other strings
+    auto short_str = std::move(*ffi_types::CompactStr::from_utf8_copy("abc"));
+    assert(short_str == "abc" && "abc" == short_str);
+    assert(short_str != std::string("abd") && std::string_view("abd") != short_str);
+    assert(ref < short_str && short_str > ref);
+    assert(short_str <= ffi_types::CharStrRef("abc") && heap == ref);
+    assert(std::hash<ffi_types::CompactStr>{}(short_str) == std::hash<ffi_types::CharStrRef>{}("abc"));
+}
+
+void test_c_str() {
+    // the terminator is excluded from the size and passed to C APIs as it is
+    constexpr auto literal = ffi_types::StrZRef("hello");
+    static_assert(literal.size() == 5);
+    assert(std::strlen(literal.c_str()) == 5);
+    assert(literal == "hello" && literal.view() == "hello");
+    assert(literal.starts_with("he"));
+
+    const auto owned = std::string("world");
+    const auto z = ffi_types::StrZRef(owned);
+    assert(z.c_str() == owned.c_str());
+    const auto c = ffi_types::CStrZRef::from(z);
+    assert(c().c_str() == owned.c_str() && c().size() == 5);
+    assert(ffi_types::StrZRef(nullptr).c_str()[0] == '\0');
+
+    auto boxed = ffi_types::BoxedCStr::from_copy("copied");
+    assert(boxed.has_value());
+    assert(boxed->size() == 6 && boxed->c_str()[6] == '\0');
+    assert(std::strcmp(boxed->c_str(), "copied") == 0);
+    const ffi_types::StrZRef ref = *boxed;
+    assert(ref.c_str() == boxed->c_str());
+    assert(ref.as_str().has_value());
+
+    auto moved = std::move(*boxed);
+    assert(boxed->empty() && boxed->c_str()[0] == '\0');
+    auto back = ffi_types::CBoxedCStr::from(std::move(moved))();
+    assert(back == "copied");
+    // dropped in Rust side as `Box<CStr>` of 7 bytes
+    back = ffi_types::BoxedCStr::from_copy("replaced").value();
+    assert(back.c_str()[8] == '\0');
+
+    auto empty = ffi_types::BoxedCStr::from_copy("");
+    assert(empty.has_value() && empty->empty() && empty->c_str()[0] == '\0');
+    assert(!ffi_types::BoxedCStr::from_copy(ffi_types::CharStrRef("a\0b", 3)).has_value());
+    assert(std::hash<ffi_types::BoxedCStr>{}(back) == std::hash<ffi_types::StrRef>{}(back.as_str().value()));
+}
+
+void test_cow() {
+    // a borrowed string is never dropped
+    const auto storage = ffi_types::CharStrRef("borrowed").as_str_unchecked();
+    auto borrowed = ffi_types::CowStr(storage);
+    assert(!borrowed.is_owned());
+    assert(borrowed.as_str().data() == storage.data() && borrowed == ffi_types::CowStr(storage));
+    auto c = borrowed.into();
+    assert(borrowed.empty());
+    borrowed = c();
+    assert(!borrowed.is_owned() && borrowed.size() == 8);
+    assert(std::hash<ffi_types::CowStr>{}(borrowed) == std::hash<ffi_types::StrRef>{}(storage));
+    assert(borrowed == "borrowed" && "borrowed" == borrowed);
+    assert(borrowed != std::string("borrower") && std::string_view("borrower") != borrowed);
+    assert(borrowed < "c" && storage <= borrowed && ffi_types::CharStrRef("a") < borrowed);
+
+    auto owned = ffi_types::CowStr(borrowed.to_owned());
+    assert(owned.is_owned() && owned.size() == 8);
+    assert(owned.as_str() == storage && owned.data() != storage.data());
+    const auto* data = owned.data();
+    auto boxed = std::move(owned).into_owned();
+    assert(boxed.data() == data && owned.empty() && !owned.is_owned());
+    // `_rust_ffi_boxed_str_drop` is a stub in this test
+    auto released = boxed.release();
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(const_cast<char*>(released._data)), released._size, 1);
+    assert(ffi_types::CowStr(ffi_types::BoxedStr(nullptr)).is_owned() == false);
+
+    // an owned slice is dropped in Rust side as a `BoxedSlice<uint8_t>`
+    const uint8_t bytes[] = {1, 2, 3};
+    auto slice = ffi_types::CowSlice<uint8_t>(ffi_types::SliceRef<uint8_t>(bytes, 3));
+    assert(!slice.is_owned() && slice.data() == bytes && slice[2] == 3);
+    auto copied = ffi_types::CowSlice<uint8_t>(slice.to_owned());
+    assert(copied.is_owned() && copied.size() == 3 && copied.data() != bytes);
+    assert(copied.as_slice() == slice.as_slice());
+    auto moved = ffi_types::CCowSlice<uint8_t>::from(std::move(copied))();
+    assert(moved.is_owned() && copied.empty());
+    auto upgraded = std::move(slice).into_owned();
+    assert(upgraded.size() == 3 && upgraded.data() != bytes);
+    moved = ffi_types::CowSlice<uint8_t>(std::move(upgraded));
+    assert(moved.is_owned() && moved[0] == 1);
+}
+
+void test_foreign_boxed_slice() {
+    auto vec = std::vector<uint8_t>(1000, 7);
+    const auto* data = vec.data();
+    auto slice = ffi_types::ForeignBoxedSlice<uint8_t>::from_container(std::move(vec));
+    assert(slice.data() == data);
+    assert(slice.size() == 1000);
+    assert(slice[999] == 7);
+
+    auto c = slice.into();
+    assert(slice.empty());
+    auto back = c();
+    assert(back.data() == data);
+
+    auto text = std::string(100, 'x');
+    const auto* chars = text.data();
+    auto chars_slice = ffi_types::ForeignBoxedSlice<char>::from_container(std::move(text));
+    assert(chars_slice.data() == chars);
+
+    static int dropped = 0;
+    int buffer[3] = {1, 2, 3};
+    {
+        auto count = [](void* ctx) { *static_cast<int*>(ctx) += 1; };
+        auto borrowed = ffi_types::ForeignBoxedSlice<int>(buffer, 3, count, &dropped);
+        auto moved = std::move(borrowed);
+        assert(moved.as_slice() == ffi_types::SliceRef<int>(buffer, 3));
+    }
+    assert(dropped == 1);
+}
+
+void test_mmap_slice() {
+#if __unix__ || __APPLE__
+    const auto file_name = "ffi_types_test_mmap_" + std::to_string(getpid()) + ".bin";
+    const auto path_string = (std::filesystem::temp_directory_path() / file_name).string();
+    const char* path = path_string.c_str();
+    auto records = std::vector<uint32_t>(4096);
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        records[i] = i * 3;
+    }
+    {
+        auto file = std::ofstream(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(uint32_t));
+    }
+
+    int32_t error = -1;
+    auto mmap = ffi_types::MmapSlice::open(path, &error);
+    assert(mmap.has_value() && error == 0);
+    assert(mmap->size() == records.size() * sizeof(uint32_t));
+    assert(mmap->advise(ffi_types::MmapAdvice::Sequential) == 0);
+    assert(mmap->prefetch(5000, 1000) == 0);
+    auto table = mmap->as_slice<uint32_t>();
+    assert(table.size() == records.size());
+    assert(table[4095] == 4095 * 3);
+
+    // the mapping is passed to Rust side and back without remapping
+    auto c = mmap->into();
+    assert(mmap->empty());
+    auto back = c();
+    assert(back.data() == reinterpret_cast<const uint8_t*>(table.data()));
+    mmap.reset();
+    back = ffi_types::MmapSlice(nullptr);
+    std::remove(path);
+
+    assert(!ffi_types::MmapSlice::open(path, &error).has_value());
+    assert(error != 0);
+#endif
+}
+
+void test_io_slices() {
+#if __unix__ || __APPLE__
+    const char* parts[] = {"GET ", "/index.html", " HTTP/1.1\r\n"};
+    auto chunks = std::vector<ffi_types::BoxedSlice<uint8_t>>();
+    for (const char* part : parts) {
+        auto chunk = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(std::strlen(part));
+        std::memcpy(chunk.data(), part, chunk.size());
+        chunks.push_back(std::move(chunk));
+    }
+    auto* iov = ffi_types::as_iovec(chunks);
+    assert(iov[1].iov_base == chunks[1].data());
+    assert(iov[1].iov_len == chunks[1].size());
+
+    int fds[2];
+    assert(pipe(fds) == 0);
+    assert(writev(fds[1], iov, static_cast<int>(chunks.size())) == 26);
+    char buffer[32] = {};
+    assert(read(fds[0], buffer, sizeof(buffer)) == 26);
+    assert(std::string_view(buffer) == "GET /index.html HTTP/1.1\r\n");
+    close(fds[0]);
+    close(fds[1]);
+
+    const uint8_t bytes[] = {'a', 'b', 'c'};
+    const ffi_types::ByteSliceRef refs[] = {ffi_types::ByteSliceRef(bytes, 1), ffi_types::ByteSliceRef(bytes + 1, 2)};
+    const auto list = ffi_types::IoSliceRef(refs, 2);
+    assert(ffi_types::as_iovec(list)[1].iov_len == 2);
+    auto c = list.into();
+    assert(ffi_types::as_iovec(c())[0].iov_base == refs[0].data());
+#endif
+}
+
+void test_channel() {
+    auto [sender, receiver] = ffi_types::byte_channel(3);
+    assert(!receiver.try_recv().has_value());
+    for (uint8_t i = 0; i < 4; ++i) {
+        auto value = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(8);
+        std::memset(value.data(), i, value.size());
+        assert(sender.try_send(std::move(value)));
+    }
+    auto rejected = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(8);
+    const auto* data = rejected.data();
+    assert(!sender.try_send(std::move(rejected)));
+    assert(rejected.data() == data);
+    auto first = receiver.try_recv();
+    assert(first.has_value() && (*first)[7] == 0);
+
+    // values in flight are still received after the sender is dropped
+    sender = ffi_types::SliceSender<uint8_t>(nullptr);
+    assert(receiver.is_disconnected());
+    assert(receiver.try_recv().has_value());
+
+    auto [producer, consumer] = ffi_types::byte_channel(16);
+    auto thread = std::thread([producer = std::move(producer)]() mutable {
+        for (size_t i = 0; i < 10000; ++i) {
+            auto value = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(1);
+            value[0] = static_cast<uint8_t>(i);
+            while (!producer.try_send(std::move(value))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    size_t received = 0;
+    while (received < 10000) {
+        if (auto value = consumer.try_recv()) {
+            assert((*value)[0] == static_cast<uint8_t>(received));
+            received += 1;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    thread.join();
+    assert(consumer.is_disconnected());
+
+    // a Rust producer thread and a C++ consumer
+    auto [rust_sender, cxx_receiver] = ffi_types::byte_channel(16);
+    ffi_types::_rust_ffi_test_byte_producer(rust_sender.into(), 10000);
+    received = 0;
+    while (received < 10000) {
+        if (auto value = cxx_receiver.try_recv()) {
+            assert(value->size() == 1 && (*value)[0] == static_cast<uint8_t>(received));
+            received += 1;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    // the producer drops the sender after the last value
+    while (!cxx_receiver.is_disconnected()) {
+        std::this_thread::yield();
+    }
+    assert(!cxx_receiver.try_recv().has_value());
+}
+
+void test_arena() {
+    auto arena = ffi_types::Arena::create(64);
+    auto hello = arena.alloc_str(ffi_types::CharStrRef("hello").as_str_unchecked());
+    const uint64_t values[] = {1, 2, 3};
+    auto numbers = arena.alloc_slice_copy(ffi_types::SliceRef<uint64_t>(values, 3));
+    numbers[0] = 10;
+    assert(hello.view() == "hello");
+    assert(numbers[0] == 10 && numbers[2] == 3);
+    assert(reinterpret_cast<uintptr_t>(numbers.data()) % alignof(uint64_t) == 0);
+    assert(arena.alloc_slice_uninit<uint32_t>(0).empty());
+    assert(!arena.alloc_str_from_utf8(ffi_types::CharStrRef("\xff")).has_value());
+
+    // the first chunk is full and the slow path allocates the next one
+    for (uint32_t i = 0; i < 100; ++i) {
+        auto slice = arena.alloc_slice_uninit<uint32_t>(4);
+        std::fill(slice.begin(), slice.end(), i);
+        assert(slice[3] == i);
+    }
+    auto large = arena.alloc_slice_uninit<uint8_t>(10000);
+    std::memset(large.data(), 7, large.size());
+
+    arena.reset();
+    auto reused = arena.alloc_str(ffi_types::CharStrRef("reused").as_str_unchecked());
+    assert(reused.view() == "reused");
+
+    // the arena is shared with Rust side
+    auto c = arena.into();
+    auto back = c();
+    assert(back.alloc_str(reused).view() == "reused");
+}
+
+void test_hash() {
+    const char* text = "0123456789abcdefghijklmnopqrstuvwxyz";
+    for (ffi_types::usize n = 0; n <= 36; ++n) {
+        auto bytes = ffi_types::SliceRef<uint8_t>(reinterpret_cast<const uint8_t*>(text), n);
+        assert(ffi_types::hash_bytes(text, n) == ffi_types::_rust_ffi_hash_bytes(bytes.into()));
+    }
+
+    const auto key = ffi_types::CharStrRef("key").as_str_unchecked();
+    const auto hashed = ffi_types::HashedStrRef(key);
+    assert(hashed.hash() == ffi_types::hash_bytes("key", 3));
+    assert(std::hash<ffi_types::StrRef>{}(key) == std::hash<ffi_types::HashedStrRef>{}(hashed));
+    assert(std::hash<ffi_types::StrRef>{}(key) == std::hash<ffi_types::CharStrRef>{}("key"));
+    assert(hashed == ffi_types::HashedStrRef(key));
+
+    auto map = std::unordered_map<ffi_types::StrRef, int, ffi_types::StrHash, ffi_types::StrEqual>();
+    map.emplace(key, 1);
+    assert(map.count(key) == 1);
+#if __cpp_lib_generic_unordered_lookup
+    assert(map.find(hashed) != map.end());
+    assert(map.find(std::string_view("key")) != map.end());
+    assert(map.find(ffi_types::CharStrRef("kex")) == map.end());
+#endif
+
+    auto ordered = std::map<ffi_types::StrRef, int, std::less<>>();
+    ordered.emplace(key, 1);
+    assert(ordered.find("key") != ordered.end());
+    assert(ordered.find(std::string("kex")) == ordered.end());
+
+    // owned keys are looked up by borrowed strings without allocation
+    auto owned = std::unordered_map<ffi_types::BoxedStr, int, ffi_types::StrHash, ffi_types::StrEqual>();
+    owned.emplace(std::move(*ffi_types::BoxedStr::from_utf8_copy("key")), 1);
+    assert(owned.count(std::move(*ffi_types::BoxedStr::from_utf8_copy("key"))) == 1);
+#if __cpp_lib_generic_unordered_lookup
+    assert(owned.find(hashed) != owned.end());
+    assert(owned.find(key) != owned.end());
+    assert(owned.find(std::string_view("key"))->second == 1);
+    assert(owned.find(ffi_types::CharStrRef("kex")) == owned.end());
+#endif
+    auto owned_ordered = std::map<ffi_types::BoxedStr, int, std::less<>>();
+    owned_ordered.emplace(std::move(*ffi_types::BoxedStr::from_utf8_copy("key")), 1);
+    assert(owned_ordered.find("key") != owned_ordered.end());
+    assert(owned_ordered.find(key) != owned_ordered.end());
+    assert(owned_ordered.find(std::string("kex")) == owned_ordered.end());
+}
+
+void test_interner() {
+    using ffi_types::Symbol;
+    const auto id = Symbol::intern(ffi_types::CharStrRef("id").as_str_unchecked());
+    assert(Symbol::intern(ffi_types::CharStrRef("id").as_str_unchecked()) == id);
+    assert(id.str() == ffi_types::CharStrRef("id"));
+    assert(id.str().data() == Symbol::intern(id.str()).str().data());
+    assert(Symbol::intern(ffi_types::CharStrRef("").as_str_unchecked()).str().empty());
+
+    // symbols over several segments are resolved inline, and their strings stay in place
+    std::vector<std::string> names;
+    for (int i = 0; i < 5000; ++i) {
+        names.push_back("name_" + std::to_string(i));
+    }
+    std::vector<ffi_types::CStrRef> strs;
+    for (const auto& name : names) {
+        strs.push_back(ffi_types::CharStrRef(name).as_str_unchecked());
+    }
+    std::vector<Symbol> symbols(names.size());
+    Symbol::intern_all(ffi_types::SliceRef<ffi_types::CStrRef>(strs.data(), strs.size()),
+                       ffi_types::MutSliceRef<Symbol>(symbols.data(), symbols.size()));
+    const auto first = symbols[0].str().data();
+    for (size_t i = 0; i < names.size(); ++i) {
+        assert(symbols[i].str() == ffi_types::CharStrRef(names[i]));
+        assert(Symbol::intern(strs[i]()) == symbols[i]);
+        assert(i == 0 || symbols[i - 1] < symbols[i]);
+    }
+    assert(symbols[0].str().data() == first);
+    assert(symbols.back().id() >= ffi_types::SymbolTable::FIRST_SEGMENT * 3);
+
+    auto counts = std::unordered_map<Symbol, int>();
+    counts[id] += 1;
+    counts[Symbol::intern(ffi_types::CharStrRef("id").as_str_unchecked())] += 1;
+    assert(counts.size() == 1 && counts[id] == 2);
+}
+
+void test_compare() {
+    const auto a = ffi_types::CharStrRef("abc");
+    const auto ab = ffi_types::CharStrRef("ab");
+    const std::string abd = "abd";
+    assert(a == "abc");
+    assert("abc" == a);
+    assert(a == std::string_view("abc"));
+    assert(std::string_view("abc") == a);
+    assert(a != abd);
+    assert(a < abd && abd > a);
+    assert(ab < a && ab <= a && a >= ab);
+    assert(ffi_types::CharStrRef(nullptr) < ab);
+
+    auto inline_str = ffi_types::CompactStr::from_utf8_copy("abc").value();
+    assert(inline_str == ffi_types::CompactStr::from_utf8_copy("abc").value());
+    assert(inline_str.as_str() == a);
+
+    const int xs[] = {1, 2, 3};
+    int ys[] = {1, 2, 4};
+    const auto x = ffi_types::SliceRef<int>(xs, 3);
+    const auto y = ffi_types::MutSliceRef<int>(ys, 3);
+    assert(x == ffi_types::SliceRef<int>(xs, 3));
+    assert(x != y);
+    assert(x < y);
+    assert(ffi_types::SliceRef<int>(xs, 2) < x);
+    assert(std::hash<ffi_types::SliceRef<int>>{}(x) == ffi_types::hash_bytes(xs, sizeof(xs)));
+}
+
+void test_vec() {
+    auto vec = ffi_types::Vec<uint8_t>(nullptr);
+    assert(vec.empty());
+    assert(vec.capacity() == 0);
+
+    for (int i = 0; i < 100; ++i) {
+        vec.push_back(static_cast<uint8_t>(i));
+    }
+    assert(vec.size() == 100);
+    assert(vec.capacity() >= 100);
+    assert(vec[99] == 99);
+
+    const uint8_t tail[] = {1, 2, 3};
+    vec.extend(ffi_types::SliceRef<uint8_t>(tail, 3));
+    assert(vec.size() == 103);
+    assert(vec.back() == 3);
+
+    auto capacity = vec.capacity();
+    vec.clear();
+    assert(vec.empty());
+    assert(vec.capacity() == capacity);
+
+    auto moved = std::move(vec);
+    assert(vec.capacity() == 0);
+    assert(moved.capacity() == capacity);
+}
+
+void test_drop_all() {
+    auto strings = std::vector<ffi_types::BoxedStr>();
+    for (int i = 0; i < 10; ++i) {
+        strings.push_back(*ffi_types::BoxedStr::from_utf8_copy("hello"));
+    }
+    strings.push_back(ffi_types::BoxedStr(nullptr));
+    ffi_types::drop_all(strings);
+    for (const auto& s : strings) {
+        assert(s.empty());
+    }
+
+    auto slices = std::vector<ffi_types::BoxedSlice<uint8_t>>();
+    for (int i = 0; i < 10; ++i) {
+        slices.push_back(ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(i));
+    }
+    ffi_types::drop_all(slices);
+    for (const auto& s : slices) {
+        assert(s.empty());
+    }
+}
+
+void test_deferred_reclaim() {
+    // buffers of a size class would be recycled by the pool instead
+    auto limit = ffi_types::pool::set_limit(0);
+    auto count = ffi_types::reclaim::deferred_count();
+    {
+        auto scope = ffi_types::reclaim::DeferredScope();
+        auto slices = std::vector<ffi_types::BoxedSlice<uint8_t>>();
+        for (int i = 1; i < 10; ++i) {
+            slices.push_back(ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(i));
+        }
+        ffi_types::drop_all(slices);
+        // a batch is deferred at once
+        assert(ffi_types::reclaim::deferred_count() == count + 1);
+#if !FFI_TYPES_INLINE_DEALLOC
+        {
+            auto bytes = ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(1 << 20);
+        }
+        {
+            auto vec = ffi_types::Vec<uint8_t>(nullptr);
+            vec.push_back(1);
+        }
+        assert(ffi_types::reclaim::deferred_count() == count + 3);
+#endif
+    }
+    ffi_types::reclaim::flush();
+    assert(ffi_types::reclaim::pending() == 0);
+
+    // drops out of the scope are not deferred
+    count = ffi_types::reclaim::deferred_count();
+    auto slices = std::vector<ffi_types::BoxedSlice<uint8_t>>();
+    slices.push_back(ffi_types::BoxedSlice<uint8_t>::with_capacity_uninit(1 << 20));
+    ffi_types::drop_all(slices);
+    assert(ffi_types::reclaim::deferred_count() == count);
+    ffi_types::pool::set_limit(limit);
+}
+
+void test_char_str_as_str() {
+    const char* valid[] = {
+            "",
+            "hello",
+            "hello, world! this string is longer than a vector block",
+            "\xc2\x80",          // U+0080
+            "\xed\x9f\xbf",      // U+D7FF
+            "\xee\x80\x80",      // U+E000
+            "\xf0\x90\x80\x80",  // U+10000
+            "\xf4\x8f\xbf\xbf",  // U+10FFFF
+            "0123456789abcdef0123456789abcdef\xea\xb0\x80 after a vector block",
+    };
+    for (const auto* s : valid) {
+        auto str = ffi_types::CharStrRef(s);
+        assert(str.is_utf8());
+        assert(str.is_utf8() == ffi_types::_rust_ffi_utf8_validate(str));
+        assert(str.as_str().has_value());
+        assert(str.as_str()->view() == s);
+        assert(ffi_types::_utf8::validate_constexpr(str.data(), str.size()));
+    }
+
+    const char* invalid[] = {
+            "\x80",                  // continuation
+            "\xc0\x80",              // overlong
+            "\xc2",                  // truncated
+            "\xe0\x80\x80",          // overlong
+            "\xed\xa0\x80",          // surrogate
+            "\xf0\x80\x80\x80",      // overlong
+            "\xf4\x90\x80\x80",      // over U+10FFFF
+            "\xf5\x80\x80\x80",      // invalid lead
+            "0123456789abcdef0123456789abcdef\xff",
+    };
+    for (const auto* s : invalid) {
+        auto str = ffi_types::CharStrRef(s);
+        assert(!str.is_utf8());
+        assert(str.is_utf8() == ffi_types::_rust_ffi_utf8_validate(str));
+        assert(!str.as_str().has_value());
+        assert(!ffi_types::_utf8::validate_constexpr(str.data(), str.size()));
+    }
 }
 
 int main() {
     test_box();
+    test_arc();
     test_char_str();
+    test_constexpr_str();
     test_null_str();
     test_move_boxed_slice();
     test_move_boxed_str();
+    test_alloc_boxed_slice();
+    test_inline_dealloc();
+    test_buffer_pool();
+    test_instrument();
+    test_option();
+    test_rust_iter();
+    test_rust_iter_from_rust();
+    test_rust_future();
+    test_str_search();
+    test_boxed_str_from_utf8_copy();
+    test_compact_str();
+    test_c_str();
+    test_cow();
+    test_foreign_boxed_slice();
+    test_slice_views();
+    test_mmap_slice();
+    test_io_slices();
+    test_channel();
+    test_arena();
+    test_hash();
+    test_interner();
+    test_compare();
+    test_vec();
+    test_drop_all();
+    test_deferred_reclaim();
+    test_char_str_as_str();
+    test_contiguous_iterator();
     test_iterator_begin<ffi_types::CharStrRef>();
     test_iterator_begin<ffi_types::SliceRef<char>>();
     test_iterator_begin<ffi_types::SliceRef<const char>>();
@@ -0,0 +1,71 @@
+//! @file rust_types.cppm
+//! @brief C++20 module interface of `rust_types.hxx`.
+//!
+//! @warning Experimental and unsupported. No tested toolchain links a program importing this module,
+//!          so use `rust_types.hxx` for production builds.
+//!
+//! `import ffi_types;` makes the types available without parsing the header and its standard headers
+//! in every translation unit. Build this file once as a module interface unit with `include/` in the include path,
+//! e.g. `g++ -std=c++20 -fmodules-ts -c rust_types.cppm -x c++` or `clang++ -std=c++20 --precompile rust_types.cppm`.
+//!
+//! @note The header is included in an export block, so every entity of it is exported and attached to the module.
+//!       The standard headers are included in the global module fragment before it not to be attached.
+//!       Using-declarations of the global module fragment are not exported by GCC 12, so they are not used.
+//!       GCC 12 compiles importers, but leaves some inline and template functions of the module undefined
+//!       when they are linked, so link with a newer compiler.
+//! @note `FFI_TYPES_*` flags are read when the module is built, so define them for this file, not for importers.
+//! @warning Don't include `rust_types.hxx` or `rust_types_fwd.hxx` in a translation unit importing the module.
+//!          Their declarations belong to the global module, so the names become ambiguous.
+
+module;
+
+// same as the standard headers of `rust_types.hxx`
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+#if __cpp_lib_ranges
+#include <ranges>
+#endif
+#if __cpp_lib_string_view
+#include <string_view>
+#endif
+#if __cpp_lib_span
+#include <span>
+#endif
+#include <type_traits>
+#if __cpp_impl_three_way_comparison
+#include <compare>
+#endif
+#if __cpp_impl_coroutine
+#include <coroutine>
+#endif
+#if __unix__ || __APPLE__
+#include <sys/uio.h>
+#endif
+#if FFI_TYPES_PARALLEL
+#include <execution>
+#endif
+#if __AVX2__
+#include <immintrin.h>
+#elif __SSE2__ || _M_X64
+#include <emmintrin.h>
+#elif __ARM_NEON
+#include <arm_neon.h>
+#endif
+#if _MSC_VER
+#include <intrin.h>
+#endif
+
+export module ffi_types;
+
+export {
+#include "rust_types.hxx"
+}
@@ -1,72 +1,25 @@
 #pragma once
+#ifndef FFI_TYPES_RUST_TYPES_FWD
+#define FFI_TYPES_RUST_TYPES_FWD
+
+//! @file rust_types_fwd.hxx
+//! @brief Forward declarations of the types of `rust_types.hxx` and definitions of the C-prefixed types
+//!        for generated FFI headers.
+//!
+//! A cbindgen or bindgen header declaring functions which take or return C-prefixed types by value,
+//! structs having them as fields, or pointers and references to any type, needs only this header.
+//! Include it there and `rust_types.hxx` only in sources calling the functions or converting the values
+//! to owned types, so most translation units don't parse the standard headers of the full header.
+//!
+//! @note The members of the C-prefixed types and the `_drop()` specializations of cbindgen trailers need
+//!       the full header. Both headers can be included in any order.
+//!       This file is also the first part of `rust_types.hxx`.
 
 #include <array>
-#include <cassert>
+#include <cstddef>
 #include <cstdint>
-#include <string>
-#include <vector>
-#if __cpp_lib_ranges
-#include <ranges>
-#endif
-#if __cpp_lib_string_view
-#include <string_view>
-#endif
-#if __cpp_lib_span
-#include <span>
-#endif
 #include <type_traits>
 
-//! @file rust_types.hh
-//! @brief This file contains matching C++ types for `ffi_types` crate.
-//!
-//! The types can be used for either bindgen, cbindgen or hand-crafted C/C++ code.
-//! The types without C-prefixes are ownership-aware types compatible with Rust types.
-//! The types with C-prefixes are C ABI compatible layout of its paired owned types.
-//! C-prefixes types are very fragile! Please read the following warning to use it safe.
-//!
-//! @warning All types prefixed with `C` in this file are C ABI compatible layout of owned types without `C` prefix.
-//!          To avoid memory leak, you must convert it to owned type or pass it to Rust side.
-//!          You *MUST* run one of the following to avoid memory leak:
-//!
-//!          1. Calling operator() to convert to owned type.
-//!             1.1 When used in bindgen generated functions' arguments.
-//!             ```c++
-//!             void foo(CBoxedSlice<uint32_t> ints) {
-//!                 auto owned = ints();  // owned is managed as BoxedSlice<uint32_t>
-//!             }
-//!             ```
-//!
-//!             1.2 When used in cbindgen generated functions' return value.
-//!             ```rust
-//!             fn foo() -> CBoxedSlice<u32> { ... }
-//!             ```
-//!             ```c++
-//!             auto owned = foo()();  // owned is managed as BoxedSlice<uint32_t>
-//!             ```
-//!
-//!             1.3 Dropping in C++ side.
-//!             The owned value in either 1.1 or 1.2 must be returned to Rust side or dropped.
-//!             See 2.1 to return value.
-//!             Implement template specialization for `_drop()` for the related type to drop it in C++ side.
-//!             (e.g. BoxedSlice<uint32_t>::_drop() for BoxedSlice<uint32_t>)
-//!             The _drop function must call `std::mem::drop()` from rust side.
-//!
-//!          2. Passing as an argument of Rust function.
-//!             2.1 When used in cbindgen generated functions' arguments.
-//!             ```rust
-//!             fn foo() -> CBoxedSlice<u32> { ... }   // See 1.2 for this case
-//!             fn bar(ints: CBoxedSlice<u32>) { ... }
-//!             ```
-//!             ```c++
-//!             auto owned = foo()();  // owned is managed as BoxedSlice<uint32_t>
-//!             bar(owned);  // BoxedSlice can be passed to CBoxedSlice
-//!             ```
-//!
-//!          3. Returning from C++ function. Note that this case will be very unlikely to happen because Box must be
-//!          created from Rust side.
-//!
-//! @note allocate or deallocate a boxed type in C++ side is not allowed.
-
 namespace ffi_types {
 
 /// Alias for Rust `std::usize`.
@@ -76,117 +29,130 @@ using usize = uintptr_t;
 template <typename T, usize N>
 using Array = std::array<T, N>;
 
-}  // namespace ffi_types
-
-#if _MSC_VER
-#define _COPY_DELETE default
-#else
-#define _COPY_DELETE delete
-#endif
-namespace ffi_types {
-
+// boxes
+template <typename T>
+struct OptionBox;
+template <typename T>
+struct Box;
 template <typename T>
 struct CBox;
-
-/// C++ counterpart for Rust `Option<Box<T>>` managed by C++ ownership model.
-//
-/// The API design is similar to `std::unique_ptr`, though construction and destruction
-/// must be executed in Rust side.
+/// C++ wrapper for Rust `Option<Box<T>>` as alias of `CBox<T>`.
 ///
-/// @warning The underlying memory must be allocated from Rust side.
+/// This is a cbindgen helper to pass `Option<Box<T>>` to C++ side.
+///
+/// @see CBox
 template <typename T>
-struct OptionBox {
-    using element_type = T;
-    using pointer = T*;
-
-    T* _ptr;
-
-    // constructors
-    OptionBox() = delete;
-    OptionBox(OptionBox&) = delete;
-    OptionBox(OptionBox&& b) noexcept : _ptr(b.release()) {}
-    explicit OptionBox(std::nullptr_t) noexcept : _ptr(nullptr) {}
-
-    explicit OptionBox(pointer p) noexcept : _ptr(p) {}
-
-    // destructor and helper
-    ~OptionBox() noexcept {
-        if (this->get()) {
-            this->_drop();
-        }
-    }
-    void _drop() noexcept;
-
-    // assignment
-    OptionBox& operator=(OptionBox&& b) noexcept {
-        this->_ptr = b.release();
-        return *this;
-    }
-
-    /// Converts to `CBox<T>` by moving the value.
-    /// The value of `this` will be invalidated to null.
-    CBox<T> into() noexcept;
-
-    /// Borrow as `CBox<T>`.
-    /// This is safe because CBox is a reference.
-    CBox<T>& as_c() noexcept {
-        return *reinterpret_cast<CBox<T>*>(this);
-    }
-
-    /// Borrow as `CBox<T>`.
-    /// This is safe because CBox is a reference.
-    const CBox<T>& as_c() const noexcept {
-        return *reinterpret_cast<const CBox<T>*>(this);
-    }
+using COptionBox = CBox<T>;
+template <typename T>
+struct Arc;
+template <typename T>
+struct CArc;
+class Arena;
+struct CArena;
+template <typename T>
+struct COption;
+template <typename T, typename E>
+struct CResult;
 
-    // observers
-    typename std::add_lvalue_reference<element_type>::type operator*() const {
-        return *get();
-    }
-    pointer operator->() const {
-        return get();
-    }
-    pointer get() const {
-        return this->_ptr;
-    }
-    explicit operator bool() const noexcept {
-        return get() != nullptr;
-    }
+// slices
+template <typename T>
+struct MutSliceRef;
+template <typename T>
+struct SliceRef;
+template <typename T>
+struct CMutSliceRef;
+template <typename T>
+struct CSliceRef;
+using ByteSliceRef = SliceRef<uint8_t>;
+struct CByteSliceRef;
+using IoSliceRef = SliceRef<ByteSliceRef>;
+using CIoSliceRef = CSliceRef<ByteSliceRef>;
+template <typename T>
+class BoxedSlice;
+template <typename T>
+struct CBoxedSlice;
+template <typename T>
+class Vec;
+template <typename T>
+struct CVec;
+template <typename T>
+class ForeignBoxedSlice;
+template <typename T>
+struct CForeignBoxedSlice;
+template <typename T>
+class CowSlice;
+template <typename T>
+struct CCowSlice;
+/// A slice allocated in an `Arena`. It is valid until the arena is reset or dropped.
+/// Unlike `BoxedSlice<T>`, it is not dropped by itself.
+template <typename T>
+using ArenaSlice = MutSliceRef<T>;
+class MmapSlice;
+struct CMmapSlice;
+enum class MmapAdvice : int32_t;
+template <typename T>
+class SliceSender;
+template <typename T>
+struct CSliceSender;
+template <typename T>
+class SliceReceiver;
+template <typename T>
+struct CSliceReceiver;
+template <typename T>
+class RustIter;
+template <typename T>
+struct CRustIter;
+template <typename T>
+class RustFuture;
+template <typename T>
+struct CRustFuture;
 
-    // operators
-    bool operator==(std::nullptr_t) const {
-        return this->get() == nullptr;
-    }
-    bool operator!=(std::nullptr_t) const {
-        return this->get() != nullptr;
-    }
+// strings
+struct CharStrRef;
+struct StrRef;
+struct CStrRef;
+using ArenaStr = StrRef;
+class BoxedStr;
+struct CBoxedStr;
+class CompactStr;
+struct CCompactStr;
+class CowStr;
+struct CCowStr;
+struct StrZRef;
+struct CStrZRef;
+class BoxedCStr;
+struct CBoxedCStr;
+struct HashedStrRef;
+struct Symbol;
+struct SymbolTable;
+
+// counters
+struct PoolStats;
+struct OwnershipStats;
+struct OwnershipSnapshot;
+struct OwnershipShard;
+
+// internal types of the fields
+template <typename T>
+struct _SliceRange;
+template <typename T>
+struct _ChannelInner;
+struct _ArenaHeader;
+template <typename T>
+struct _FutureVTable;
+template <typename T>
+struct _IterVTable;
 
-    // modifiers
-    T* release() noexcept {
-        auto* ptr = this->_ptr;
-        this->_ptr = 0;
-        return ptr;
-    }
-    void reset(pointer p) noexcept {
-        if (this->get()) {
-            this->_drop();
-        }
-        this->_ptr = p;
-    }
-};
-static_assert(sizeof(OptionBox<int>) == sizeof(int*));
-static_assert(std::is_standard_layout<OptionBox<int>>::value);
+// C-prefixed types
+//
+// The layouts are complete to be passed by value and stored in fields.
+// The members converting them from and to the C++ counterparts are defined in `rust_types.hxx`.
 
-/// C++ counterpart for Rust `Box<T>` as alias of `OptionBox<T>`.
-/// Since `Box<T>` can be moved or released, a value of this type is still not guaranteed to be non-null.
-///
-/// @warning The underlying memory must be allocated from Rust side.
-template <typename T>
-struct Box : public OptionBox<T> {
-    explicit Box(T* p) noexcept : OptionBox<T>(p) {
-        assert(p != nullptr);
-    }
-};
+#if _MSC_VER
+#define _COPY_DELETE default
+#else
+#define _COPY_DELETE delete
+#endif
 
 /// C++ wrapper for Rust `Box<T>` with C ABI compatible layout.
 ///
@@ -203,21 +169,15 @@ struct [[nodiscard]] CBox {
 #if _MSC_VER
     /// Creates a CBox from a `OptionBox<T>` by moving the value.
     /// This is a workaround for MSVC constructor limitation.
-    static CBox from(OptionBox<T>&& box) noexcept {
-        CBox cbox;
-        cbox._ptr = box.release();
-        return cbox;
-    }
+    static CBox from(OptionBox<T>&& box) noexcept;
 #else
     CBox(CBox&&) = default;
     CBox& operator=(CBox&& b) noexcept = default;
-    CBox(OptionBox<T>&& box) noexcept : _ptr(box.release()) {}
+    CBox(OptionBox<T>&& box) noexcept;
 
     /// Creates a CBox from a `OptionBox<T>` by moving the value.
     /// This is a workaround for MSVC constructor limitation.
-    static CBox from(OptionBox<T>&& box) noexcept {
-        return CBox(std::move(box));
-    }
+    static CBox from(OptionBox<T>&& box) noexcept;
 #endif
 
     /// Conversion operator to check if the box is not null.
@@ -236,12 +196,7 @@ struct [[nodiscard]] CBox {
     /// `CBox` itself still can be a null due to move.
     ///
     /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
-    OptionBox<T> operator()() noexcept {
-        auto box = OptionBox<T>(nullptr);
-        box.reset(this->_ptr);
-        this->_ptr = nullptr;
-        return box;
-    }
+    OptionBox<T> operator()() noexcept;
 
     T* release() noexcept {
         auto* ptr = this->_ptr;
@@ -253,245 +208,46 @@ static_assert(sizeof(CBox<int>) == sizeof(int*));
 static_assert(std::is_trivial<CBox<int>>::value);
 static_assert(std::is_standard_layout<CBox<int>>::value);
 
-/// C++ wrapper for Rust `Option<Box<T>>` as alias of `CBox<T>`.
+/// C++ wrapper for Rust `Arc<T>` with C ABI compatible layout.
 ///
-/// This is a cbindgen helper to pass `Option<Box<T>>` to C++ side.
-///
-/// @see CBox
-template <typename T>
-using COptionBox = CBox<T>;
-
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
 template <typename T>
-inline CBox<T> OptionBox<T>::into() noexcept {
-    return CBox<T>::from(std::move(*this));
-}
+struct [[nodiscard]] CArc {
+    CArc() = _COPY_DELETE;
+    CArc(const CArc&) = _COPY_DELETE;
+    CArc& operator=(const CArc& b) noexcept = _COPY_DELETE;
 
-// specializations to prohibit void box drop
-template struct CBox<void>;
+    const T* _ptr;
 
-template <>
-inline void OptionBox<void>::_drop() noexcept {
-    assert("void box doesn't support drop" && false);
-}
+#if _MSC_VER
+    /// Creates a CArc from a `Arc<T>` by moving the value.
+    /// This is a workaround for MSVC constructor limitation.
+    static CArc from(Arc<T>&& arc) noexcept;
+#else
+    CArc(CArc&&) = default;
+    CArc& operator=(CArc&& b) noexcept = default;
+    CArc(Arc<T>&& arc) noexcept;
 
-}  // namespace ffi_types
-namespace ffi_types {
+    /// Creates a CArc from a `Arc<T>` by moving the value.
+    /// This is a workaround for MSVC constructor limitation.
+    static CArc from(Arc<T>&& arc) noexcept;
+#endif
 
-#define EMPTY_SLICE_BEGIN(T) reinterpret_cast<T*>(1)
+    /// Conversion operator to `Arc<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    Arc<T> operator()() noexcept;
 
-template<typename T>
-T* _wrap_null(T* ptr) {
-    return ptr ? ptr : reinterpret_cast<T*>(1);
-}
-
-// C++ std::ranges compatibility layer until C++17.
-#if __cpp_lib_ranges
-namespace ranges {
-using std::ranges::data;
-using std::ranges::size;
-}  // namespace ranges
-#define SAFE_R R&&
-#else
-namespace ranges {
-template <typename C>
-auto data(C& x) noexcept {
-    auto begin = x.begin();
-
-    using iterator_type = decltype(begin);
-    using pointer_type = decltype(&*begin);
-
-    if constexpr (std::is_same_v<iterator_type, pointer_type>) {
-        // same type
-        return begin;
-    } else if constexpr (sizeof(iterator_type) == sizeof(uintptr_t)) {
-        // likely to be a pointer
-        return *reinterpret_cast<pointer_type*>(&begin);
-    } else {
-        if (begin != x.end()) {
-            return &*begin;
-        } else {
-            return static_cast<pointer_type>(nullptr);
-        }
-    }
-}
-
-template <typename C>
-size_t size(C& x) noexcept {
-    return x.end() - x.begin();
-}
-}  // namespace ranges
-// R&& is not safe without actual ranges
-#define SAFE_R const R&
-#endif
-
-struct CharStrRef;
-struct StrRef;
-struct CStrRef;
-struct CByteSliceRef;
-class BoxedStr;
-
-template <typename T>
-struct CMutSliceRef;
-template <typename T>
-struct CSliceRef;
-template <typename T>
-struct CBoxedSlice;
-
-/// A minimal range type of slices to be compatible with internal ranges.
-template <typename T>
-struct _SliceRange {
-    T* _data;
-    usize _size;
-
-    auto* begin() const noexcept {
-        return this->_data;
-    }
-    auto* end() const noexcept {
-        return this->_data + _size;
-    }
-};
-
-/// Common C++ STL-like interface for &[T] and &str.
-/// @see std::span
-template <typename T, template <typename _> typename I>
-struct _SliceInterface {
-    // constants and types
-    using element_type = T;
-    using value_type = typename std::remove_cv_t<T>;
-    using size_type = uintptr_t;
-    using difference_type = intptr_t;
-    using pointer = element_type*;
-    using const_pointer = const element_type*;
-    using reference = element_type&;
-    using const_reference = const element_type&;
-#if __cpp_lib_span
-    using iterator = typename std::span<element_type>::iterator;
-#else
-    using iterator = pointer;
-#endif
-    using reverse_iterator = std::reverse_iterator<iterator>;
-
-    // observers
-    size_type size() const noexcept {
-        return static_cast<const I<T>*>(this)->_size;
-    }
-    size_type size_bytes() const noexcept {
-        return this->size() * sizeof(element_type);
-    }
-    bool empty() const noexcept {
-        return this->size() == 0;
-    }
-
-    // element access
-    reference operator[](size_type idx) const noexcept {
-        assert(idx < this->size());
-        return this->data()[idx];
-    }
-    reference front() const noexcept {
-        return this->data()[0];
-    }
-    reference back() const noexcept {
-        return this->data()[size() - 1];
-    }
-    pointer data() const noexcept {
-        return static_cast<const I<T>*>(this)->_data;
-    }
-
-    // iterator
-#if __cpp_lib_span
-    iterator begin() const noexcept {
-        return span().begin();
-    }
-#else
-    iterator begin() const noexcept {
-        return data();
-    }
-#endif
-    iterator end() const noexcept {
-        return begin() + size();
-    }
-    reverse_iterator rbegin() const noexcept {
-        return reverse_iterator(end());
-    }
-    reverse_iterator rend() const noexcept {
-        return reverse_iterator(begin());
-    }
-
-    _SliceRange<element_type> get() const noexcept {
-        return {data(), size()};
-    }
-
-#if __cpp_lib_span
-    /// Returns the slice as a `std::span`.
-    std::span<element_type> span() const noexcept {
-        return std::span<T>(data(), size());
-    }
-#endif
-};
-
-/// C++ counterpart of Rust `&mut [T]` and &[T]`.
-/// The interface is following `std::span` design.
-template <typename T>
-struct MutSliceRef : public _SliceInterface<T, MutSliceRef> {
-    T* _data;
-    usize _size;
-
-    MutSliceRef() noexcept : _data(EMPTY_SLICE_BEGIN(T)), _size(0) {}
-    MutSliceRef(const MutSliceRef&) = default;
-    MutSliceRef(MutSliceRef&&) = default;
-    explicit MutSliceRef(T* head, usize size) noexcept : _data(_wrap_null(head)), _size(size) {}
-    template <class R>
-    MutSliceRef(SAFE_R range) noexcept : _data(_wrap_null(ranges::data(range))), _size(static_cast<usize>(ranges::size(range))) {}
-
-    MutSliceRef& operator=(const MutSliceRef<T>&) = default;
-    MutSliceRef& operator=(MutSliceRef<T>&&) = default;
-
-    CMutSliceRef<T> into() const noexcept;
-
-    /// Convert &[u8] to C++ string wrapper.
-    /// This is &[u8] specialization as bytes
-    template <typename U = T>
-    std::enable_if_t<std::is_same_v<U, const uint8_t>, CharStrRef> as_char_str() const noexcept;
-
-    /// Convert &[u8] to Rust string wrapper without UTF-8 checking.
-    /// This is &[u8] specialization as bytes
-    ///
-    /// @warning Safety: Only when the data is a valid UTF-8 string.
-    template <typename U = T>
-    std::enable_if_t<std::is_same_v<U, const uint8_t>, StrRef> as_str_unchecked() const noexcept;
-};
-static_assert(std::is_trivially_copyable<MutSliceRef<usize>>::value);
-static_assert(std::is_standard_layout<MutSliceRef<usize>>::value);
-
-/// SliceRef<T> is a read-only slice `&[T]` in Rust and a conceptional alias to `MutSliceRef<const T>` in C++.
-/// This is not a hard alias because:
-/// - template alias doesn't support generic parameter deduction.
-/// - bindgen resolve template alias to the original type, which we don't supposed to do.
-template <typename T>
-struct SliceRef : public MutSliceRef<const T> {
-    SliceRef() noexcept : MutSliceRef<const T>(){};
-    SliceRef(const SliceRef&) = default;
-    SliceRef(SliceRef&&) = default;
-    explicit SliceRef(const T* head, usize size) noexcept : MutSliceRef<const T>(head, size) {}
-    template <class R>
-    SliceRef(SAFE_R range) noexcept : MutSliceRef<const T>(range) {}
-
-    SliceRef& operator=(const SliceRef<T>&) = default;
-    SliceRef& operator=(SliceRef<T>&&) = default;
-
-    typename std::conditional<std::is_same_v<T, uint8_t>, CByteSliceRef, CSliceRef<T>>::type into() const noexcept;
-
-    template <typename B, typename U = T>
-    static std::enable_if_t<std::is_same_v<U, uint8_t>, SliceRef<uint8_t>> from_buffer(const B& buffer) noexcept {
-        return SliceRef<uint8_t>(reinterpret_cast<const uint8_t*>(&buffer), sizeof(B));
-    }
-};
-static_assert(std::is_trivially_copyable<SliceRef<usize>>::value);
-static_assert(std::is_standard_layout<SliceRef<usize>>::value);
-
-/// C++ counterpart of `&[u8]` as alias for `SliceRef<uint8_t>`.
-/// This alias is useful to pass `&[u8]` in cbindgen without configuration and boilerplate.
-using ByteSliceRef = SliceRef<uint8_t>;
+    const T* release() noexcept {
+        auto* ptr = this->_ptr;
+        this->_ptr = nullptr;
+        return ptr;
+    }
+};
+static_assert(sizeof(CArc<int>) == sizeof(int*));
+static_assert(std::is_trivial<CArc<int>>::value);
+static_assert(std::is_standard_layout<CArc<int>>::value);
 
 template <typename T>
 struct CMutSliceRef {
@@ -502,30 +258,18 @@ struct CMutSliceRef {
 #if _MSC_VER
     /// Creates a `CMutSliceRef` from a `MutSliceRef`.
     /// This is a workaround for MSVC constructor limitation.
-    static CMutSliceRef from(const MutSliceRef<T>& slice) noexcept {
-        CMutSliceRef s;
-        s._data = slice._data;
-        s._size = slice._size;
-        return s;
-    }
+    static constexpr CMutSliceRef from(const MutSliceRef<T>& slice) noexcept;
 #else
-    CMutSliceRef(const MutSliceRef<T>& slice) noexcept {
-        this->_data = slice._data;
-        this->_size = slice._size;
-    }
+    constexpr CMutSliceRef(const MutSliceRef<T>& slice) noexcept;
     /// Creates a `CMutSliceRef` from a `MutSliceRef`.
     /// This is a workaround for MSVC constructor limitation.
-    static CMutSliceRef from(const MutSliceRef<T>& slice) noexcept {
-        return CMutSliceRef(slice);
-    }
+    static constexpr CMutSliceRef from(const MutSliceRef<T>& slice) noexcept;
 #endif
 
     T* _data;
     usize _size;
 
-    MutSliceRef<T> operator()() const noexcept {
-        return MutSliceRef<T>(this->_data, this->_size);
-    }
+    constexpr MutSliceRef<T> operator()() const noexcept;
 };
 static_assert(std::is_trivial<CMutSliceRef<usize>>::value);
 static_assert(std::is_standard_layout<CMutSliceRef<usize>>::value);
@@ -539,30 +283,18 @@ struct CSliceRef {
 #if _MSC_VER
     /// Creates a `CSliceRef` from a `SliceRef`.
     /// This is a workaround for MSVC constructor limitation.
-    static CSliceRef from(const SliceRef<T>& slice) noexcept {
-        CSliceRef s;
-        s._data = slice._data;
-        s._size = slice._size;
-        return s;
-    }
+    static constexpr CSliceRef from(const SliceRef<T>& slice) noexcept;
 #else
-    CSliceRef(const SliceRef<T>& slice) noexcept {
-        this->_data = slice._data;
-        this->_size = slice._size;
-    }
+    constexpr CSliceRef(const SliceRef<T>& slice) noexcept;
     /// Creates a `CSliceRef` from a `SliceRef`.
     /// This is a workaround for MSVC constructor limitation.
-    static CSliceRef from(const SliceRef<T>& slice) noexcept {
-        return CSliceRef(slice);
-    }
+    static constexpr CSliceRef from(const SliceRef<T>& slice) noexcept;
 #endif
 
     const T* _data;
     usize _size;
 
-    SliceRef<T> operator()() const noexcept {
-        return SliceRef<T>(this->_data, this->_size);
-    }
+    constexpr SliceRef<T> operator()() const noexcept;
 };
 static_assert(std::is_trivial<CSliceRef<usize>>::value);
 static_assert(std::is_standard_layout<CSliceRef<usize>>::value);
@@ -579,286 +311,166 @@ struct CByteSliceRef {
 #if _MSC_VER
     /// Creates a `CByteSliceRef` from a `ByteSliceRef`.
     /// This is a workaround for MSVC constructor limitation.
-    static CByteSliceRef from(const ByteSliceRef& slice) noexcept {
-        CByteSliceRef s;
-        s._data = slice._data;
-        s._size = slice._size;
-        return s;
-    }
+    static constexpr CByteSliceRef from(const ByteSliceRef& slice) noexcept;
 #else
-    CByteSliceRef(const ByteSliceRef& slice) noexcept {
-        this->_data = slice._data;
-        this->_size = slice._size;
-    }
+    constexpr CByteSliceRef(const ByteSliceRef& slice) noexcept;
     /// Creates a `CByteSliceRef` from a `ByteSliceRef`.
     /// This is a workaround for MSVC constructor limitation.
-    static CByteSliceRef from(const ByteSliceRef& slice) noexcept {
-        return CByteSliceRef(slice);
-    }
+    static constexpr CByteSliceRef from(const ByteSliceRef& slice) noexcept;
 #endif
 
     const uint8_t* _data;
     usize _size;
 
-    ByteSliceRef operator()() const noexcept {
-        ByteSliceRef slice;
-        slice._data = this->_data;
-        slice._size = this->_size;
-        return slice;
-    }
+    ByteSliceRef operator()() const noexcept;
 };
 static_assert(std::is_trivial<CByteSliceRef>::value);
 static_assert(std::is_standard_layout<CByteSliceRef>::value);
 
-/// C++ counterpart of `Box<T>`
-/// The ownership API is following `std::unique_ptr` design and the slice API is following `std::span` design.
+/// C++ wrapper for a boxed slice with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
 template <typename T>
-class BoxedSlice : public MutSliceRef<T> {
-public:
-    BoxedSlice() = delete;
-    BoxedSlice(const BoxedSlice<T>&) = delete;
-    BoxedSlice(BoxedSlice<T>&& s) noexcept : MutSliceRef<T>(s) {
-        s._data = EMPTY_SLICE_BEGIN(T);
-        s._size = 0;
-    }
-    BoxedSlice(std::nullptr_t) noexcept : MutSliceRef<T>() {}
-    ~BoxedSlice() noexcept {
-        if (this->_size > 0) {
-            this->_drop();
-        }
-    }
-    BoxedSlice<T>& operator=(BoxedSlice<T>&& b) noexcept {
-        this->reset(b.release());
-        return *this;
-    }
+struct [[nodiscard]] CBoxedSlice {
+    CBoxedSlice() = _COPY_DELETE;
+    CBoxedSlice(const CBoxedSlice&) = _COPY_DELETE;
+    CBoxedSlice& operator=(const CBoxedSlice<T>&) = _COPY_DELETE;
 
-    void _drop() noexcept;
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedSlice from(BoxedSlice<T>&& slice) noexcept;
+#else
+    CBoxedSlice(CBoxedSlice&&) = default;
+    CBoxedSlice& operator=(CBoxedSlice<T>&&) = default;
+    /// Constructs a `CBoxedSlice` by moving a `BoxedSlice`.
+    CBoxedSlice(BoxedSlice<T>&& slice) noexcept;
 
-    CBoxedSlice<T> into() noexcept;
-    const CBoxedSlice<T>& as_c() const noexcept {
-        return *reinterpret_cast<const CBoxedSlice<T>*>(this);
-    }
-    CBoxedSlice<T>& as_c() noexcept {
-        return *reinterpret_cast<CBoxedSlice<T>*>(this);
-    }
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedSlice from(BoxedSlice<T>&& slice) noexcept;
+#endif
 
-    void reset(_SliceRange<T> s) noexcept {
-        if (this->_size > 0) {
-            this->_drop();
-        }
-        this->_data = s._data;
-        this->_size = s._size;
-    }
+    T* _data;
+    usize _size;
 
-    _SliceRange<T> release() noexcept {
-        const auto range = this->get();
-        this->_data = EMPTY_SLICE_BEGIN(T);
-        this->_size = 0;
-        return range;
-    }
+    /// Conversion operator to `BoxedSlice`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    BoxedSlice<T> operator()() noexcept;
 
-    /// Returns a mutable slice of the boxed slice.
-    auto as_slice() noexcept {
-        return MutSliceRef<T>(this->_data, this->_size);
-    }
+    _SliceRange<T> get() const noexcept;
 
-    /// Returns a read-only slice of the boxed slice.
-    auto as_slice() const noexcept {
-        return SliceRef<T>(this->_data, this->_size);
-    }
+    _SliceRange<T> release() noexcept;
 };
-static_assert(sizeof(usize) * 2 == sizeof(BoxedSlice<int>));
-static_assert(std::is_standard_layout<BoxedSlice<usize>>::value);
+static_assert(std::is_trivial<CBoxedSlice<int>>::value);
+static_assert(std::is_standard_layout<CBoxedSlice<int>>::value);
 
-/// C++ wrapper for a boxed slice with C ABI compatible layout.
+/// C++ wrapper for Rust `Vec<T>` with C ABI compatible layout.
 ///
 /// @warning This type does *NOT* implement a safe destructor.
 ///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
 template <typename T>
-struct [[nodiscard]] CBoxedSlice {
-    CBoxedSlice() = _COPY_DELETE;
-    CBoxedSlice(const CBoxedSlice&) = _COPY_DELETE;
-    CBoxedSlice& operator=(const CBoxedSlice<T>&) = _COPY_DELETE;
+struct [[nodiscard]] CVec {
+    CVec() = _COPY_DELETE;
+    CVec(const CVec&) = _COPY_DELETE;
+    CVec& operator=(const CVec<T>&) = _COPY_DELETE;
 
 #if _MSC_VER
     /// This is a workaround for MSVC constructor limitation.
-    static CBoxedSlice from(BoxedSlice<T>&& slice) noexcept {
-        auto r = slice.release();
-        CBoxedSlice s;
-        s._data = r._data;
-        s._size = r._size;
-        return s;
-    }
+    static CVec from(Vec<T>&& vec) noexcept;
 #else
-    CBoxedSlice(CBoxedSlice&&) = default;
-    CBoxedSlice& operator=(CBoxedSlice<T>&&) = default;
-    /// Constructs a `CBoxedSlice` by moving a `BoxedSlice`.
-    CBoxedSlice(BoxedSlice<T>&& slice) noexcept {
-        auto r = slice.release();
-        this->_data = r._data;
-        this->_size = r._size;
-    }
+    CVec(CVec&&) = default;
+    CVec& operator=(CVec<T>&&) = default;
+    /// Constructs a `CVec` by moving a `Vec`.
+    CVec(Vec<T>&& vec) noexcept;
 
     /// This is a workaround for MSVC constructor limitation.
-    static CBoxedSlice from(BoxedSlice<T>&& slice) noexcept {
-        return CBoxedSlice(std::move(slice));
-    }
+    static CVec from(Vec<T>&& vec) noexcept;
 #endif
 
     T* _data;
     usize _size;
+    usize _capacity;
 
-    /// Conversion operator to `BoxedSlice`.
+    /// Conversion operator to `Vec`.
     ///
     /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
-    BoxedSlice<T> operator()() noexcept {
-        auto slice = BoxedSlice<T>(nullptr);
-        auto r = this->release();
-        slice._data = r._data;
-        slice._size = r._size;
-        return slice;
-    }
-
-    _SliceRange<T> get() const noexcept {
-        return {this->_data, this->_size};
-    }
-
-    _SliceRange<T> release() noexcept {
-        const auto range = this->get();
-        this->_data = EMPTY_SLICE_BEGIN(T);
-        this->_size = 0;
-        return range;
-    }
+    Vec<T> operator()() noexcept;
 };
-static_assert(std::is_trivial<CBoxedSlice<int>>::value);
-static_assert(std::is_standard_layout<CBoxedSlice<int>>::value);
+static_assert(std::is_trivial<CVec<int>>::value);
+static_assert(std::is_standard_layout<CVec<int>>::value);
 
-/// C++ unsafe counterpart of Rust `&str`.
+/// C++ wrapper for Rust `ForeignBoxedSlice<T>` with C ABI compatible layout.
 ///
-/// Because `StrRef` in C++ side doesn't have any UTF-8 validation checking,
-/// `CharStrRef` is an alternative of `StrRef` creation in C++ side.
-/// The value can be converted to either `&[u8]` or `&str` with UTF-8 validation in Rust side.
-struct CharStrRef {
-    CharStrRef() = _COPY_DELETE;
-    CharStrRef(const CharStrRef&) = default;
-    CharStrRef& operator=(const CharStrRef&) = default;
-    // #if !_MSC_VER
-    CharStrRef(const char* head, usize size) noexcept : _data(_wrap_null(head)), _size(size) {}
-    template <class R>
-    CharStrRef(SAFE_R range) noexcept : _data(_wrap_null(ranges::data(range))), _size(ranges::size(range)) {}
-    CharStrRef(std::nullptr_t) noexcept : _data(EMPTY_SLICE_BEGIN(const char)), _size(0) {}
-    // #endif
-
-    const char* _data;
-    usize _size;
-
-    // constants and types
-    using element_type = const char;
-    using value_type = typename std::remove_cv_t<const char>;
-    using size_type = uintptr_t;
-    using difference_type = intptr_t;
-    using pointer = element_type*;
-    using const_pointer = const element_type*;
-    using reference = element_type&;
-    using const_reference = const element_type&;
-    using iterator = typename std::string_view::iterator;
-    using reverse_iterator = std::reverse_iterator<iterator>;
-
-    // observers
-    size_type size() const noexcept {
-        return this->_size;
-    }
-    size_type size_bytes() const noexcept {
-        return this->size() * sizeof(element_type);
-    }
-    bool empty() const noexcept {
-        return this->size() == 0;
-    }
-
-    // element access
-    reference operator[](size_type idx) const noexcept {
-        assert(idx < this->size());
-        return this->data()[idx];
-    }
-    reference front() const noexcept {
-        return this->data()[0];
-    }
-    reference back() const noexcept {
-        return this->data()[size() - 1];
-    }
-    pointer data() const noexcept {
-        return this->_data;
-    }
-
-    // iterator
-    iterator begin() const noexcept {
-        return view().begin();
-    }
-    iterator end() const noexcept {
-        return begin() + size();
-    }
-    reverse_iterator rbegin() const noexcept {
-        return reverse_iterator(end());
-    }
-    reverse_iterator rend() const noexcept {
-        return reverse_iterator(begin());
-    }
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CForeignBoxedSlice {
+    CForeignBoxedSlice() = _COPY_DELETE;
+    CForeignBoxedSlice(const CForeignBoxedSlice&) = _COPY_DELETE;
+    CForeignBoxedSlice& operator=(const CForeignBoxedSlice<T>&) = _COPY_DELETE;
 
-    _SliceRange<element_type> get() const noexcept {
-        return {data(), size()};
-    }
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CForeignBoxedSlice from(ForeignBoxedSlice<T>&& slice) noexcept;
+#else
+    CForeignBoxedSlice(CForeignBoxedSlice&&) = default;
+    CForeignBoxedSlice& operator=(CForeignBoxedSlice<T>&&) = default;
+    /// Constructs a `CForeignBoxedSlice` by moving a `ForeignBoxedSlice`.
+    CForeignBoxedSlice(ForeignBoxedSlice<T>&& slice) noexcept;
 
-#if __cpp_lib_span
-    /// Returns the slice as a `std::span`.
-    std::span<element_type> span() const noexcept {
-        return std::span<element_type>(data(), size());
-    }
+    /// This is a workaround for MSVC constructor limitation.
+    static CForeignBoxedSlice from(ForeignBoxedSlice<T>&& slice) noexcept;
 #endif
 
-    StrRef as_str_unchecked() const noexcept;
+    T* _data;
+    usize _size;
+    /// Same as `ForeignBoxedSlice<T>::drop_fn`.
+    void (*_drop_fn)(void* ctx);
+    void* _ctx;
 
-#if __cpp_lib_string_view
-    /// Constructs a `CharStrRef` from a null-terminated string.
-    CharStrRef(const char* s) noexcept : CharStrRef(std::string_view(s)) {}
+    /// Conversion operator to `ForeignBoxedSlice`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    ForeignBoxedSlice<T> operator()() noexcept;
+};
+static_assert(sizeof(CForeignBoxedSlice<int>) == 4 * sizeof(void*));
+static_assert(std::is_trivial<CForeignBoxedSlice<int>>::value);
+static_assert(std::is_standard_layout<CForeignBoxedSlice<int>>::value);
 
-    /// Returns a `std::string_view` of the string.
-    std::string_view view() const noexcept {
-        return std::string_view(this->data(), this->size());
-    }
+/// C++ wrapper for Rust `MmapSlice` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CMmapSlice {
+    CMmapSlice() = _COPY_DELETE;
+    CMmapSlice(const CMmapSlice&) = _COPY_DELETE;
+    CMmapSlice& operator=(const CMmapSlice&) = _COPY_DELETE;
 
-    /// Conversion operator to `std::string_view`.
-    operator std::string_view() const noexcept {
-        return this->view();
-    }
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CMmapSlice from(MmapSlice&& slice) noexcept;
+#else
+    CMmapSlice(CMmapSlice&&) = default;
+    CMmapSlice& operator=(CMmapSlice&&) = default;
+    /// Constructs a `CMmapSlice` by moving a `MmapSlice`.
+    CMmapSlice(MmapSlice&& slice) noexcept;
 
-    /// Create a `std::string` by copying data.
-    /// @return The newly created `std::string`.
-    std::string to_string() const noexcept {
-        return std::string(this->view());
-    }
+    /// This is a workaround for MSVC constructor limitation.
+    static CMmapSlice from(MmapSlice&& slice) noexcept;
 #endif
-};
-static_assert(sizeof(SliceRef<char>) == sizeof(CharStrRef));
-static_assert(std::is_trivial<CharStrRef>::value);
-static_assert(std::is_standard_layout<CharStrRef>::value);
 
-/// C++ counterpart of Rust `&str`.
-///
-/// Because `StrRef` in C++ side doesn't have any UTF-8 validation checking,
-/// this type is highly recommended to be created from Rust side.
-///
-/// To create `StrRef` in C++ side, use `ByteSliceRef::as_str_unchecked()` or `CharStrRef::as_str_unchecked()`
-/// at your own risk.
-struct StrRef : public CharStrRef {
-    StrRef() = delete;
-    StrRef(const StrRef&) = default;
-    StrRef(const BoxedStr&) noexcept;
-    StrRef(std::nullptr_t) noexcept : CharStrRef(EMPTY_SLICE_BEGIN(const char), 0) {}
+    const uint8_t* _data;
+    usize _size;
 
-    StrRef& operator=(const StrRef&) = default;
+    /// Conversion operator to `MmapSlice`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    MmapSlice operator()() noexcept;
 };
-static_assert(std::is_trivially_copyable<StrRef>::value);
-static_assert(std::is_standard_layout<StrRef>::value);
+static_assert(sizeof(CMmapSlice) == 2 * sizeof(void*));
+static_assert(std::is_trivial<CMmapSlice>::value);
+static_assert(std::is_standard_layout<CMmapSlice>::value);
 
 /// C++ wrapper for a str with C ABI compatible layout.
 struct CStrRef {
@@ -866,72 +478,25 @@ struct CStrRef {
     CStrRef(const CStrRef&) = default;
     CStrRef& operator=(const CStrRef&) = default;
 
-#if !_MSC_VER
-    CStrRef(const StrRef& slice) noexcept {
-        this->_data = slice.data();
-        this->_size = slice.size();
-    }
+#if _MSC_VER
+    /// Creates a `CStrRef` from a `StrRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CStrRef from(const StrRef& slice) noexcept;
+#else
+    constexpr CStrRef(const StrRef& slice) noexcept;
+    /// Creates a `CStrRef` from a `StrRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CStrRef from(const StrRef& slice) noexcept;
 #endif
 
     const char* _data;
     usize _size;
 
-    StrRef operator()() const noexcept {
-        auto s = StrRef(nullptr);
-        s._data = this->_data;
-        s._size = this->_size;
-        return s;
-    }
+    constexpr StrRef operator()() const noexcept;
 };
 static_assert(std::is_trivial<CStrRef>::value);
 static_assert(std::is_standard_layout<CStrRef>::value);
 
-/// C++ counterpart of Rust `Box<str>`.
-class BoxedStr : public StrRef {
-public:
-    BoxedStr() = delete;
-    BoxedStr(BoxedStr&) = delete;
-    BoxedStr(BoxedStr&& s) noexcept : StrRef(s) {
-        s._data = EMPTY_SLICE_BEGIN(const char);
-        s._size = 0;
-    }
-    BoxedStr(std::nullptr_t) noexcept : StrRef(nullptr) {}
-
-    ~BoxedStr() noexcept {
-        if (this->_size > 0) {
-            this->_drop();
-        }
-    }
-
-    BoxedStr& operator=(BoxedStr&& b) noexcept {
-        this->reset(b.release());
-        return *this;
-    }
-
-    void _drop() noexcept;
-
-    void reset(_SliceRange<const char> s) noexcept {
-        if (this->_size > 0) {
-            this->_drop();
-        }
-        this->_data = s._data;
-        this->_size = s._size;
-    }
-
-    _SliceRange<const char> release() noexcept {
-        const auto range = this->get();
-        this->_data = EMPTY_SLICE_BEGIN(const char);
-        this->_size = 0;
-        return range;
-    }
-
-    StrRef as_str() const noexcept {
-        return this->as_str_unchecked();
-    }
-};
-static_assert(sizeof(StrRef) == sizeof(BoxedStr));
-static_assert(std::is_standard_layout<BoxedStr>::value);
-
 /// C++ wrapper for Rust `Box<str>` with C ABI compatible layout.
 ///
 /// @warning This type does *NOT* implement a safe destructor.
@@ -946,54 +511,3093 @@ struct [[nodiscard]] CBoxedStr {
 
 #if _MSC_VER
     /// This is a workaround for MSVC constructor limitation.
-    static CBoxedStr from(BoxedStr&& str) noexcept {
-        auto r = str.release();
-        CBoxedStr s;
-        s._data = r._data;
-        s._size = r._size;
-        return s;
-    }
+    static CBoxedStr from(BoxedStr&& str) noexcept;
 #else
     CBoxedStr(CBoxedStr&&) = default;
     CBoxedStr& operator=(CBoxedStr&&) = default;
-    CBoxedStr(BoxedStr&& str) noexcept {
-        auto r = str.release();
-        this->_data = r._data;
-        this->_size = r._size;
-    }
+    CBoxedStr(BoxedStr&& str) noexcept;
 
     /// This is a workaround for MSVC constructor limitation.
-    static CBoxedStr from(BoxedStr&& slice) noexcept {
-        return CBoxedStr(std::move(slice));
-    }
+    static CBoxedStr from(BoxedStr&& slice) noexcept;
 #endif
 
-    BoxedStr operator()() noexcept {
-        auto slice = BoxedStr(nullptr);
-        auto r = this->release();
-        slice._data = r._data;
-        slice._size = r._size;
-        return slice;
-    }
+    BoxedStr operator()() noexcept;
 
-    _SliceRange<const char> release() noexcept {
-        const auto range = _SliceRange<const char>{_data, _size};
-        this->_data = EMPTY_SLICE_BEGIN(const char);
-        this->_size = 0;
-        return range;
-    }
+    _SliceRange<const char> release() noexcept;
 };
 static_assert(std::is_trivial<CBoxedStr>::value);
 static_assert(std::is_standard_layout<CBoxedStr>::value);
 
-template <typename T>
-inline CMutSliceRef<T> MutSliceRef<T>::into() const noexcept {
-    return CMutSliceRef<T>::from(*this);
-}
+/// C++ wrapper for Rust `CompactStr` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CCompactStr {
+    CCompactStr() = _COPY_DELETE;
+    CCompactStr(const CCompactStr&) = _COPY_DELETE;
+    CCompactStr& operator=(const CCompactStr&) = _COPY_DELETE;
 
-template <typename T>
-inline typename std::conditional<std::is_same_v<T, uint8_t>, CByteSliceRef, CSliceRef<T>>::type SliceRef<T>::into()
-        const noexcept {
+    const char* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CCompactStr from(CompactStr&& str) noexcept;
+#else
+    CCompactStr(CCompactStr&&) = default;
+    CCompactStr& operator=(CCompactStr&&) = default;
+    CCompactStr(CompactStr&& str) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CCompactStr from(CompactStr&& str) noexcept;
+#endif
+
+    CompactStr operator()() noexcept;
+
+    /// A heap string is a `BoxedStr`, which is counted by `FFI_TYPES_INSTRUMENT`.
+    bool _is_heap() const noexcept;
+};
+static_assert(std::is_trivial<CCompactStr>::value);
+static_assert(std::is_standard_layout<CCompactStr>::value);
+
+/// C++ wrapper for Rust `&CStr` with C ABI compatible layout.
+struct CStrZRef {
+    CStrZRef() = _COPY_DELETE;
+    CStrZRef(const CStrZRef&) = default;
+    CStrZRef& operator=(const CStrZRef&) = default;
+
+#if _MSC_VER
+    /// Creates a `CStrZRef` from a `StrZRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CStrZRef from(const StrZRef& s) noexcept;
+#else
+    constexpr CStrZRef(const StrZRef& s) noexcept;
+    /// Creates a `CStrZRef` from a `StrZRef`.
+    /// This is a workaround for MSVC constructor limitation.
+    static constexpr CStrZRef from(const StrZRef& s) noexcept;
+#endif
+
+    const char* _data;
+    usize _size;
+
+    constexpr StrZRef operator()() const noexcept;
+};
+static_assert(std::is_trivial<CStrZRef>::value);
+static_assert(std::is_standard_layout<CStrZRef>::value);
+
+/// C++ wrapper for Rust `Box<CStr>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CBoxedCStr {
+    CBoxedCStr() = _COPY_DELETE;
+    CBoxedCStr(const CBoxedCStr&) = _COPY_DELETE;
+    CBoxedCStr& operator=(const CBoxedCStr&) = _COPY_DELETE;
+
+    const char* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedCStr from(BoxedCStr&& str) noexcept;
+#else
+    CBoxedCStr(CBoxedCStr&&) = default;
+    CBoxedCStr& operator=(CBoxedCStr&&) = default;
+    CBoxedCStr(BoxedCStr&& str) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CBoxedCStr from(BoxedCStr&& str) noexcept;
+#endif
+
+    BoxedCStr operator()() noexcept;
+
+    _SliceRange<const char> release() noexcept;
+};
+static_assert(std::is_trivial<CBoxedCStr>::value);
+static_assert(std::is_standard_layout<CBoxedCStr>::value);
+
+/// C++ wrapper for Rust `SliceSender<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CSliceSender {
+    CSliceSender() = _COPY_DELETE;
+    CSliceSender(const CSliceSender&) = _COPY_DELETE;
+    CSliceSender& operator=(const CSliceSender&) = _COPY_DELETE;
+
+    _ChannelInner<T>* _inner;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CSliceSender from(SliceSender<T>&& sender) noexcept;
+#else
+    CSliceSender(CSliceSender&&) = default;
+    CSliceSender& operator=(CSliceSender&&) = default;
+    CSliceSender(SliceSender<T>&& sender) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CSliceSender from(SliceSender<T>&& sender) noexcept;
+#endif
+
+    /// Conversion operator to `SliceSender<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    SliceSender<T> operator()() noexcept;
+};
+static_assert(sizeof(CSliceSender<int>) == sizeof(void*));
+static_assert(std::is_trivial<CSliceSender<int>>::value);
+static_assert(std::is_standard_layout<CSliceSender<int>>::value);
+
+/// C++ wrapper for Rust `SliceReceiver<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CSliceReceiver {
+    CSliceReceiver() = _COPY_DELETE;
+    CSliceReceiver(const CSliceReceiver&) = _COPY_DELETE;
+    CSliceReceiver& operator=(const CSliceReceiver&) = _COPY_DELETE;
+
+    _ChannelInner<T>* _inner;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CSliceReceiver from(SliceReceiver<T>&& receiver) noexcept;
+#else
+    CSliceReceiver(CSliceReceiver&&) = default;
+    CSliceReceiver& operator=(CSliceReceiver&&) = default;
+    CSliceReceiver(SliceReceiver<T>&& receiver) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CSliceReceiver from(SliceReceiver<T>&& receiver) noexcept;
+#endif
+
+    /// Conversion operator to `SliceReceiver<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    SliceReceiver<T> operator()() noexcept;
+};
+static_assert(sizeof(CSliceReceiver<int>) == sizeof(void*));
+static_assert(std::is_trivial<CSliceReceiver<int>>::value);
+static_assert(std::is_standard_layout<CSliceReceiver<int>>::value);
+
+/// C++ wrapper for Rust `CowStr` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CCowStr {
+    CCowStr() = _COPY_DELETE;
+    CCowStr(const CCowStr&) = _COPY_DELETE;
+    CCowStr& operator=(const CCowStr&) = _COPY_DELETE;
+
+    const char* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CCowStr from(CowStr&& str) noexcept;
+#else
+    CCowStr(CCowStr&&) = default;
+    CCowStr& operator=(CCowStr&&) = default;
+    CCowStr(CowStr&& str) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CCowStr from(CowStr&& str) noexcept;
+#endif
+
+    CowStr operator()() noexcept;
+};
+static_assert(std::is_trivial<CCowStr>::value);
+static_assert(std::is_standard_layout<CCowStr>::value);
+
+/// C++ wrapper for Rust `CowSlice<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CCowSlice {
+    CCowSlice() = _COPY_DELETE;
+    CCowSlice(const CCowSlice&) = _COPY_DELETE;
+    CCowSlice& operator=(const CCowSlice&) = _COPY_DELETE;
+
+    const T* _data;
+    usize _size;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CCowSlice from(CowSlice<T>&& slice) noexcept;
+#else
+    CCowSlice(CCowSlice&&) = default;
+    CCowSlice& operator=(CCowSlice&&) = default;
+    CCowSlice(CowSlice<T>&& slice) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CCowSlice from(CowSlice<T>&& slice) noexcept;
+#endif
+
+    CowSlice<T> operator()() noexcept;
+};
+static_assert(std::is_trivial<CCowSlice<int>>::value);
+static_assert(std::is_standard_layout<CCowSlice<int>>::value);
+
+/// C++ wrapper for Rust `Arena` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+struct [[nodiscard]] CArena {
+    CArena() = _COPY_DELETE;
+    CArena(const CArena&) = _COPY_DELETE;
+    CArena& operator=(const CArena&) = _COPY_DELETE;
+
+    _ArenaHeader* _inner;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CArena from(Arena&& arena) noexcept;
+#else
+    CArena(CArena&&) = default;
+    CArena& operator=(CArena&&) = default;
+    CArena(Arena&& arena) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CArena from(Arena&& arena) noexcept;
+#endif
+
+    /// Conversion operator to `Arena`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    Arena operator()() noexcept;
+};
+static_assert(sizeof(CArena) == sizeof(void*));
+static_assert(std::is_trivial<CArena>::value);
+static_assert(std::is_standard_layout<CArena>::value);
+
+/// C-prefixed types of which the first field is a data pointer never null for a valid value.
+/// Same as Rust `NullNiche`.
+template <typename T>
+struct _HasNullNiche : std::false_type {};
+template <typename T>
+struct _HasNullNiche<CSliceRef<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CMutSliceRef<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CBoxedSlice<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CVec<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CForeignBoxedSlice<T>> : std::true_type {};
+template <typename T>
+struct _HasNullNiche<CArc<T>> : std::true_type {};
+template <>
+struct _HasNullNiche<CByteSliceRef> : std::true_type {};
+template <>
+struct _HasNullNiche<CharStrRef> : std::true_type {};
+template <>
+struct _HasNullNiche<CStrRef> : std::true_type {};
+template <>
+struct _HasNullNiche<CBoxedStr> : std::true_type {};
+
+/// C++ wrapper for Rust `COption<T>` with the layout of `T`.
+///
+/// A null data pointer of `T` stands for none, so `COption<CBoxedSlice<T>>` is still 2 words
+/// and returned in registers.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] COption {
+    static_assert(_HasNullNiche<T>::value, "T must be a C-prefixed type with a non-null data pointer");
+
+    COption() = _COPY_DELETE;
+    COption(const COption&) = _COPY_DELETE;
+    COption& operator=(const COption&) = _COPY_DELETE;
+
+    union {
+        T _value;
+        /// The data pointer of `T`, which is null for none.
+        const void* _niche;
+    };
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static COption from(T&& value) noexcept;
+
+    static COption none() noexcept;
+#else
+    COption(COption&&) = default;
+    COption& operator=(COption&&) = default;
+    COption(T&& value) noexcept;
+    COption(std::nullptr_t) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static COption from(T&& value) noexcept;
+
+    static COption none() noexcept;
+#endif
+
+    bool is_some() const noexcept;
+    explicit operator bool() const noexcept {
+        return this->is_some();
+    }
+
+    /// Borrows the value. Call `operator()()` of the value to own it.
+    T& unwrap() noexcept;
+
+    /// Conversion operator to `std::optional` of the owned type of `T`, e.g. `BoxedSlice<T>` for `CBoxedSlice<T>`.
+    /// The value of `this` will be invalidated to none.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    auto operator()() noexcept;
+};
+static_assert(sizeof(COption<CBoxedSlice<int>>) == sizeof(CBoxedSlice<int>));
+static_assert(std::is_trivial<COption<CBoxedSlice<int>>>::value);
+static_assert(std::is_standard_layout<COption<CBoxedSlice<int>>>::value);
+
+/// C++ wrapper for Rust `CResult<T, E>`, a tagged union of `T` and `E`.
+///
+/// The tag is a byte before the union, so a result of 2-word `T` is 3 words and returned through memory.
+/// Use `COption<T>` with an out-parameter of the error to return in registers.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T, typename E>
+struct [[nodiscard]] CResult {
+    enum class Tag : uint8_t {
+        Ok = 0,
+        Err = 1,
+    };
+
+    CResult() = _COPY_DELETE;
+    CResult(const CResult&) = _COPY_DELETE;
+    CResult& operator=(const CResult&) = _COPY_DELETE;
+
+    Tag _tag;
+    union {
+        T _ok;
+        E _err;
+    };
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CResult ok(T&& value) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CResult err(E&& error) noexcept;
+#else
+    CResult(CResult&&) = default;
+    CResult& operator=(CResult&&) = default;
+
+    static CResult ok(T&& value) noexcept;
+
+    static CResult err(E&& error) noexcept;
+
+private:
+    CResult(Tag tag, T&& value) noexcept;
+    CResult(E&& error) noexcept;
+
+public:
+#endif
+
+    bool is_ok() const noexcept {
+        return this->_tag == Tag::Ok;
+    }
+    bool is_err() const noexcept {
+        return this->_tag == Tag::Err;
+    }
+
+    /// Borrows the `Ok` value. Call `operator()()` of the value to own it.
+    T& unwrap() noexcept;
+
+    /// Borrows the `Err` value. Call `operator()()` of the value to own it.
+    E& unwrap_err() noexcept;
+};
+static_assert(sizeof(CResult<uint32_t, int32_t>) == 2 * sizeof(uint32_t));
+static_assert(sizeof(CResult<CBoxedSlice<int>, int32_t>) == 3 * sizeof(usize));
+static_assert(std::is_trivial<CResult<CBoxedSlice<int>, int32_t>>::value);
+static_assert(std::is_standard_layout<CResult<CBoxedSlice<int>, int32_t>>::value);
+
+/// C++ wrapper for Rust `RustFuture<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CRustFuture {
+    CRustFuture() = _COPY_DELETE;
+    CRustFuture(const CRustFuture&) = _COPY_DELETE;
+    CRustFuture& operator=(const CRustFuture&) = _COPY_DELETE;
+
+    void* _state;
+    const _FutureVTable<T>* _vtable;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CRustFuture from(RustFuture<T>&& future) noexcept;
+#else
+    CRustFuture(CRustFuture&&) = default;
+    CRustFuture& operator=(CRustFuture&&) = default;
+    CRustFuture(RustFuture<T>&& future) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CRustFuture from(RustFuture<T>&& future) noexcept;
+#endif
+
+    /// Conversion operator to `RustFuture<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    RustFuture<T> operator()() noexcept;
+};
+static_assert(sizeof(CRustFuture<int>) == 2 * sizeof(void*));
+static_assert(std::is_trivial<CRustFuture<int>>::value);
+static_assert(std::is_standard_layout<CRustFuture<int>>::value);
+
+/// C++ wrapper for Rust `RustIter<T>` with C ABI compatible layout.
+///
+/// @warning This type does *NOT* implement a safe destructor.
+///          To avoid leak, see general note about C-prefixed types at the top of module documentation.
+template <typename T>
+struct [[nodiscard]] CRustIter {
+    CRustIter() = _COPY_DELETE;
+    CRustIter(const CRustIter&) = _COPY_DELETE;
+    CRustIter& operator=(const CRustIter&) = _COPY_DELETE;
+
+    void* _state;
+    const _IterVTable<T>* _vtable;
+
+#if _MSC_VER
+    /// This is a workaround for MSVC constructor limitation.
+    static CRustIter from(RustIter<T>&& iter) noexcept;
+#else
+    CRustIter(CRustIter&&) = default;
+    CRustIter& operator=(CRustIter&&) = default;
+    CRustIter(RustIter<T>&& iter) noexcept;
+
+    /// This is a workaround for MSVC constructor limitation.
+    static CRustIter from(RustIter<T>&& iter) noexcept;
+#endif
+
+    /// Conversion operator to `RustIter<T>`.
+    ///
+    /// @note This conversion *MUST* be called unless the value is going to be passed to Rust side.
+    RustIter<T> operator()() noexcept;
+};
+static_assert(sizeof(CRustIter<int>) == 2 * sizeof(void*));
+static_assert(std::is_trivial<CRustIter<int>>::value);
+static_assert(std::is_standard_layout<CRustIter<int>>::value);
+
+#undef _COPY_DELETE
+
+}  // namespace ffi_types
+
+#endif  // FFI_TYPES_RUST_TYPES_FWD
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+#if __cpp_lib_ranges
+#include <ranges>
+#endif
+#if __cpp_lib_string_view
+#include <string_view>
+#endif
+#if __cpp_lib_span
+#include <span>
+#endif
+#include <type_traits>
+#if __cpp_impl_three_way_comparison
+#include <compare>
+#endif
+#if __cpp_impl_coroutine
+#include <coroutine>
+#endif
+#if __unix__ || __APPLE__
+#include <sys/uio.h>
+#endif
+#if FFI_TYPES_PARALLEL
+#include <execution>
+#endif
+#if __AVX2__
+#include <immintrin.h>
+#elif __SSE2__ || _M_X64
+#include <emmintrin.h>
+#elif __ARM_NEON
+#include <arm_neon.h>
+#endif
+#if _MSC_VER
+#include <intrin.h>
+#endif
+
+//! @file rust_types.hh
+//! @brief This file contains matching C++ types for `ffi_types` crate.
+//!
+//! The types can be used for either bindgen, cbindgen or hand-crafted C/C++ code.
+//! The types without C-prefixes are ownership-aware types compatible with Rust types.
+//! The types with C-prefixes are C ABI compatible layout of its paired owned types.
+//! C-prefixes types are very fragile! Please read the following warning to use it safe.
+//!
+//! @warning All types prefixed with `C` in this file are C ABI compatible layout of owned types without `C` prefix.
+//!          To avoid memory leak, you must convert it to owned type or pass it to Rust side.
+//!          You *MUST* run one of the following to avoid memory leak:
+//!
+//!          1. Calling operator() to convert to owned type.
+//!             1.1 When used in bindgen generated functions' arguments.
+//!             ```c++
+//!             void foo(CBoxedSlice<uint32_t> ints) {
+//!                 auto owned = ints();  // owned is managed as BoxedSlice<uint32_t>
+//!             }
+//!             ```
+//!
+//!             1.2 When used in cbindgen generated functions' return value.
+//!             ```rust
+//!             fn foo() -> CBoxedSlice<u32> { ... }
+//!             ```
+//!             ```c++
+//!             auto owned = foo()();  // owned is managed as BoxedSlice<uint32_t>
+//!             ```
+//!
+//!             1.3 Dropping in C++ side.
+//!             The owned value in either 1.1 or 1.2 must be returned to Rust side or dropped.
+//!             See 2.1 to return value.
+//!             Implement template specialization for `_drop()` for the related type to drop it in C++ side.
+//!             (e.g. BoxedSlice<uint32_t>::_drop() for BoxedSlice<uint32_t>)
+//!             The _drop function must call `std::mem::drop()` from rust side.
+//!
+//!          2. Passing as an argument of Rust function.
+//!             2.1 When used in cbindgen generated functions' arguments.
+//!             ```rust
+//!             fn foo() -> CBoxedSlice<u32> { ... }   // See 1.2 for this case
+//!             fn bar(ints: CBoxedSlice<u32>) { ... }
+//!             ```
+//!             ```c++
+//!             auto owned = foo()();  // owned is managed as BoxedSlice<uint32_t>
+//!             bar(owned);  // BoxedSlice can be passed to CBoxedSlice
+//!             ```
+//!
+//!          3. Returning from C++ function. Note that this case will be very unlikely to happen because Box must be
+//!          created from Rust side.
+//!
+//! @note A boxed type must be allocated by the Rust global allocator. Memory from `new` or `malloc` is not allowed.
+//!       To allocate a boxed type in C++ side, use `BoxedSlice<T>::with_capacity_uninit()`
+//!       or `BoxedStr::from_utf8_copy()`.
+//!
+//! @note Define `FFI_TYPES_INLINE_DEALLOC` to 1 to drop `BoxedStr`, `BoxedSlice<T>` and `Vec<T>` in the header.
+//!       The memory is freed by `_rust_ffi_dealloc()` with the layout from `sizeof(T)` and `alignof(T)`,
+//!       so no `_drop()` specialization is needed for a trivially destructible `T`.
+//!       The C++ layout of `T` must match the Rust layout and the Rust type must not implement `Drop`.
+//!       With cross-language LTO, the whole drop is inlined to a call of the Rust global allocator.
+//!
+//! @note Define `FFI_TYPES_PARALLEL` to 1 to run `par_for_each_chunk()` by `std::execution::par`.
+//!       The standard library may need a parallel backend to link, e.g. `-ltbb` for libstdc++.
+//!
+//! @note Define `FFI_TYPES_POINTER_ITERATOR` to 1 to make `iterator` of every slice and string type a raw pointer
+//!       instead of `std::span<T>::iterator` or `std::string_view::iterator`, which may be checked iterators in
+//!       debug builds. A pointer is a contiguous iterator in every standard, so std algorithms like `std::find()`
+//!       and `std::copy()` can be lowered to `memchr()` and `memmove()`.
+//!
+//! @note Define `FFI_TYPES_INSTRUMENT` to 1 to count values of `BoxedStr`, `BoxedSlice<T>` and `OptionBox<T>`
+//!       taken by `operator()()` of C-prefixed types or C++ allocations, then given up by `into()`, `release()`
+//!       or `_drop()`. `instrument::snapshot()` sums the counters of every thread to find leaks of C-prefixed
+//!       values. Rust side must be built with `instrument` feature. Without the flag, counting compiles to nothing.
+//!
+//! @warning `FFI_TYPES_INLINE_DEALLOC` changes the bodies of inline functions, `FFI_TYPES_INSTRUMENT` those of
+//!          the constructors, destructors, `into()` and `release()` of owned types, `FFI_TYPES_PARALLEL` that of
+//!          `par_for_each_chunk()`, and `FFI_TYPES_POINTER_ITERATOR` changes the `iterator` types, so each must be
+//!          defined the same in every translation unit of a program. Mixing the settings is an ODR violation.
+
+#ifndef FFI_TYPES_INLINE_DEALLOC
+#define FFI_TYPES_INLINE_DEALLOC 0
+#endif
+#ifndef FFI_TYPES_PARALLEL
+#define FFI_TYPES_PARALLEL 0
+#endif
+#ifndef FFI_TYPES_POINTER_ITERATOR
+#define FFI_TYPES_POINTER_ITERATOR 0
+#endif
+#ifndef FFI_TYPES_INSTRUMENT
+#define FFI_TYPES_INSTRUMENT 0
+#endif
+
+#if _MSC_VER
+#define _COPY_DELETE default
+#else
+#define _COPY_DELETE delete
+#endif
+namespace ffi_types {
+
+/// Counters of a C++ owned type. Same as Rust `instrument::OwnershipStats`.
+struct OwnershipStats {
+    /// Values taken by C++ owned types, e.g. by `operator()()` of C-prefixed types or C++ allocations.
+    uint64_t acquired;
+    /// Values converted to C-prefixed types by `into()`, e.g. to be passed to Rust side.
+    uint64_t into;
+    /// Values given up by `release()`.
+    uint64_t released;
+    /// Values dropped by `_drop()`.
+    uint64_t dropped;
+    /// Values owned by C++ side now.
+    int64_t live;
+    /// Bytes of values owned by C++ side now. Values of `OptionBox<T>` have no bytes because `T` may be opaque.
+    int64_t live_bytes;
+};
+
+/// Counters of every C++ owned type summed over all threads. Same as Rust `instrument::OwnershipSnapshot`.
+struct OwnershipSnapshot {
+    OwnershipStats boxed_str;
+    OwnershipStats boxed_slice;
+    OwnershipStats option_box;
+};
+
+/// Counters of a thread indexed by type and event. Same as Rust `instrument::OwnershipShard`.
+/// Only the owner thread writes a shard.
+struct alignas(64) OwnershipShard {
+    std::atomic<uint64_t> counters[3][5];
+};
+static_assert(sizeof(OwnershipShard) == 2 * 64);
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t));
+
+namespace instrument {
+
+enum class _Kind : usize {
+    boxed_str = 0,
+    boxed_slice = 1,
+    option_box = 2,
+};
+
+enum class _Event : usize {
+    acquired = 0,
+    into = 1,
+    released = 2,
+    dropped = 3,
+    live_bytes = 4,
+};
+
+#if FFI_TYPES_INSTRUMENT
+/// Set while `_drop()` runs not to count `into()` or `release()` called by `_drop()` again.
+inline thread_local bool _dropping = false;
+inline thread_local OwnershipShard* _shard = nullptr;
+
+inline OwnershipShard& _thread_shard() noexcept;
+
+inline void _add(_Kind kind, _Event event, uint64_t n) noexcept {
+    auto& counter = _thread_shard().counters[static_cast<usize>(kind)][static_cast<usize>(event)];
+    // Only the current thread writes its shard, so a relaxed load and store are enough.
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/// Sums the counters of every thread. Rust side must be built with `instrument` feature.
+inline OwnershipSnapshot snapshot() noexcept;
+#endif
+
+/// Counts a value of `bytes` bytes taken by a C++ owned type.
+inline void _acquire(_Kind kind, bool owned, usize bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+    if (owned) {
+        _add(kind, _Event::acquired, 1);
+        _add(kind, _Event::live_bytes, bytes);
+    }
+#else
+    (void)kind, (void)owned, (void)bytes;
+#endif
+}
+
+/// Counts a value of `bytes` bytes given up by `into()` or `release()` out of `_drop()`.
+inline void _give_up(_Kind kind, _Event event, bool owned, usize bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+    if (owned && !_dropping) {
+        _add(kind, event, 1);
+        _add(kind, _Event::live_bytes, -static_cast<uint64_t>(bytes));
+    }
+#else
+    (void)kind, (void)event, (void)owned, (void)bytes;
+#endif
+}
+
+/// Counts a drop of a value of `bytes` bytes.
+inline void _dropped(_Kind kind, bool owned, usize bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+    if (owned) {
+        _add(kind, _Event::dropped, 1);
+        _add(kind, _Event::live_bytes, -static_cast<uint64_t>(bytes));
+    }
+#else
+    (void)kind, (void)owned, (void)bytes;
+#endif
+}
+
+/// Counts a reallocation of a value. An empty value is not owned.
+inline void _resize(_Kind kind, usize old_bytes, usize new_bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+    if (old_bytes == 0) {
+        _acquire(kind, new_bytes > 0, new_bytes);
+        return;
+    }
+    if (new_bytes == 0) {
+        _dropped(kind, true, old_bytes);
+        return;
+    }
+    _add(kind, _Event::live_bytes, static_cast<uint64_t>(new_bytes) - old_bytes);
+#else
+    (void)kind, (void)old_bytes, (void)new_bytes;
+#endif
+}
+
+/// Counts a drop of a value of `bytes` bytes while `_drop()` runs in the scope.
+class _DropScope {
+public:
+    _DropScope(_Kind kind, usize bytes) noexcept {
+#if FFI_TYPES_INSTRUMENT
+        _dropped(kind, true, bytes);
+        this->_previous = _dropping;
+        _dropping = true;
+#else
+        (void)kind, (void)bytes;
+#endif
+    }
+    _DropScope(const _DropScope&) = delete;
+    _DropScope& operator=(const _DropScope&) = delete;
+#if FFI_TYPES_INSTRUMENT
+    ~_DropScope() noexcept {
+        _dropping = this->_previous;
+    }
+
+private:
+    bool _previous;
+#endif
+};
+
+}  // namespace instrument
+
+}  // namespace ffi_types
+namespace ffi_types {
+
+template <typename T>
+struct CBox;
+
+/// C++ counterpart for Rust `Option<Box<T>>` managed by C++ ownership model.
+//
+/// The API design is similar to `std::unique_ptr`, though construction and destruction
+/// must be executed in Rust side.
+///
+/// @warning The underlying memory must be allocated from Rust side.
+template <typename T>
+struct OptionBox {
+    using element_type = T;
+    using pointer = T*;
+
+    T* _ptr;
+
+    // constructors
+    OptionBox() = delete;
+    OptionBox(OptionBox&) = delete;
+    OptionBox(OptionBox&& b) noexcept : _ptr(b._take()) {}
+    explicit OptionBox(std::nullptr_t) noexcept : _ptr(nullptr) {}
+
+    explicit OptionBox(pointer p) noexcept : _ptr(p) {
+        instrument::_acquire(instrument::_Kind::option_box, p != nullptr, 0);
+    }
+
+    // destructor and helper
+    ~OptionBox() noexcept {
+        if (this->get()) {
+            instrument::_DropScope scope(instrument::_Kind::option_box, 0);
+            this->_drop();
+        }
+    }
+    void _drop() noexcept;
+
+    // assignment
+    OptionBox& operator=(OptionBox&& b) noexcept {
+        this->_ptr = b._take();
+        return *this;
+    }
+
+    /// Converts to `CBox<T>` by moving the value.
+    /// The value of `this` will be invalidated to null.
+    CBox<T> into() noexcept;
+
+    /// Borrow as `CBox<T>`.
+    /// This is safe because CBox is a reference.
+    CBox<T>& as_c() noexcept {
+        return *reinterpret_cast<CBox<T>*>(this);
+    }
+
+    /// Borrow as `CBox<T>`.
+    /// This is safe because CBox is a reference.
+    const CBox<T>& as_c() const noexcept {
+        return *reinterpret_cast<const CBox<T>*>(this);
+    }
+
+    // observers
+    typename std::add_lvalue_reference<element_type>::type operator*() const {
+        return *get();
+    }
+    pointer operator->() const {
+        return get();
+    }
+    pointer get() const {
+        return this->_ptr;
+    }
+    explicit operator bool() const noexcept {
+        return get() != nullptr;
+    }
+
+    // operators
+    bool operator==(std::nullptr_t) const {
+        return this->get() == nullptr;
+    }
+    bool operator!=(std::nullptr_t) const {
+        return this->get() != nullptr;
+    }
+
+    // modifiers
+    T* release() noexcept {
+        instrument::_give_up(instrument::_Kind::option_box, instrument::_Event::released, this->get() != nullptr, 0);
+        return this->_take();
+    }
+    void reset(pointer p) noexcept {
+        if (this->get()) {
+            instrument::_DropScope scope(instrument::_Kind::option_box, 0);
+            this->_drop();
+        }
+        instrument::_acquire(instrument::_Kind::option_box, p != nullptr, 0);
+        this->_ptr = p;
+    }
+
+    /// Same as `release()` but the ownership stays in C++ side, e.g. moved to another owned value.
+    T* _take() noexcept {
+        auto* ptr = this->_ptr;
+        this->_ptr = 0;
+        return ptr;
+    }
+};
+static_assert(sizeof(OptionBox<int>) == sizeof(int*));
+static_assert(std::is_standard_layout<OptionBox<int>>::value);
+
+/// C++ counterpart for Rust `Box<T>` as alias of `OptionBox<T>`.
+/// Since `Box<T>` can be moved or released, a value of this type is still not guaranteed to be non-null.
+///
+/// @warning The underlying memory must be allocated from Rust side.
+template <typename T>
+struct Box : public OptionBox<T> {
+    explicit Box(T* p) noexcept : OptionBox<T>(p) {
+        assert(p != nullptr);
+    }
+};
+
+template <typename T>
+inline CBox<T> OptionBox<T>::into() noexcept {
+    return CBox<T>::from(std::move(*this));
+}
+
+template <typename T>
+struct CArc;
+
+/// C++ counterpart for Rust `std::sync::Arc<T>` sharing the reference count with Rust side.
+///
+/// Copying and destroying a non-last reference update the counter of Rust `ArcInner<T>` inline.
+/// Only the last reference crosses the FFI boundary by `_drop()`.
+/// Like `OptionBox<T>`, a moved value is a null.
+///
+/// @warning The underlying memory must be allocated by Rust `Arc::new()`.
+///          Implement template specialization for `_drop()`, which must call `std::mem::drop()` from Rust side.
+template <typename T>
+struct Arc {
+    using element_type = const T;
+    using pointer = const T*;
+
+    const T* _ptr;
+
+    // constructors
+    Arc() = delete;
+    Arc(const Arc& a) noexcept : _ptr(a._ptr) {
+        if (this->_ptr) {
+            this->_increment();
+        }
+    }
+    Arc(Arc&& a) noexcept : _ptr(a.release()) {}
+    explicit Arc(std::nullptr_t) noexcept : _ptr(nullptr) {}
+
+    /// Takes a reference owned by the return value of Rust `Arc::into_raw()`.
+    explicit Arc(pointer p) noexcept : _ptr(p) {}
+
+    // destructor and helper
+    ~Arc() noexcept {
+        if (this->get()) {
+            this->_release();
+        }
+    }
+    void _drop() noexcept;
+
+    /// The strong counter of Rust `ArcInner<T>`, which is `#[repr(C)] { strong, weak, data }`.
+    std::atomic<usize>& _strong() const noexcept {
+        constexpr usize offset = (2 * sizeof(usize) + alignof(T) - 1) / alignof(T) * alignof(T);
+        auto* inner = reinterpret_cast<const char*>(this->_ptr) - offset;
+        return *reinterpret_cast<std::atomic<usize>*>(const_cast<char*>(inner));
+    }
+
+    void _increment() const noexcept {
+        // Same as Rust `Arc::clone()`, which aborts before the counter overflows.
+        auto old = this->_strong().fetch_add(1, std::memory_order_relaxed);
+        if (old > static_cast<usize>(INTPTR_MAX)) {
+            std::abort();
+        }
+    }
+
+    void _release() noexcept {
+        auto& strong = this->_strong();
+        auto count = strong.load(std::memory_order_relaxed);
+        while (count > 1) {
+            if (strong.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed)) {
+                this->_ptr = nullptr;
+                return;
+            }
+        }
+        // The last reference. Rust side decrements it again with the proper fences and frees the memory.
+        this->_drop();
+    }
+
+    // assignment
+    Arc& operator=(const Arc& a) noexcept {
+        if (this != &a) {
+            *this = Arc(a);
+        }
+        return *this;
+    }
+    Arc& operator=(Arc&& a) noexcept {
+        this->reset(a.release());
+        return *this;
+    }
+
+    /// Converts to `CArc<T>` by moving the value.
+    /// The value of `this` will be invalidated to null.
+    CArc<T> into() noexcept;
+
+    // observers
+    const T& operator*() const {
+        return *get();
+    }
+    pointer operator->() const {
+        return get();
+    }
+    pointer get() const {
+        return this->_ptr;
+    }
+    explicit operator bool() const noexcept {
+        return get() != nullptr;
+    }
+    /// Same as Rust `Arc::strong_count()`.
+    usize strong_count() const noexcept {
+        return this->_strong().load(std::memory_order_relaxed);
+    }
+
+    // operators
+    bool operator==(std::nullptr_t) const {
+        return this->get() == nullptr;
+    }
+    bool operator!=(std::nullptr_t) const {
+        return this->get() != nullptr;
+    }
+
+    // modifiers
+    pointer release() noexcept {
+        auto* ptr = this->_ptr;
+        this->_ptr = nullptr;
+        return ptr;
+    }
+    void reset(pointer p) noexcept {
+        if (this->get()) {
+            this->_release();
+        }
+        this->_ptr = p;
+    }
+};
+static_assert(sizeof(Arc<int>) == sizeof(int*));
+static_assert(std::is_standard_layout<Arc<int>>::value);
+static_assert(sizeof(std::atomic<usize>) == sizeof(usize));
+
+template <typename T>
+inline CArc<T> Arc<T>::into() noexcept {
+    return CArc<T>::from(std::move(*this));
+}
+
+// specializations to prohibit void box drop
+template <>
+inline void OptionBox<void>::_drop() noexcept {
+    assert("void box doesn't support drop" && false);
+}
+
+}  // namespace ffi_types
+namespace ffi_types {
+
+#define EMPTY_SLICE_BEGIN(T) reinterpret_cast<T*>(1)
+
+template <typename T>
+constexpr T* _wrap_null(T* ptr) noexcept {
+    return ptr ? ptr : reinterpret_cast<T*>(1);
+}
+
+// C++ std::ranges compatibility layer until C++17.
+#if __cpp_lib_ranges
+namespace ranges {
+using std::ranges::data;
+using std::ranges::size;
+}  // namespace ranges
+#define SAFE_R R&&
+#else
+namespace ranges {
+template <typename C>
+auto _data_from_begin(C& x) noexcept {
+    auto begin = x.begin();
+
+    using iterator_type = decltype(begin);
+    using pointer_type = decltype(&*begin);
+
+    if constexpr (std::is_same_v<iterator_type, pointer_type>) {
+        // same type
+        return begin;
+    } else if constexpr (sizeof(iterator_type) == sizeof(uintptr_t)) {
+        // likely to be a pointer
+        return *reinterpret_cast<pointer_type*>(&begin);
+    } else {
+        if (begin != x.end()) {
+            return &*begin;
+        } else {
+            return static_cast<pointer_type>(nullptr);
+        }
+    }
+}
+
+/// `true` if `C::data()` returns a pointer.
+template <typename C, typename = void>
+struct _has_data : std::false_type {};
+template <typename C>
+struct _has_data<C, std::void_t<decltype(std::declval<C&>().data())>>
+    : std::is_pointer<decltype(std::declval<C&>().data())> {};
+
+template <typename C>
+constexpr auto data(C& x) noexcept {
+    if constexpr (std::is_array_v<C>) {
+        return static_cast<std::remove_extent_t<C>*>(x);
+    } else if constexpr (_has_data<C>::value) {
+        return x.data();
+    } else {
+        return _data_from_begin(x);
+    }
+}
+
+template <typename C>
+constexpr size_t size(C& x) noexcept {
+    if constexpr (std::is_array_v<C>) {
+        return std::extent_v<C>;
+    } else {
+        return x.end() - x.begin();
+    }
+}
+}  // namespace ranges
+// R&& is not safe without actual ranges
+#define SAFE_R const R&
+#endif
+
+// UTF-8 validation following Rust `std::str::from_utf8`.
+namespace _utf8 {
+
+#if __AVX2__
+inline constexpr usize ASCII_BLOCK = 32;
+#else
+inline constexpr usize ASCII_BLOCK = 16;
+#endif
+
+/// Checks if `ASCII_BLOCK * N` bytes from `s` are all ASCII.
+template <usize N>
+inline bool _is_ascii_block(const uint8_t* s) noexcept {
+#if __AVX2__
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    for (usize k = 1; k < N; ++k) {
+        v = _mm256_or_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + k * ASCII_BLOCK)));
+    }
+    return _mm256_movemask_epi8(v) == 0;
+#elif __SSE2__ || _M_X64
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    for (usize k = 1; k < N; ++k) {
+        v = _mm_or_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + k * ASCII_BLOCK)));
+    }
+    return _mm_movemask_epi8(v) == 0;
+#elif __ARM_NEON && __aarch64__
+    auto v = vld1q_u8(s);
+    for (usize k = 1; k < N; ++k) {
+        v = vorrq_u8(v, vld1q_u8(s + k * ASCII_BLOCK));
+    }
+    return vmaxvq_u8(v) < 0x80;
+#else
+    uint64_t words[N * 2];
+    std::memcpy(words, s, sizeof(words));
+    uint64_t v = 0;
+    for (usize k = 0; k < N * 2; ++k) {
+        v |= words[k];
+    }
+    return (v & 0x8080808080808080ull) == 0;
+#endif
+}
+
+constexpr bool _is_continuation(uint8_t c) noexcept {
+    return (c & 0xc0) == 0x80;
+}
+
+/// Returns the width of a valid multi-byte character at `data[i]`, or 0 if it is invalid.
+constexpr usize _multi_byte_width(const char* data, usize size, usize i) noexcept {
+    const auto byte = [&](usize j) { return static_cast<uint8_t>(data[i + j]); };
+    const uint8_t c = byte(0);
+    const usize remaining = size - i;
+    if (c >= 0xc2 && c <= 0xdf) {
+        if (remaining < 2 || !_is_continuation(byte(1))) {
+            return 0;
+        }
+        return 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        if (remaining < 3) {
+            return 0;
+        }
+        const uint8_t c1 = byte(1);
+        // reject overlong encodings and surrogates
+        const bool valid1 = c == 0xe0 ? (c1 >= 0xa0 && c1 <= 0xbf)
+                            : c == 0xed ? (c1 >= 0x80 && c1 <= 0x9f)
+                                        : _is_continuation(c1);
+        if (!valid1 || !_is_continuation(byte(2))) {
+            return 0;
+        }
+        return 3;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        if (remaining < 4) {
+            return 0;
+        }
+        const uint8_t c1 = byte(1);
+        // reject overlong encodings and code points over U+10FFFF
+        const bool valid1 = c == 0xf0 ? (c1 >= 0x90 && c1 <= 0xbf)
+                            : c == 0xf4 ? (c1 >= 0x80 && c1 <= 0x8f)
+                                        : _is_continuation(c1);
+        if (!valid1 || !_is_continuation(byte(2)) || !_is_continuation(byte(3))) {
+            return 0;
+        }
+        return 4;
+    }
+    return 0;
+}
+
+/// Validates a string with vectorized ASCII blocks and scalar multi-byte characters.
+inline bool validate(const char* data, usize size) noexcept {
+    const auto* s = reinterpret_cast<const uint8_t*>(data);
+    usize i = 0;
+    while (i < size) {
+        while (size - i >= ASCII_BLOCK * 4 && _is_ascii_block<4>(s + i)) {
+            i += ASCII_BLOCK * 4;
+        }
+        while (size - i >= ASCII_BLOCK && _is_ascii_block<1>(s + i)) {
+            i += ASCII_BLOCK;
+        }
+        while (i < size && s[i] < 0x80) {
+            i += 1;
+        }
+        if (i == size) {
+            break;
+        }
+        const usize width = _multi_byte_width(data, size, i);
+        if (width == 0) {
+            return false;
+        }
+        i += width;
+    }
+    return true;
+}
+
+/// Validates a string without vector instructions, so that it can be evaluated at compile time.
+constexpr bool validate_constexpr(const char* data, usize size) noexcept {
+    usize i = 0;
+    while (i < size) {
+        if (static_cast<uint8_t>(data[i]) < 0x80) {
+            i += 1;
+            continue;
+        }
+        const usize width = _multi_byte_width(data, size, i);
+        if (width == 0) {
+            return false;
+        }
+        i += width;
+    }
+    return true;
+}
+
+}  // namespace _utf8
+
+// Byte search kernels of `CharStrRef` following Rust `str` methods.
+namespace _str {
+
+#if __AVX2__
+inline constexpr usize BLOCK = 32;
+#else
+inline constexpr usize BLOCK = 16;
+#endif
+#define _STR_SIMD (__AVX2__ || __SSE2__ || _M_X64 || (__ARM_NEON && __aarch64__))
+
+inline unsigned _lowest_bit(uint32_t mask) noexcept {
+#if _MSC_VER && !__clang__
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+inline unsigned _highest_bit(uint32_t mask) noexcept {
+#if _MSC_VER && !__clang__
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return 31 - static_cast<unsigned>(__builtin_clz(mask));
+#endif
+}
+
+#if _STR_SIMD
+/// Returns a mask of `i` in `[0, BLOCK)` where `s[i] == c`.
+inline uint32_t _eq_mask(const uint8_t* s, uint8_t c) noexcept {
+#if __AVX2__
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(c)))));
+#elif __SSE2__ || _M_X64
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(c)))));
+#else
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const auto bits = vandq_u8(vceqq_u8(vld1q_u8(s), vdupq_n_u8(c)), vld1q_u8(weights));
+    return vaddv_u8(vget_low_u8(bits)) | static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8;
+#endif
+}
+
+/// Checks if `BLOCK` bytes of `a` and `b` are equal after ASCII lowercasing.
+inline bool _eq_ignore_ascii_case_block(const uint8_t* a, const uint8_t* b) noexcept {
+#if __AVX2__
+    const auto lower = [](const uint8_t* s) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        // 'A'..'Z' is shifted to the lowest signed values to be compared at once.
+        const auto shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+        const auto upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + 26)), shifted);
+        return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    };
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(lower(a), lower(b))) == -1;
+#elif __SSE2__ || _M_X64
+    const auto lower = [](const uint8_t* s) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        // 'A'..'Z' is shifted to the lowest signed values to be compared at once.
+        const auto shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+        const auto upper = _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(0x80 + 26)), shifted);
+        return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    };
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(lower(a), lower(b))) == 0xffff;
+#else
+    const auto lower = [](const uint8_t* s) {
+        const auto v = vld1q_u8(s);
+        const auto upper = vcltq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8(26));
+        return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+    };
+    return vminvq_u8(vceqq_u8(lower(a), lower(b))) == 0xff;
+#endif
+}
+#endif
+
+inline constexpr usize NOT_FOUND = ~usize(0);
+
+/// Returns the first index of `needle` in `haystack` like Rust `str::find`, or `NOT_FOUND`.
+///
+/// Blocks of candidates are filtered by the first and the last bytes of `needle` before comparing the rest.
+inline usize find(const char* haystack, usize size, const char* needle, usize needle_size) noexcept {
+    if (needle_size == 0) {
+        return 0;
+    }
+    if (needle_size > size) {
+        return NOT_FOUND;
+    }
+    if (needle_size == 1) {
+        const auto* found = std::memchr(haystack, needle[0], size);
+        return found ? static_cast<const char*>(found) - haystack : NOT_FOUND;
+    }
+    const auto* h = reinterpret_cast<const uint8_t*>(haystack);
+    const auto* n = reinterpret_cast<const uint8_t*>(needle);
+    const usize last = needle_size - 1;
+    usize i = 0;
+#if _STR_SIMD
+    for (; i + last + BLOCK <= size; i += BLOCK) {
+        auto mask = _eq_mask(h + i, n[0]) & _eq_mask(h + i + last, n[last]);
+        while (mask != 0) {
+            const usize j = i + _lowest_bit(mask);
+            if (needle_size == 2 || std::memcmp(h + j + 1, n + 1, needle_size - 2) == 0) {
+                return j;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + last < size; ++i) {
+        if (h[i] == n[0] && h[i + last] == n[last] && std::memcmp(h + i + 1, n + 1, needle_size - 2) == 0) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+/// Returns the last index of `needle` in `haystack` like Rust `str::rfind`, or `NOT_FOUND`.
+inline usize rfind(const char* haystack, usize size, const char* needle, usize needle_size) noexcept {
+    if (needle_size == 0) {
+        return size;
+    }
+    if (needle_size > size) {
+        return NOT_FOUND;
+    }
+    const auto* h = reinterpret_cast<const uint8_t*>(haystack);
+    const auto* n = reinterpret_cast<const uint8_t*>(needle);
+    const usize last = needle_size - 1;
+    // candidates are `[0, end)`
+    usize end = size - last;
+#if _STR_SIMD
+    for (; end >= BLOCK; end -= BLOCK) {
+        const usize i = end - BLOCK;
+        auto mask = _eq_mask(h + i, n[0]) & _eq_mask(h + i + last, n[last]);
+        while (mask != 0) {
+            const unsigned bit = _highest_bit(mask);
+            if (needle_size <= 2 || std::memcmp(h + i + bit + 1, n + 1, needle_size - 2) == 0) {
+                return i + bit;
+            }
+            mask &= ~(uint32_t(1) << bit);
+        }
+    }
+#endif
+    while (end-- > 0) {
+        if (h[end] == n[0] && h[end + last] == n[last] &&
+            (needle_size <= 2 || std::memcmp(h + end + 1, n + 1, needle_size - 2) == 0)) {
+            return end;
+        }
+    }
+    return NOT_FOUND;
+}
+
+/// Returns the first index of any of `set` in `haystack`, or `NOT_FOUND`.
+inline usize find_any(const char* haystack, usize size, const char* set, usize set_size) noexcept {
+    const auto* h = reinterpret_cast<const uint8_t*>(haystack);
+    const auto* s = reinterpret_cast<const uint8_t*>(set);
+    usize i = 0;
+#if _STR_SIMD
+    for (; i + BLOCK <= size; i += BLOCK) {
+        uint32_t mask = 0;
+        for (usize k = 0; k < set_size; ++k) {
+            mask |= _eq_mask(h + i, s[k]);
+        }
+        if (mask != 0) {
+            return i + _lowest_bit(mask);
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (set_size > 0 && std::memchr(set, h[i], set_size)) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+constexpr uint8_t _to_ascii_lowercase(uint8_t c) noexcept {
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+/// Checks if two strings are equal after ASCII lowercasing like Rust `str::eq_ignore_ascii_case`.
+inline bool eq_ignore_ascii_case(const char* a, const char* b, usize size) noexcept {
+    const auto* x = reinterpret_cast<const uint8_t*>(a);
+    const auto* y = reinterpret_cast<const uint8_t*>(b);
+    usize i = 0;
+#if _STR_SIMD
+    for (; i + BLOCK <= size; i += BLOCK) {
+        if (!_eq_ignore_ascii_case_block(x + i, y + i)) {
+            return false;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (_to_ascii_lowercase(x[i]) != _to_ascii_lowercase(y[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace _str
+
+/// A forward range of the parts of a string split by any byte of a set, returned by `split()`.
+///
+/// The parts are the same as Rust `str::split(&[char])` of the ASCII characters: a separator at either end
+/// makes an empty part, and an empty string is one empty part. `S` is `StrRef` for UTF-8 strings.
+template <typename S>
+struct _StrSplit {
+    const char* _data;
+    usize _size;
+    const char* _set;
+    usize _set_size;
+
+    /// Keeps the end and the separators of the string, so it may outlive the range.
+    ///
+    /// `reference` is a part made on dereference, so the iterator is only an input iterator before C++20.
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+#if __cplusplus >= 202002L
+        using iterator_concept = std::forward_iterator_tag;
+#endif
+        using value_type = S;
+        using difference_type = intptr_t;
+        using pointer = void;
+        using reference = S;
+
+        /// The start of the part, or null at the end.
+        const char* _start;
+        usize _part_size;
+        const char* _end;
+        const char* _set;
+        usize _set_size;
+
+        void _find() noexcept {
+            const usize rest = this->_end - this->_start;
+            const usize found = _str::find_any(this->_start, rest, this->_set, this->_set_size);
+            this->_part_size = found == _str::NOT_FOUND ? rest : found;
+        }
+
+        reference operator*() const noexcept {
+            return S::_from_parts(this->_start, this->_part_size);
+        }
+        iterator& operator++() noexcept {
+            const auto* part_end = this->_start + this->_part_size;
+            if (part_end == this->_end) {
+                this->_start = nullptr;
+            } else {
+                this->_start = part_end + 1;
+                this->_find();
+            }
+            return *this;
+        }
+        iterator operator++(int) noexcept {
+            auto it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const iterator& other) const noexcept {
+            return this->_start == other._start;
+        }
+        bool operator!=(const iterator& other) const noexcept {
+            return this->_start != other._start;
+        }
+    };
+
+    iterator begin() const noexcept {
+        auto it = iterator{this->_data, 0, this->_data + this->_size, this->_set, this->_set_size};
+        it._find();
+        return it;
+    }
+    iterator end() const noexcept {
+        return iterator{nullptr, 0, this->_data + this->_size, this->_set, this->_set_size};
+    }
+};
+
+/// Hashes bytes by the same function as Rust `ffi_types::hash_bytes`.
+///
+/// The result is stable only in the same process. Words are loaded in native endian.
+inline uint64_t hash_bytes(const void* data, usize size) noexcept {
+    constexpr uint64_t K = 0x9e3779b97f4a7c15;
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t h = static_cast<uint64_t>(size) * K;
+    uint64_t word;
+    for (; size >= 8; size -= 8, p += 8) {
+        std::memcpy(&word, p, 8);
+        h = ((h << 5 | h >> 59) ^ word) * K;
+    }
+    if (size > 0) {
+        word = 0;
+        std::memcpy(&word, p, size);
+        h = ((h << 5 | h >> 59) ^ word) * K;
+    }
+    // finalizer of MurmurHash3
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccd;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53;
+    h ^= h >> 33;
+    return h;
+}
+
+struct CharStrRef;
+struct StrRef;
+struct CStrRef;
+struct CByteSliceRef;
+class BoxedStr;
+class BoxedCStr;
+
+template <typename T>
+struct MutSliceRef;
+template <typename T>
+struct SliceRef;
+template <typename T>
+struct CMutSliceRef;
+template <typename T>
+struct CSliceRef;
+template <typename T>
+struct CBoxedSlice;
+template <typename T>
+struct CVec;
+template <typename T>
+struct CForeignBoxedSlice;
+struct CMmapSlice;
+
+/// A minimal range type of slices to be compatible with internal ranges.
+template <typename T>
+struct _SliceRange {
+    T* _data;
+    usize _size;
+
+    auto* begin() const noexcept {
+        return this->_data;
+    }
+    auto* end() const noexcept {
+        return this->_data + _size;
+    }
+};
+
+/// A view to a part of a slice of `T`. `SliceRef<U>` if `T` is `const U`, `MutSliceRef<T>` otherwise.
+template <typename T>
+using _SliceView = std::conditional_t<std::is_const_v<T>, SliceRef<std::remove_const_t<T>>, MutSliceRef<T>>;
+
+/// A random access range of views returned by `chunks()`, `chunks_exact()` or `windows()`.
+///
+/// The `i`-th view starts at `i * _step` and has `_width` elements, or less for the last view of `chunks()`.
+/// The partition is the same as Rust `slice::chunks()`, `slice::chunks_exact()` and `slice::windows()`.
+template <typename T>
+struct _SliceChunks {
+    T* _data;
+    /// The number of elements covered by the views.
+    usize _size;
+    /// The number of elements after the covered ones. Only `chunks_exact()` leaves a remainder.
+    usize _rest;
+    usize _step;
+    usize _width;
+    usize _count;
+
+    /// `reference` is a view made on dereference, so the iterator is only an input iterator before C++20.
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+#if __cplusplus >= 202002L
+        using iterator_concept = std::random_access_iterator_tag;
+#endif
+        using value_type = _SliceView<T>;
+        using difference_type = intptr_t;
+        using pointer = void;
+        using reference = value_type;
+
+        _SliceChunks<T> _chunks;
+        usize _index;
+
+        reference operator*() const noexcept {
+            return this->_chunks[this->_index];
+        }
+        reference operator[](difference_type n) const noexcept {
+            return this->_chunks[this->_index + n];
+        }
+        iterator& operator++() noexcept {
+            ++this->_index;
+            return *this;
+        }
+        iterator operator++(int) noexcept {
+            auto it = *this;
+            ++this->_index;
+            return it;
+        }
+        iterator& operator--() noexcept {
+            --this->_index;
+            return *this;
+        }
+        iterator operator--(int) noexcept {
+            auto it = *this;
+            --this->_index;
+            return it;
+        }
+        iterator& operator+=(difference_type n) noexcept {
+            this->_index += n;
+            return *this;
+        }
+        iterator& operator-=(difference_type n) noexcept {
+            this->_index -= n;
+            return *this;
+        }
+        friend iterator operator+(iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+        friend iterator operator+(difference_type n, iterator it) noexcept {
+            return it += n;
+        }
+        friend iterator operator-(iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+        friend difference_type operator-(const iterator& a, const iterator& b) noexcept {
+            return static_cast<difference_type>(a._index - b._index);
+        }
+        friend bool operator==(const iterator& a, const iterator& b) noexcept {
+            return a._index == b._index;
+        }
+        friend bool operator!=(const iterator& a, const iterator& b) noexcept {
+            return a._index != b._index;
+        }
+        friend bool operator<(const iterator& a, const iterator& b) noexcept {
+            return a._index < b._index;
+        }
+        friend bool operator<=(const iterator& a, const iterator& b) noexcept {
+            return a._index <= b._index;
+        }
+        friend bool operator>(const iterator& a, const iterator& b) noexcept {
+            return a._index > b._index;
+        }
+        friend bool operator>=(const iterator& a, const iterator& b) noexcept {
+            return a._index >= b._index;
+        }
+    };
+
+    usize size() const noexcept {
+        return this->_count;
+    }
+    bool empty() const noexcept {
+        return this->_count == 0;
+    }
+    _SliceView<T> operator[](usize idx) const noexcept {
+        assert(idx < this->_count);
+        const auto offset = idx * this->_step;
+        return _SliceView<T>(this->_data + offset, std::min(this->_width, this->_size - offset));
+    }
+    iterator begin() const noexcept {
+        return iterator{*this, 0};
+    }
+    iterator end() const noexcept {
+        return iterator{*this, this->_count};
+    }
+
+    /// Returns the elements not covered by `chunks_exact()`. Empty for the others.
+    _SliceView<T> remainder() const noexcept {
+        return _SliceView<T>(this->_data + this->_size, this->_rest);
+    }
+};
+
+/// Common C++ STL-like interface for &[T] and &str.
+/// @see std::span
+template <typename T, template <typename _> typename I>
+struct _SliceInterface {
+    // constants and types
+    using element_type = T;
+    using value_type = typename std::remove_cv_t<T>;
+    using size_type = uintptr_t;
+    using difference_type = intptr_t;
+    using pointer = element_type*;
+    using const_pointer = const element_type*;
+    using reference = element_type&;
+    using const_reference = const element_type&;
+#if __cpp_lib_span && !FFI_TYPES_POINTER_ITERATOR
+    using iterator = typename std::span<element_type>::iterator;
+#else
+    using iterator = pointer;
+#endif
+    using reverse_iterator = std::reverse_iterator<iterator>;
+
+    // observers
+    constexpr size_type size() const noexcept {
+        return static_cast<const I<T>*>(this)->_size;
+    }
+    constexpr size_type size_bytes() const noexcept {
+        return this->size() * sizeof(element_type);
+    }
+    constexpr bool empty() const noexcept {
+        return this->size() == 0;
+    }
+
+    // element access
+    constexpr reference operator[](size_type idx) const noexcept {
+        assert(idx < this->size());
+        return this->data()[idx];
+    }
+    constexpr reference front() const noexcept {
+        return this->data()[0];
+    }
+    constexpr reference back() const noexcept {
+        return this->data()[size() - 1];
+    }
+    constexpr pointer data() const noexcept {
+        return static_cast<const I<T>*>(this)->_data;
+    }
+
+    // iterator
+#if __cpp_lib_span && !FFI_TYPES_POINTER_ITERATOR
+    iterator begin() const noexcept {
+        return span().begin();
+    }
+#else
+    iterator begin() const noexcept {
+        return data();
+    }
+#endif
+    iterator end() const noexcept {
+        return begin() + size();
+    }
+    reverse_iterator rbegin() const noexcept {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend() const noexcept {
+        return reverse_iterator(begin());
+    }
+
+    _SliceRange<element_type> get() const noexcept {
+        return {data(), size()};
+    }
+
+    // subviews, following Rust `[T]` methods
+    /// Returns the first `count` elements.
+    _SliceView<T> first(size_type count) const noexcept {
+        assert(count <= size());
+        return _SliceView<T>(data(), count);
+    }
+    /// Returns the last `count` elements.
+    _SliceView<T> last(size_type count) const noexcept {
+        assert(count <= size());
+        return _SliceView<T>(data() + (size() - count), count);
+    }
+    /// Returns `count` elements from `offset`, or the rest of the slice by default.
+    _SliceView<T> subslice(size_type offset, size_type count = SIZE_MAX) const noexcept {
+        assert(offset <= size());
+        if (count == SIZE_MAX) {
+            count = size() - offset;
+        }
+        assert(count <= size() - offset);
+        return _SliceView<T>(data() + offset, count);
+    }
+    /// Divides the slice into `[0, mid)` and `[mid, size())`.
+    std::pair<_SliceView<T>, _SliceView<T>> split_at(size_type mid) const noexcept {
+        assert(mid <= size());
+        return {_SliceView<T>(data(), mid), _SliceView<T>(data() + mid, size() - mid)};
+    }
+    /// Returns views of `chunk_size` elements. The last chunk is shorter if `chunk_size` doesn't divide the size.
+    _SliceChunks<T> chunks(size_type chunk_size) const noexcept {
+        assert(chunk_size > 0);
+        return {data(), size(), 0, chunk_size, chunk_size, size() / chunk_size + (size() % chunk_size != 0)};
+    }
+    /// Returns views of exactly `chunk_size` elements. The rest is left to `remainder()`.
+    _SliceChunks<T> chunks_exact(size_type chunk_size) const noexcept {
+        assert(chunk_size > 0);
+        const auto count = size() / chunk_size;
+        return {data(), count * chunk_size, size() - count * chunk_size, chunk_size, chunk_size, count};
+    }
+    /// Returns all overlapping views of `window_size` elements.
+    _SliceChunks<T> windows(size_type window_size) const noexcept {
+        assert(window_size > 0);
+        const auto count = size() >= window_size ? size() - window_size + 1 : 0;
+        return {data(), size(), 0, 1, window_size, count};
+    }
+
+#if __cpp_lib_span
+    /// Returns the slice as a `std::span`.
+    std::span<element_type> span() const noexcept {
+        return std::span<T>(data(), size());
+    }
+#endif
+};
+
+// comparisons of slices with the same element type, e.g. `SliceRef<T>`, `MutSliceRef<T>`, `BoxedSlice<T>` or `Vec<T>`.
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator==(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    static_assert(std::is_same_v<std::remove_cv_t<T>, std::remove_cv_t<U>>, "comparing slices of different types");
+    if (a.size() != b.size()) {
+        return false;
+    }
+    if constexpr (std::has_unique_object_representations_v<std::remove_cv_t<T>>) {
+        return a.empty() || std::memcmp(a.data(), b.data(), a.size_bytes()) == 0;
+    } else {
+        return std::equal(a.data(), a.data() + a.size(), b.data());
+    }
+}
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator!=(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return !(a == b);
+}
+#if __cpp_lib_three_way_comparison
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline auto operator<=>(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return std::lexicographical_compare_three_way(
+            a.data(), a.data() + a.size(), b.data(), b.data() + b.size());
+}
+#else
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator<(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return std::lexicographical_compare(a.data(), a.data() + a.size(), b.data(), b.data() + b.size());
+}
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator<=(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return !(b < a);
+}
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator>(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return b < a;
+}
+template <typename T, template <typename> typename I, typename U, template <typename> typename J>
+inline bool operator>=(const _SliceInterface<T, I>& a, const _SliceInterface<U, J>& b) noexcept {
+    return !(a < b);
+}
+#endif
+
+/// C++ counterpart of Rust `&mut [T]` and &[T]`.
+/// The interface is following `std::span` design.
+template <typename T>
+struct MutSliceRef : public _SliceInterface<T, MutSliceRef> {
+    T* _data;
+    usize _size;
+
+    MutSliceRef() noexcept : _data(EMPTY_SLICE_BEGIN(T)), _size(0) {}
+    MutSliceRef(const MutSliceRef&) = default;
+    MutSliceRef(MutSliceRef&&) = default;
+    constexpr explicit MutSliceRef(T* head, usize size) noexcept : _data(_wrap_null(head)), _size(size) {}
+    template <class R>
+    constexpr MutSliceRef(SAFE_R range) noexcept
+        : _data(_wrap_null(ranges::data(range))), _size(static_cast<usize>(ranges::size(range))) {}
+
+    MutSliceRef& operator=(const MutSliceRef<T>&) = default;
+    MutSliceRef& operator=(MutSliceRef<T>&&) = default;
+
+    CMutSliceRef<T> into() const noexcept;
+
+    /// Convert &[u8] to C++ string wrapper.
+    /// This is &[u8] specialization as bytes
+    template <typename U = T>
+    std::enable_if_t<std::is_same_v<U, const uint8_t>, CharStrRef> as_char_str() const noexcept;
+
+    /// Convert &[u8] to Rust string wrapper without UTF-8 checking.
+    /// This is &[u8] specialization as bytes
+    ///
+    /// @warning Safety: Only when the data is a valid UTF-8 string.
+    template <typename U = T>
+    std::enable_if_t<std::is_same_v<U, const uint8_t>, StrRef> as_str_unchecked() const noexcept;
+};
+static_assert(std::is_trivially_copyable<MutSliceRef<usize>>::value);
+static_assert(std::is_standard_layout<MutSliceRef<usize>>::value);
+
+/// SliceRef<T> is a read-only slice `&[T]` in Rust and a conceptional alias to `MutSliceRef<const T>` in C++.
+/// This is not a hard alias because:
+/// - template alias doesn't support generic parameter deduction.
+/// - bindgen resolve template alias to the original type, which we don't supposed to do.
+template <typename T>
+struct SliceRef : public MutSliceRef<const T> {
+    SliceRef() noexcept : MutSliceRef<const T>(){};
+    SliceRef(const SliceRef&) = default;
+    SliceRef(SliceRef&&) = default;
+    constexpr explicit SliceRef(const T* head, usize size) noexcept : MutSliceRef<const T>(head, size) {}
+    template <class R>
+    constexpr SliceRef(SAFE_R range) noexcept : MutSliceRef<const T>(range) {}
+
+    SliceRef& operator=(const SliceRef<T>&) = default;
+    SliceRef& operator=(SliceRef<T>&&) = default;
+
+    typename std::conditional<std::is_same_v<T, uint8_t>, CByteSliceRef, CSliceRef<T>>::type into() const noexcept;
+
+    template <typename B, typename U = T>
+    static std::enable_if_t<std::is_same_v<U, uint8_t>, SliceRef<uint8_t>> from_buffer(const B& buffer) noexcept {
+        return SliceRef<uint8_t>(reinterpret_cast<const uint8_t*>(&buffer), sizeof(B));
+    }
+};
+static_assert(std::is_trivially_copyable<SliceRef<usize>>::value);
+static_assert(std::is_standard_layout<SliceRef<usize>>::value);
+
+/// C++ counterpart of `&[u8]` as alias for `SliceRef<uint8_t>`.
+/// This alias is useful to pass `&[u8]` in cbindgen without configuration and boilerplate.
+using ByteSliceRef = SliceRef<uint8_t>;
+
+/// C++ counterpart of `Box<T>`
+/// The ownership API is following `std::unique_ptr` design and the slice API is following `std::span` design.
+template <typename T>
+class BoxedSlice : public MutSliceRef<T> {
+public:
+    BoxedSlice() = delete;
+    BoxedSlice(const BoxedSlice<T>&) = delete;
+    BoxedSlice(BoxedSlice<T>&& s) noexcept : MutSliceRef<T>(s) {
+        s._data = EMPTY_SLICE_BEGIN(T);
+        s._size = 0;
+    }
+    BoxedSlice(std::nullptr_t) noexcept : MutSliceRef<T>() {}
+    ~BoxedSlice() noexcept {
+        if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_slice, sizeof(T) * this->_size);
+            this->_drop();
+        }
+    }
+    BoxedSlice<T>& operator=(BoxedSlice<T>&& b) noexcept {
+        this->_reset(b._take());
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Drops every item of `items`. The items are left empty.
+    /// Specialize this function to drop the items by a single call to Rust side.
+    static void _drop_many(MutSliceRef<BoxedSlice<T>> items) noexcept {
+        for (auto& item : items) {
+            auto dropped = std::move(item);
+        }
+    }
+
+    /// Allocates a boxed slice of `size` uninitialized elements from the Rust global allocator.
+    /// The layout is the same as Rust `Box<[T]>` so that the value can be dropped in either side.
+    ///
+    /// @warning Every element must be written before it is read or the value is passed to Rust side.
+    static BoxedSlice<T> with_capacity_uninit(usize size) noexcept;
+
+    /// Allocates a byte slice of `size` uninitialized bytes from the buffer pool of the current thread.
+    ///
+    /// Only a power of two size from 1 KiB to 1 MiB is pooled. The other sizes are allocated as usual.
+    /// The Rust drop function returns a buffer of such a size to the pool of the dropping thread.
+    /// Pools are disabled until `pool::set_limit()` is called.
+    ///
+    /// @note `FFI_TYPES_INLINE_DEALLOC` drops bypass pools.
+    /// @warning Every byte must be written before it is read or the value is passed to Rust side.
+    template <typename U = T>
+    static std::enable_if_t<std::is_same_v<U, uint8_t>, BoxedSlice<uint8_t>> from_pool(usize size) noexcept;
+
+    /// Reallocates the boxed slice to `size` elements.
+    /// Existing elements are kept up to `size` and new elements are uninitialized.
+    void resize_uninit(usize size) noexcept;
+
+    CBoxedSlice<T> into() noexcept;
+    const CBoxedSlice<T>& as_c() const noexcept {
+        return *reinterpret_cast<const CBoxedSlice<T>*>(this);
+    }
+    CBoxedSlice<T>& as_c() noexcept {
+        return *reinterpret_cast<CBoxedSlice<T>*>(this);
+    }
+
+    void reset(_SliceRange<T> s) noexcept {
+        instrument::_acquire(instrument::_Kind::boxed_slice, s._size > 0, sizeof(T) * s._size);
+        this->_reset(s);
+    }
+
+    _SliceRange<T> release() noexcept {
+        instrument::_give_up(
+                instrument::_Kind::boxed_slice, instrument::_Event::released, this->_size > 0, sizeof(T) * this->_size);
+        return this->_take();
+    }
+
+    /// Same as `reset()` for a value already owned by C++ side, e.g. moved from another owned value.
+    void _reset(_SliceRange<T> s) noexcept {
+        if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_slice, sizeof(T) * this->_size);
+            this->_drop();
+        }
+        this->_data = s._data;
+        this->_size = s._size;
+    }
+
+    /// Same as `release()` but the ownership stays in C++ side, e.g. moved to another owned value.
+    _SliceRange<T> _take() noexcept {
+        const auto range = this->get();
+        this->_data = EMPTY_SLICE_BEGIN(T);
+        this->_size = 0;
+        return range;
+    }
+
+    /// Returns a mutable slice of the boxed slice.
+    auto as_slice() noexcept {
+        return MutSliceRef<T>(this->_data, this->_size);
+    }
+
+    /// Returns a read-only slice of the boxed slice.
+    auto as_slice() const noexcept {
+        return SliceRef<T>(this->_data, this->_size);
+    }
+};
+static_assert(sizeof(usize) * 2 == sizeof(BoxedSlice<int>));
+static_assert(std::is_standard_layout<BoxedSlice<usize>>::value);
+
+/// C++ counterpart of Rust `Vec<T>`.
+/// The ownership API is following `std::unique_ptr` design and the container API is following `std::vector` design.
+///
+/// The storage grows by Rust global allocator, so the value can be passed to Rust side without reallocation.
+/// Elements are moved by `realloc`, so `T` must be trivially copyable.
+template <typename T>
+class Vec : public _SliceInterface<T, Vec> {
+public:
+    T* _data;
+    usize _size;
+    usize _capacity;
+
+    Vec() = delete;
+    Vec(const Vec<T>&) = delete;
+    Vec(Vec<T>&& v) noexcept : _data(v._data), _size(v._size), _capacity(v._capacity) {
+        v._data = EMPTY_SLICE_BEGIN(T);
+        v._size = 0;
+        v._capacity = 0;
+    }
+    Vec(std::nullptr_t) noexcept : _data(EMPTY_SLICE_BEGIN(T)), _size(0), _capacity(0) {}
+    ~Vec() noexcept {
+        if (this->_capacity > 0) {
+            this->_drop();
+        }
+    }
+    Vec<T>& operator=(Vec<T>&& v) noexcept {
+        if (this->_capacity > 0) {
+            this->_drop();
+        }
+        this->_data = v._data;
+        this->_size = v._size;
+        this->_capacity = v._capacity;
+        v._data = EMPTY_SLICE_BEGIN(T);
+        v._size = 0;
+        v._capacity = 0;
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    CVec<T> into() noexcept;
+    const CVec<T>& as_c() const noexcept {
+        return *reinterpret_cast<const CVec<T>*>(this);
+    }
+    CVec<T>& as_c() noexcept {
+        return *reinterpret_cast<CVec<T>*>(this);
+    }
+
+    usize capacity() const noexcept {
+        return this->_capacity;
+    }
+
+    /// Reserves capacity for at least `additional` more elements by Rust `Vec::reserve` growth strategy.
+    void reserve(usize additional) noexcept;
+
+    void push_back(const T& value) noexcept {
+        this->reserve(1);
+        this->_data[this->_size++] = value;
+    }
+
+    void pop_back() noexcept {
+        assert(this->_size > 0);
+        this->_size -= 1;
+    }
+
+    /// Appends all elements of `values` by copying.
+    void extend(SliceRef<std::remove_cv_t<T>> values) noexcept {
+        if (values.empty()) {
+            return;
+        }
+        this->reserve(values.size());
+        std::memcpy(this->_data + this->_size, values.data(), values.size_bytes());
+        this->_size += values.size();
+    }
+
+    void clear() noexcept {
+        this->_size = 0;
+    }
+
+    /// Returns a mutable slice of the vector.
+    auto as_slice() noexcept {
+        return MutSliceRef<T>(this->_data, this->_size);
+    }
+
+    /// Returns a read-only slice of the vector.
+    auto as_slice() const noexcept {
+        return SliceRef<T>(this->_data, this->_size);
+    }
+};
+static_assert(sizeof(usize) * 3 == sizeof(Vec<int>));
+static_assert(std::is_standard_layout<Vec<usize>>::value);
+
+/// C++ counterpart for Rust `ForeignBoxedSlice<T>`, a slice owned by C++ side and visible to Rust side.
+///
+/// Rust side calls `_drop_fn(_ctx)` back to free the buffer when the value is dropped.
+/// Use `from_container()` to move the storage of a `std::vector` or a `std::string` to Rust without copying.
+///
+/// @warning `_drop_fn` may be called from any thread of Rust side.
+template <typename T>
+class ForeignBoxedSlice : public _SliceInterface<T, ForeignBoxedSlice> {
+public:
+    using drop_fn = void (*)(void* ctx);
+
+    T* _data;
+    usize _size;
+    drop_fn _drop_fn;
+    void* _ctx;
+
+    ForeignBoxedSlice() = delete;
+    ForeignBoxedSlice(const ForeignBoxedSlice<T>&) = delete;
+    ForeignBoxedSlice(ForeignBoxedSlice<T>&& s) noexcept
+        : _data(s._data), _size(s._size), _drop_fn(s._drop_fn), _ctx(s._ctx) {
+        s._reset_empty();
+    }
+    ForeignBoxedSlice(std::nullptr_t) noexcept
+        : _data(EMPTY_SLICE_BEGIN(T)), _size(0), _drop_fn(nullptr), _ctx(nullptr) {}
+    /// Takes the ownership of `data`. `drop(ctx)` is called once to free it.
+    ForeignBoxedSlice(T* data, usize size, drop_fn drop, void* ctx) noexcept
+        : _data(_wrap_null(data)), _size(size), _drop_fn(drop), _ctx(ctx) {}
+    ~ForeignBoxedSlice() noexcept {
+        this->_drop();
+    }
+    ForeignBoxedSlice<T>& operator=(ForeignBoxedSlice<T>&& s) noexcept {
+        if (this != &s) {
+            this->_drop();
+            this->_data = s._data;
+            this->_size = s._size;
+            this->_drop_fn = s._drop_fn;
+            this->_ctx = s._ctx;
+            s._reset_empty();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept {
+        if (this->_drop_fn) {
+            this->_drop_fn(this->_ctx);
+        }
+        this->_reset_empty();
+    }
+    void _reset_empty() noexcept {
+        this->_data = EMPTY_SLICE_BEGIN(T);
+        this->_size = 0;
+        this->_drop_fn = nullptr;
+        this->_ctx = nullptr;
+    }
+
+    /// Moves `container` to the heap and owns its storage.
+    ///
+    /// Only the container object is allocated. Elements are neither copied nor moved,
+    /// so the storage of `std::vector` or a long `std::string` stays at the same address.
+    template <class C>
+    static ForeignBoxedSlice<T> from_container(C&& container) {
+        using container_type = std::remove_cv_t<std::remove_reference_t<C>>;
+        static_assert(!std::is_lvalue_reference_v<C>, "the container must be moved");
+        static_assert(
+                std::is_same_v<std::remove_cv_t<T>, typename container_type::value_type>,
+                "the element type must be the same");
+        auto* owned = new container_type(std::move(container));
+        return ForeignBoxedSlice<T>(
+                const_cast<T*>(owned->data()),
+                owned->size(),
+                [](void* ctx) { delete static_cast<container_type*>(ctx); },
+                owned);
+    }
+
+    CForeignBoxedSlice<T> into() noexcept;
+
+    /// Returns a mutable slice of the buffer.
+    auto as_slice() noexcept {
+        return MutSliceRef<T>(this->_data, this->_size);
+    }
+
+    /// Returns a read-only slice of the buffer.
+    auto as_slice() const noexcept {
+        return SliceRef<T>(this->_data, this->_size);
+    }
+};
+
+/// Counters of the buffer pool of a thread. Same as Rust `PoolStats`.
+/// @see `BoxedSlice<uint8_t>::from_pool()`
+struct PoolStats {
+    /// Allocations served by the pool.
+    uint64_t hits;
+    /// Allocations of a size class served by the global allocator.
+    uint64_t misses;
+    /// Buffers returned to the pool.
+    uint64_t recycled;
+    /// Buffers of a size class freed because the pool was full.
+    uint64_t released;
+};
+static_assert(std::is_trivial<PoolStats>::value);
+static_assert(std::is_standard_layout<PoolStats>::value);
+
+/// Access pattern hints for `MmapSlice::advise()`. Same as Rust `MmapAdvice` and `madvise(2)`.
+enum class MmapAdvice : int32_t {
+    Normal = 0,
+    Random = 1,
+    Sequential = 2,
+    WillNeed = 3,
+    DontNeed = 4,
+};
+
+/// C++ counterpart for Rust `MmapSlice`, a read-only memory-mapped file as an owned byte slice.
+///
+/// The mapping is created and released by Rust side, so a single mapping can be passed between both sides.
+/// An empty file is not mapped and results in an empty slice.
+///
+/// @warning The file is mapped by `MAP_SHARED`. Writes to the file by any process change the bytes of the slice,
+///          and reading pages of a truncated file raises `SIGBUS`. Map only files nobody modifies while mapped.
+/// @note This type is available only on unix platforms.
+class MmapSlice : public SliceRef<uint8_t> {
+public:
+    MmapSlice() = delete;
+    MmapSlice(const MmapSlice&) = delete;
+    MmapSlice(MmapSlice&& s) noexcept : SliceRef<uint8_t>(s) {
+        s._data = EMPTY_SLICE_BEGIN(uint8_t);
+        s._size = 0;
+    }
+    MmapSlice(std::nullptr_t) noexcept : SliceRef<uint8_t>() {}
+    ~MmapSlice() noexcept {
+        if (this->_size > 0) {
+            this->_drop();
+        }
+    }
+    MmapSlice& operator=(MmapSlice&& s) noexcept {
+        if (this != &s) {
+            if (this->_size > 0) {
+                this->_drop();
+            }
+            this->_data = s._data;
+            this->_size = s._size;
+            s._data = EMPTY_SLICE_BEGIN(uint8_t);
+            s._size = 0;
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Maps the whole file of `path` as read-only.
+    /// Returns `std::nullopt` on failure and stores the `errno` value to `error` if given.
+    static std::optional<MmapSlice> open(CharStrRef path, int32_t* error = nullptr) noexcept;
+
+    /// Gives a hint of the access pattern of the whole mapping. Returns 0 on success or an `errno` value.
+    int32_t advise(MmapAdvice advice) const noexcept {
+        return this->advise(0, this->_size, advice);
+    }
+
+    /// Gives a hint of the access pattern of `size` bytes from `offset`. The range is extended to page boundaries.
+    int32_t advise(usize offset, usize size, MmapAdvice advice) const noexcept;
+
+    /// Asks the kernel to read `size` bytes from `offset` of the file ahead.
+    int32_t prefetch(usize offset, usize size) const noexcept {
+        return this->advise(offset, size, MmapAdvice::WillNeed);
+    }
+
+    /// Returns the mapping as a slice of `T`, e.g. a table of fixed size records.
+    ///
+    /// The mapping is page-aligned, so only the size must be a multiple of `sizeof(T)`.
+    template <typename T>
+    SliceRef<T> as_slice() const noexcept {
+        static_assert(std::is_trivially_copyable<T>::value, "the mapping is read as raw bytes");
+        assert(this->_size % sizeof(T) == 0);
+        assert(reinterpret_cast<uintptr_t>(this->_data) % alignof(T) == 0);
+        return SliceRef<T>(reinterpret_cast<const T*>(this->_data), this->_size / sizeof(T));
+    }
+
+    CMmapSlice into() noexcept;
+};
+static_assert(sizeof(MmapSlice) == 2 * sizeof(void*));
+static_assert(std::is_standard_layout<MmapSlice>::value);
+
+/// A list of byte slices for vectored I/O, same as Rust `IoSliceRef`.
+///
+/// On unix, the elements have the same layout as `struct iovec`, so the list is passed to `writev()` or `io_uring`
+/// by `as_iovec()` without copying.
+using IoSliceRef = SliceRef<ByteSliceRef>;
+using CIoSliceRef = CSliceRef<ByteSliceRef>;
+
+/// C++ unsafe counterpart of Rust `&str`.
+///
+/// Because `StrRef` in C++ side doesn't have any UTF-8 validation checking,
+/// `CharStrRef` is an alternative of `StrRef` creation in C++ side.
+/// The value can be converted to either `&[u8]` or `&str` with UTF-8 validation in Rust side.
+struct CharStrRef {
+    CharStrRef() = _COPY_DELETE;
+    CharStrRef(const CharStrRef&) = default;
+    CharStrRef& operator=(const CharStrRef&) = default;
+    // #if !_MSC_VER
+    constexpr CharStrRef(const char* head, usize size) noexcept : _data(_wrap_null(head)), _size(size) {}
+    template <class R>
+    constexpr CharStrRef(SAFE_R range) noexcept
+        : _data(_wrap_null(ranges::data(range))), _size(ranges::size(range)) {}
+    CharStrRef(std::nullptr_t) noexcept : _data(EMPTY_SLICE_BEGIN(const char)), _size(0) {}
+    // #endif
+
+    const char* _data;
+    usize _size;
+
+    // constants and types
+    using element_type = const char;
+    using value_type = typename std::remove_cv_t<const char>;
+    using size_type = uintptr_t;
+    using difference_type = intptr_t;
+    using pointer = element_type*;
+    using const_pointer = const element_type*;
+    using reference = element_type&;
+    using const_reference = const element_type&;
+#if FFI_TYPES_POINTER_ITERATOR
+    using iterator = pointer;
+#else
+    using iterator = typename std::string_view::iterator;
+#endif
+    using reverse_iterator = std::reverse_iterator<iterator>;
+
+    // observers
+    constexpr size_type size() const noexcept {
+        return this->_size;
+    }
+    constexpr size_type size_bytes() const noexcept {
+        return this->size() * sizeof(element_type);
+    }
+    constexpr bool empty() const noexcept {
+        return this->size() == 0;
+    }
+
+    // element access
+    constexpr reference operator[](size_type idx) const noexcept {
+        assert(idx < this->size());
+        return this->data()[idx];
+    }
+    constexpr reference front() const noexcept {
+        return this->data()[0];
+    }
+    constexpr reference back() const noexcept {
+        return this->data()[size() - 1];
+    }
+    constexpr pointer data() const noexcept {
+        return this->_data;
+    }
+
+    // iterator
+#if FFI_TYPES_POINTER_ITERATOR
+    iterator begin() const noexcept {
+        return data();
+    }
+#else
+    iterator begin() const noexcept {
+        return view().begin();
+    }
+#endif
+    iterator end() const noexcept {
+        return begin() + size();
+    }
+    reverse_iterator rbegin() const noexcept {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend() const noexcept {
+        return reverse_iterator(begin());
+    }
+
+    _SliceRange<element_type> get() const noexcept {
+        return {data(), size()};
+    }
+
+#if __cpp_lib_span
+    /// Returns the slice as a `std::span`.
+    std::span<element_type> span() const noexcept {
+        return std::span<element_type>(data(), size());
+    }
+#endif
+
+    StrRef as_str_unchecked() const noexcept;
+
+    /// Checks if the string is a valid UTF-8 string by the same rule as Rust `std::str::from_utf8`.
+    bool is_utf8() const noexcept {
+        return _utf8::validate(this->_data, this->_size);
+    }
+
+    /// Convert to Rust string wrapper with UTF-8 validation.
+    /// The result can be passed to Rust side as `&str` without validating again.
+    /// @return `std::nullopt` if the string is not a valid UTF-8 string.
+    std::optional<StrRef> as_str() const noexcept;
+
+#if __cpp_lib_string_view
+    /// Constructs a `CharStrRef` from a null-terminated string.
+    constexpr CharStrRef(const char* s) noexcept : CharStrRef(std::string_view(s)) {}
+
+    /// Returns a `std::string_view` of the string.
+    constexpr std::string_view view() const noexcept {
+        return std::string_view(this->data(), this->size());
+    }
+
+    /// Conversion operator to `std::string_view`.
+    operator std::string_view() const noexcept {
+        return this->view();
+    }
+
+    /// Create a `std::string` by copying data.
+    /// @return The newly created `std::string`.
+    std::string to_string() const noexcept {
+        return std::string(this->view());
+    }
+#endif
+
+    static CharStrRef _from_parts(const char* head, usize size) noexcept {
+        return CharStrRef(head, size);
+    }
+
+    // Allocation-free searches with the same results as Rust `str` methods, e.g. an empty needle is found at 0 by
+    // `find()` and at `size()` by `rfind()`. Found indices are byte offsets.
+
+    /// Returns the byte index of the first `needle`, or `std::nullopt`. Same as Rust `str::find`.
+    std::optional<usize> find(const CharStrRef& needle) const noexcept {
+        const usize i = _str::find(this->_data, this->_size, needle._data, needle._size);
+        return i == _str::NOT_FOUND ? std::nullopt : std::optional<usize>(i);
+    }
+    std::optional<usize> find(char needle) const noexcept {
+        return this->find(CharStrRef(&needle, 1));
+    }
+
+    /// Returns the byte index of the last `needle`, or `std::nullopt`. Same as Rust `str::rfind`.
+    std::optional<usize> rfind(const CharStrRef& needle) const noexcept {
+        const usize i = _str::rfind(this->_data, this->_size, needle._data, needle._size);
+        return i == _str::NOT_FOUND ? std::nullopt : std::optional<usize>(i);
+    }
+    std::optional<usize> rfind(char needle) const noexcept {
+        return this->rfind(CharStrRef(&needle, 1));
+    }
+
+    bool contains(const CharStrRef& needle) const noexcept {
+        return _str::find(this->_data, this->_size, needle._data, needle._size) != _str::NOT_FOUND;
+    }
+    bool contains(char needle) const noexcept {
+        return this->contains(CharStrRef(&needle, 1));
+    }
+
+    bool starts_with(const CharStrRef& prefix) const noexcept {
+        return prefix._size <= this->_size && _equal(CharStrRef(this->_data, prefix._size), prefix);
+    }
+    bool ends_with(const CharStrRef& suffix) const noexcept {
+        return suffix._size <= this->_size &&
+               _equal(CharStrRef(this->_data + this->_size - suffix._size, suffix._size), suffix);
+    }
+
+    /// Checks if the strings are equal after ASCII lowercasing. Same as Rust `str::eq_ignore_ascii_case`.
+    bool eq_ignore_ascii_case(const CharStrRef& other) const noexcept {
+        return this->_size == other._size && _str::eq_ignore_ascii_case(this->_data, other._data, this->_size);
+    }
+
+    /// Splits the string by any byte of `separators`. Both strings must outlive the range.
+    _StrSplit<CharStrRef> split(const CharStrRef& separators) const noexcept {
+        return {this->_data, this->_size, separators._data, separators._size};
+    }
+
+    /// Compares bytes like `memcmp`, then sizes. Same order as Rust `str` and `std::string_view`.
+    static int _compare(const CharStrRef& a, const CharStrRef& b) noexcept {
+        const auto size = std::min(a.size(), b.size());
+        const int r = size > 0 ? std::memcmp(a.data(), b.data(), size) : 0;
+        if (r != 0) {
+            return r;
+        }
+        return a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0;
+    }
+
+    static const CharStrRef& _ref(const CharStrRef& s) noexcept {
+        return s;
+    }
+#if __cpp_lib_string_view
+    template <typename S>
+    static CharStrRef _ref(const S& s) noexcept {
+        if constexpr (std::is_convertible_v<const S&, std::string_view>) {
+            const auto view = std::string_view(s);
+            return CharStrRef(view.data(), view.size());
+        } else {
+            // owned strings not derived from `CharStrRef`, e.g. `CompactStr`
+            return s.as_str();
+        }
+    }
+    template <typename S>
+    using _if_other_str = std::enable_if_t<
+            !std::is_base_of_v<CharStrRef, S> && std::is_convertible_v<const S&, std::string_view>,
+            int>;
+    template <typename S>
+    using _if_str = std::enable_if_t<
+            std::is_base_of_v<CharStrRef, S> || std::is_convertible_v<const S&, std::string_view>,
+            int>;
+#endif
+
+    static bool _equal(const CharStrRef& a, const CharStrRef& b) noexcept {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+    }
+
+// comparisons of `CharStrRef`, `StrRef` and `BoxedStr` with each other or with any string convertible to
+// `std::string_view`. The latter is a template to be an exact match and preferred over `std::string_view` operators.
+// Owned strings not derived from `CharStrRef` define the same operators by this macro, which is undefined at the end.
+#if __cpp_impl_three_way_comparison
+#define _STR_COMPARISONS(A, B, ...)                                                                                    \
+    __VA_ARGS__ friend bool operator==(A a, B b) noexcept {                                                            \
+        return CharStrRef::_equal(CharStrRef::_ref(a), CharStrRef::_ref(b));                                           \
+    }                                                                                                                  \
+    __VA_ARGS__ friend std::strong_ordering operator<=>(A a, B b) noexcept {                                           \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) <=> 0;                                   \
+    }
+#else
+#define _STR_COMPARISONS(A, B, ...)                                                                                    \
+    __VA_ARGS__ friend bool operator==(A a, B b) noexcept {                                                            \
+        return CharStrRef::_equal(CharStrRef::_ref(a), CharStrRef::_ref(b));                                           \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator!=(A a, B b) noexcept {                                                            \
+        return !CharStrRef::_equal(CharStrRef::_ref(a), CharStrRef::_ref(b));                                          \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator<(A a, B b) noexcept {                                                             \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) < 0;                                     \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator<=(A a, B b) noexcept {                                                            \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) <= 0;                                    \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator>(A a, B b) noexcept {                                                             \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) > 0;                                     \
+    }                                                                                                                  \
+    __VA_ARGS__ friend bool operator>=(A a, B b) noexcept {                                                            \
+        return CharStrRef::_compare(CharStrRef::_ref(a), CharStrRef::_ref(b)) >= 0;                                    \
+    }
+#endif
+    _STR_COMPARISONS(const CharStrRef&, const CharStrRef&, inline)
+#if __cpp_lib_string_view
+    _STR_COMPARISONS(const CharStrRef&, const S&, template <typename S, _if_other_str<S> = 0>)
+#if !__cpp_impl_three_way_comparison
+    _STR_COMPARISONS(const S&, const CharStrRef&, template <typename S, _if_other_str<S> = 0>)
+#endif
+#endif
+};
+static_assert(sizeof(SliceRef<char>) == sizeof(CharStrRef));
+static_assert(std::is_trivial<CharStrRef>::value);
+static_assert(std::is_standard_layout<CharStrRef>::value);
+
+/// C++ counterpart of Rust `&str`.
+///
+/// Because `StrRef` in C++ side doesn't have any UTF-8 validation checking,
+/// this type is highly recommended to be created from Rust side.
+///
+/// To create `StrRef` in C++ side, use `ByteSliceRef::as_str_unchecked()` or `CharStrRef::as_str_unchecked()`
+/// at your own risk.
+struct StrRef : public CharStrRef {
+    StrRef() = delete;
+    StrRef(const StrRef&) = default;
+    StrRef(const BoxedStr&) noexcept;
+    StrRef(std::nullptr_t) noexcept : CharStrRef(EMPTY_SLICE_BEGIN(const char), 0) {}
+
+    /// Tag of the constructor without UTF-8 checking.
+    struct _Unchecked {};
+    /// Creates a `StrRef` without UTF-8 checking. Use `_rs` literal for string literals.
+    ///
+    /// @warning Safety: Only when the data is a valid UTF-8 string.
+    constexpr StrRef(_Unchecked, const char* head, usize size) noexcept : CharStrRef(head, size) {}
+
+    StrRef& operator=(const StrRef&) = default;
+
+    /// A `StrRef` is always a valid UTF-8 string.
+    StrRef as_str() const noexcept {
+        return *this;
+    }
+
+    static StrRef _from_parts(const char* head, usize size) noexcept {
+        return StrRef(_Unchecked{}, head, size);
+    }
+
+    /// Splits the string by any ASCII character of `separators` into `StrRef` parts. Same as Rust
+    /// `str::split(&[char])`. Both strings must outlive the range.
+    _StrSplit<StrRef> split(const CharStrRef& separators) const noexcept {
+        // a non-ASCII separator would split a multi-byte character
+        assert(std::all_of(separators.data(), separators.data() + separators.size(),
+                           [](char c) { return static_cast<uint8_t>(c) < 0x80; }));
+        return {this->_data, this->_size, separators._data, separators._size};
+    }
+};
+static_assert(std::is_trivially_copyable<StrRef>::value);
+static_assert(std::is_standard_layout<StrRef>::value);
+
+/// Fails the constant evaluation of `_rs` literal of an invalid UTF-8 string.
+inline void _invalid_utf8_literal() noexcept {
+    assert(false && "invalid UTF-8 literal");
+    std::abort();
+}
+
+inline namespace literals {
+/// Creates a `StrRef` of a string literal, e.g. `"key"_rs`.
+/// The literal is validated at compile time in C++20 and in constant expressions of C++17,
+/// so it can initialize `constexpr` or `constinit` tables of `StrRef` and `CStrRef` without dynamic initializers.
+#if __cpp_consteval
+#define _RS_LITERAL consteval
+#else
+#define _RS_LITERAL constexpr
+#endif
+_RS_LITERAL StrRef operator""_rs(const char* s, size_t size) noexcept {
+    if (!_utf8::validate_constexpr(s, size)) {
+        _invalid_utf8_literal();
+    }
+    return StrRef(StrRef::_Unchecked{}, s, size);
+}
+#undef _RS_LITERAL
+}  // namespace literals
+
+/// C++ counterpart of Rust `Box<str>`.
+class BoxedStr : public StrRef {
+public:
+    BoxedStr() = delete;
+    BoxedStr(BoxedStr&) = delete;
+    BoxedStr(BoxedStr&& s) noexcept : StrRef(s) {
+        s._data = EMPTY_SLICE_BEGIN(const char);
+        s._size = 0;
+    }
+    BoxedStr(std::nullptr_t) noexcept : StrRef(nullptr) {}
+
+    ~BoxedStr() noexcept {
+        if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+            this->_drop();
+        }
+    }
+
+    BoxedStr& operator=(BoxedStr&& b) noexcept {
+        this->_reset(b._take());
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Drops every item of `items` by a single call to Rust side. The items are left empty.
+    static void _drop_many(MutSliceRef<BoxedStr> items) noexcept;
+
+    void reset(_SliceRange<const char> s) noexcept {
+        instrument::_acquire(instrument::_Kind::boxed_str, s._size > 0, s._size);
+        this->_reset(s);
+    }
+
+    _SliceRange<const char> release() noexcept {
+        instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::released, this->_size > 0, this->_size);
+        return this->_take();
+    }
+
+    /// Same as `reset()` for a value already owned by C++ side, e.g. moved from another owned value.
+    void _reset(_SliceRange<const char> s) noexcept {
+        if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+            this->_drop();
+        }
+        this->_data = s._data;
+        this->_size = s._size;
+    }
+
+    /// Same as `release()` but the ownership stays in C++ side, e.g. moved to another owned value.
+    _SliceRange<const char> _take() noexcept {
+        const auto range = this->get();
+        this->_data = EMPTY_SLICE_BEGIN(const char);
+        this->_size = 0;
+        return range;
+    }
+
+    StrRef as_str() const noexcept {
+        return this->as_str_unchecked();
+    }
+
+    /// Creates a `BoxedStr` by copying `s` into memory from the Rust global allocator.
+    /// @return `std::nullopt` if `s` is not a valid UTF-8 string.
+    static std::optional<BoxedStr> from_utf8_copy(CharStrRef s) noexcept;
+};
+static_assert(sizeof(StrRef) == sizeof(BoxedStr));
+static_assert(std::is_standard_layout<BoxedStr>::value);
+
+struct CCompactStr;
+
+/// C++ counterpart for Rust `CompactStr`, a `BoxedStr` storing short strings inline.
+///
+/// A string up to `inline_capacity` bytes is stored in the `{ptr, len}` footprint itself.
+/// The highest bit of the length word tags an inline string, and the rest of its highest byte is the length.
+/// Longer strings are exactly `BoxedStr`.
+///
+/// @note A `StrRef` of an inline string borrows the `CompactStr` itself. It is invalidated by moving the value.
+class CompactStr {
+public:
+    const char* _data;
+    usize _size;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    /// Inline strings need the tag byte at the end, which is only true for little-endian.
+    static constexpr usize inline_capacity = 0;
+#else
+    static constexpr usize inline_capacity = 2 * sizeof(usize) - 1;
+#endif
+    static constexpr usize _INLINE_TAG = usize(1) << (sizeof(usize) * 8 - 1);
+    static constexpr usize _LEN_SHIFT = (sizeof(usize) - 1) * 8;
+
+    CompactStr() = delete;
+    CompactStr(const CompactStr&) = delete;
+    CompactStr(CompactStr&& s) noexcept {
+        std::memcpy(static_cast<void*>(this), &s, sizeof(CompactStr));
+        s._set_inline_size(0);
+    }
+    /// Creates an empty inline string.
+    CompactStr(std::nullptr_t) noexcept : _data(nullptr), _size(_INLINE_TAG) {}
+    /// Takes the ownership of `s` without copying it.
+    explicit CompactStr(BoxedStr&& s) noexcept {
+        auto r = s._take();
+        this->_data = r._data;
+        this->_size = r._size;
+    }
+
+    ~CompactStr() noexcept {
+        if (!this->is_inline() && this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+            this->_drop();
+        }
+    }
+
+    CompactStr& operator=(CompactStr&& s) noexcept {
+        if (this != &s) {
+            if (!this->is_inline() && this->_size > 0) {
+                instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+                this->_drop();
+            }
+            std::memcpy(static_cast<void*>(this), &s, sizeof(CompactStr));
+            s._set_inline_size(0);
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Sets the highest byte only. The other bytes of the length word are inline data.
+    void _set_inline_size(usize size) noexcept {
+        assert(size <= inline_capacity);
+        constexpr usize mask = usize(0xff) << _LEN_SHIFT;
+        this->_size = (this->_size & ~mask) | _INLINE_TAG | (size << _LEN_SHIFT);
+    }
+
+    bool is_inline() const noexcept {
+        return (this->_size & _INLINE_TAG) != 0;
+    }
+
+    const char* data() const noexcept {
+        return this->is_inline() ? reinterpret_cast<const char*>(this) : this->_data;
+    }
+    usize size() const noexcept {
+        return this->is_inline() ? (this->_size >> _LEN_SHIFT) & 0x7f : this->_size;
+    }
+    bool empty() const noexcept {
+        return this->size() == 0;
+    }
+    const char* begin() const noexcept {
+        return this->data();
+    }
+    const char* end() const noexcept {
+        return this->data() + this->size();
+    }
+
+    StrRef as_str() const noexcept {
+        auto s = StrRef(nullptr);
+        s._data = this->data();
+        s._size = this->size();
+        return s;
+    }
+    operator StrRef() const noexcept {
+        return this->as_str();
+    }
+
+    /// Converts to `CCompactStr` by moving the value.
+    /// The value of `this` will be invalidated to an empty string.
+    CCompactStr into() noexcept;
+
+    /// Creates a `CompactStr` by copying `s`.
+    /// Only a string longer than `inline_capacity` is allocated from the Rust global allocator.
+    /// @return `std::nullopt` if `s` is not a valid UTF-8 string.
+    static std::optional<CompactStr> from_utf8_copy(CharStrRef s) noexcept;
+
+    // comparisons between `CompactStr`
+    friend bool operator==(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() == b.as_str();
+    }
+    friend bool operator!=(const CompactStr& a, const CompactStr& b) noexcept {
+        return !(a == b);
+    }
+#if __cpp_impl_three_way_comparison
+    friend std::strong_ordering operator<=>(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() <=> b.as_str();
+    }
+#else
+    friend bool operator<(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() < b.as_str();
+    }
+    friend bool operator<=(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() <= b.as_str();
+    }
+    friend bool operator>(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() > b.as_str();
+    }
+    friend bool operator>=(const CompactStr& a, const CompactStr& b) noexcept {
+        return a.as_str() >= b.as_str();
+    }
+#endif
+    // comparisons with the other strings, which don't find the operators of `CharStrRef` by ADL
+    _STR_COMPARISONS(const CompactStr&, const S&, template <typename S, CharStrRef::_if_str<S> = 0>)
+#if !__cpp_impl_three_way_comparison
+    _STR_COMPARISONS(const S&, const CompactStr&, template <typename S, CharStrRef::_if_str<S> = 0>)
+#endif
+};
+static_assert(sizeof(CompactStr) == sizeof(BoxedStr));
+static_assert(std::is_standard_layout<CompactStr>::value);
+
+static_assert(sizeof(CCompactStr) == sizeof(CompactStr));
+
+/// C++ counterpart of Rust `&CStr`, a string followed by a NUL terminator which is excluded from `size()`.
+///
+/// `c_str()` passes the string to C APIs taking `const char*` without copying it to add the terminator.
+/// The bytes may not be UTF-8 as Rust `CStr`, so `as_str()` validates them as `CharStrRef` does.
+struct StrZRef : public CharStrRef {
+    StrZRef() = delete;
+    StrZRef(const StrZRef&) = default;
+    StrZRef(const BoxedCStr&) noexcept;
+    StrZRef(std::nullptr_t) noexcept : CharStrRef("", 0) {}
+    /// Creates a `StrZRef` of a null-terminated string, e.g. a string literal.
+    constexpr StrZRef(const char* s) noexcept : CharStrRef(s) {}
+    /// Creates a `StrZRef` of `s.c_str()`. `s` must not contain NUL.
+    StrZRef(const std::string& s) noexcept : CharStrRef(s.c_str(), s.size()) {
+        assert(std::memchr(s.data(), 0, s.size()) == nullptr);
+    }
+
+    /// Tag of the constructor without checking the terminator.
+    struct _Terminated {};
+    /// Creates a `StrZRef` without checking the terminator.
+    ///
+    /// @warning Safety: Only when `head[size]` is NUL and no byte before it is NUL.
+    constexpr StrZRef(_Terminated, const char* head, usize size) noexcept : CharStrRef(head, size) {}
+
+    StrZRef& operator=(const StrZRef&) = default;
+
+    /// Returns the string terminated by NUL at `size()`.
+    constexpr const char* c_str() const noexcept {
+        return this->_data;
+    }
+};
+static_assert(sizeof(StrZRef) == sizeof(CharStrRef));
+static_assert(std::is_trivially_copyable<StrZRef>::value);
+static_assert(std::is_standard_layout<StrZRef>::value);
+
+/// C++ counterpart of Rust `Box<CStr>`. The NUL terminator is owned with the string and excluded from `size()`.
+///
+/// An empty string points to a static terminator and owns nothing, same as an empty `BoxedStr`.
+class BoxedCStr : public StrZRef {
+public:
+    BoxedCStr() = delete;
+    BoxedCStr(BoxedCStr&) = delete;
+    BoxedCStr(BoxedCStr&& s) noexcept : StrZRef(s) {
+        s._data = "";
+        s._size = 0;
+    }
+    BoxedCStr(std::nullptr_t) noexcept : StrZRef(nullptr) {}
+
+    ~BoxedCStr() noexcept {
+        if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+            this->_drop();
+        }
+    }
+
+    BoxedCStr& operator=(BoxedCStr&& b) noexcept {
+        this->_reset(b._take());
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Takes the ownership of `s`, which is followed by a NUL terminator.
+    void reset(_SliceRange<const char> s) noexcept {
+        instrument::_acquire(instrument::_Kind::boxed_str, s._size > 0, s._size);
+        this->_reset(s);
+    }
+
+    /// Gives up the ownership. The returned range excludes the NUL terminator.
+    _SliceRange<const char> release() noexcept {
+        instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::released, this->_size > 0, this->_size);
+        return this->_take();
+    }
+
+    /// Same as `reset()` for a value already owned by C++ side, e.g. moved from another owned value.
+    void _reset(_SliceRange<const char> s) noexcept {
+        if (this->_size > 0) {
+            instrument::_DropScope scope(instrument::_Kind::boxed_str, this->_size);
+            this->_drop();
+        }
+        this->_data = s._data;
+        this->_size = s._size;
+    }
+
+    /// Same as `release()` but the ownership stays in C++ side, e.g. moved to another owned value.
+    _SliceRange<const char> _take() noexcept {
+        const auto range = this->get();
+        this->_data = "";
+        this->_size = 0;
+        return range;
+    }
+
+    /// Creates a `BoxedCStr` by copying `s` with a NUL terminator into memory from the Rust global allocator.
+    /// @return `std::nullopt` if `s` contains NUL.
+    static std::optional<BoxedCStr> from_copy(CharStrRef s) noexcept;
+};
+static_assert(sizeof(StrZRef) == sizeof(BoxedCStr));
+static_assert(std::is_standard_layout<BoxedCStr>::value);
+
+/// Drops every boxed value in a contiguous `range` of `BoxedStr` or `BoxedSlice<T>`.
+///
+/// Dropping is done by a single call to Rust side where `_drop_many()` is specialized.
+/// The values are left empty, so destructing them later is a no-op.
+template <class R>
+inline void drop_all(R& range) noexcept {
+    using value_type = std::remove_reference_t<decltype(*std::data(range))>;
+    value_type::_drop_many(MutSliceRef<value_type>(std::data(range), std::size(range)));
+}
+
+/// A counting iterator of indices of `_SliceChunks<T>`.
+///
+/// Parallel algorithms run in parallel only for iterators of which `iterator_category` is random access,
+/// which `_SliceChunks<T>::iterator` isn't because the views are made on dereference.
+/// `reference` is bound to the index in the iterator, as counting iterators of other libraries do.
+struct _IndexIterator {
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = usize;
+    using difference_type = intptr_t;
+    using pointer = const usize*;
+    using reference = const usize&;
+
+    usize _index;
+
+    reference operator*() const noexcept {
+        return this->_index;
+    }
+    value_type operator[](difference_type n) const noexcept {
+        return this->_index + n;
+    }
+    _IndexIterator& operator++() noexcept {
+        ++this->_index;
+        return *this;
+    }
+    _IndexIterator operator++(int) noexcept {
+        auto it = *this;
+        ++this->_index;
+        return it;
+    }
+    _IndexIterator& operator--() noexcept {
+        --this->_index;
+        return *this;
+    }
+    _IndexIterator operator--(int) noexcept {
+        auto it = *this;
+        --this->_index;
+        return it;
+    }
+    _IndexIterator& operator+=(difference_type n) noexcept {
+        this->_index += n;
+        return *this;
+    }
+    _IndexIterator& operator-=(difference_type n) noexcept {
+        this->_index -= n;
+        return *this;
+    }
+    friend _IndexIterator operator+(_IndexIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend _IndexIterator operator+(difference_type n, _IndexIterator it) noexcept {
+        return it += n;
+    }
+    friend _IndexIterator operator-(_IndexIterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+    friend difference_type operator-(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return static_cast<difference_type>(a._index - b._index);
+    }
+    friend bool operator==(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index == b._index;
+    }
+    friend bool operator!=(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index != b._index;
+    }
+    friend bool operator<(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index < b._index;
+    }
+    friend bool operator<=(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index <= b._index;
+    }
+    friend bool operator>(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index > b._index;
+    }
+    friend bool operator>=(const _IndexIterator& a, const _IndexIterator& b) noexcept {
+        return a._index >= b._index;
+    }
+};
+
+/// Calls `f` with each view of `slice.chunks(chunk_size)`, the same partition as Rust `par_chunks()` of rayon.
+///
+/// The chunks run by `std::execution::par` if `FFI_TYPES_PARALLEL` is 1, or sequentially otherwise.
+/// The algorithm runs over the indices of the chunks, and each view is made by `chunks[i]`.
+template <typename T, template <typename> typename I, typename F>
+inline void par_for_each_chunk(const _SliceInterface<T, I>& slice, usize chunk_size, F&& f) {
+    const auto chunks = slice.chunks(chunk_size);
+    const auto call = [&chunks, &f](usize i) { f(chunks[i]); };
+#if FFI_TYPES_PARALLEL && __cpp_lib_execution
+    std::for_each(std::execution::par, _IndexIterator{0}, _IndexIterator{chunks.size()}, call);
+#else
+    std::for_each(_IndexIterator{0}, _IndexIterator{chunks.size()}, call);
+#endif
+}
+
+/// `true` if `T` is a byte buffer laid out as `{ptr, len}`, which is the layout of `struct iovec` on unix.
+template <typename T>
+struct _is_io_buf : std::false_type {};
+template <>
+struct _is_io_buf<ByteSliceRef> : std::true_type {};
+template <>
+struct _is_io_buf<MutSliceRef<uint8_t>> : std::true_type {};
+template <>
+struct _is_io_buf<CByteSliceRef> : std::true_type {};
+template <>
+struct _is_io_buf<BoxedSlice<uint8_t>> : std::true_type {};
+template <>
+struct _is_io_buf<CBoxedSlice<uint8_t>> : std::true_type {};
+template <>
+struct _is_io_buf<MmapSlice> : std::true_type {};
+template <>
+struct _is_io_buf<CMmapSlice> : std::true_type {};
+template <>
+struct _is_io_buf<StrRef> : std::true_type {};
+template <>
+struct _is_io_buf<CStrRef> : std::true_type {};
+template <>
+struct _is_io_buf<BoxedStr> : std::true_type {};
+template <>
+struct _is_io_buf<CBoxedStr> : std::true_type {};
+template <>
+struct _is_io_buf<CharStrRef> : std::true_type {};
+
+#if __unix__ || __APPLE__
+static_assert(sizeof(struct iovec) == sizeof(ByteSliceRef), "iovec must be {ptr, len}");
+static_assert(alignof(struct iovec) == alignof(ByteSliceRef), "iovec must be {ptr, len}");
+static_assert(offsetof(struct iovec, iov_base) == 0, "iovec must be {ptr, len}");
+static_assert(offsetof(struct iovec, iov_len) == sizeof(void*), "iovec must be {ptr, len}");
+
+/// Views a contiguous `range` of byte buffers, e.g. `IoSliceRef` or `std::vector<BoxedSlice<uint8_t>>`,
+/// as `iovec`s without copying. The count of the elements is `std::size(range)`.
+///
+/// @note `writev()` takes a non-const `iovec*` but writes to neither the `iovec`s nor the buffers.
+template <class R>
+inline struct iovec* as_iovec(const R& range) noexcept {
+    using value_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(range))>>;
+    static_assert(_is_io_buf<value_type>::value, "the elements must be byte buffers laid out as {ptr, len}");
+    return reinterpret_cast<struct iovec*>(const_cast<value_type*>(std::data(range)));
+}
+#endif
+
+template <typename T>
+inline CMutSliceRef<T> MutSliceRef<T>::into() const noexcept {
+    return CMutSliceRef<T>::from(*this);
+}
+
+template <typename T>
+inline typename std::conditional<std::is_same_v<T, uint8_t>, CByteSliceRef, CSliceRef<T>>::type SliceRef<T>::into()
+        const noexcept {
     if constexpr (std::is_same_v<T, uint8_t>) {
         return CByteSliceRef::from(*this);
     } else {
@@ -1002,60 +3606,2464 @@ inline typename std::conditional<std::is_same_v<T, uint8_t>, CByteSliceRef, CSli
 }
 
 template <typename T>
-inline CBoxedSlice<T> BoxedSlice<T>::into() noexcept {
-    return CBoxedSlice<T>::from(std::move(*this));
+inline CBoxedSlice<T> BoxedSlice<T>::into() noexcept {
+    return CBoxedSlice<T>::from(std::move(*this));
+}
+
+template <typename T>
+inline CVec<T> Vec<T>::into() noexcept {
+    return CVec<T>::from(std::move(*this));
+}
+
+template <typename T>
+inline CForeignBoxedSlice<T> ForeignBoxedSlice<T>::into() noexcept {
+    return CForeignBoxedSlice<T>::from(std::move(*this));
+}
+
+inline CMmapSlice MmapSlice::into() noexcept {
+    return CMmapSlice::from(std::move(*this));
+}
+
+/// A `StrRef` carrying its hash by `hash_bytes()`.
+///
+/// C++ `HashedStrRef` and Rust `HashedStrRef` share the layout and the hash function,
+/// so a key hashed once in either side is looked up in both sides without hashing it again.
+struct HashedStrRef {
+    HashedStrRef() = _COPY_DELETE;
+    HashedStrRef(const HashedStrRef&) = default;
+    HashedStrRef& operator=(const HashedStrRef&) = default;
+    explicit HashedStrRef(const StrRef& s) noexcept
+        : _data(s.data()), _size(s.size()), _hash(hash_bytes(s.data(), s.size())) {}
+
+    const char* _data;
+    usize _size;
+    uint64_t _hash;
+
+    const char* data() const noexcept {
+        return this->_data;
+    }
+    usize size() const noexcept {
+        return this->_size;
+    }
+    bool empty() const noexcept {
+        return this->_size == 0;
+    }
+    const char* begin() const noexcept {
+        return this->_data;
+    }
+    const char* end() const noexcept {
+        return this->_data + this->_size;
+    }
+    uint64_t hash() const noexcept {
+        return this->_hash;
+    }
+
+    StrRef as_str() const noexcept {
+        return CharStrRef(this->_data, this->_size).as_str_unchecked();
+    }
+    operator StrRef() const noexcept {
+        return this->as_str();
+    }
+
+    friend bool operator==(const HashedStrRef& a, const HashedStrRef& b) noexcept {
+        return a._hash == b._hash && a.as_str() == b.as_str();
+    }
+    friend bool operator!=(const HashedStrRef& a, const HashedStrRef& b) noexcept {
+        return !(a == b);
+    }
+};
+static_assert(std::is_trivially_copyable<HashedStrRef>::value);
+static_assert(std::is_standard_layout<HashedStrRef>::value);
+
+/// Transparent hasher of strings for heterogeneous lookup.
+///
+/// `std::unordered_map<BoxedStr, V, StrHash, StrEqual>` can be looked up by `StrRef`, `CharStrRef`,
+/// `std::string_view` or `HashedStrRef` without allocation. `HashedStrRef` reuses its hash.
+struct StrHash {
+    using is_transparent = void;
+
+    template <typename S>
+    size_t operator()(const S& s) const noexcept {
+        const auto str = CharStrRef(s);
+        return static_cast<size_t>(hash_bytes(str.data(), str.size()));
+    }
+    size_t operator()(const HashedStrRef& s) const noexcept {
+        return static_cast<size_t>(s.hash());
+    }
+};
+
+/// Transparent equality of strings for heterogeneous lookup.
+/// @see StrHash
+struct StrEqual {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const noexcept {
+        return CharStrRef(a) == CharStrRef(b);
+    }
+};
+
+/// Hasher of slices as bytes for `std::hash`.
+template <typename S>
+struct _SliceHash {
+    size_t operator()(const S& s) const noexcept {
+        static_assert(
+                std::has_unique_object_representations_v<typename S::value_type>,
+                "only slices of values with unique object representations can be hashed as bytes");
+        return static_cast<size_t>(hash_bytes(s.data(), s.size_bytes()));
+    }
+};
+
+inline CCompactStr CompactStr::into() noexcept {
+    return CCompactStr::from(std::move(*this));
+}
+
+inline StrRef::StrRef(const BoxedStr& owned) noexcept : CharStrRef(owned._data, owned._size) {}
+inline StrZRef::StrZRef(const BoxedCStr& owned) noexcept : CharStrRef(owned._data, owned._size) {}
+
+inline StrRef CharStrRef::as_str_unchecked() const noexcept {
+    return *reinterpret_cast<const StrRef*>(this);
+}
+inline std::optional<StrRef> CharStrRef::as_str() const noexcept {
+    if (!this->is_utf8()) {
+        return std::nullopt;
+    }
+    return this->as_str_unchecked();
+}
+template <>
+template <>
+inline CharStrRef MutSliceRef<const uint8_t>::as_char_str<const uint8_t>() const noexcept {
+    return CharStrRef(reinterpret_cast<const char*>(this->_data), this->_size);
+}
+template <>
+template <>
+inline StrRef MutSliceRef<const uint8_t>::as_str_unchecked<const uint8_t>() const noexcept {
+    return as_char_str().as_str_unchecked();
+}
+
+#if __cpp_lib_ranges
+// std algorithms are lowered to `memchr()` or `memmove()` only for contiguous iterators.
+static_assert(std::contiguous_iterator<MutSliceRef<int>::iterator>);
+static_assert(std::contiguous_iterator<SliceRef<int>::iterator>);
+static_assert(std::contiguous_iterator<BoxedSlice<int>::iterator>);
+static_assert(std::contiguous_iterator<Vec<int>::iterator>);
+static_assert(std::contiguous_iterator<CharStrRef::iterator>);
+static_assert(std::contiguous_iterator<StrRef::iterator>);
+static_assert(std::contiguous_iterator<BoxedStr::iterator>);
+static_assert(std::ranges::contiguous_range<SliceRef<int>>);
+static_assert(std::ranges::contiguous_range<Vec<int>>);
+static_assert(std::ranges::contiguous_range<StrRef>);
+static_assert(std::ranges::contiguous_range<CompactStr>);
+#endif
+#if FFI_TYPES_POINTER_ITERATOR
+static_assert(std::is_pointer_v<SliceRef<int>::iterator>);
+static_assert(std::is_pointer_v<StrRef::iterator>);
+#endif
+
+#undef SAFE_R
+
+}  // namespace ffi_types
+
+namespace std {
+
+template <>
+struct hash<ffi_types::CharStrRef> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::StrRef> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::BoxedStr> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::CompactStr> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::HashedStrRef> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::StrZRef> : ffi_types::StrHash {};
+template <>
+struct hash<ffi_types::BoxedCStr> : ffi_types::StrHash {};
+
+template <typename T>
+struct hash<ffi_types::MutSliceRef<T>> : ffi_types::_SliceHash<ffi_types::MutSliceRef<T>> {};
+template <typename T>
+struct hash<ffi_types::SliceRef<T>> : ffi_types::_SliceHash<ffi_types::SliceRef<T>> {};
+template <typename T>
+struct hash<ffi_types::BoxedSlice<T>> : ffi_types::_SliceHash<ffi_types::BoxedSlice<T>> {};
+template <typename T>
+struct hash<ffi_types::Vec<T>> : ffi_types::_SliceHash<ffi_types::Vec<T>> {};
+template <typename T>
+struct hash<ffi_types::ForeignBoxedSlice<T>> : ffi_types::_SliceHash<ffi_types::ForeignBoxedSlice<T>> {};
+
+}  // namespace std
+
+#undef _STR_SIMD
+namespace ffi_types {
+
+template <typename T>
+struct CSliceSender;
+template <typename T>
+struct CSliceReceiver;
+
+/// An index owned by one side with a cached copy of the index of the other side.
+/// Same layout as Rust `Cursor`.
+struct alignas(64) _ChannelCursor {
+    std::atomic<usize> index;
+    usize cached;
+};
+
+/// Same layout as Rust `ChannelInner<T>`. The channel is allocated and freed by Rust side.
+template <typename T>
+struct _ChannelInner {
+    /// The next slot to receive, written by the receiver.
+    _ChannelCursor head;
+    /// The next slot to send, written by the sender.
+    _ChannelCursor tail;
+    CBoxedSlice<T>* slots;
+    usize mask;
+    std::atomic<usize> refs;
+};
+static_assert(sizeof(_ChannelInner<int>) == 3 * 64);
+static_assert(std::atomic<usize>::is_always_lock_free);
+
+/// C++ counterpart for Rust `SliceSender<T>`, the sending half of a lock-free single-producer single-consumer
+/// channel of `BoxedSlice<T>`.
+///
+/// Sending is inline and moves the ownership of the slice without copying the elements.
+/// Only one thread may send at once.
+///
+/// @note Specialize `_drop()` to release the channel in Rust side. `SliceSender<uint8_t>` is specialized by default.
+template <typename T>
+class SliceSender {
+public:
+    _ChannelInner<T>* _inner;
+
+    SliceSender() = delete;
+    SliceSender(const SliceSender<T>&) = delete;
+    SliceSender(SliceSender<T>&& s) noexcept : _inner(s.release()) {}
+    SliceSender(std::nullptr_t) noexcept : _inner(nullptr) {}
+    explicit SliceSender(_ChannelInner<T>* inner) noexcept : _inner(inner) {}
+    ~SliceSender() noexcept {
+        if (this->_inner) {
+            this->_drop();
+        }
+    }
+    SliceSender<T>& operator=(SliceSender<T>&& s) noexcept {
+        if (this != &s) {
+            if (this->_inner) {
+                this->_drop();
+            }
+            this->_inner = s.release();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Sends `value` without blocking. Returns `false` and leaves `value` as it is if the channel is full.
+    bool try_send(BoxedSlice<T>&& value) noexcept {
+        auto& inner = *this->_inner;
+        const auto tail = inner.tail.index.load(std::memory_order_relaxed);
+        if (tail - inner.tail.cached > inner.mask) {
+            inner.tail.cached = inner.head.index.load(std::memory_order_acquire);
+            if (tail - inner.tail.cached > inner.mask) {
+                return false;
+            }
+        }
+        inner.slots[tail & inner.mask] = CBoxedSlice<T>::from(std::move(value));
+        inner.tail.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns `true` if the receiver is dropped.
+    bool is_disconnected() const noexcept {
+        return this->_inner->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    explicit operator bool() const noexcept {
+        return this->_inner != nullptr;
+    }
+
+    CSliceSender<T> into() noexcept;
+
+    _ChannelInner<T>* release() noexcept {
+        auto* inner = this->_inner;
+        this->_inner = nullptr;
+        return inner;
+    }
+};
+static_assert(sizeof(SliceSender<int>) == sizeof(void*));
+static_assert(std::is_standard_layout<SliceSender<int>>::value);
+
+/// C++ counterpart for Rust `SliceReceiver<T>`, the receiving half of a lock-free single-producer single-consumer
+/// channel of `BoxedSlice<T>`.
+///
+/// Receiving is inline and moves the ownership of the slice without copying the elements.
+/// Only one thread may receive at once.
+///
+/// @note Specialize `_drop()` to release the channel in Rust side. `SliceReceiver<uint8_t>` is specialized by default.
+template <typename T>
+class SliceReceiver {
+public:
+    _ChannelInner<T>* _inner;
+
+    SliceReceiver() = delete;
+    SliceReceiver(const SliceReceiver<T>&) = delete;
+    SliceReceiver(SliceReceiver<T>&& s) noexcept : _inner(s.release()) {}
+    SliceReceiver(std::nullptr_t) noexcept : _inner(nullptr) {}
+    explicit SliceReceiver(_ChannelInner<T>* inner) noexcept : _inner(inner) {}
+    ~SliceReceiver() noexcept {
+        if (this->_inner) {
+            this->_drop();
+        }
+    }
+    SliceReceiver<T>& operator=(SliceReceiver<T>&& s) noexcept {
+        if (this != &s) {
+            if (this->_inner) {
+                this->_drop();
+            }
+            this->_inner = s.release();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Receives a value without blocking. Returns `std::nullopt` if the channel is empty.
+    std::optional<BoxedSlice<T>> try_recv() noexcept {
+        auto& inner = *this->_inner;
+        const auto head = inner.head.index.load(std::memory_order_relaxed);
+        if (head == inner.head.cached) {
+            inner.head.cached = inner.tail.index.load(std::memory_order_acquire);
+            if (head == inner.head.cached) {
+                return std::nullopt;
+            }
+        }
+        auto value = inner.slots[head & inner.mask]();
+        inner.head.index.store(head + 1, std::memory_order_release);
+        return std::optional<BoxedSlice<T>>(std::move(value));
+    }
+
+    /// Returns `true` if the sender is dropped. Values sent before are still received.
+    bool is_disconnected() const noexcept {
+        return this->_inner->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    explicit operator bool() const noexcept {
+        return this->_inner != nullptr;
+    }
+
+    CSliceReceiver<T> into() noexcept;
+
+    _ChannelInner<T>* release() noexcept {
+        auto* inner = this->_inner;
+        this->_inner = nullptr;
+        return inner;
+    }
+};
+static_assert(sizeof(SliceReceiver<int>) == sizeof(void*));
+static_assert(std::is_standard_layout<SliceReceiver<int>>::value);
+
+template <typename T>
+inline CSliceSender<T> SliceSender<T>::into() noexcept {
+    return CSliceSender<T>::from(std::move(*this));
+}
+
+template <typename T>
+inline CSliceReceiver<T> SliceReceiver<T>::into() noexcept {
+    return CSliceReceiver<T>::from(std::move(*this));
+}
+
+}  // namespace ffi_types
+namespace ffi_types {
+
+struct CCowStr;
+template <typename T>
+struct CCowSlice;
+
+/// The highest bit of the length word of `CowStr` and `CowSlice<T>`, which tags an owned value.
+inline constexpr usize _COW_OWNED_TAG = usize(1) << (sizeof(usize) * 8 - 1);
+
+/// C++ counterpart for Rust `CowStr`, a string either borrowed from Rust storage or owned.
+///
+/// An owned string is exactly a `BoxedStr` with the highest bit of the length word set,
+/// and the destructor drops only an owned string. Both are read as `StrRef` without branching on the data.
+///
+/// @note A borrowed string is valid as long as the storage Rust side borrowed it from.
+class CowStr {
+public:
+    const char* _data;
+    usize _size;
+
+    CowStr() = delete;
+    CowStr(const CowStr&) = delete;
+    CowStr(CowStr&& s) noexcept : _data(s._data), _size(s._size) {
+        s._reset_empty();
+    }
+    CowStr(std::nullptr_t) noexcept : _data(reinterpret_cast<const char*>(1)), _size(0) {}
+    /// Borrows `s` without copying it.
+    explicit CowStr(const StrRef& s) noexcept : _data(s.data()), _size(s.size()) {
+        assert((s.size() & _COW_OWNED_TAG) == 0);
+    }
+    /// Takes the ownership of `s` without copying it.
+    explicit CowStr(BoxedStr&& s) noexcept {
+        auto r = s._take();
+        this->_data = r._data;
+        this->_size = r._size > 0 ? r._size | _COW_OWNED_TAG : 0;
+    }
+
+    ~CowStr() noexcept {
+        this->_drop();
+    }
+
+    CowStr& operator=(CowStr&& s) noexcept {
+        if (this != &s) {
+            this->_drop();
+            this->_data = s._data;
+            this->_size = s._size;
+            s._reset_empty();
+        }
+        return *this;
+    }
+
+    /// Drops an owned string as a `BoxedStr`. A borrowed string is left as it is.
+    void _drop() noexcept {
+        if (this->is_owned()) {
+            auto owned = BoxedStr(nullptr);
+            owned._reset({this->_data, this->size()});
+            this->_reset_empty();
+        }
+    }
+    void _reset_empty() noexcept {
+        this->_data = reinterpret_cast<const char*>(1);
+        this->_size = 0;
+    }
+
+    bool is_owned() const noexcept {
+        return (this->_size & _COW_OWNED_TAG) != 0;
+    }
+
+    const char* data() const noexcept {
+        return this->_data;
+    }
+    usize size() const noexcept {
+        return this->_size & ~_COW_OWNED_TAG;
+    }
+    bool empty() const noexcept {
+        return this->size() == 0;
+    }
+    const char* begin() const noexcept {
+        return this->data();
+    }
+    const char* end() const noexcept {
+        return this->data() + this->size();
+    }
+
+    StrRef as_str() const noexcept {
+        return StrRef::_from_parts(this->data(), this->size());
+    }
+    operator StrRef() const noexcept {
+        return this->as_str();
+    }
+
+    /// Returns the owned string, copying a borrowed one. `this` is left empty.
+    BoxedStr into_owned() && noexcept {
+        if (!this->is_owned()) {
+            auto owned = this->to_owned();
+            this->_reset_empty();
+            return owned;
+        }
+        auto owned = BoxedStr(nullptr);
+        owned._reset({this->_data, this->size()});
+        this->_reset_empty();
+        return owned;
+    }
+
+    /// Returns a copy of the string owned by C++ side.
+    BoxedStr to_owned() const noexcept;
+
+    /// Converts to `CCowStr` by moving the value.
+    /// The value of `this` will be invalidated to an empty string.
+    CCowStr into() noexcept;
+
+    // comparisons between `CowStr`
+    friend bool operator==(const CowStr& a, const CowStr& b) noexcept {
+        return a.as_str() == b.as_str();
+    }
+    friend bool operator!=(const CowStr& a, const CowStr& b) noexcept {
+        return !(a == b);
+    }
+    // comparisons with the other strings, which don't find the operators of `CharStrRef` by ADL
+    _STR_COMPARISONS(const CowStr&, const S&, template <typename S, CharStrRef::_if_str<S> = 0>)
+#if !__cpp_impl_three_way_comparison
+    _STR_COMPARISONS(const S&, const CowStr&, template <typename S, CharStrRef::_if_str<S> = 0>)
+#endif
+};
+static_assert(sizeof(CowStr) == sizeof(BoxedStr));
+static_assert(std::is_standard_layout<CowStr>::value);
+
+static_assert(sizeof(CCowStr) == sizeof(CowStr));
+
+inline CCowStr CowStr::into() noexcept {
+    return CCowStr::from(std::move(*this));
+}
+
+/// C++ counterpart for Rust `CowSlice<T>`, a slice either borrowed from Rust storage or owned.
+///
+/// An owned slice is exactly a `BoxedSlice<T>` with the highest bit of the length word set,
+/// and the destructor drops only an owned slice. Both are read as `SliceRef<T>`.
+///
+/// @note An owned slice is dropped by `BoxedSlice<T>::_drop()`, which must be specialized for `T`.
+template <typename T>
+class CowSlice {
+public:
+    const T* _data;
+    usize _size;
+
+    CowSlice() = delete;
+    CowSlice(const CowSlice<T>&) = delete;
+    CowSlice(CowSlice<T>&& s) noexcept : _data(s._data), _size(s._size) {
+        s._reset_empty();
+    }
+    CowSlice(std::nullptr_t) noexcept : _data(reinterpret_cast<const T*>(alignof(T))), _size(0) {}
+    /// Borrows `s` without copying it.
+    explicit CowSlice(const SliceRef<T>& s) noexcept : _data(s.data()), _size(s.size()) {
+        assert((s.size() & _COW_OWNED_TAG) == 0);
+    }
+    /// Takes the ownership of `s` without copying it.
+    explicit CowSlice(BoxedSlice<T>&& s) noexcept {
+        auto r = s._take();
+        this->_data = r._data;
+        this->_size = r._size > 0 ? r._size | _COW_OWNED_TAG : 0;
+    }
+
+    ~CowSlice() noexcept {
+        this->_drop();
+    }
+
+    CowSlice<T>& operator=(CowSlice<T>&& s) noexcept {
+        if (this != &s) {
+            this->_drop();
+            this->_data = s._data;
+            this->_size = s._size;
+            s._reset_empty();
+        }
+        return *this;
+    }
+
+    /// Drops an owned slice as a `BoxedSlice<T>`. A borrowed slice is left as it is.
+    void _drop() noexcept {
+        if (this->is_owned()) {
+            auto owned = BoxedSlice<T>(nullptr);
+            owned._reset({const_cast<T*>(this->_data), this->size()});
+            this->_reset_empty();
+        }
+    }
+    void _reset_empty() noexcept {
+        this->_data = reinterpret_cast<const T*>(alignof(T));
+        this->_size = 0;
+    }
+
+    bool is_owned() const noexcept {
+        return (this->_size & _COW_OWNED_TAG) != 0;
+    }
+
+    const T* data() const noexcept {
+        return this->_data;
+    }
+    usize size() const noexcept {
+        return this->_size & ~_COW_OWNED_TAG;
+    }
+    bool empty() const noexcept {
+        return this->size() == 0;
+    }
+    const T* begin() const noexcept {
+        return this->data();
+    }
+    const T* end() const noexcept {
+        return this->data() + this->size();
+    }
+    const T& operator[](usize idx) const noexcept {
+        assert(idx < this->size());
+        return this->_data[idx];
+    }
+
+    SliceRef<T> as_slice() const noexcept {
+        return SliceRef<T>(this->data(), this->size());
+    }
+    operator SliceRef<T>() const noexcept {
+        return this->as_slice();
+    }
+
+    /// Returns the owned slice, copying a borrowed one. `this` is left empty.
+    BoxedSlice<T> into_owned() && noexcept {
+        if (!this->is_owned()) {
+            auto owned = this->to_owned();
+            this->_reset_empty();
+            return owned;
+        }
+        auto owned = BoxedSlice<T>(nullptr);
+        owned._reset({const_cast<T*>(this->_data), this->size()});
+        this->_reset_empty();
+        return owned;
+    }
+
+    /// Returns a copy of the slice allocated from the Rust global allocator.
+    BoxedSlice<T> to_owned() const noexcept {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable elements are copied");
+        auto owned = BoxedSlice<T>::with_capacity_uninit(this->size());
+        if (!this->empty()) {
+            std::memcpy(static_cast<void*>(owned.data()), this->_data, sizeof(T) * this->size());
+        }
+        return owned;
+    }
+
+    CCowSlice<T> into() noexcept;
+};
+static_assert(sizeof(CowSlice<int>) == sizeof(BoxedSlice<int>));
+static_assert(std::is_standard_layout<CowSlice<int>>::value);
+
+static_assert(sizeof(CCowSlice<int>) == sizeof(CowSlice<int>));
+
+template <typename T>
+inline CCowSlice<T> CowSlice<T>::into() noexcept {
+    return CCowSlice<T>::from(std::move(*this));
+}
+
+}  // namespace ffi_types
+
+namespace std {
+
+template <>
+struct hash<ffi_types::CowStr> : ffi_types::StrHash {};
+
+}  // namespace std
+namespace ffi_types {
+
+/// Segments of interned strings indexed by symbols. Same as Rust `interner::SymbolTable`.
+///
+/// Segment `k` holds `FIRST_SEGMENT << k` strings and is never moved once it is published,
+/// so a `StrRef` of a symbol is stable until the process exits.
+struct SymbolTable {
+    static constexpr usize FIRST_SEGMENT = usize(1) << 10;
+    static constexpr usize SEGMENT_COUNT = 22;
+
+    std::atomic<const CStrRef*> segments[SEGMENT_COUNT];
+};
+static_assert(sizeof(SymbolTable) == SymbolTable::SEGMENT_COUNT * sizeof(void*));
+static_assert(std::atomic<const CStrRef*>::is_always_lock_free);
+
+/// A string interned by Rust side. Same as Rust `interner::Symbol`.
+///
+/// Equal strings have the same symbol in the process, so comparing and hashing symbols touch no string.
+/// `str()` resolves a symbol by an inline lookup of the table without an FFI call.
+struct Symbol {
+    uint32_t _id;
+
+    /// Returns the symbol of `s`, interning it if it is new.
+    static Symbol intern(const StrRef& s) noexcept;
+    /// Interns every string of `strs` into `out` of the same size by one FFI call.
+    static void intern_all(SliceRef<CStrRef> strs, MutSliceRef<Symbol> out) noexcept;
+
+    uint32_t id() const noexcept {
+        return this->_id;
+    }
+
+    /// Returns the interned string.
+    StrRef str() const noexcept;
+
+    friend bool operator==(const Symbol& a, const Symbol& b) noexcept {
+        return a._id == b._id;
+    }
+    friend bool operator!=(const Symbol& a, const Symbol& b) noexcept {
+        return a._id != b._id;
+    }
+    /// Orders symbols by the interning order, not by the strings.
+    friend bool operator<(const Symbol& a, const Symbol& b) noexcept {
+        return a._id < b._id;
+    }
+};
+static_assert(sizeof(Symbol) == sizeof(uint32_t));
+static_assert(std::is_trivial<Symbol>::value);
+static_assert(std::is_standard_layout<Symbol>::value);
+
+}  // namespace ffi_types
+
+namespace std {
+
+template <>
+struct hash<ffi_types::Symbol> {
+    size_t operator()(const ffi_types::Symbol& s) const noexcept {
+        return std::hash<uint32_t>()(s._id);
+    }
+};
+
+}  // namespace std
+namespace ffi_types {
+
+struct CArena;
+
+/// A string allocated in an `Arena`. It is valid until the arena is reset or dropped.
+/// Unlike `BoxedStr`, it is not dropped by itself.
+using ArenaStr = StrRef;
+
+/// The first 2 fields of Rust `ArenaInner`.
+struct _ArenaHeader {
+    uint8_t* cursor;
+    uint8_t* end;
+};
+
+/// C++ counterpart for Rust `Arena`, a bump allocator for values living together, e.g. in a request.
+///
+/// Allocation is inline until the current chunk is full. Dropping or resetting the arena frees every value at once,
+/// so no drop call crosses FFI per value. Only trivially destructible values are allocated.
+///
+/// @warning An arena is not thread-safe. Move it to share between threads.
+class Arena {
+public:
+    _ArenaHeader* _inner;
+
+    Arena() = delete;
+    Arena(const Arena&) = delete;
+    Arena(Arena&& a) noexcept : _inner(a._inner) {
+        a._inner = nullptr;
+    }
+    Arena(std::nullptr_t) noexcept : _inner(nullptr) {}
+    ~Arena() noexcept {
+        if (this->_inner) {
+            this->_drop();
+        }
+    }
+    Arena& operator=(Arena&& a) noexcept {
+        if (this != &a) {
+            if (this->_inner) {
+                this->_drop();
+            }
+            this->_inner = a._inner;
+            a._inner = nullptr;
+        }
+        return *this;
+    }
+
+    void _drop() noexcept;
+
+    /// Creates an arena allocating chunks of `chunk_size` bytes first. Zero means the default size.
+    static Arena create(usize chunk_size = 0) noexcept;
+
+    /// Allocates `size` bytes aligned by `align`, which must be a power of two. Zero-sized blocks are dangling.
+    uint8_t* alloc(usize size, usize align) noexcept {
+        assert(align > 0 && (align & (align - 1)) == 0);
+        const auto cursor = reinterpret_cast<uintptr_t>(this->_inner->cursor);
+        const auto aligned = (cursor + align - 1) & ~(align - 1);
+        const auto end = reinterpret_cast<uintptr_t>(this->_inner->end);
+        if (aligned >= cursor && aligned <= end && size <= end - aligned && cursor != 0) {
+            // keep the provenance of the chunk
+            auto* ptr = this->_inner->cursor + (aligned - cursor);
+            this->_inner->cursor = ptr + size;
+            return ptr;
+        }
+        return this->_alloc_slow(size, align);
+    }
+
+    uint8_t* _alloc_slow(usize size, usize align) noexcept;
+
+    /// Allocates a slice of `size` uninitialized elements.
+    ///
+    /// @warning Every element must be written before it is read.
+    template <typename T>
+    ArenaSlice<T> alloc_slice_uninit(usize size) noexcept {
+        static_assert(std::is_trivially_destructible<T>::value, "the arena never drops values");
+        assert(size <= SIZE_MAX / sizeof(T));
+        return ArenaSlice<T>(reinterpret_cast<T*>(this->alloc(sizeof(T) * size, alignof(T))), size);
+    }
+
+    /// Copies `slice` to the arena.
+    template <typename T>
+    ArenaSlice<T> alloc_slice_copy(SliceRef<T> slice) noexcept {
+        static_assert(std::is_trivially_copyable<T>::value, "elements are copied by memcpy");
+        auto* data = this->alloc(slice.size_bytes(), alignof(T));
+        if (!slice.empty()) {
+            std::memcpy(data, slice.data(), slice.size_bytes());
+        }
+        return ArenaSlice<T>(reinterpret_cast<T*>(data), slice.size());
+    }
+
+    /// Copies `s` to the arena.
+    ArenaStr alloc_str(StrRef s) noexcept {
+        auto bytes = this->alloc_slice_uninit<char>(s.size());
+        if (!s.empty()) {
+            std::memcpy(bytes.data(), s.data(), s.size());
+        }
+        return CharStrRef(bytes.data(), bytes.size()).as_str_unchecked();
+    }
+
+    /// Copies `s` to the arena if it is a valid UTF-8 string.
+    std::optional<ArenaStr> alloc_str_from_utf8(CharStrRef s) noexcept {
+        if (!s.is_utf8()) {
+            return std::nullopt;
+        }
+        return this->alloc_str(s.as_str_unchecked());
+    }
+
+    /// Frees every value at once. The current chunk is kept to be reused.
+    void reset() noexcept;
+
+    CArena into() noexcept;
+    const CArena& as_c() const noexcept {
+        return *reinterpret_cast<const CArena*>(this);
+    }
+    CArena& as_c() noexcept {
+        return *reinterpret_cast<CArena*>(this);
+    }
+};
+static_assert(sizeof(Arena) == sizeof(void*));
+static_assert(std::is_standard_layout<Arena>::value);
+
+inline CArena Arena::into() noexcept {
+    return CArena::from(std::move(*this));
+}
+
+}  // namespace ffi_types
+namespace ffi_types {
+
+/// The C++ counterpart converted by `operator()()` of a C-prefixed type, or the type itself.
+template <typename T, typename = void>
+struct _Owned {
+    using type = T;
+    static type take(T& value) noexcept {
+        return std::move(value);
+    }
+};
+template <typename T>
+struct _Owned<T, std::void_t<decltype(std::declval<T&>()())>> {
+    using type = decltype(std::declval<T&>()());
+    static type take(T& value) noexcept {
+        return value();
+    }
+};
+
+}  // namespace ffi_types
+namespace ffi_types {
+
+template <typename T>
+struct CRustFuture;
+
+/// Functions of a waker of C++ side. Same as Rust `WakerVTable`.
+///
+/// `data` points to an object starting with a pointer to the vtable. The object is reference counted by the owner.
+struct _WakerVTable {
+    /// Adds a reference to the waker.
+    void (*clone)(const void* data);
+    /// Wakes the task without consuming a reference. May be called from any thread.
+    void (*wake)(const void* data);
+    /// Removes a reference to the waker.
+    void (*drop)(const void* data);
+};
+
+/// Functions of a `RustFuture<T>`. Same as Rust `FutureVTable<T>`.
+template <typename T>
+struct _FutureVTable {
+    /// Polls the future once with a borrowed `waker`. Returns `true` and moves the output to `out` when ready.
+    /// Otherwise `waker` is woken when the future should be polled again.
+    /// The future must not be polled after it is ready.
+    bool (*poll)(void* state, const void* waker, T* out);
+    /// Drops the future, even if it is not ready yet.
+    void (*drop)(void* state);
+};
+
+#if __cpp_impl_coroutine
+/// An executor of C++ side resuming coroutines which await `RustFuture<T>`, e.g. an event loop.
+///
+/// A wake from Rust side only calls `schedule(context, run, task)`, which must arrange `run(task)` to be called
+/// once on the executor, e.g. by posting it to the loop, and return without calling it.
+/// `run(task)` polls the future again and resumes the coroutine if the output is ready.
+///
+/// @note `schedule` may be called from any thread, e.g. a worker thread of a Rust runtime holding its locks,
+///       so it must be cheap and must not call Rust side.
+struct FutureExecutor {
+    void (*schedule)(void* context, void (*run)(void* task), void* task);
+    void* context;
+};
+
+template <typename T>
+class _FutureAwaiter;
+#endif
+
+/// C++ counterpart for Rust `RustFuture<T>`, a future of Rust side polled by a waker of C++ side.
+///
+/// `T` is the C-prefixed type of the Rust output, e.g. `CBoxedStr` for `BoxedStr`.
+/// In C++20, `co_await std::move(future).on(executor)` suspends the coroutine until the output is ready
+/// and returns the owned type, e.g. `BoxedStr`. The coroutine resumes on `executor`, see `FutureExecutor`.
+///
+/// The vtable is called inline, so no `_drop()` specialization is needed.
+template <typename T>
+class RustFuture {
+public:
+    void* _state;
+    const _FutureVTable<T>* _vtable;
+
+    RustFuture() = delete;
+    RustFuture(const RustFuture<T>&) = delete;
+    RustFuture(RustFuture<T>&& f) noexcept : _state(f._state), _vtable(f._vtable) {
+        f._reset_empty();
+    }
+    RustFuture(std::nullptr_t) noexcept : _state(nullptr), _vtable(nullptr) {}
+    /// Takes the ownership of `state`. `vtable->drop(state)` is called once to free it.
+    explicit RustFuture(void* state, const _FutureVTable<T>* vtable) noexcept : _state(state), _vtable(vtable) {}
+    ~RustFuture() noexcept {
+        this->_drop();
+    }
+    RustFuture<T>& operator=(RustFuture<T>&& f) noexcept {
+        if (this != &f) {
+            this->_drop();
+            this->_state = f._state;
+            this->_vtable = f._vtable;
+            f._reset_empty();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept {
+        if (this->_vtable) {
+            this->_vtable->drop(this->_state);
+        }
+        this->_reset_empty();
+    }
+    void _reset_empty() noexcept {
+        this->_state = nullptr;
+        this->_vtable = nullptr;
+    }
+
+    /// Polls the future once. Returns `true` and writes `out` without destroying it when ready.
+    /// Otherwise `waker` is woken when the future should be polled again.
+    ///
+    /// @note `waker` points to an object starting with a pointer to `_WakerVTable`.
+    ///       The future must not be polled after it is ready.
+    bool poll(const void* waker, T* out) noexcept {
+        return this->_vtable->poll(this->_state, waker, out);
+    }
+
+    explicit operator bool() const noexcept {
+        return this->_vtable != nullptr;
+    }
+
+    CRustFuture<T> into() noexcept;
+
+#if __cpp_impl_coroutine
+    /// Returns an awaiter polling the future again and resuming the coroutine on `executor`.
+    _FutureAwaiter<T> on(FutureExecutor executor) && noexcept;
+#endif
+};
+static_assert(sizeof(RustFuture<int>) == 2 * sizeof(void*));
+static_assert(std::is_standard_layout<RustFuture<int>>::value);
+
+template <typename T>
+inline CRustFuture<T> RustFuture<T>::into() noexcept {
+    return CRustFuture<T>::from(std::move(*this));
+}
+
+#if __cpp_impl_coroutine
+/// A reference counted waker owning a `RustFuture<T>` awaited by a coroutine.
+///
+/// Rust side may keep clones of the waker after the coroutine is gone, so the future lives until the last clone
+/// is dropped. A wake schedules a task polling the future on the executor, which keeps a reference until it runs.
+/// A wake while the task is scheduled is merged into it, and a wake while the future is polled makes the poller
+/// poll again instead of polling concurrently.
+template <typename T>
+struct _FutureWaker {
+    enum Status : uint8_t {
+        idle = 0,
+        polling = 1,
+        /// Woken while polling.
+        notified = 2,
+        ready = 3,
+        /// The coroutine is gone without the output.
+        closed = 4,
+        /// Woken and waiting for the task on the executor.
+        scheduled = 5,
+    };
+
+    /// The first field to be a waker of Rust side.
+    const _WakerVTable* _vtable;
+    std::atomic<usize> _refs;
+    std::atomic<uint8_t> _status;
+    RustFuture<T> _future;
+    FutureExecutor _executor;
+    std::coroutine_handle<> _handle;
+    union _Output {
+        _Output() noexcept {}
+        T value;
+    } _output;
+
+    static const _WakerVTable VTABLE;
+
+    explicit _FutureWaker(RustFuture<T>&& future, FutureExecutor executor) noexcept
+        : _vtable(&VTABLE),
+          _refs(1),
+          _status(polling),
+          _future(std::move(future)),
+          _executor(executor),
+          _handle(nullptr) {}
+
+    /// Polls until the future is ready or no wake is left. `_status` must be `polling`.
+    /// Returns `true` if the future is ready.
+    bool _run() noexcept {
+        while (true) {
+            if (this->_future.poll(this, &this->_output.value)) {
+                // Resources of the future are released as soon as it is ready.
+                this->_future._drop();
+                this->_status.store(ready, std::memory_order_release);
+                return true;
+            }
+            uint8_t expected = polling;
+            if (this->_status.compare_exchange_strong(expected, idle, std::memory_order_acq_rel)) {
+                return false;
+            }
+            this->_status.store(polling, std::memory_order_relaxed);
+        }
+    }
+
+    static void _clone(const void* data) noexcept {
+        auto* waker = const_cast<_FutureWaker*>(static_cast<const _FutureWaker*>(data));
+        waker->_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Only schedules `_poll_task()`, so the future is polled and the coroutine resumes on the executor.
+    static void _wake(const void* data) noexcept {
+        auto* waker = const_cast<_FutureWaker*>(static_cast<const _FutureWaker*>(data));
+        auto status = waker->_status.load(std::memory_order_acquire);
+        while (true) {
+            if (status == idle) {
+                if (waker->_status.compare_exchange_weak(status, scheduled, std::memory_order_acq_rel)) {
+                    // The scheduled task keeps a reference until it runs.
+                    _clone(waker);
+                    waker->_executor.schedule(waker->_executor.context, _poll_task, waker);
+                    return;
+                }
+            } else if (status == polling) {
+                if (waker->_status.compare_exchange_weak(status, notified, std::memory_order_acq_rel)) {
+                    return;
+                }
+            } else {
+                return;
+            }
+        }
+    }
+
+    /// Runs on the executor. The wake is dropped if the coroutine is destroyed after it is scheduled.
+    static void _poll_task(void* task) noexcept {
+        auto* waker = static_cast<_FutureWaker*>(task);
+        uint8_t expected = scheduled;
+        if (waker->_status.compare_exchange_strong(expected, polling, std::memory_order_acq_rel) && waker->_run()) {
+            waker->_handle.resume();
+        }
+        _release(waker);
+    }
+
+    static void _release(const void* data) noexcept {
+        auto* waker = const_cast<_FutureWaker*>(static_cast<const _FutureWaker*>(data));
+        if (waker->_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete waker;
+        }
+    }
+};
+
+template <typename T>
+const _WakerVTable _FutureWaker<T>::VTABLE = {_FutureWaker<T>::_clone, _FutureWaker<T>::_wake,
+                                              _FutureWaker<T>::_release};
+
+/// An awaiter of a `RustFuture<T>` returning the owned type of `T`, e.g. `BoxedStr` for `CBoxedStr`.
+///
+/// The future is polled first on the awaiting thread, and then only by tasks on the executor,
+/// so the coroutine resumes either without suspending or on the executor.
+template <typename T>
+class _FutureAwaiter {
+public:
+    _FutureWaker<T>* _waker;
+
+    explicit _FutureAwaiter(RustFuture<T>&& future, FutureExecutor executor) noexcept
+        : _waker(new _FutureWaker<T>(std::move(future), executor)) {}
+    _FutureAwaiter(const _FutureAwaiter&) = delete;
+    _FutureAwaiter& operator=(const _FutureAwaiter&) = delete;
+    /// Drops the future and ignores later wakes and the scheduled task if the coroutine is destroyed while suspended.
+    ///
+    /// @warning Destroying the coroutine while the future is polled by another thread is undefined behavior,
+    ///          same as destroying any coroutine being resumed.
+    ~_FutureAwaiter() noexcept {
+        auto* waker = this->_waker;
+        auto status = waker->_status.load(std::memory_order_acquire);
+        while (status == _FutureWaker<T>::idle || status == _FutureWaker<T>::scheduled) {
+            if (waker->_status.compare_exchange_weak(status, _FutureWaker<T>::closed, std::memory_order_acq_rel)) {
+                // No one polls a closed future, and dropping it drops the clones of the waker it keeps.
+                waker->_future._drop();
+                break;
+            }
+        }
+        _FutureWaker<T>::_release(waker);
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    /// Polls first on the awaiting thread. Does not suspend if the output is ready.
+    bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        auto* waker = this->_waker;
+        waker->_handle = handle;
+        // The coroutine may be resumed by another thread once `_run()` returns, so `this` is not used after it.
+        return !waker->_run();
+    }
+
+    typename _Owned<T>::type await_resume() noexcept {
+        return _Owned<T>::take(this->_waker->_output.value);
+    }
+};
+
+template <typename T>
+inline _FutureAwaiter<T> RustFuture<T>::on(FutureExecutor executor) && noexcept {
+    return _FutureAwaiter<T>(std::move(*this), executor);
+}
+#endif
+
+}  // namespace ffi_types
+namespace ffi_types {
+
+template <typename T>
+struct CRustIter;
+
+/// Functions of a `RustIter<T>`. Same as Rust `IterVTable<T>`.
+template <typename T>
+struct _IterVTable {
+    /// Moves up to `buffer._size` items to the front of `buffer` and returns the count.
+    /// Zero means the end of the iterator. The moved items are owned by the caller.
+    usize (*next_batch)(void* state, CMutSliceRef<T> buffer);
+    /// Drops the iterator with the items not moved yet.
+    void (*drop)(void* state);
+};
+
+template <typename T>
+class RustIter;
+
+/// An input range of the items of a `RustIter<T>` pulled into a buffer. Returned by `RustIter<T>::items()`.
+///
+/// Items are referenced in the buffer and owned by the caller. Call `operator()()` of C-prefixed items to own them.
+///
+/// @warning Items pulled but not visited yet are left in `remaining()` when the loop breaks.
+template <typename T>
+struct _IterItems {
+    RustIter<T>* _iter;
+    MutSliceRef<T> _buffer;
+    usize _index;
+    usize _count;
+
+    bool _fill() noexcept {
+        this->_index = 0;
+        this->_count = this->_iter->next_batch(this->_buffer);
+        return this->_count > 0;
+    }
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = intptr_t;
+        using pointer = T*;
+        using reference = T&;
+
+        /// Null at the end.
+        _IterItems<T>* _items;
+
+        reference operator*() const noexcept {
+            return this->_items->_buffer._data[this->_items->_index];
+        }
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+        iterator& operator++() noexcept {
+            if (++this->_items->_index == this->_items->_count && !this->_items->_fill()) {
+                this->_items = nullptr;
+            }
+            return *this;
+        }
+        void operator++(int) noexcept {
+            ++*this;
+        }
+        bool operator==(const iterator& other) const noexcept {
+            return this->_items == other._items;
+        }
+        bool operator!=(const iterator& other) const noexcept {
+            return this->_items != other._items;
+        }
+    };
+
+    iterator begin() noexcept {
+        if (this->_index == this->_count && !this->_fill()) {
+            return iterator{nullptr};
+        }
+        return iterator{this};
+    }
+    iterator end() noexcept {
+        return iterator{nullptr};
+    }
+
+    /// Returns the items pulled into the buffer but not visited yet.
+    MutSliceRef<T> remaining() const noexcept {
+        return MutSliceRef<T>(this->_buffer._data + this->_index, this->_count - this->_index);
+    }
+};
+
+/// C++ counterpart for Rust `RustIter<T>`, an iterator of Rust side pulled in batches.
+///
+/// `next_batch()` moves items into a buffer of the caller, so streaming a large result takes the memory
+/// of the buffer only and crosses FFI once per batch. `T` is the C-prefixed type of the Rust item,
+/// e.g. `CBoxedStr` for `BoxedStr`.
+///
+/// The vtable is called inline, so no `_drop()` specialization is needed.
+template <typename T>
+class RustIter {
+public:
+    void* _state;
+    const _IterVTable<T>* _vtable;
+
+    RustIter() = delete;
+    RustIter(const RustIter<T>&) = delete;
+    RustIter(RustIter<T>&& it) noexcept : _state(it._state), _vtable(it._vtable) {
+        it._reset_empty();
+    }
+    RustIter(std::nullptr_t) noexcept : _state(nullptr), _vtable(nullptr) {}
+    /// Takes the ownership of `state`. `vtable->drop(state)` is called once to free it.
+    explicit RustIter(void* state, const _IterVTable<T>* vtable) noexcept : _state(state), _vtable(vtable) {}
+    ~RustIter() noexcept {
+        this->_drop();
+    }
+    RustIter<T>& operator=(RustIter<T>&& it) noexcept {
+        if (this != &it) {
+            this->_drop();
+            this->_state = it._state;
+            this->_vtable = it._vtable;
+            it._reset_empty();
+        }
+        return *this;
+    }
+
+    void _drop() noexcept {
+        if (this->_vtable) {
+            this->_vtable->drop(this->_state);
+        }
+        this->_reset_empty();
+    }
+    void _reset_empty() noexcept {
+        this->_state = nullptr;
+        this->_vtable = nullptr;
+    }
+
+    /// Moves up to `buffer.size()` items to the front of `buffer` and returns the count.
+    /// Zero means the end of the iterator. The moved items are owned by the caller.
+    ///
+    /// @note `buffer` is written without destroying the old elements.
+    usize next_batch(MutSliceRef<T> buffer) noexcept {
+        return this->_vtable->next_batch(this->_state, CMutSliceRef<T>::from(buffer));
+    }
+
+    /// Returns an input range of the items pulled into `buffer` batch by batch.
+    /// `buffer` must not be empty and must outlive the range.
+    _IterItems<T> items(MutSliceRef<T> buffer) noexcept {
+        assert(!buffer.empty());
+        return _IterItems<T>{this, buffer, 0, 0};
+    }
+
+    explicit operator bool() const noexcept {
+        return this->_vtable != nullptr;
+    }
+
+    CRustIter<T> into() noexcept;
+};
+static_assert(sizeof(RustIter<int>) == 2 * sizeof(void*));
+static_assert(std::is_standard_layout<RustIter<int>>::value);
+
+template <typename T>
+inline CRustIter<T> RustIter<T>::into() noexcept {
+    return CRustIter<T>::from(std::move(*this));
+}
+
+}  // namespace ffi_types
+#pragma once
+
+
+//! This header is intended to be included in rust_types.hh file.
+    
+
+namespace ffi_types {
+
+extern "C" {
+
+void _rust_ffi_boxed_str_drop(ffi_types::CBoxedStr string);
+
+void _rust_ffi_boxed_c_str_drop(ffi_types::CBoxedCStr string);
+
+/// Returns `slice` to the buffer pool of the current thread if it is of a size class.
+void _rust_ffi_boxed_bytes_drop(ffi_types::CBoxedSlice<uint8_t> slice);
+
+/// Drops every string of `strings` at once.
+/// The caller must not use or drop the items after this call.
+void _rust_ffi_boxed_str_drop_many(ffi_types::CMutSliceRef<ffi_types::CBoxedStr> strings);
+
+/// Drops every slice of `slices` at once.
+/// The caller must not use or drop the items after this call.
+void _rust_ffi_boxed_bytes_drop_many(ffi_types::CMutSliceRef<ffi_types::CBoxedSlice<uint8_t>> slices);
+
+/// Enables or disables deferred drop of boxed values in the current thread.
+/// Returns the previous state.
+///
+/// In deferred mode, drop functions push values to a reclaimer thread instead of deallocating them.
+bool _rust_ffi_reclaim_set_deferred(bool enabled);
+
+/// Drops every deferred value before returning.
+void _rust_ffi_reclaim_flush();
+
+/// Returns the number of values deferred but not dropped yet.
+uintptr_t _rust_ffi_reclaim_pending();
+
+/// Returns the number of values ever deferred.
+uintptr_t _rust_ffi_reclaim_deferred_count();
+
+/// Allocates a byte slice of `size` uninitialized bytes.
+/// A buffer of a size class is taken from the buffer pool of the current thread if one is available.
+ffi_types::CBoxedSlice<uint8_t> _rust_ffi_pool_alloc(uintptr_t size);
+
+/// Sets the maximum bytes kept by each size class of each thread. Zero disables buffer pools.
+/// Returns the previous limit.
+uintptr_t _rust_ffi_pool_set_limit(uintptr_t bytes_per_class);
+
+/// Returns the counters of the buffer pool of the current thread.
+ffi_types::PoolStats _rust_ffi_pool_thread_stats();
+
+/// Frees every buffer in the buffer pool of the current thread.
+void _rust_ffi_pool_clear();
+
+/// Returns the counters of the current thread, which C++ `FFI_TYPES_INSTRUMENT` writes inline.
+const ffi_types::OwnershipShard *_rust_ffi_instrument_thread_shard();
+
+/// Sums the counters of C++ ownership transfers of every thread.
+ffi_types::OwnershipSnapshot _rust_ffi_instrument_snapshot();
+
+void _rust_ffi_vec_bytes_drop(ffi_types::CVec<uint8_t> vec);
+
+/// Reserves capacity for at least `additional` more elements.
+///
+/// This is a type-erased `Vec::reserve` for elements of `elem_size` bytes aligned by `align`.
+/// `len` and `cap` of `vec` are counted by elements, not bytes.
+void _rust_ffi_vec_reserve(ffi_types::CVec<uint8_t> *vec, uintptr_t additional, uintptr_t elem_size, uintptr_t align);
+
+/// Allocates `size` bytes aligned by `align` from the Rust global allocator.
+///
+/// The memory can be owned by a boxed type only if the layout is the one Rust deallocates it with.
+/// e.g. `size_of::<T>() * len` and `align_of::<T>()` for `Box<[T]>`.
+/// Zero-sized allocation returns a dangling pointer.
+uint8_t *_rust_ffi_alloc(uintptr_t size, uintptr_t align);
+
+/// Resizes a memory block from [`alloc`] or a boxed type from `old_size` to `new_size` bytes.
+///
+/// Either size can be zero. The returned pointer is dangling when `new_size` is zero.
+uint8_t *_rust_ffi_realloc(uint8_t *ptr, uintptr_t old_size, uintptr_t align, uintptr_t new_size);
+
+/// Deallocates a memory block from [`alloc`] or [`realloc`]. Zero-sized blocks are ignored.
+void _rust_ffi_dealloc(uint8_t *ptr, uintptr_t size, uintptr_t align);
+
+/// Checks whether `string` is a valid UTF-8 string.
+bool _rust_ffi_utf8_validate(ffi_types::CharStrRef string);
+
+/// Hashes `bytes` by the same function as C++ `ffi_types::hash_bytes()`.
+uint64_t _rust_ffi_hash_bytes(ffi_types::CByteSliceRef bytes);
+
+/// Returns the symbol of `string`, interning it if it is new.
+ffi_types::Symbol _rust_ffi_intern(ffi_types::CStrRef string);
+
+/// Interns every string of `strings` into `out` of the same length.
+void _rust_ffi_intern_all(ffi_types::CSliceRef<ffi_types::CStrRef> strings,
+                          ffi_types::CMutSliceRef<ffi_types::Symbol> out);
+
+/// Returns the table which C++ `Symbol::str()` resolves symbols with inline.
+const ffi_types::SymbolTable *_rust_ffi_symbol_table();
+
+/// Creates an arena allocating chunks of `chunk_size` bytes first. Zero means the default size.
+ffi_types::CArena _rust_ffi_arena_new(uintptr_t chunk_size);
+
+void _rust_ffi_arena_drop(ffi_types::CArena _arena);
+
+/// Allocates `size` bytes aligned by `align` from `arena`.
+/// This is the slow path of C++ `Arena::alloc()` when the current chunk is full.
+uint8_t *_rust_ffi_arena_alloc(const ffi_types::CArena *arena, uintptr_t size, uintptr_t align);
+
+/// Frees every value of `arena` at once.
+void _rust_ffi_arena_reset(ffi_types::CArena *arena);
+
+/// Creates a channel of byte slices holding up to `capacity` slices in flight.
+/// The capacity is rounded up to a power of two.
+void _rust_ffi_byte_channel_new(uintptr_t capacity,
+                                ffi_types::CSliceSender<uint8_t> *sender,
+                                ffi_types::CSliceReceiver<uint8_t> *receiver);
+
+void _rust_ffi_byte_sender_drop(ffi_types::CSliceSender<uint8_t> _sender);
+
+void _rust_ffi_byte_receiver_drop(ffi_types::CSliceReceiver<uint8_t> _receiver);
+
+/// Maps the whole file of `path` as read-only to `out`.
+/// Returns 0 on success or an `errno` value. `out` is not written on failure.
+///
+/// The file must not be modified or truncated while the mapping is alive. See Rust `MmapSlice::open`.
+int32_t _rust_ffi_mmap_open(ffi_types::CharStrRef path, ffi_types::CMmapSlice *out);
+
+void _rust_ffi_mmap_drop(ffi_types::CMmapSlice _mmap);
+
+/// Gives a hint of the access pattern of `bytes`, which must be a part of a mapping.
+/// Returns 0 on success or an `errno` value.
+int32_t _rust_ffi_mmap_advise(ffi_types::CByteSliceRef bytes, ffi_types::MmapAdvice advice);
+
+} // extern "C"
+
+} // namespace ffi_types
+namespace ffi_types {
+
+// members of the C-prefixed types defined in `rust_types_fwd.hxx`
+
+#if _MSC_VER
+template <typename T>
+inline CBox<T> CBox<T>::from(OptionBox<T>&& box) noexcept {
+    CBox cbox;
+    cbox._ptr = box._take();
+    instrument::_give_up(instrument::_Kind::option_box, instrument::_Event::into, cbox._ptr != nullptr, 0);
+    return cbox;
+}
+#else
+template <typename T>
+inline CBox<T>::CBox(OptionBox<T>&& box) noexcept : _ptr(box._take()) {
+    instrument::_give_up(instrument::_Kind::option_box, instrument::_Event::into, this->_ptr != nullptr, 0);
+}
+
+template <typename T>
+inline CBox<T> CBox<T>::from(OptionBox<T>&& box) noexcept {
+    return CBox(std::move(box));
+}
+#endif
+
+template <typename T>
+inline OptionBox<T> CBox<T>::operator()() noexcept {
+    auto box = OptionBox<T>(nullptr);
+    box.reset(this->_ptr);
+    this->_ptr = nullptr;
+    return box;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CArc<T> CArc<T>::from(Arc<T>&& arc) noexcept {
+    CArc carc;
+    carc._ptr = arc.release();
+    return carc;
+}
+#else
+template <typename T>
+inline CArc<T>::CArc(Arc<T>&& arc) noexcept : _ptr(arc.release()) {}
+
+template <typename T>
+inline CArc<T> CArc<T>::from(Arc<T>&& arc) noexcept {
+    return CArc(std::move(arc));
+}
+#endif
+
+template <typename T>
+inline Arc<T> CArc<T>::operator()() noexcept {
+    return Arc<T>(this->release());
+}
+
+// checks the members of a void box, which is still passed to Rust side
+template struct CBox<void>;
+
+#if _MSC_VER
+template <typename T>
+constexpr CMutSliceRef<T> CMutSliceRef<T>::from(const MutSliceRef<T>& slice) noexcept {
+    CMutSliceRef s{};
+    s._data = slice._data;
+    s._size = slice._size;
+    return s;
+}
+#else
+template <typename T>
+constexpr CMutSliceRef<T>::CMutSliceRef(const MutSliceRef<T>& slice) noexcept
+    : _data(slice._data), _size(slice._size) {}
+
+template <typename T>
+constexpr CMutSliceRef<T> CMutSliceRef<T>::from(const MutSliceRef<T>& slice) noexcept {
+    return CMutSliceRef(slice);
+}
+#endif
+
+template <typename T>
+constexpr MutSliceRef<T> CMutSliceRef<T>::operator()() const noexcept {
+    return MutSliceRef<T>(this->_data, this->_size);
+}
+
+#if _MSC_VER
+template <typename T>
+constexpr CSliceRef<T> CSliceRef<T>::from(const SliceRef<T>& slice) noexcept {
+    CSliceRef s{};
+    s._data = slice._data;
+    s._size = slice._size;
+    return s;
+}
+#else
+template <typename T>
+constexpr CSliceRef<T>::CSliceRef(const SliceRef<T>& slice) noexcept : _data(slice._data), _size(slice._size) {}
+
+template <typename T>
+constexpr CSliceRef<T> CSliceRef<T>::from(const SliceRef<T>& slice) noexcept {
+    return CSliceRef(slice);
+}
+#endif
+
+template <typename T>
+constexpr SliceRef<T> CSliceRef<T>::operator()() const noexcept {
+    return SliceRef<T>(this->_data, this->_size);
+}
+
+#if _MSC_VER
+constexpr CByteSliceRef CByteSliceRef::from(const ByteSliceRef& slice) noexcept {
+    CByteSliceRef s{};
+    s._data = slice._data;
+    s._size = slice._size;
+    return s;
+}
+#else
+constexpr CByteSliceRef::CByteSliceRef(const ByteSliceRef& slice) noexcept : _data(slice._data), _size(slice._size) {}
+
+constexpr CByteSliceRef CByteSliceRef::from(const ByteSliceRef& slice) noexcept {
+    return CByteSliceRef(slice);
+}
+#endif
+
+inline ByteSliceRef CByteSliceRef::operator()() const noexcept {
+    ByteSliceRef slice;
+    slice._data = this->_data;
+    slice._size = this->_size;
+    return slice;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CBoxedSlice<T> CBoxedSlice<T>::from(BoxedSlice<T>&& slice) noexcept {
+    auto r = slice._take();
+    instrument::_give_up(
+            instrument::_Kind::boxed_slice, instrument::_Event::into, r._size > 0, sizeof(T) * r._size);
+    CBoxedSlice s;
+    s._data = r._data;
+    s._size = r._size;
+    return s;
+}
+#else
+template <typename T>
+inline CBoxedSlice<T>::CBoxedSlice(BoxedSlice<T>&& slice) noexcept {
+    auto r = slice._take();
+    instrument::_give_up(
+            instrument::_Kind::boxed_slice, instrument::_Event::into, r._size > 0, sizeof(T) * r._size);
+    this->_data = r._data;
+    this->_size = r._size;
+}
+
+template <typename T>
+inline CBoxedSlice<T> CBoxedSlice<T>::from(BoxedSlice<T>&& slice) noexcept {
+    return CBoxedSlice(std::move(slice));
+}
+#endif
+
+template <typename T>
+inline BoxedSlice<T> CBoxedSlice<T>::operator()() noexcept {
+    auto slice = BoxedSlice<T>(nullptr);
+    slice.reset(this->release());
+    return slice;
+}
+
+template <typename T>
+inline _SliceRange<T> CBoxedSlice<T>::get() const noexcept {
+    return {this->_data, this->_size};
+}
+
+template <typename T>
+inline _SliceRange<T> CBoxedSlice<T>::release() noexcept {
+    const auto range = this->get();
+    this->_data = EMPTY_SLICE_BEGIN(T);
+    this->_size = 0;
+    return range;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CVec<T> CVec<T>::from(Vec<T>&& vec) noexcept {
+    CVec v;
+    v._data = vec._data;
+    v._size = vec._size;
+    v._capacity = vec._capacity;
+    vec._data = EMPTY_SLICE_BEGIN(T);
+    vec._size = 0;
+    vec._capacity = 0;
+    return v;
+}
+#else
+template <typename T>
+inline CVec<T>::CVec(Vec<T>&& vec) noexcept : _data(vec._data), _size(vec._size), _capacity(vec._capacity) {
+    vec._data = EMPTY_SLICE_BEGIN(T);
+    vec._size = 0;
+    vec._capacity = 0;
+}
+
+template <typename T>
+inline CVec<T> CVec<T>::from(Vec<T>&& vec) noexcept {
+    return CVec(std::move(vec));
+}
+#endif
+
+template <typename T>
+inline Vec<T> CVec<T>::operator()() noexcept {
+    auto vec = Vec<T>(nullptr);
+    vec._data = this->_data;
+    vec._size = this->_size;
+    vec._capacity = this->_capacity;
+    this->_data = EMPTY_SLICE_BEGIN(T);
+    this->_size = 0;
+    this->_capacity = 0;
+    return vec;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CForeignBoxedSlice<T> CForeignBoxedSlice<T>::from(ForeignBoxedSlice<T>&& slice) noexcept {
+    CForeignBoxedSlice s;
+    s._data = slice._data;
+    s._size = slice._size;
+    s._drop_fn = slice._drop_fn;
+    s._ctx = slice._ctx;
+    slice._reset_empty();
+    return s;
+}
+#else
+template <typename T>
+inline CForeignBoxedSlice<T>::CForeignBoxedSlice(ForeignBoxedSlice<T>&& slice) noexcept
+    : _data(slice._data), _size(slice._size), _drop_fn(slice._drop_fn), _ctx(slice._ctx) {
+    slice._reset_empty();
+}
+
+template <typename T>
+inline CForeignBoxedSlice<T> CForeignBoxedSlice<T>::from(ForeignBoxedSlice<T>&& slice) noexcept {
+    return CForeignBoxedSlice(std::move(slice));
+}
+#endif
+
+template <typename T>
+inline ForeignBoxedSlice<T> CForeignBoxedSlice<T>::operator()() noexcept {
+    auto slice = ForeignBoxedSlice<T>(this->_data, this->_size, this->_drop_fn, this->_ctx);
+    this->_data = EMPTY_SLICE_BEGIN(T);
+    this->_size = 0;
+    this->_drop_fn = nullptr;
+    this->_ctx = nullptr;
+    return slice;
+}
+
+#if _MSC_VER
+inline CMmapSlice CMmapSlice::from(MmapSlice&& slice) noexcept {
+    CMmapSlice s;
+    s._data = slice._data;
+    s._size = slice._size;
+    slice._data = EMPTY_SLICE_BEGIN(uint8_t);
+    slice._size = 0;
+    return s;
+}
+#else
+inline CMmapSlice::CMmapSlice(MmapSlice&& slice) noexcept : _data(slice._data), _size(slice._size) {
+    slice._data = EMPTY_SLICE_BEGIN(uint8_t);
+    slice._size = 0;
+}
+
+inline CMmapSlice CMmapSlice::from(MmapSlice&& slice) noexcept {
+    return CMmapSlice(std::move(slice));
+}
+#endif
+
+inline MmapSlice CMmapSlice::operator()() noexcept {
+    auto slice = MmapSlice(nullptr);
+    slice._data = this->_data;
+    slice._size = this->_size;
+    this->_data = EMPTY_SLICE_BEGIN(uint8_t);
+    this->_size = 0;
+    return slice;
+}
+
+#if _MSC_VER
+constexpr CStrRef CStrRef::from(const StrRef& slice) noexcept {
+    CStrRef s{};
+    s._data = slice.data();
+    s._size = slice.size();
+    return s;
+}
+#else
+constexpr CStrRef::CStrRef(const StrRef& slice) noexcept : _data(slice.data()), _size(slice.size()) {}
+
+constexpr CStrRef CStrRef::from(const StrRef& slice) noexcept {
+    return CStrRef(slice);
+}
+#endif
+
+constexpr StrRef CStrRef::operator()() const noexcept {
+    return StrRef(StrRef::_Unchecked{}, this->_data, this->_size);
+}
+
+#if _MSC_VER
+inline CBoxedStr CBoxedStr::from(BoxedStr&& str) noexcept {
+    auto r = str._take();
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, r._size > 0, r._size);
+    CBoxedStr s;
+    s._data = r._data;
+    s._size = r._size;
+    return s;
+}
+#else
+inline CBoxedStr::CBoxedStr(BoxedStr&& str) noexcept {
+    auto r = str._take();
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, r._size > 0, r._size);
+    this->_data = r._data;
+    this->_size = r._size;
+}
+
+inline CBoxedStr CBoxedStr::from(BoxedStr&& slice) noexcept {
+    return CBoxedStr(std::move(slice));
+}
+#endif
+
+inline BoxedStr CBoxedStr::operator()() noexcept {
+    auto slice = BoxedStr(nullptr);
+    slice.reset(this->release());
+    return slice;
+}
+
+inline _SliceRange<const char> CBoxedStr::release() noexcept {
+    const auto range = _SliceRange<const char>{_data, _size};
+    this->_data = EMPTY_SLICE_BEGIN(const char);
+    this->_size = 0;
+    return range;
+}
+
+#if _MSC_VER
+inline CCompactStr CCompactStr::from(CompactStr&& str) noexcept {
+    CCompactStr s;
+    std::memcpy(&s, &str, sizeof(CCompactStr));
+    str._set_inline_size(0);
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, s._is_heap(), s._size);
+    return s;
+}
+#else
+inline CCompactStr::CCompactStr(CompactStr&& str) noexcept {
+    std::memcpy(static_cast<void*>(this), &str, sizeof(CCompactStr));
+    str._set_inline_size(0);
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, this->_is_heap(), this->_size);
+}
+
+inline CCompactStr CCompactStr::from(CompactStr&& str) noexcept {
+    return CCompactStr(std::move(str));
+}
+#endif
+
+inline CompactStr CCompactStr::operator()() noexcept {
+    auto str = CompactStr(nullptr);
+    std::memcpy(static_cast<void*>(&str), this, sizeof(CCompactStr));
+    instrument::_acquire(instrument::_Kind::boxed_str, this->_is_heap(), this->_size);
+    this->_size = CompactStr::_INLINE_TAG;
+    return str;
+}
+
+inline bool CCompactStr::_is_heap() const noexcept {
+    return (this->_size & CompactStr::_INLINE_TAG) == 0 && this->_size > 0;
+}
+
+#if _MSC_VER
+constexpr CStrZRef CStrZRef::from(const StrZRef& s) noexcept {
+    CStrZRef r{};
+    r._data = s.data();
+    r._size = s.size();
+    return r;
+}
+#else
+constexpr CStrZRef::CStrZRef(const StrZRef& s) noexcept : _data(s.data()), _size(s.size()) {}
+
+constexpr CStrZRef CStrZRef::from(const StrZRef& s) noexcept {
+    return CStrZRef(s);
+}
+#endif
+
+constexpr StrZRef CStrZRef::operator()() const noexcept {
+    return StrZRef(StrZRef::_Terminated{}, this->_data, this->_size);
+}
+
+#if _MSC_VER
+inline CBoxedCStr CBoxedCStr::from(BoxedCStr&& str) noexcept {
+    auto r = str._take();
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, r._size > 0, r._size);
+    CBoxedCStr s;
+    s._data = r._data;
+    s._size = r._size;
+    return s;
+}
+#else
+inline CBoxedCStr::CBoxedCStr(BoxedCStr&& str) noexcept {
+    auto r = str._take();
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, r._size > 0, r._size);
+    this->_data = r._data;
+    this->_size = r._size;
+}
+
+inline CBoxedCStr CBoxedCStr::from(BoxedCStr&& str) noexcept {
+    return CBoxedCStr(std::move(str));
+}
+#endif
+
+inline BoxedCStr CBoxedCStr::operator()() noexcept {
+    auto str = BoxedCStr(nullptr);
+    str.reset(this->release());
+    return str;
+}
+
+inline _SliceRange<const char> CBoxedCStr::release() noexcept {
+    const auto range = _SliceRange<const char>{_data, _size};
+    this->_data = "";
+    this->_size = 0;
+    return range;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CSliceSender<T> CSliceSender<T>::from(SliceSender<T>&& sender) noexcept {
+    CSliceSender s;
+    s._inner = sender.release();
+    return s;
+}
+#else
+template <typename T>
+inline CSliceSender<T>::CSliceSender(SliceSender<T>&& sender) noexcept : _inner(sender.release()) {}
+
+template <typename T>
+inline CSliceSender<T> CSliceSender<T>::from(SliceSender<T>&& sender) noexcept {
+    return CSliceSender(std::move(sender));
+}
+#endif
+
+template <typename T>
+inline SliceSender<T> CSliceSender<T>::operator()() noexcept {
+    auto* inner = this->_inner;
+    this->_inner = nullptr;
+    return SliceSender<T>(inner);
+}
+
+#if _MSC_VER
+template <typename T>
+inline CSliceReceiver<T> CSliceReceiver<T>::from(SliceReceiver<T>&& receiver) noexcept {
+    CSliceReceiver s;
+    s._inner = receiver.release();
+    return s;
+}
+#else
+template <typename T>
+inline CSliceReceiver<T>::CSliceReceiver(SliceReceiver<T>&& receiver) noexcept : _inner(receiver.release()) {}
+
+template <typename T>
+inline CSliceReceiver<T> CSliceReceiver<T>::from(SliceReceiver<T>&& receiver) noexcept {
+    return CSliceReceiver(std::move(receiver));
+}
+#endif
+
+template <typename T>
+inline SliceReceiver<T> CSliceReceiver<T>::operator()() noexcept {
+    auto* inner = this->_inner;
+    this->_inner = nullptr;
+    return SliceReceiver<T>(inner);
+}
+
+#if _MSC_VER
+inline CCowStr CCowStr::from(CowStr&& str) noexcept {
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, str.is_owned(), str.size());
+    CCowStr s;
+    s._data = str._data;
+    s._size = str._size;
+    str._reset_empty();
+    return s;
+}
+#else
+inline CCowStr::CCowStr(CowStr&& str) noexcept : _data(str._data), _size(str._size) {
+    instrument::_give_up(instrument::_Kind::boxed_str, instrument::_Event::into, str.is_owned(), str.size());
+    str._reset_empty();
+}
+
+inline CCowStr CCowStr::from(CowStr&& str) noexcept {
+    return CCowStr(std::move(str));
+}
+#endif
+
+inline CowStr CCowStr::operator()() noexcept {
+    auto str = CowStr(nullptr);
+    str._data = this->_data;
+    str._size = this->_size;
+    instrument::_acquire(instrument::_Kind::boxed_str, str.is_owned(), str.size());
+    this->_data = reinterpret_cast<const char*>(1);
+    this->_size = 0;
+    return str;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CCowSlice<T> CCowSlice<T>::from(CowSlice<T>&& slice) noexcept {
+    instrument::_give_up(instrument::_Kind::boxed_slice, instrument::_Event::into, slice.is_owned(),
+                         sizeof(T) * slice.size());
+    CCowSlice s;
+    s._data = slice._data;
+    s._size = slice._size;
+    slice._reset_empty();
+    return s;
+}
+#else
+template <typename T>
+inline CCowSlice<T>::CCowSlice(CowSlice<T>&& slice) noexcept : _data(slice._data), _size(slice._size) {
+    instrument::_give_up(instrument::_Kind::boxed_slice, instrument::_Event::into, slice.is_owned(),
+                         sizeof(T) * slice.size());
+    slice._reset_empty();
+}
+
+template <typename T>
+inline CCowSlice<T> CCowSlice<T>::from(CowSlice<T>&& slice) noexcept {
+    return CCowSlice(std::move(slice));
+}
+#endif
+
+template <typename T>
+inline CowSlice<T> CCowSlice<T>::operator()() noexcept {
+    auto slice = CowSlice<T>(nullptr);
+    slice._data = this->_data;
+    slice._size = this->_size;
+    instrument::_acquire(instrument::_Kind::boxed_slice, slice.is_owned(), sizeof(T) * slice.size());
+    this->_data = reinterpret_cast<const T*>(alignof(T));
+    this->_size = 0;
+    return slice;
+}
+
+#if _MSC_VER
+inline CArena CArena::from(Arena&& arena) noexcept {
+    CArena a;
+    a._inner = arena._inner;
+    arena._inner = nullptr;
+    return a;
+}
+#else
+inline CArena::CArena(Arena&& arena) noexcept : _inner(arena._inner) {
+    arena._inner = nullptr;
+}
+
+inline CArena CArena::from(Arena&& arena) noexcept {
+    return CArena(std::move(arena));
+}
+#endif
+
+inline Arena CArena::operator()() noexcept {
+    auto arena = Arena(nullptr);
+    arena._inner = this->_inner;
+    this->_inner = nullptr;
+    return arena;
+}
+
+#if _MSC_VER
+template <typename T>
+inline COption<T> COption<T>::from(T&& value) noexcept {
+    COption o;
+    o._value = std::move(value);
+    return o;
+}
+
+template <typename T>
+inline COption<T> COption<T>::none() noexcept {
+    COption o;
+    o._niche = nullptr;
+    return o;
+}
+#else
+template <typename T>
+inline COption<T>::COption(T&& value) noexcept : _value(std::move(value)) {}
+
+template <typename T>
+inline COption<T>::COption(std::nullptr_t) noexcept : _niche(nullptr) {}
+
+template <typename T>
+inline COption<T> COption<T>::from(T&& value) noexcept {
+    return COption(std::move(value));
+}
+
+template <typename T>
+inline COption<T> COption<T>::none() noexcept {
+    return COption(nullptr);
+}
+#endif
+
+template <typename T>
+inline bool COption<T>::is_some() const noexcept {
+    const void* data;
+    std::memcpy(&data, this, sizeof(data));
+    return data != nullptr;
+}
+
+template <typename T>
+inline T& COption<T>::unwrap() noexcept {
+    assert(this->is_some());
+    return this->_value;
+}
+
+// The return type is deduced for the forward declaration header not to include `<optional>`.
+template <typename T>
+inline auto COption<T>::operator()() noexcept {
+    auto owned = std::optional<typename _Owned<T>::type>();
+    if (this->is_some()) {
+        owned.emplace(_Owned<T>::take(this->_value));
+        this->_niche = nullptr;
+    }
+    return owned;
+}
+
+#if _MSC_VER
+template <typename T, typename E>
+inline CResult<T, E> CResult<T, E>::ok(T&& value) noexcept {
+    CResult r;
+    r._tag = Tag::Ok;
+    r._ok = std::move(value);
+    return r;
+}
+
+template <typename T, typename E>
+inline CResult<T, E> CResult<T, E>::err(E&& error) noexcept {
+    CResult r;
+    r._tag = Tag::Err;
+    r._err = std::move(error);
+    return r;
+}
+#else
+template <typename T, typename E>
+inline CResult<T, E> CResult<T, E>::ok(T&& value) noexcept {
+    return CResult(Tag::Ok, std::move(value));
+}
+
+template <typename T, typename E>
+inline CResult<T, E> CResult<T, E>::err(E&& error) noexcept {
+    return CResult(std::move(error));
+}
+
+template <typename T, typename E>
+inline CResult<T, E>::CResult(Tag tag, T&& value) noexcept : _tag(tag), _ok(std::move(value)) {}
+
+template <typename T, typename E>
+inline CResult<T, E>::CResult(E&& error) noexcept : _tag(Tag::Err), _err(std::move(error)) {}
+#endif
+
+template <typename T, typename E>
+inline T& CResult<T, E>::unwrap() noexcept {
+    assert(this->is_ok());
+    return this->_ok;
+}
+
+template <typename T, typename E>
+inline E& CResult<T, E>::unwrap_err() noexcept {
+    assert(this->is_err());
+    return this->_err;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CRustFuture<T> CRustFuture<T>::from(RustFuture<T>&& future) noexcept {
+    CRustFuture f;
+    f._state = future._state;
+    f._vtable = future._vtable;
+    future._reset_empty();
+    return f;
+}
+#else
+template <typename T>
+inline CRustFuture<T>::CRustFuture(RustFuture<T>&& future) noexcept : _state(future._state), _vtable(future._vtable) {
+    future._reset_empty();
 }
 
-inline StrRef::StrRef(const BoxedStr& owned) noexcept : CharStrRef(owned._data, owned._size) {}
+template <typename T>
+inline CRustFuture<T> CRustFuture<T>::from(RustFuture<T>&& future) noexcept {
+    return CRustFuture(std::move(future));
+}
+#endif
 
-inline StrRef CharStrRef::as_str_unchecked() const noexcept {
-    return *reinterpret_cast<const StrRef*>(this);
+template <typename T>
+inline RustFuture<T> CRustFuture<T>::operator()() noexcept {
+    auto future = RustFuture<T>(this->_state, this->_vtable);
+    this->_state = nullptr;
+    this->_vtable = nullptr;
+    return future;
+}
+
+#if _MSC_VER
+template <typename T>
+inline CRustIter<T> CRustIter<T>::from(RustIter<T>&& iter) noexcept {
+    CRustIter it;
+    it._state = iter._state;
+    it._vtable = iter._vtable;
+    iter._reset_empty();
+    return it;
+}
+#else
+template <typename T>
+inline CRustIter<T>::CRustIter(RustIter<T>&& iter) noexcept : _state(iter._state), _vtable(iter._vtable) {
+    iter._reset_empty();
+}
+
+template <typename T>
+inline CRustIter<T> CRustIter<T>::from(RustIter<T>&& iter) noexcept {
+    return CRustIter(std::move(iter));
+}
+#endif
+
+template <typename T>
+inline RustIter<T> CRustIter<T>::operator()() noexcept {
+    auto iter = RustIter<T>(this->_state, this->_vtable);
+    this->_state = nullptr;
+    this->_vtable = nullptr;
+    return iter;
+}
+
+#if FFI_TYPES_INLINE_DEALLOC
+// The layout is known at compile time, so the drop is a single call to the Rust global allocator.
+// Deferred reclamation of `reclaim::DeferredScope` doesn't apply to these drops.
+
+inline void BoxedStr::_drop() noexcept {
+    auto s = this->release();
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(const_cast<char*>(s._data)), s._size, 1);
+}
+
+inline void BoxedCStr::_drop() noexcept {
+    auto s = this->release();
+    // the terminator is a part of the allocation of `Box<CStr>`
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(const_cast<char*>(s._data)), s._size + 1, 1);
+}
+
+template <typename T>
+inline void BoxedSlice<T>::_drop() noexcept {
+    static_assert(std::is_trivially_destructible<T>::value, "specialize _drop() to drop the elements in Rust side");
+    auto s = this->release();
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(s._data), sizeof(T) * s._size, alignof(T));
+}
+#else
+inline void BoxedStr::_drop() noexcept {
+    ffi_types::_rust_ffi_boxed_str_drop(CBoxedStr::from(std::move(*this)));
+}
+
+inline void BoxedCStr::_drop() noexcept {
+    ffi_types::_rust_ffi_boxed_c_str_drop(CBoxedCStr::from(std::move(*this)));
 }
+
 template <>
+inline void BoxedSlice<uint8_t>::_drop() noexcept {
+    ffi_types::_rust_ffi_boxed_bytes_drop(CBoxedSlice<uint8_t>::from(std::move(*this)));
+}
+#endif
+
+inline void BoxedStr::_drop_many(MutSliceRef<BoxedStr> items) noexcept {
+    if (items.empty()) {
+        return;
+    }
+    auto strings = MutSliceRef<CBoxedStr>(reinterpret_cast<CBoxedStr*>(items.data()), items.size());
+    ffi_types::_rust_ffi_boxed_str_drop_many(strings.into());
+    for (auto& item : items) {
+        instrument::_dropped(instrument::_Kind::boxed_str, item._size > 0, item._size);
+        item._take();
+    }
+}
+
 template <>
-inline CharStrRef MutSliceRef<const uint8_t>::as_char_str<const uint8_t>() const noexcept {
-    return CharStrRef(reinterpret_cast<const char*>(this->_data), this->_size);
+inline void BoxedSlice<uint8_t>::_drop_many(MutSliceRef<BoxedSlice<uint8_t>> items) noexcept {
+    if (items.empty()) {
+        return;
+    }
+    auto slices =
+            MutSliceRef<CBoxedSlice<uint8_t>>(reinterpret_cast<CBoxedSlice<uint8_t>*>(items.data()), items.size());
+    ffi_types::_rust_ffi_boxed_bytes_drop_many(slices.into());
+    for (auto& item : items) {
+        instrument::_dropped(instrument::_Kind::boxed_slice, item._size > 0, item._size);
+        item._take();
+    }
 }
+
 template <>
+inline void SliceSender<uint8_t>::_drop() noexcept {
+    ffi_types::_rust_ffi_byte_sender_drop(CSliceSender<uint8_t>::from(std::move(*this)));
+}
+
 template <>
-inline StrRef MutSliceRef<const uint8_t>::as_str_unchecked<const uint8_t>() const noexcept {
-    return as_char_str().as_str_unchecked();
+inline void SliceReceiver<uint8_t>::_drop() noexcept {
+    ffi_types::_rust_ffi_byte_receiver_drop(CSliceReceiver<uint8_t>::from(std::move(*this)));
 }
 
-#undef SAFE_R
-#undef EMPTY_SLICE_BEGIN
+/// Creates a lock-free single-producer single-consumer channel of byte slices
+/// holding up to `capacity` slices in flight. The capacity is rounded up to a power of two.
+inline std::pair<SliceSender<uint8_t>, SliceReceiver<uint8_t>> byte_channel(usize capacity) noexcept {
+    auto sender = CSliceSender<uint8_t>::from(SliceSender<uint8_t>(nullptr));
+    auto receiver = CSliceReceiver<uint8_t>::from(SliceReceiver<uint8_t>(nullptr));
+    ffi_types::_rust_ffi_byte_channel_new(capacity, &sender, &receiver);
+    return {sender(), receiver()};
+}
 
-}  // namespace ffi_types
-#pragma once
+inline Symbol Symbol::intern(const StrRef& s) noexcept {
+    return ffi_types::_rust_ffi_intern(CStrRef::from(s));
+}
 
+inline void Symbol::intern_all(SliceRef<CStrRef> strs, MutSliceRef<Symbol> out) noexcept {
+    assert(strs.size() == out.size());
+    ffi_types::_rust_ffi_intern_all(CSliceRef<CStrRef>::from(strs), CMutSliceRef<Symbol>::from(out));
+}
 
-//! This header is intended to be included in rust_types.hh file.
-    
+inline StrRef Symbol::str() const noexcept {
+    static const SymbolTable* const table = ffi_types::_rust_ffi_symbol_table();
+    const auto block = static_cast<uint32_t>(this->_id / SymbolTable::FIRST_SEGMENT + 1);
+    const auto segment = _str::_highest_bit(block);
+    const auto offset = this->_id - SymbolTable::FIRST_SEGMENT * ((usize(1) << segment) - 1);
+    // A symbol is created only after its segment is published.
+    return table->segments[segment].load(std::memory_order_acquire)[offset]();
+}
 
-namespace ffi_types {
+inline void Arena::_drop() noexcept {
+    ffi_types::_rust_ffi_arena_drop(CArena::from(std::move(*this)));
+}
 
-extern "C" {
+inline Arena Arena::create(usize chunk_size) noexcept {
+    return ffi_types::_rust_ffi_arena_new(chunk_size)();
+}
+
+inline uint8_t* Arena::_alloc_slow(usize size, usize align) noexcept {
+    return ffi_types::_rust_ffi_arena_alloc(&this->as_c(), size, align);
+}
 
-void _rust_ffi_boxed_str_drop(ffi_types::CBoxedStr _string);
+inline void Arena::reset() noexcept {
+    ffi_types::_rust_ffi_arena_reset(&this->as_c());
+}
 
-void _rust_ffi_boxed_bytes_drop(ffi_types::CBoxedSlice<uint8_t> _slice);
+namespace reclaim {
 
-} // extern "C"
+/// Defers drops of boxed values in the current thread while the scope is alive.
+///
+/// Values dropped by Rust drop functions, e.g. `BoxedStr::_drop()` or `BoxedSlice<uint8_t>::_drop()`,
+/// are pushed to a lock-free queue and deallocated by a reclaimer thread in Rust side.
+class DeferredScope {
+public:
+    DeferredScope() noexcept : _previous(ffi_types::_rust_ffi_reclaim_set_deferred(true)) {}
+    DeferredScope(const DeferredScope&) = delete;
+    DeferredScope& operator=(const DeferredScope&) = delete;
+    ~DeferredScope() noexcept {
+        ffi_types::_rust_ffi_reclaim_set_deferred(this->_previous);
+    }
 
-} // namespace ffi_types
-namespace ffi_types {
+private:
+    bool _previous;
+};
 
-inline void BoxedStr::_drop() noexcept {
-    ffi_types::_rust_ffi_boxed_str_drop(CBoxedStr::from(std::move(*this)));
+/// Drops every deferred value before returning.
+inline void flush() noexcept {
+    ffi_types::_rust_ffi_reclaim_flush();
+}
+
+/// Returns the number of values deferred but not dropped yet.
+inline usize pending() noexcept {
+    return ffi_types::_rust_ffi_reclaim_pending();
+}
+
+/// Returns the number of values ever deferred in any thread.
+inline usize deferred_count() noexcept {
+    return ffi_types::_rust_ffi_reclaim_deferred_count();
+}
+
+}  // namespace reclaim
+
+namespace pool {
+
+/// Sets the maximum bytes kept by each size class of each thread. Zero disables buffer pools.
+/// Returns the previous limit.
+inline usize set_limit(usize bytes_per_class) noexcept {
+    return ffi_types::_rust_ffi_pool_set_limit(bytes_per_class);
+}
+
+/// Returns the counters of the buffer pool of the current thread.
+inline PoolStats thread_stats() noexcept {
+    return ffi_types::_rust_ffi_pool_thread_stats();
+}
+
+/// Frees every buffer in the buffer pool of the current thread.
+inline void clear() noexcept {
+    ffi_types::_rust_ffi_pool_clear();
+}
+
+}  // namespace pool
+
+#if FFI_TYPES_INSTRUMENT
+namespace instrument {
+
+inline OwnershipShard& _thread_shard() noexcept {
+    if (!_shard) {
+        // Atomic counters are written through the shared reference as in Rust side.
+        _shard = const_cast<OwnershipShard*>(ffi_types::_rust_ffi_instrument_thread_shard());
+    }
+    return *_shard;
+}
+
+inline OwnershipSnapshot snapshot() noexcept {
+    return ffi_types::_rust_ffi_instrument_snapshot();
 }
 
+}  // namespace instrument
+#endif
+
 template <>
-inline void BoxedSlice<uint8_t>::_drop() noexcept {
-    ffi_types::_rust_ffi_boxed_bytes_drop(CBoxedSlice<uint8_t>::from(std::move(*this)));
+template <>
+inline BoxedSlice<uint8_t> BoxedSlice<uint8_t>::from_pool<uint8_t>(usize size) noexcept {
+    return ffi_types::_rust_ffi_pool_alloc(size)();
+}
+
+template <typename T>
+inline BoxedSlice<T> BoxedSlice<T>::with_capacity_uninit(usize size) noexcept {
+    auto slice = BoxedSlice<T>(nullptr);
+    slice.resize_uninit(size);
+    return slice;
+}
+
+template <typename T>
+inline void BoxedSlice<T>::resize_uninit(usize size) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "elements are moved by realloc");
+    assert(size <= SIZE_MAX / sizeof(T));
+    if (size == this->_size) {
+        return;
+    }
+    // realloc ignores the dangling pointer of an empty slice
+    auto* data = ffi_types::_rust_ffi_realloc(
+            reinterpret_cast<uint8_t*>(this->_data), sizeof(T) * this->_size, alignof(T), sizeof(T) * size);
+    instrument::_resize(instrument::_Kind::boxed_slice, sizeof(T) * this->_size, sizeof(T) * size);
+    this->_data = size > 0 ? reinterpret_cast<T*>(data) : reinterpret_cast<T*>(1);
+    this->_size = size;
+}
+
+#if FFI_TYPES_INLINE_DEALLOC
+template <typename T>
+inline void Vec<T>::_drop() noexcept {
+    static_assert(std::is_trivially_destructible<T>::value, "specialize _drop() to drop the elements in Rust side");
+    auto v = CVec<T>::from(std::move(*this));
+    ffi_types::_rust_ffi_dealloc(reinterpret_cast<uint8_t*>(v._data), sizeof(T) * v._capacity, alignof(T));
+}
+#else
+template <>
+inline void Vec<uint8_t>::_drop() noexcept {
+    ffi_types::_rust_ffi_vec_bytes_drop(CVec<uint8_t>::from(std::move(*this)));
+}
+#endif
+
+template <typename T>
+inline void Vec<T>::reserve(usize additional) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "elements are moved by realloc");
+    if (this->_capacity - this->_size < additional) {
+        ffi_types::_rust_ffi_vec_reserve(reinterpret_cast<CVec<uint8_t>*>(this), additional, sizeof(T), alignof(T));
+    }
+}
+
+inline std::optional<BoxedStr> BoxedStr::from_utf8_copy(CharStrRef s) noexcept {
+    if (!s.is_utf8()) {
+        return std::nullopt;
+    }
+    // the layout of `Box<str>`
+    auto* data = ffi_types::_rust_ffi_alloc(s.size(), 1);
+    if (!s.empty()) {
+        std::memcpy(data, s.data(), s.size());
+    }
+    auto str = BoxedStr(nullptr);
+    str.reset({reinterpret_cast<const char*>(data), s.size()});
+    return std::optional<BoxedStr>(std::move(str));
+}
+
+inline BoxedStr CowStr::to_owned() const noexcept {
+    // the layout of `Box<str>`
+    auto* data = ffi_types::_rust_ffi_alloc(this->size(), 1);
+    if (!this->empty()) {
+        std::memcpy(data, this->_data, this->size());
+    }
+    auto str = BoxedStr(nullptr);
+    str.reset({reinterpret_cast<const char*>(data), this->size()});
+    return str;
+}
+
+inline std::optional<BoxedCStr> BoxedCStr::from_copy(CharStrRef s) noexcept {
+    if (s.empty()) {
+        return std::optional<BoxedCStr>(BoxedCStr(nullptr));
+    }
+    if (std::memchr(s.data(), 0, s.size()) != nullptr) {
+        return std::nullopt;
+    }
+    // the layout of `Box<CStr>`
+    auto* data = ffi_types::_rust_ffi_alloc(s.size() + 1, 1);
+    std::memcpy(data, s.data(), s.size());
+    data[s.size()] = 0;
+    auto str = BoxedCStr(nullptr);
+    str.reset({reinterpret_cast<const char*>(data), s.size()});
+    return std::optional<BoxedCStr>(std::move(str));
+}
+
+inline void CompactStr::_drop() noexcept {
+    // A heap string is a `BoxedStr`.
+    auto boxed = BoxedStr(nullptr);
+    boxed._reset({this->_data, this->_size});
+    this->_set_inline_size(0);
+    boxed._drop();
+}
+
+inline std::optional<CompactStr> CompactStr::from_utf8_copy(CharStrRef s) noexcept {
+    if (s.size() > inline_capacity) {
+        auto boxed = BoxedStr::from_utf8_copy(s);
+        if (!boxed) {
+            return std::nullopt;
+        }
+        return std::optional<CompactStr>(CompactStr(std::move(*boxed)));
+    }
+    if (!s.is_utf8()) {
+        return std::nullopt;
+    }
+    auto str = CompactStr(nullptr);
+    if (!s.empty()) {
+        std::memcpy(static_cast<void*>(&str), s.data(), s.size());
+    }
+    str._set_inline_size(s.size());
+    return std::optional<CompactStr>(std::move(str));
+}
+
+inline void MmapSlice::_drop() noexcept {
+    ffi_types::_rust_ffi_mmap_drop(CMmapSlice::from(std::move(*this)));
+}
+
+inline std::optional<MmapSlice> MmapSlice::open(CharStrRef path, int32_t* error) noexcept {
+    CMmapSlice c = CMmapSlice::from(MmapSlice(nullptr));
+    const auto result = ffi_types::_rust_ffi_mmap_open(path, &c);
+    if (error) {
+        *error = result;
+    }
+    if (result != 0) {
+        return std::nullopt;
+    }
+    return std::optional<MmapSlice>(c());
+}
+
+inline int32_t MmapSlice::advise(usize offset, usize size, MmapAdvice advice) const noexcept {
+    assert(offset <= this->_size && size <= this->_size - offset);
+    return ffi_types::_rust_ffi_mmap_advise(SliceRef<uint8_t>(this->_data + offset, size).into(), advice);
 }
 
 }  // namespace ffi_types
 #undef _COPY_DELETE
+#undef _STR_COMPARISONS
+#undef EMPTY_SLICE_BEGIN
 
 namespace rust {
 using namespace ffi_types;
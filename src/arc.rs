@@ -0,0 +1,126 @@
+/// A FFI-safe wrapper for `std::sync::Arc<T>`.
+///
+/// The pointer is the value of `Arc::into_raw()`, which points the data of `ArcInner<T>`.
+/// C++ `Arc<T>` updates the strong counter of `ArcInner<T>` in place, so its layout is tested below.
+#[repr(C)]
+pub struct Arc<T> {
+    pub(crate) ptr: *const T,
+}
+static_assertions::assert_eq_size!(Arc<u8>, *const u8);
+static_assertions::assert_eq_size!(Arc<u8>, std::sync::Arc<u8>);
+
+unsafe impl<T: Send + Sync> Send for Arc<T> {}
+unsafe impl<T: Send + Sync> Sync for Arc<T> {}
+
+impl<T> Arc<T> {
+    #[inline(always)]
+    pub fn new(arc: std::sync::Arc<T>) -> Self {
+        Self {
+            ptr: std::sync::Arc::into_raw(arc),
+        }
+    }
+
+    #[inline(always)]
+    pub fn from_value(value: T) -> Self {
+        Self::new(std::sync::Arc::new(value))
+    }
+
+    #[inline(always)]
+    pub fn into_arc(self) -> std::sync::Arc<T> {
+        let this = std::mem::ManuallyDrop::new(self);
+        unsafe { std::sync::Arc::from_raw(this.ptr) }
+    }
+
+    #[inline(always)]
+    pub fn as_ptr(&self) -> *const T {
+        self.ptr
+    }
+}
+
+impl<T> Drop for Arc<T> {
+    #[inline]
+    fn drop(&mut self) {
+        drop(unsafe { std::sync::Arc::from_raw(self.ptr) });
+    }
+}
+
+impl<T> Clone for Arc<T> {
+    #[inline]
+    fn clone(&self) -> Self {
+        unsafe { std::sync::Arc::increment_strong_count(self.ptr) };
+        Self { ptr: self.ptr }
+    }
+}
+
+impl<T> From<std::sync::Arc<T>> for Arc<T> {
+    #[inline]
+    fn from(arc: std::sync::Arc<T>) -> Self {
+        Self::new(arc)
+    }
+}
+
+impl<T> From<Arc<T>> for std::sync::Arc<T> {
+    #[inline]
+    fn from(arc: Arc<T>) -> Self {
+        arc.into_arc()
+    }
+}
+
+impl<T> std::convert::AsRef<T> for Arc<T> {
+    #[inline(always)]
+    fn as_ref(&self) -> &T {
+        unsafe { &*self.ptr }
+    }
+}
+
+impl<T> std::borrow::Borrow<T> for Arc<T> {
+    #[inline(always)]
+    fn borrow(&self) -> &T {
+        self.as_ref()
+    }
+}
+
+impl<T> std::ops::Deref for Arc<T> {
+    type Target = T;
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_ref()
+    }
+}
+
+#[cfg(test)]
+fn strong_counter<T>(arc: &Arc<T>) -> &std::sync::atomic::AtomicUsize {
+    // same as `Arc<T>::_strong()` in C++ side
+    let size = std::mem::size_of::<usize>();
+    let align = std::mem::align_of::<T>();
+    let offset = (2 * size + align - 1) / align * align;
+    unsafe { &*((arc.ptr as *const u8).sub(offset) as *const std::sync::atomic::AtomicUsize) }
+}
+
+#[test]
+fn test_arc_inner_layout() {
+    use std::sync::atomic::Ordering;
+
+    #[repr(align(64))]
+    struct Aligned(#[allow(dead_code)] u8);
+
+    fn check<T>(value: T) {
+        let arc = Arc::from_value(value);
+        assert_eq!(strong_counter(&arc).load(Ordering::Relaxed), 1);
+        let cloned = arc.clone();
+        assert_eq!(strong_counter(&arc).load(Ordering::Relaxed), 2);
+        drop(cloned);
+
+        // increments as C++ side does
+        strong_counter(&arc).fetch_add(1, Ordering::Relaxed);
+        let arc: std::sync::Arc<T> = arc.into();
+        assert_eq!(std::sync::Arc::strong_count(&arc), 2);
+        unsafe { std::sync::Arc::decrement_strong_count(std::sync::Arc::as_ptr(&arc)) };
+        assert_eq!(std::sync::Arc::strong_count(&arc), 1);
+    }
+    check(1u8);
+    check(1u64);
+    check(Aligned(1));
+    check(String::from("shared"));
+}
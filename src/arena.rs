@@ -0,0 +1,204 @@
+//! Bump allocation of slices and strings freed all at once.
+//!
+//! Values allocated in an [`Arena`] are not dropped one by one.
+//! Dropping or resetting the arena frees every chunk at once instead,
+//! so no per-value drop call crosses FFI and no allocator lock is taken per value.
+
+use crate::{MutSliceRef, StrRef};
+use std::alloc::Layout;
+use std::cell::{Cell, UnsafeCell};
+use std::ptr::NonNull;
+
+/// A string allocated in an [`Arena`]. It is valid until the arena is reset or dropped.
+pub type ArenaStr = StrRef;
+/// A slice allocated in an [`Arena`]. It is valid until the arena is reset or dropped.
+pub type ArenaSlice<T> = MutSliceRef<T>;
+
+const DEFAULT_CHUNK_SIZE: usize = 4096;
+const MAX_CHUNK_SIZE: usize = 1 << 20;
+const CHUNK_ALIGN: usize = 16;
+
+/// The first 2 fields are shared with C++ `Arena`, which bumps `cursor` inline.
+#[repr(C)]
+struct ArenaInner {
+    cursor: Cell<*mut u8>,
+    end: Cell<*mut u8>,
+    chunks: UnsafeCell<std::vec::Vec<(NonNull<u8>, Layout)>>,
+    chunk_size: Cell<usize>,
+}
+
+/// A bump allocator for values living together, e.g. in a request.
+///
+/// Only values without drop glue are allocated, because the arena never drops them.
+/// C++ `Arena` shares the same allocator and allocates inline until the current chunk is full.
+#[repr(C)]
+pub struct Arena {
+    inner: NonNull<ArenaInner>,
+}
+static_assertions::assert_eq_size!(Arena, *const u8);
+
+// SAFETY: Allocated values are only reachable through borrows of the arena.
+unsafe impl Send for Arena {}
+
+impl Arena {
+    #[inline]
+    pub fn new() -> Self {
+        Self::with_chunk_size(DEFAULT_CHUNK_SIZE)
+    }
+
+    /// Creates an arena allocating chunks of `chunk_size` bytes first.
+    /// Later chunks grow up to 1 MiB.
+    pub fn with_chunk_size(chunk_size: usize) -> Self {
+        let inner = std::boxed::Box::new(ArenaInner {
+            cursor: Cell::new(std::ptr::null_mut()),
+            end: Cell::new(std::ptr::null_mut()),
+            chunks: UnsafeCell::new(std::vec::Vec::new()),
+            chunk_size: Cell::new(chunk_size.clamp(CHUNK_ALIGN, MAX_CHUNK_SIZE)),
+        });
+        Self {
+            inner: NonNull::from(std::boxed::Box::leak(inner)),
+        }
+    }
+
+    #[inline(always)]
+    fn inner(&self) -> &ArenaInner {
+        unsafe { self.inner.as_ref() }
+    }
+
+    /// Allocates a memory block of `layout`. Zero-sized blocks are dangling.
+    #[inline]
+    pub fn alloc_layout(&self, layout: Layout) -> NonNull<u8> {
+        let inner = self.inner();
+        let cursor = inner.cursor.get() as usize;
+        let aligned = cursor.wrapping_add(layout.align() - 1) & !(layout.align() - 1);
+        let end = inner.end.get() as usize;
+        if aligned >= cursor && aligned <= end && layout.size() <= end - aligned && cursor != 0 {
+            // keep the provenance of the chunk
+            let ptr = unsafe { inner.cursor.get().add(aligned - cursor) };
+            inner.cursor.set(unsafe { ptr.add(layout.size()) });
+            return unsafe { NonNull::new_unchecked(ptr) };
+        }
+        self.alloc_slow(layout)
+    }
+
+    #[cold]
+    fn alloc_slow(&self, layout: Layout) -> NonNull<u8> {
+        if layout.size() == 0 {
+            return unsafe { NonNull::new_unchecked(layout.align() as *mut u8) };
+        }
+        let inner = self.inner();
+        let chunk_size = inner.chunk_size.get();
+        // A large block gets its own chunk not to waste the rest of the current chunk.
+        if layout.size() > chunk_size / 4 || layout.align() > CHUNK_ALIGN {
+            return self.alloc_chunk(layout);
+        }
+        let chunk = self.alloc_chunk(Layout::from_size_align(chunk_size, CHUNK_ALIGN).unwrap());
+        inner.chunk_size.set((chunk_size * 2).min(MAX_CHUNK_SIZE));
+        let start = chunk.as_ptr();
+        inner.cursor.set(unsafe { start.add(layout.size()) });
+        inner.end.set(unsafe { start.add(chunk_size) });
+        chunk
+    }
+
+    fn alloc_chunk(&self, layout: Layout) -> NonNull<u8> {
+        let Some(ptr) = NonNull::new(unsafe { std::alloc::alloc(layout) }) else {
+            std::alloc::handle_alloc_error(layout);
+        };
+        unsafe { (*self.inner().chunks.get()).push((ptr, layout)) };
+        ptr
+    }
+
+    /// Copies `value` to the arena.
+    #[inline]
+    pub fn alloc_str(&self, value: &str) -> &str {
+        let bytes = self.alloc_slice_copy(value.as_bytes());
+        unsafe { std::str::from_utf8_unchecked(bytes) }
+    }
+
+    /// Copies `value` to the arena.
+    #[inline]
+    #[allow(clippy::mut_from_ref)]
+    pub fn alloc_slice_copy<T: Copy>(&self, value: &[T]) -> &mut [T] {
+        let layout = Layout::for_value(value);
+        let ptr = self.alloc_layout(layout).as_ptr() as *mut T;
+        unsafe {
+            std::ptr::copy_nonoverlapping(value.as_ptr(), ptr, value.len());
+            std::slice::from_raw_parts_mut(ptr, value.len())
+        }
+    }
+
+    /// Frees every value at once. The last chunk is kept to be reused.
+    pub fn reset(&mut self) {
+        let inner = self.inner();
+        let chunks = unsafe { &mut *inner.chunks.get() };
+        // The current chunk ends at `end`. Dedicated chunks of large blocks may follow it.
+        let end = inner.end.get();
+        let kept = chunks
+            .iter()
+            .rposition(|&(ptr, layout)| ptr.as_ptr().wrapping_add(layout.size()) == end)
+            .filter(|_| !end.is_null())
+            .map(|i| chunks.swap_remove(i));
+        for (ptr, layout) in chunks.drain(..) {
+            unsafe { std::alloc::dealloc(ptr.as_ptr(), layout) };
+        }
+        match kept {
+            Some((ptr, layout)) => {
+                chunks.push((ptr, layout));
+                inner.cursor.set(ptr.as_ptr());
+                inner.end.set(unsafe { ptr.as_ptr().add(layout.size()) });
+            }
+            None => {
+                inner.cursor.set(std::ptr::null_mut());
+                inner.end.set(std::ptr::null_mut());
+            }
+        }
+    }
+
+    /// Returns the total size of chunks allocated from the global allocator.
+    pub fn allocated_bytes(&self) -> usize {
+        let chunks = unsafe { &*self.inner().chunks.get() };
+        chunks.iter().map(|(_, layout)| layout.size()).sum()
+    }
+}
+
+impl Default for Arena {
+    #[inline]
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Drop for Arena {
+    fn drop(&mut self) {
+        let inner = unsafe { std::boxed::Box::from_raw(self.inner.as_ptr()) };
+        for (ptr, layout) in inner.chunks.into_inner() {
+            unsafe { std::alloc::dealloc(ptr.as_ptr(), layout) };
+        }
+    }
+}
+
+#[test]
+fn test_arena() {
+    let mut arena = Arena::with_chunk_size(64);
+    let hello = arena.alloc_str("hello");
+    let numbers = arena.alloc_slice_copy(&[1u64, 2, 3]);
+    numbers[0] = 10;
+    assert_eq!(hello, "hello");
+    assert_eq!(numbers, &[10, 2, 3]);
+    assert_eq!(numbers.as_ptr() as usize % 8, 0);
+    assert!(arena.alloc_slice_copy::<u8>(&[]).is_empty());
+
+    // a large block gets its own chunk
+    let large = arena.alloc_slice_copy(&[7u8; 1000]);
+    assert_eq!(large.len(), 1000);
+    let next = arena.alloc_str("next");
+    assert_eq!(next, "next");
+    assert_eq!(arena.allocated_bytes(), 64 + 1000);
+
+    for i in 0..100u32 {
+        assert_eq!(arena.alloc_slice_copy(&[i; 4]), &[i; 4]);
+    }
+    arena.reset();
+    assert!(arena.allocated_bytes() <= MAX_CHUNK_SIZE);
+    assert_eq!(arena.alloc_str("reused"), "reused");
+}
@@ -3,6 +3,14 @@ use crate::slice::SliceInner;
 pub const CXX_INCLUDE_PATH: &str = concat!(env!("CARGO_MANIFEST_DIR"), "/include");
 pub const CXX_HEADER_PATH: &str = concat!(env!("CARGO_MANIFEST_DIR"), "/include/rust_types.hxx");
 pub const CXX_HEADER_CONTENT: &str = include_str!("../include/rust_types.hxx");
+/// Forward declarations and C-prefixed types, enough for FFI headers declaring functions and structs using them.
+pub const CXX_FWD_HEADER_PATH: &str =
+    concat!(env!("CARGO_MANIFEST_DIR"), "/include/rust_types_fwd.hxx");
+/// C++20 module interface exporting `ffi_types` of `CXX_HEADER_PATH`.
+///
+/// Experimental and unsupported: no tested toolchain links a program importing it, so use `CXX_HEADER_PATH`
+/// or `CXX_FWD_HEADER_PATH` for production builds.
+pub const CXX_MODULE_PATH: &str = concat!(env!("CARGO_MANIFEST_DIR"), "/include/rust_types.cppm");
 
 #[allow(non_camel_case_types)]
 #[cfg(feature = "libc")]
@@ -13,10 +21,22 @@ type c_char = u8;
 
 pub type COptionBox<T> = crate::OptionBox<T>;
 pub type CBox<T> = COptionBox<T>;
+pub type CArc<T> = crate::Arc<T>;
+pub type CArena = crate::Arena;
 
 pub type CSliceRef<T> = crate::SliceRef<T>;
+pub type CMutSliceRef<T> = crate::MutSliceRef<T>;
 pub type CBoxedSlice<T> = crate::BoxedSlice<T>;
 pub type CByteSliceRef = crate::ByteSliceRef;
+pub type CIoSliceRef = crate::IoSliceRef;
+#[cfg(all(unix, feature = "libc"))]
+pub type CMmapSlice = crate::MmapSlice;
+pub type CVec<T> = crate::Vec<T>;
+pub type CForeignBoxedSlice<T> = crate::ForeignBoxedSlice<T>;
+pub type CSliceSender<T> = crate::SliceSender<T>;
+pub type CSliceReceiver<T> = crate::SliceReceiver<T>;
+pub type CRustIter<T> = crate::RustIter<T>;
+pub type CRustFuture<T> = crate::RustFuture<T>;
 
 pub type CStrRef = crate::StrRef;
 
@@ -71,15 +91,394 @@ impl CharStrRef {
 }
 
 pub type CBoxedStr = crate::BoxedStr;
+pub type CCompactStr = crate::CompactStr;
+pub type CStrZRef = crate::StrZRef;
+pub type CBoxedCStr = crate::BoxedCStr;
+pub type CCowStr = crate::CowStr;
+pub type CCowSlice<T> = crate::CowSlice<T>;
 
 pub mod ffi {
     use super::*;
 
     #[export_name = "_rust_ffi_boxed_str_drop"]
-    pub unsafe extern "C" fn boxed_str_drop(_string: CBoxedStr) {}
+    pub unsafe extern "C" fn boxed_str_drop(string: CBoxedStr) {
+        crate::reclaim::drop_or_defer(string);
+    }
+
+    #[export_name = "_rust_ffi_boxed_c_str_drop"]
+    pub unsafe extern "C" fn boxed_c_str_drop(string: CBoxedCStr) {
+        crate::reclaim::drop_or_defer(string);
+    }
 
+    /// Returns `slice` to the buffer pool of the current thread if it is of a size class.
     #[export_name = "_rust_ffi_boxed_bytes_drop"]
-    pub unsafe extern "C" fn boxed_bytes_drop(_slice: CBoxedSlice<u8>) {}
+    pub unsafe extern "C" fn boxed_bytes_drop(slice: CBoxedSlice<u8>) {
+        if let Err(slice) = crate::pool::recycle(slice) {
+            crate::reclaim::drop_or_defer(slice);
+        }
+    }
+
+    /// Drops every string of `strings` at once.
+    /// The caller must not use or drop the items after this call.
+    #[export_name = "_rust_ffi_boxed_str_drop_many"]
+    pub unsafe extern "C" fn boxed_str_drop_many(strings: CMutSliceRef<CBoxedStr>) {
+        crate::reclaim::drop_or_defer_many(strings.into_mut_slice());
+    }
+
+    /// Drops every slice of `slices` at once.
+    /// The caller must not use or drop the items after this call.
+    #[export_name = "_rust_ffi_boxed_bytes_drop_many"]
+    pub unsafe extern "C" fn boxed_bytes_drop_many(slices: CMutSliceRef<CBoxedSlice<u8>>) {
+        let slices = slices.into_mut_slice();
+        if crate::pool::limit() == 0 {
+            crate::reclaim::drop_or_defer_many(slices);
+            return;
+        }
+        for slice in slices {
+            boxed_bytes_drop(std::ptr::read(slice));
+        }
+    }
+
+    /// Enables or disables deferred drop of boxed values in the current thread.
+    /// Returns the previous state.
+    ///
+    /// In deferred mode, drop functions push values to a reclaimer thread instead of deallocating them.
+    #[export_name = "_rust_ffi_reclaim_set_deferred"]
+    pub extern "C" fn reclaim_set_deferred(enabled: bool) -> bool {
+        crate::reclaim::set_deferred(enabled)
+    }
+
+    /// Drops every deferred value before returning.
+    #[export_name = "_rust_ffi_reclaim_flush"]
+    pub extern "C" fn reclaim_flush() {
+        crate::reclaim::flush()
+    }
+
+    /// Returns the number of values deferred but not dropped yet.
+    #[export_name = "_rust_ffi_reclaim_pending"]
+    pub extern "C" fn reclaim_pending() -> usize {
+        crate::reclaim::pending()
+    }
+
+    /// Returns the number of values ever deferred.
+    #[export_name = "_rust_ffi_reclaim_deferred_count"]
+    pub extern "C" fn reclaim_deferred_count() -> usize {
+        crate::reclaim::deferred_count()
+    }
+
+    /// Allocates a byte slice of `size` uninitialized bytes.
+    /// A buffer of a size class is taken from the buffer pool of the current thread if one is available.
+    #[export_name = "_rust_ffi_pool_alloc"]
+    pub unsafe extern "C" fn pool_alloc(size: usize) -> CBoxedSlice<u8> {
+        crate::pool::alloc_uninit(size)
+    }
+
+    /// Sets the maximum bytes kept by each size class of each thread. Zero disables buffer pools.
+    /// Returns the previous limit.
+    #[export_name = "_rust_ffi_pool_set_limit"]
+    pub extern "C" fn pool_set_limit(bytes_per_class: usize) -> usize {
+        crate::pool::set_limit(bytes_per_class)
+    }
+
+    /// Returns the counters of the buffer pool of the current thread.
+    #[export_name = "_rust_ffi_pool_thread_stats"]
+    pub extern "C" fn pool_thread_stats() -> crate::pool::PoolStats {
+        crate::pool::thread_stats()
+    }
+
+    /// Frees every buffer in the buffer pool of the current thread.
+    #[export_name = "_rust_ffi_pool_clear"]
+    pub extern "C" fn pool_clear() {
+        crate::pool::clear()
+    }
+
+    /// Returns the counters of the current thread, which C++ `FFI_TYPES_INSTRUMENT` writes inline.
+    #[cfg(feature = "instrument")]
+    #[export_name = "_rust_ffi_instrument_thread_shard"]
+    pub extern "C" fn instrument_thread_shard() -> &'static crate::instrument::OwnershipShard {
+        crate::instrument::thread_shard()
+    }
+
+    /// Sums the counters of C++ ownership transfers of every thread.
+    #[cfg(feature = "instrument")]
+    #[export_name = "_rust_ffi_instrument_snapshot"]
+    pub extern "C" fn instrument_snapshot() -> crate::instrument::OwnershipSnapshot {
+        crate::instrument::snapshot()
+    }
+
+    #[export_name = "_rust_ffi_vec_bytes_drop"]
+    pub unsafe extern "C" fn vec_bytes_drop(vec: CVec<u8>) {
+        crate::reclaim::drop_or_defer(vec);
+    }
+
+    /// Reserves capacity for at least `additional` more elements.
+    ///
+    /// This is a type-erased `Vec::reserve` for elements of `elem_size` bytes aligned by `align`.
+    /// `len` and `cap` of `vec` are counted by elements, not bytes.
+    #[export_name = "_rust_ffi_vec_reserve"]
+    pub unsafe extern "C" fn vec_reserve(
+        vec: &mut CVec<u8>,
+        additional: usize,
+        elem_size: usize,
+        align: usize,
+    ) {
+        if elem_size == 0 {
+            vec.cap = usize::MAX;
+            return;
+        }
+        let Some(cap) = grown_capacity(vec.inner.len, vec.cap, additional, elem_size, align) else {
+            return;
+        };
+        vec.inner.ptr = realloc(vec.inner.ptr, vec.cap * elem_size, align, cap * elem_size);
+        vec.cap = cap;
+    }
+
+    /// Returns the capacity of [`vec_reserve`] if `cap` is not enough for `additional` more elements.
+    ///
+    /// Panics with "capacity overflow" as `Vec::reserve` if the capacity in bytes is not a valid layout,
+    /// i.e. overflows `isize::MAX`, before anything is reallocated.
+    pub(crate) fn grown_capacity(
+        len: usize,
+        cap: usize,
+        additional: usize,
+        elem_size: usize,
+        align: usize,
+    ) -> Option<usize> {
+        let required = len.checked_add(additional).expect("capacity overflow");
+        if required <= cap {
+            return None;
+        }
+        // same amortized growth as `Vec<T>`
+        let min_cap = if elem_size == 1 {
+            8
+        } else if elem_size <= 1024 {
+            4
+        } else {
+            1
+        };
+        let cap = std::cmp::max(std::cmp::max(cap * 2, required), min_cap);
+        let new_size = cap.checked_mul(elem_size).expect("capacity overflow");
+        std::alloc::Layout::from_size_align(new_size, align).expect("capacity overflow");
+        Some(cap)
+    }
+
+    /// Allocates `size` bytes aligned by `align` from the Rust global allocator.
+    ///
+    /// The memory can be owned by a boxed type only if the layout is the one Rust deallocates it with.
+    /// e.g. `size_of::<T>() * len` and `align_of::<T>()` for `Box<[T]>`.
+    /// Zero-sized allocation returns a dangling pointer.
+    #[export_name = "_rust_ffi_alloc"]
+    pub unsafe extern "C" fn alloc(size: usize, align: usize) -> *mut u8 {
+        let layout = std::alloc::Layout::from_size_align(size, align).expect("invalid layout");
+        if size == 0 {
+            return align as *mut u8;
+        }
+        let ptr = std::alloc::alloc(layout);
+        if ptr.is_null() {
+            std::alloc::handle_alloc_error(layout);
+        }
+        ptr
+    }
+
+    /// Resizes a memory block from [`alloc`] or a boxed type from `old_size` to `new_size` bytes.
+    ///
+    /// Either size can be zero. The returned pointer is dangling when `new_size` is zero.
+    #[export_name = "_rust_ffi_realloc"]
+    pub unsafe extern "C" fn realloc(
+        ptr: *mut u8,
+        old_size: usize,
+        align: usize,
+        new_size: usize,
+    ) -> *mut u8 {
+        if old_size == 0 {
+            return alloc(new_size, align);
+        }
+        if new_size == 0 {
+            dealloc(ptr, old_size, align);
+            return align as *mut u8;
+        }
+        let layout = std::alloc::Layout::from_size_align_unchecked(old_size, align);
+        let ptr = std::alloc::realloc(ptr, layout, new_size);
+        if ptr.is_null() {
+            std::alloc::handle_alloc_error(std::alloc::Layout::from_size_align_unchecked(
+                new_size, align,
+            ));
+        }
+        ptr
+    }
+
+    /// Deallocates a memory block from [`alloc`] or [`realloc`]. Zero-sized blocks are ignored.
+    #[export_name = "_rust_ffi_dealloc"]
+    pub unsafe extern "C" fn dealloc(ptr: *mut u8, size: usize, align: usize) {
+        if size == 0 {
+            return;
+        }
+        std::alloc::dealloc(
+            ptr,
+            std::alloc::Layout::from_size_align_unchecked(size, align),
+        );
+    }
+
+    /// Checks whether `string` is a valid UTF-8 string.
+    #[export_name = "_rust_ffi_utf8_validate"]
+    pub extern "C" fn utf8_validate(string: CharStrRef) -> bool {
+        string.to_str().is_ok()
+    }
+
+    /// Hashes `bytes` by the same function as C++ `ffi_types::hash_bytes()`.
+    #[export_name = "_rust_ffi_hash_bytes"]
+    pub extern "C" fn hash_bytes(bytes: CByteSliceRef) -> u64 {
+        crate::hash_bytes(bytes.as_ref())
+    }
+
+    /// Returns the symbol of `string`, interning it if it is new.
+    #[export_name = "_rust_ffi_intern"]
+    pub extern "C" fn intern(string: CStrRef) -> crate::Symbol {
+        crate::interner::intern(string.as_str())
+    }
+
+    /// Interns every string of `strings` into `out` of the same length.
+    #[export_name = "_rust_ffi_intern_all"]
+    pub extern "C" fn intern_all(strings: CSliceRef<CStrRef>, out: CMutSliceRef<crate::Symbol>) {
+        crate::interner::intern_all(&strings, out.into_mut_slice());
+    }
+
+    /// Returns the table which C++ `Symbol::str()` resolves symbols with inline.
+    #[export_name = "_rust_ffi_symbol_table"]
+    pub extern "C" fn symbol_table() -> &'static crate::interner::SymbolTable {
+        crate::interner::table()
+    }
+
+    /// Creates an arena allocating chunks of `chunk_size` bytes first. Zero means the default size.
+    #[export_name = "_rust_ffi_arena_new"]
+    pub extern "C" fn arena_new(chunk_size: usize) -> CArena {
+        if chunk_size == 0 {
+            CArena::new()
+        } else {
+            CArena::with_chunk_size(chunk_size)
+        }
+    }
+
+    #[export_name = "_rust_ffi_arena_drop"]
+    pub extern "C" fn arena_drop(_arena: CArena) {}
+
+    /// Allocates `size` bytes aligned by `align` from `arena`.
+    /// This is the slow path of C++ `Arena::alloc()` when the current chunk is full.
+    #[export_name = "_rust_ffi_arena_alloc"]
+    pub extern "C" fn arena_alloc(arena: &CArena, size: usize, align: usize) -> *mut u8 {
+        let layout = std::alloc::Layout::from_size_align(size, align).expect("invalid layout");
+        arena.alloc_layout(layout).as_ptr()
+    }
+
+    /// Frees every value of `arena` at once.
+    #[export_name = "_rust_ffi_arena_reset"]
+    pub extern "C" fn arena_reset(arena: &mut CArena) {
+        arena.reset();
+    }
+
+    /// Creates a channel of byte slices holding up to `capacity` slices in flight.
+    /// The capacity is rounded up to a power of two.
+    #[export_name = "_rust_ffi_byte_channel_new"]
+    pub unsafe extern "C" fn byte_channel_new(
+        capacity: usize,
+        sender: *mut CSliceSender<u8>,
+        receiver: *mut CSliceReceiver<u8>,
+    ) {
+        let (s, r) = crate::channel::channel(capacity);
+        sender.write(s);
+        receiver.write(r);
+    }
+
+    #[export_name = "_rust_ffi_byte_sender_drop"]
+    pub extern "C" fn byte_sender_drop(_sender: CSliceSender<u8>) {}
+
+    #[export_name = "_rust_ffi_byte_receiver_drop"]
+    pub extern "C" fn byte_receiver_drop(_receiver: CSliceReceiver<u8>) {}
+
+    /// Maps the whole file of `path` as read-only to `out`.
+    /// Returns 0 on success or an `errno` value. `out` is not written on failure.
+    ///
+    /// The file must not be modified or truncated while the mapping is alive. See Rust `MmapSlice::open`.
+    #[cfg(all(unix, feature = "libc"))]
+    #[export_name = "_rust_ffi_mmap_open"]
+    pub unsafe extern "C" fn mmap_open(path: CharStrRef, out: *mut CMmapSlice) -> i32 {
+        use std::os::unix::ffi::OsStrExt;
+
+        let path = std::ffi::OsStr::from_bytes(path.as_bytes());
+        match CMmapSlice::open(path) {
+            Ok(mmap) => {
+                out.write(mmap);
+                0
+            }
+            Err(e) => e.raw_os_error().unwrap_or(libc::EIO),
+        }
+    }
+
+    #[cfg(all(unix, feature = "libc"))]
+    #[export_name = "_rust_ffi_mmap_drop"]
+    pub unsafe extern "C" fn mmap_drop(_mmap: CMmapSlice) {}
+
+    /// Gives a hint of the access pattern of `bytes`, which must be a part of a mapping.
+    /// Returns 0 on success or an `errno` value.
+    #[cfg(all(unix, feature = "libc"))]
+    #[export_name = "_rust_ffi_mmap_advise"]
+    pub extern "C" fn mmap_advise(bytes: CByteSliceRef, advice: crate::MmapAdvice) -> i32 {
+        match crate::mmap::advise(bytes.as_ref(), advice) {
+            Ok(()) => 0,
+            Err(e) => e.raw_os_error().unwrap_or(libc::EIO),
+        }
+    }
+}
+
+/// Rust side of `cxx/test.cxx`. The functions are private not to be emitted by cbindgen.
+#[cfg(feature = "__test")]
+mod test_ffi {
+    use super::*;
+
+    /// Sends `count` slices of one byte `i as u8` in order from a Rust thread, then drops `sender`.
+    #[export_name = "_rust_ffi_test_byte_producer"]
+    extern "C" fn byte_producer(sender: CSliceSender<u8>, count: usize) {
+        std::thread::spawn(move || {
+            for i in 0..count {
+                let mut value = CBoxedSlice::from(vec![i as u8].into_boxed_slice());
+                while let Err(rejected) = sender.try_send(value) {
+                    value = rejected;
+                    std::thread::yield_now();
+                }
+            }
+        });
+    }
+
+    static SQUARES_DROPS: std::sync::atomic::AtomicUsize = std::sync::atomic::AtomicUsize::new(0);
+
+    /// An iterator counting its drops in `SQUARES_DROPS`.
+    struct Squares(std::ops::Range<u64>);
+
+    impl Iterator for Squares {
+        type Item = u64;
+
+        fn next(&mut self) -> Option<u64> {
+            self.0.next().map(|i| i * i)
+        }
+    }
+
+    impl Drop for Squares {
+        fn drop(&mut self) {
+            SQUARES_DROPS.fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+        }
+    }
+
+    /// Returns an iterator of `i * i` for `i` in `0..count`.
+    #[export_name = "_rust_ffi_test_iter_squares"]
+    extern "C" fn iter_squares(count: u64) -> CRustIter<u64> {
+        crate::RustIter::new(Squares(0..count))
+    }
+
+    /// Returns the number of iterators of `_rust_ffi_test_iter_squares` dropped so far.
+    #[export_name = "_rust_ffi_test_iter_squares_drops"]
+    extern "C" fn iter_squares_drops() -> usize {
+        SQUARES_DROPS.load(std::sync::atomic::Ordering::Relaxed)
+    }
 }
 
 #[test]
@@ -96,6 +495,72 @@ fn test_empty_slice() {
     drop(empty);
 }
 
+#[test]
+fn test_alloc_boxed_slice() {
+    // memory from `_rust_ffi_alloc` must be owned by a Rust box
+    unsafe {
+        let ptr = ffi::alloc(4, 1);
+        std::ptr::copy_nonoverlapping(b"abcd".as_ptr(), ptr, 4);
+        let ptr = ffi::realloc(ptr, 4, 1, 8);
+        std::ptr::copy_nonoverlapping(b"efgh".as_ptr(), ptr.add(4), 4);
+        let boxed = CBoxedSlice::new(Box::from_raw(std::ptr::slice_from_raw_parts_mut(ptr, 8)));
+        assert_eq!(&*boxed, b"abcdefgh");
+
+        assert!(!ffi::alloc(0, 8).is_null());
+        let ptr = ffi::realloc(ffi::alloc(16, 8), 16, 8, 0);
+        assert_eq!(ptr as usize, 8);
+    }
+}
+
+#[test]
+fn test_drop_many() {
+    let mut strings = vec![
+        CBoxedStr::new("a".into()),
+        CBoxedStr::new("".into()),
+        CBoxedStr::new("c".into()),
+    ];
+    unsafe {
+        ffi::boxed_str_drop_many(CMutSliceRef::new_unbound(&mut strings));
+        strings.set_len(0);
+    }
+
+    let mut slices = vec![CBoxedSlice::new(vec![1u8, 2].into()), CBoxedSlice::empty()];
+    unsafe {
+        ffi::boxed_bytes_drop_many(CMutSliceRef::new_unbound(&mut slices));
+        slices.set_len(0);
+    }
+}
+
+#[test]
+fn test_vec_reserve() {
+    let mut vec = CVec::new(vec![1u32, 2, 3]);
+    unsafe {
+        let bytes = &mut *(&mut vec as *mut CVec<u32> as *mut CVec<u8>);
+        ffi::vec_reserve(bytes, 10, 4, 4);
+    }
+    assert!(vec.capacity() >= 13);
+    vec.with_vec(|v| v.extend_from_slice(&[4, 5]));
+    assert_eq!(vec.into_vec(), vec![1, 2, 3, 4, 5]);
+
+    let mut empty = CVec::<u64>::empty();
+    unsafe {
+        let bytes = &mut *(&mut empty as *mut CVec<u64> as *mut CVec<u8>);
+        ffi::vec_reserve(bytes, 1, 8, 8);
+    }
+    assert_eq!(empty.capacity(), 4);
+    assert!(empty.is_empty());
+
+    assert_eq!(ffi::grown_capacity(3, 3, 1, 2, 2), Some(6));
+    assert_eq!(ffi::grown_capacity(3, 8, 5, 2, 2), None);
+}
+
+#[test]
+#[should_panic(expected = "capacity overflow")]
+fn test_vec_reserve_overflow_isize() {
+    // The size fits in `usize` but not in `isize`, which `Vec::reserve` rejects too.
+    ffi::grown_capacity(1, 1, 1 << 62, 2, 2);
+}
+
 #[test]
 fn test_empty_char_str() {
     // ensure dropping empty char str is no-op
@@ -112,3 +577,57 @@ fn test_empty_char_str() {
     let bytes = empty.as_bytes();
     assert_eq!(bytes, b"");
 }
+
+/// Builds `CXX_MODULE_PATH` and compiles `cxx/module.cxx` importing it.
+/// Skipped unless the C++ compiler is GCC, which builds modules by `-fmodules-ts`.
+/// The importer is not linked, because GCC 12 leaves functions of the module undefined; the module is experimental.
+#[test]
+fn test_cxx_module_import() {
+    let compiler = std::env::var("CXX").unwrap_or_else(|_| "c++".to_owned());
+    let is_gcc = std::process::Command::new(&compiler)
+        .arg("--version")
+        .output()
+        .map(|out| String::from_utf8_lossy(&out.stdout).contains("Free Software Foundation"))
+        .unwrap_or(false);
+    if !is_gcc {
+        return;
+    }
+
+    // Compiled modules are written to `gcm.cache` in the working directory.
+    let dir = std::env::temp_dir().join(format!("ffi_types_test_module_{}", std::process::id()));
+    std::fs::create_dir_all(&dir).unwrap();
+    let compile = |args: &[&str]| {
+        std::process::Command::new(&compiler)
+            .args([
+                "-std=c++20",
+                "-fmodules-ts",
+                "-Wall",
+                "-Wextra",
+                "-Werror",
+                "-c",
+            ])
+            .args(args)
+            .current_dir(&dir)
+            .status()
+            .unwrap()
+            .success()
+    };
+    let interface = compile(&[
+        "-I",
+        CXX_INCLUDE_PATH,
+        "-x",
+        "c++",
+        CXX_MODULE_PATH,
+        "-o",
+        "rust_types.o",
+    ]);
+    let importer = interface
+        && compile(&[
+            concat!(env!("CARGO_MANIFEST_DIR"), "/cxx/module.cxx"),
+            "-o",
+            "module.o",
+        ]);
+    std::fs::remove_dir_all(&dir).unwrap();
+    assert!(interface, "rust_types.cppm doesn't build");
+    assert!(importer, "cxx/module.cxx doesn't import the module");
+}
@@ -4,26 +4,69 @@ const CXX_TYPE_NAMES: &[&str] = &[
     // simple box
     "Box",
     "OptionBox",
+    "Arc",
+    "Arena",
     // slices
     "SliceRef",
     "MutSliceRef",
     "BoxedSlice",
     "ByteSliceRef",
+    "IoSliceRef",
+    "Vec",
+    "ForeignBoxedSlice",
+    "ArenaSlice",
+    "MmapSlice",
+    "SliceSender",
+    "SliceReceiver",
+    "RustIter",
+    "RustFuture",
+    "MmapAdvice",
+    "PoolStats",
+    "OwnershipStats",
+    "OwnershipSnapshot",
+    "OwnershipShard",
+    "Symbol",
+    "SymbolTable",
     // strings
     "StrRef",
     "BoxedStr",
+    "CompactStr",
+    "ArenaStr",
+    "HashedStrRef",
+    "StrZRef",
+    "BoxedCStr",
+    "CowStr",
+    "CowSlice",
 ];
 const CXX_WRAPPER_NAMES: &[&str] = &[
     // simple box
     "CBox",
     "COptionBox",
+    "COption",
+    "CResult",
+    "CArc",
+    "CArena",
     // slices
     "CSliceRef",
+    "CMutSliceRef",
     "CByteSliceRef",
+    "CIoSliceRef",
     "CBoxedSlice",
+    "CVec",
+    "CForeignBoxedSlice",
+    "CMmapSlice",
+    "CSliceSender",
+    "CSliceReceiver",
+    "CRustIter",
+    "CRustFuture",
     // strings
     "CStrRef",
     "CBoxedStr",
+    "CCompactStr",
+    "CStrZRef",
+    "CBoxedCStr",
+    "CCowStr",
+    "CCowSlice",
     "CharStrRef",
 ];
 
@@ -49,3 +92,210 @@ pub fn with_cxx_ffi_types_with_namespace(
 
     builder
 }
+
+/// Boxed types of which drop functions are exported by [`crate::export_drop!`].
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum DropKind {
+    BoxedSlice,
+    OptionBox,
+    Vec,
+    Arc,
+}
+
+/// A drop function exported by [`crate::export_drop!`].
+///
+/// `cxx_type` is the C++ name of `T` qualified from the global namespace, e.g. `my_crate::Item`.
+/// `prefix` is the same literal given to the macro.
+#[derive(Clone, Debug)]
+pub struct DropExport {
+    pub kind: DropKind,
+    pub cxx_type: String,
+    pub prefix: String,
+}
+
+impl DropExport {
+    pub fn new(kind: DropKind, cxx_type: impl Into<String>, prefix: impl Into<String>) -> Self {
+        Self {
+            kind,
+            cxx_type: cxx_type.into(),
+            prefix: prefix.into(),
+        }
+    }
+}
+
+/// Appends declarations of `exports` and the matching C++ `_drop()` specializations to the trailer of `config`.
+///
+/// The trailer is placed after every type, so the specializations come after the definitions of `T`.
+/// A trailer already set in `config` is kept before them.
+/// `cbindgen::Builder` doesn't expose its trailer, so give the config to `Builder::with_config` afterwards.
+#[must_use]
+pub fn with_cxx_drop_exports(
+    mut config: cbindgen::Config,
+    exports: &[DropExport],
+) -> cbindgen::Config {
+    let specializations = cxx_drop_specializations(exports, "ffi_types");
+    match &mut config.trailer {
+        Some(trailer) => trailer.push_str(&specializations),
+        None => config.trailer = Some(specializations),
+    }
+    config
+}
+
+/// Returns C++ declarations of the drop functions of `exports` and `_drop()` specializations calling them.
+/// `namespace` is the namespace of `ffi_types` types.
+pub fn cxx_drop_specializations(exports: &[DropExport], namespace: &str) -> String {
+    let mut out = String::new();
+    out.push_str("\nextern \"C\" {\n");
+    for export in exports {
+        let (c_type, prefix) = (export.c_type(namespace), &export.prefix);
+        out.push_str(&format!("void {prefix}_drop({c_type} value);\n"));
+        if export.kind == DropKind::BoxedSlice {
+            out.push_str(&format!(
+                "void {prefix}_drop_many({namespace}::CMutSliceRef<{c_type}> values);\n"
+            ));
+        }
+    }
+    out.push_str("}  // extern \"C\"\n");
+
+    for export in exports {
+        let (c_type, owned_type, prefix) = (
+            export.c_type(namespace),
+            export.owned_type(namespace),
+            &export.prefix,
+        );
+        out.push_str(&format!(
+            r#"
+template <>
+inline void {owned_type}::_drop() noexcept {{
+    {prefix}_drop({c_type}::from(std::move(*this)));
+}}
+"#
+        ));
+        if export.kind == DropKind::BoxedSlice {
+            out.push_str(&format!(
+                r#"
+template <>
+inline void {owned_type}::_drop_many({namespace}::MutSliceRef<{owned_type}> items) noexcept {{
+    if (items.empty()) {{
+        return;
+    }}
+    auto slices = {namespace}::MutSliceRef<{c_type}>(reinterpret_cast<{c_type}*>(items.data()), items.size());
+    {prefix}_drop_many(slices.into());
+    for (auto& item : items) {{
+        {namespace}::instrument::_dropped(
+                {namespace}::instrument::_Kind::boxed_slice, item._size > 0, sizeof({cxx_type}) * item._size);
+        item._take();
+    }}
+}}
+"#,
+                cxx_type = export.cxx_type,
+            ));
+        }
+    }
+    out
+}
+
+impl DropExport {
+    fn type_name(&self) -> &'static str {
+        match self.kind {
+            DropKind::BoxedSlice => "BoxedSlice",
+            DropKind::OptionBox => "OptionBox",
+            DropKind::Vec => "Vec",
+            DropKind::Arc => "Arc",
+        }
+    }
+
+    fn owned_type(&self, namespace: &str) -> String {
+        format!("{}::{}<{}>", namespace, self.type_name(), self.cxx_type)
+    }
+
+    fn c_type(&self, namespace: &str) -> String {
+        // C++ `OptionBox<T>` is converted to `CBox<T>`.
+        let name = match self.kind {
+            DropKind::OptionBox => "Box",
+            _ => self.type_name(),
+        };
+        format!("{}::C{}<{}>", namespace, name, self.cxx_type)
+    }
+}
+
+#[test]
+fn test_cxx_drop_specializations() {
+    let out = cxx_drop_specializations(
+        &[
+            DropExport::new(DropKind::BoxedSlice, "my::Item", "my_item_slice"),
+            DropExport::new(DropKind::OptionBox, "my::Item", "my_item_box"),
+        ],
+        "ffi_types",
+    );
+    assert!(out.contains("void my_item_slice_drop(ffi_types::CBoxedSlice<my::Item> value);"));
+    assert!(out.contains(
+        "void my_item_slice_drop_many(ffi_types::CMutSliceRef<ffi_types::CBoxedSlice<my::Item>> values);"
+    ));
+    assert!(out.contains("inline void ffi_types::BoxedSlice<my::Item>::_drop() noexcept {"));
+    assert!(out.contains("inline void ffi_types::BoxedSlice<my::Item>::_drop_many("));
+    assert!(out.contains("item._size > 0, sizeof(my::Item) * item._size);"));
+    assert!(!out.contains("item.release();"));
+    assert!(out.contains("my_item_box_drop(ffi_types::CBox<my::Item>::from(std::move(*this)));"));
+    assert!(!out.contains("my_item_box_drop_many"));
+
+    let config = cbindgen::Config {
+        trailer: Some("// trailer of the caller\n".to_owned()),
+        ..Default::default()
+    };
+    let config = with_cxx_drop_exports(
+        config,
+        &[DropExport::new(DropKind::Vec, "my::Item", "my_item_vec")],
+    );
+    let trailer = config.trailer.unwrap();
+    assert!(trailer.starts_with("// trailer of the caller\n"));
+    assert!(trailer.contains("void my_item_vec_drop(ffi_types::CVec<my::Item> value);"));
+}
+
+/// Compiles the specializations of every kind after the header and a definition of `T`.
+/// Skipped if no C++ compiler is found.
+#[test]
+fn test_cxx_drop_specializations_compile() {
+    let exports = [
+        DropExport::new(DropKind::BoxedSlice, "my::Item", "my_item_slice"),
+        DropExport::new(DropKind::OptionBox, "my::Item", "my_item_box"),
+        DropExport::new(DropKind::Vec, "my::Item", "my_item_vec"),
+        DropExport::new(DropKind::Arc, "my::Item", "my_item_arc"),
+    ];
+    let source = format!(
+        "#include \"rust_types.hxx\"\nnamespace my {{\nstruct Item {{\n    int value;\n}};\n}}\n{}",
+        cxx_drop_specializations(&exports, "ffi_types")
+    );
+    let dir = std::env::temp_dir().join(format!("ffi_types_test_drop_{}", std::process::id()));
+    std::fs::create_dir_all(&dir).unwrap();
+    let path = dir.join("drop.cxx");
+    std::fs::write(&path, source).unwrap();
+
+    let compiler = std::env::var("CXX").unwrap_or_else(|_| "c++".to_owned());
+    // The counters of `FFI_TYPES_INSTRUMENT` are referenced by the `_drop_many()` specialization.
+    let statuses: Vec<_> = ["0", "1"]
+        .iter()
+        .map(|instrument| {
+            std::process::Command::new(&compiler)
+                .args([
+                    "-std=c++17",
+                    "-fsyntax-only",
+                    "-Wall",
+                    "-Werror",
+                    "-I",
+                    crate::CXX_INCLUDE_PATH,
+                ])
+                .arg(format!("-DFFI_TYPES_INSTRUMENT={}", instrument))
+                .arg(&path)
+                .status()
+        })
+        .collect();
+    std::fs::remove_dir_all(&dir).unwrap();
+    for status in statuses {
+        match status {
+            Ok(status) => assert!(status.success(), "generated specializations don't compile"),
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => {}
+            Err(e) => panic!("{}", e),
+        }
+    }
+}
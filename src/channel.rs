@@ -0,0 +1,234 @@
+//! Lock-free single-producer single-consumer channel of boxed slices.
+//!
+//! The ring buffer is a shared array of `BoxedSlice<T>` slots.
+//! Both Rust and C++ sides send and receive inline, so the ownership of a slice moves between threads
+//! without a lock or a copy. C++ `SliceSender<T>` and `SliceReceiver<T>` share the layout below.
+
+use crate::slice::SliceInner;
+use crate::BoxedSlice;
+use std::cell::Cell;
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+/// An index owned by one side with a cached copy of the index of the other side.
+/// Each side runs in its own cache line to avoid false sharing.
+#[repr(C, align(64))]
+struct Cursor {
+    index: AtomicUsize,
+    cached: Cell<usize>,
+}
+
+#[repr(C)]
+struct ChannelInner<T: 'static> {
+    /// The next slot to receive, written by the receiver.
+    head: Cursor,
+    /// The next slot to send, written by the sender.
+    tail: Cursor,
+    slots: *mut SliceInner<T>,
+    mask: usize,
+    refs: AtomicUsize,
+}
+static_assertions::assert_eq_size!(ChannelInner<u8>, [u8; 3 * 64]);
+
+impl<T> ChannelInner<T> {
+    #[inline(always)]
+    fn slot(&self, index: usize) -> *mut SliceInner<T> {
+        unsafe { self.slots.add(index & self.mask) }
+    }
+
+    /// Drops the channel if the other side is gone.
+    ///
+    /// # Safety
+    /// `this` must be a live channel and the caller must not use it after the call.
+    unsafe fn release(this: *const Self) {
+        if (*this).refs.fetch_sub(1, Ordering::AcqRel) == 1 {
+            drop(Box::from_raw(this as *mut Self));
+        }
+    }
+}
+
+impl<T> Drop for ChannelInner<T> {
+    fn drop(&mut self) {
+        let tail = *self.tail.index.get_mut();
+        let mut head = *self.head.index.get_mut();
+        while head != tail {
+            drop(BoxedSlice(unsafe { self.slot(head).read() }));
+            head = head.wrapping_add(1);
+        }
+        let slots = std::ptr::slice_from_raw_parts_mut(self.slots, self.mask + 1);
+        drop(unsafe { Box::from_raw(slots) });
+    }
+}
+
+/// The sending half of a channel of `BoxedSlice<T>`. Same as C++ `SliceSender<T>`.
+#[repr(C)]
+pub struct SliceSender<T: 'static> {
+    inner: *const ChannelInner<T>,
+}
+static_assertions::assert_eq_size!(SliceSender<u8>, *const u8);
+
+/// The receiving half of a channel of `BoxedSlice<T>`. Same as C++ `SliceReceiver<T>`.
+#[repr(C)]
+pub struct SliceReceiver<T: 'static> {
+    inner: *const ChannelInner<T>,
+}
+static_assertions::assert_eq_size!(SliceReceiver<u8>, *const u8);
+
+// SAFETY: Each half is used by a single thread at once. The slices are sent between threads.
+unsafe impl<T: Send> Send for SliceSender<T> {}
+unsafe impl<T: Send> Send for SliceReceiver<T> {}
+
+/// Creates a channel holding up to `capacity` slices in flight.
+/// The capacity is rounded up to a power of two.
+pub fn channel<T>(capacity: usize) -> (SliceSender<T>, SliceReceiver<T>) {
+    let capacity = capacity.max(1).next_power_of_two();
+    let slots: Box<[SliceInner<T>]> = (0..capacity).map(|_| SliceInner::empty()).collect();
+    let cursor = || Cursor {
+        index: AtomicUsize::new(0),
+        cached: Cell::new(0),
+    };
+    let inner = Box::into_raw(Box::new(ChannelInner {
+        head: cursor(),
+        tail: cursor(),
+        slots: Box::into_raw(slots) as *mut SliceInner<T>,
+        mask: capacity - 1,
+        refs: AtomicUsize::new(2),
+    }));
+    (SliceSender { inner }, SliceReceiver { inner })
+}
+
+impl<T> SliceSender<T> {
+    #[inline(always)]
+    fn inner(&self) -> &ChannelInner<T> {
+        unsafe { &*self.inner }
+    }
+
+    /// Sends `value` without blocking. Returns `value` back if the channel is full.
+    #[inline]
+    pub fn try_send(&self, value: BoxedSlice<T>) -> Result<(), BoxedSlice<T>> {
+        let inner = self.inner();
+        let tail = inner.tail.index.load(Ordering::Relaxed);
+        if tail.wrapping_sub(inner.tail.cached.get()) > inner.mask {
+            inner
+                .tail
+                .cached
+                .set(inner.head.index.load(Ordering::Acquire));
+            if tail.wrapping_sub(inner.tail.cached.get()) > inner.mask {
+                return Err(value);
+            }
+        }
+        let value = std::mem::ManuallyDrop::new(value);
+        unsafe { inner.slot(tail).write(value.0) };
+        inner
+            .tail
+            .index
+            .store(tail.wrapping_add(1), Ordering::Release);
+        Ok(())
+    }
+
+    /// Returns `true` if the receiver is dropped.
+    #[inline]
+    pub fn is_disconnected(&self) -> bool {
+        self.inner().refs.load(Ordering::Acquire) == 1
+    }
+}
+
+impl<T> SliceReceiver<T> {
+    #[inline(always)]
+    fn inner(&self) -> &ChannelInner<T> {
+        unsafe { &*self.inner }
+    }
+
+    /// Receives a value without blocking. Returns `None` if the channel is empty.
+    #[inline]
+    pub fn try_recv(&self) -> Option<BoxedSlice<T>> {
+        let inner = self.inner();
+        let head = inner.head.index.load(Ordering::Relaxed);
+        if head == inner.head.cached.get() {
+            inner
+                .head
+                .cached
+                .set(inner.tail.index.load(Ordering::Acquire));
+            if head == inner.head.cached.get() {
+                return None;
+            }
+        }
+        let value = BoxedSlice(unsafe { inner.slot(head).read() });
+        inner
+            .head
+            .index
+            .store(head.wrapping_add(1), Ordering::Release);
+        Some(value)
+    }
+
+    /// Returns `true` if the sender is dropped. Values sent before are still received.
+    #[inline]
+    pub fn is_disconnected(&self) -> bool {
+        self.inner().refs.load(Ordering::Acquire) == 1
+    }
+}
+
+impl<T> Drop for SliceSender<T> {
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { ChannelInner::release(self.inner) };
+    }
+}
+
+impl<T> Drop for SliceReceiver<T> {
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { ChannelInner::release(self.inner) };
+    }
+}
+
+#[test]
+fn test_channel() {
+    let (sender, receiver) = channel::<u8>(3);
+    assert!(receiver.try_recv().is_none());
+    for i in 0..4u8 {
+        assert!(sender
+            .try_send(BoxedSlice::from(vec![i; 8].into_boxed_slice()))
+            .is_ok());
+    }
+    let rejected = sender.try_send(BoxedSlice::from(vec![4; 8].into_boxed_slice()));
+    assert_eq!(&*rejected.unwrap_err(), &[4; 8]);
+    assert_eq!(&*receiver.try_recv().unwrap(), &[0; 8]);
+    assert!(sender
+        .try_send(BoxedSlice::from(vec![4; 8].into_boxed_slice()))
+        .is_ok());
+
+    // values in flight are still received after the sender is dropped
+    drop(sender);
+    assert!(receiver.is_disconnected());
+    assert_eq!(&*receiver.try_recv().unwrap(), &[1; 8]);
+
+    let (sender, receiver) = channel::<u64>(16);
+    let consumer = std::thread::spawn(move || {
+        let mut sum = 0;
+        loop {
+            match receiver.try_recv() {
+                Some(value) => sum += value.iter().sum::<u64>(),
+                None if receiver.is_disconnected() => {
+                    // the sender may have sent the last values right before being dropped
+                    while let Some(value) = receiver.try_recv() {
+                        sum += value.iter().sum::<u64>();
+                    }
+                    return sum;
+                }
+                None => std::thread::yield_now(),
+            }
+        }
+    });
+    for i in 0..10_000u64 {
+        let mut value = BoxedSlice::from(vec![i, 1].into_boxed_slice());
+        while let Err(rejected) = sender.try_send(value) {
+            value = rejected;
+            std::thread::yield_now();
+        }
+    }
+    drop(sender);
+    assert_eq!(
+        consumer.join().unwrap(),
+        (0..10_000u64).sum::<u64>() + 10_000
+    );
+}
@@ -0,0 +1,316 @@
+//! Copy-on-write strings and slices which are borrowed unless they have to be owned.
+//!
+//! Returning a `BoxedStr` allocates and copies even when the data is borrowed from long-lived storage.
+//! [`CowStr`] and [`CowSlice<T>`] are laid out as `(ptr, len)` like [`crate::StrRef`] and [`crate::SliceRef<T>`],
+//! where the highest bit of `len` tags an owned value. C++ destructors free only owned values.
+
+use crate::slice::SliceInner;
+use crate::{BoxedSlice, BoxedStr};
+use std::borrow::Cow;
+
+const OWNED_TAG: usize = 1 << (usize::BITS - 1);
+
+/// Rust wrapper for `Cow<'static, str>`. Same as C++ `CowStr`.
+///
+/// An owned string is exactly a `BoxedStr` with the highest bit of `len` set.
+#[repr(C)]
+pub struct CowStr(SliceInner<u8>);
+static_assertions::assert_eq_size!(CowStr, BoxedStr);
+
+/// Rust wrapper for `Cow<'static, [T]>` of `Box<[T]>`. Same as C++ `CowSlice<T>`.
+///
+/// An owned slice is exactly a `BoxedSlice<T>` with the highest bit of `len` set.
+#[repr(C)]
+pub struct CowSlice<T: 'static>(SliceInner<T>);
+static_assertions::assert_eq_size!(CowSlice<u8>, BoxedSlice<u8>);
+
+// SAFETY: An owned value is owned as `Box<str>` or `Box<[T]>` does, and a borrowed value is `&'static`.
+unsafe impl Send for CowStr {}
+unsafe impl Sync for CowStr {}
+unsafe impl<T: Send + Sync> Send for CowSlice<T> {}
+unsafe impl<T: Sync> Sync for CowSlice<T> {}
+
+/// Sets the owned tag of `inner`. Slices longer than `isize::MAX` bytes don't exist, except for zero-sized types.
+#[inline(always)]
+fn tag<T>(mut inner: SliceInner<T>) -> SliceInner<T> {
+    assert_eq!(inner.len & OWNED_TAG, 0, "too long to be tagged");
+    // An empty value owns nothing, same as an empty `BoxedStr`.
+    if inner.len > 0 {
+        inner.len |= OWNED_TAG;
+    }
+    inner
+}
+
+#[inline(always)]
+fn untag<T>(inner: SliceInner<T>) -> SliceInner<T> {
+    SliceInner {
+        ptr: inner.ptr,
+        len: inner.len & !OWNED_TAG,
+    }
+}
+
+impl CowStr {
+    /// Borrows a `&'static str` without copying it.
+    #[inline(always)]
+    pub const fn borrowed(value: &'static str) -> Self {
+        Self(SliceInner::from_str(value))
+    }
+
+    /// Borrows a `&str` without copying it.
+    ///
+    /// # Safety
+    /// The returned object must not outlive the given string.
+    #[inline(always)]
+    pub unsafe fn borrowed_unbound(value: &'_ str) -> Self {
+        Self::borrowed(crate::into_static(value))
+    }
+
+    /// Takes the ownership of `value`.
+    #[inline]
+    pub fn owned(value: BoxedStr) -> Self {
+        let this = std::mem::ManuallyDrop::new(value);
+        Self(tag(this.0))
+    }
+
+    #[inline(always)]
+    pub fn is_owned(&self) -> bool {
+        self.0.len & OWNED_TAG != 0
+    }
+
+    #[inline(always)]
+    pub fn as_str(&self) -> &str {
+        crate::StrRef(untag(self.0)).into_str()
+    }
+
+    /// Returns the owned string, copying a borrowed one.
+    #[inline]
+    pub fn into_owned(self) -> BoxedStr {
+        let this = std::mem::ManuallyDrop::new(self);
+        if this.is_owned() {
+            BoxedStr(untag(this.0))
+        } else {
+            BoxedStr::new(this.as_str().into())
+        }
+    }
+
+    /// Converts to `Cow<'static, str>` without copying. See [`CowStr::borrowed_unbound`] for the lifetime.
+    #[inline]
+    pub fn into_cow(self) -> Cow<'static, str> {
+        if self.is_owned() {
+            Cow::Owned(self.into_owned().into_boxed_str().into())
+        } else {
+            Cow::Borrowed(crate::StrRef(self.0).into_str())
+        }
+    }
+}
+
+impl Drop for CowStr {
+    #[inline]
+    fn drop(&mut self) {
+        if self.is_owned() {
+            drop(BoxedStr(untag(self.0)));
+        }
+    }
+}
+
+impl Clone for CowStr {
+    /// Copies an owned string. A borrowed string stays borrowed.
+    #[inline]
+    fn clone(&self) -> Self {
+        if self.is_owned() {
+            Self::owned(BoxedStr::new(self.as_str().into()))
+        } else {
+            Self(self.0)
+        }
+    }
+}
+
+impl From<Cow<'static, str>> for CowStr {
+    #[inline]
+    fn from(value: Cow<'static, str>) -> Self {
+        match value {
+            Cow::Borrowed(s) => Self::borrowed(s),
+            Cow::Owned(s) => Self::owned(BoxedStr::new(s.into_boxed_str())),
+        }
+    }
+}
+
+impl From<&'static str> for CowStr {
+    #[inline(always)]
+    fn from(value: &'static str) -> Self {
+        Self::borrowed(value)
+    }
+}
+
+impl From<String> for CowStr {
+    #[inline(always)]
+    fn from(value: String) -> Self {
+        Self::owned(BoxedStr::new(value.into_boxed_str()))
+    }
+}
+
+impl std::ops::Deref for CowStr {
+    type Target = str;
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_str()
+    }
+}
+
+impl std::fmt::Debug for CowStr {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        (**self).fmt(f)
+    }
+}
+
+impl PartialEq for CowStr {
+    #[inline]
+    fn eq(&self, other: &Self) -> bool {
+        **self == **other
+    }
+}
+
+impl Eq for CowStr {}
+
+impl std::hash::Hash for CowStr {
+    #[inline]
+    fn hash<H: std::hash::Hasher>(&self, state: &mut H) {
+        (**self).hash(state)
+    }
+}
+
+impl<T> CowSlice<T> {
+    /// Borrows a `&'static [T]` without copying it.
+    #[inline(always)]
+    pub fn borrowed(value: &'static [T]) -> Self {
+        Self(tag_free(SliceInner::from_slice(value)))
+    }
+
+    /// Borrows a `&[T]` without copying it.
+    ///
+    /// # Safety
+    /// The returned object must not outlive the given slice.
+    #[inline(always)]
+    pub unsafe fn borrowed_unbound(value: &'_ [T]) -> Self {
+        Self::borrowed(crate::into_static(value))
+    }
+
+    /// Takes the ownership of `value`.
+    #[inline]
+    pub fn owned(value: BoxedSlice<T>) -> Self {
+        let this = std::mem::ManuallyDrop::new(value);
+        Self(tag(this.0))
+    }
+
+    #[inline(always)]
+    pub fn is_owned(&self) -> bool {
+        self.0.len & OWNED_TAG != 0
+    }
+
+    #[inline(always)]
+    pub fn as_slice(&self) -> &[T] {
+        let inner = untag(self.0);
+        unsafe { std::slice::from_raw_parts(inner.ptr, inner.len) }
+    }
+
+    /// Returns the owned slice, cloning the elements of a borrowed one.
+    #[inline]
+    pub fn into_owned(self) -> BoxedSlice<T>
+    where
+        T: Clone,
+    {
+        let this = std::mem::ManuallyDrop::new(self);
+        if this.is_owned() {
+            BoxedSlice(untag(this.0))
+        } else {
+            BoxedSlice::new(this.as_slice().into())
+        }
+    }
+}
+
+/// Checks a borrowed slice can be told from an owned one.
+#[inline(always)]
+fn tag_free<T>(inner: SliceInner<T>) -> SliceInner<T> {
+    assert_eq!(inner.len & OWNED_TAG, 0, "too long to be tagged");
+    inner
+}
+
+impl<T> Drop for CowSlice<T> {
+    #[inline]
+    fn drop(&mut self) {
+        if self.is_owned() {
+            drop(BoxedSlice(untag(self.0)));
+        }
+    }
+}
+
+impl<T> From<&'static [T]> for CowSlice<T> {
+    #[inline(always)]
+    fn from(value: &'static [T]) -> Self {
+        Self::borrowed(value)
+    }
+}
+
+impl<T> From<std::vec::Vec<T>> for CowSlice<T> {
+    #[inline(always)]
+    fn from(value: std::vec::Vec<T>) -> Self {
+        Self::owned(BoxedSlice::new(value.into_boxed_slice()))
+    }
+}
+
+impl<T> std::ops::Deref for CowSlice<T> {
+    type Target = [T];
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_slice()
+    }
+}
+
+impl<T: std::fmt::Debug> std::fmt::Debug for CowSlice<T> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        (**self).fmt(f)
+    }
+}
+
+#[test]
+fn test_cow_str() {
+    let borrowed = CowStr::borrowed("static");
+    assert!(!borrowed.is_owned());
+    assert_eq!(&*borrowed, "static");
+    assert!(matches!(
+        borrowed.clone().into_cow(),
+        Cow::Borrowed("static")
+    ));
+
+    let owned = CowStr::from(String::from("computed"));
+    assert!(owned.is_owned());
+    assert_eq!(owned.0.len & !OWNED_TAG, 8);
+    assert_eq!(owned.clone(), owned);
+    let ptr = owned.as_ptr();
+    let boxed = owned.into_owned();
+    assert_eq!(boxed.as_ptr(), ptr);
+
+    assert_eq!(&*borrowed.into_owned(), "static");
+    // an empty value owns nothing
+    assert!(!CowStr::from(String::new()).is_owned());
+    assert!(matches!(
+        CowStr::from(Cow::Owned("x".to_owned())).into_cow(),
+        Cow::Owned(s) if s == "x"
+    ));
+}
+
+#[test]
+fn test_cow_slice() {
+    static VALUES: [u32; 3] = [1, 2, 3];
+    let borrowed = CowSlice::borrowed(&VALUES);
+    assert!(!borrowed.is_owned());
+    assert_eq!(&*borrowed, &[1, 2, 3]);
+    assert_eq!(&*borrowed.into_owned(), &[1, 2, 3]);
+
+    let owned = CowSlice::from(vec![crate::BoxedStr::new("a".into())]);
+    assert!(owned.is_owned());
+    assert_eq!(&*owned[0], "a");
+    drop(owned);
+}
@@ -0,0 +1,198 @@
+//! NUL-terminated strings to be passed to C APIs taking `const char*` without copying.
+//!
+//! [`StrZRef`] and [`BoxedCStr`] are laid out as `(ptr, len)` like [`crate::StrRef`] and [`crate::BoxedStr`],
+//! where `len` excludes the terminator. C++ `c_str()` returns the pointer as it is,
+//! so the producer writes the terminator once instead of every consumer copying the string to add it.
+
+use crate::slice::SliceInner;
+use std::ffi::{CStr, CString};
+
+/// Rust wrapper for `&CStr`. Same as C++ `StrZRef`.
+///
+/// `len` excludes the NUL terminator which always follows the bytes. The bytes may not be UTF-8.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct StrZRef(SliceInner<u8>);
+static_assertions::assert_eq_size!(StrZRef, &[u8]);
+
+/// Rust wrapper for `Box<CStr>`. Same as C++ `BoxedCStr`.
+///
+/// `len` excludes the NUL terminator, so the allocation is `len + 1` bytes.
+/// An empty string points to a static terminator to be freed by nobody, same as an empty `BoxedStr`.
+#[repr(C)]
+pub struct BoxedCStr(SliceInner<u8>);
+static_assertions::assert_eq_size!(BoxedCStr, std::boxed::Box<CStr>);
+
+// SAFETY: `BoxedCStr` owns the string as `Box<CStr>` does.
+unsafe impl Send for BoxedCStr {}
+unsafe impl Sync for BoxedCStr {}
+
+static EMPTY: &CStr = c"";
+
+impl StrZRef {
+    /// Create a new wrapper for a `&'static CStr`.
+    /// See [`StrZRef::new_unbound`] to remove lifetime bound.
+    #[inline(always)]
+    pub const fn new(value: &'static CStr) -> Self {
+        Self(SliceInner::from_slice(value.to_bytes()))
+    }
+
+    /// Create a new wrapper for a `&CStr`.
+    /// `unbound` means bounded lifetime will be removed to be static.
+    ///
+    /// # Safety
+    /// The returned object must not outlive the given string.
+    #[inline(always)]
+    pub unsafe fn new_unbound(value: &'_ CStr) -> Self {
+        Self::new(crate::into_static(value))
+    }
+
+    /// Inverse of [`StrZRef::new`].
+    #[inline(always)]
+    pub fn as_c_str(&self) -> &'static CStr {
+        unsafe { c_str(self.0) }
+    }
+}
+
+/// # Safety
+/// `inner` must be followed by a NUL terminator without interior NUL.
+#[inline(always)]
+unsafe fn c_str(inner: SliceInner<u8>) -> &'static CStr {
+    let bytes = std::slice::from_raw_parts(inner.ptr as *const u8, inner.len + 1);
+    CStr::from_bytes_with_nul_unchecked(bytes)
+}
+
+impl std::ops::Deref for StrZRef {
+    type Target = CStr;
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_c_str()
+    }
+}
+
+impl std::fmt::Debug for StrZRef {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        (**self).fmt(f)
+    }
+}
+
+impl PartialEq for StrZRef {
+    #[inline]
+    fn eq(&self, other: &Self) -> bool {
+        **self == **other
+    }
+}
+
+impl Eq for StrZRef {}
+
+impl BoxedCStr {
+    /// Create a new wrapper for a `Box<CStr>`.
+    #[inline]
+    pub fn new(value: std::boxed::Box<CStr>) -> Self {
+        if value.is_empty() {
+            return Self(SliceInner::from_slice(EMPTY.to_bytes()));
+        }
+        let inner = SliceInner::from_slice(value.to_bytes());
+        let raw = std::boxed::Box::into_raw(value);
+        assert_eq!(inner.ptr, raw as *mut u8);
+        Self(inner)
+    }
+
+    /// Inverse of [`BoxedCStr::new`].
+    #[inline]
+    pub fn into_boxed_c_str(self) -> std::boxed::Box<CStr> {
+        let this = std::mem::ManuallyDrop::new(self);
+        if this.0.len == 0 {
+            return std::boxed::Box::default();
+        }
+        unsafe { std::boxed::Box::from_raw(c_str(this.0) as *const CStr as *mut CStr) }
+    }
+}
+
+impl Drop for BoxedCStr {
+    #[inline]
+    fn drop(&mut self) {
+        if self.0.len > 0 {
+            drop(unsafe { std::boxed::Box::from_raw(c_str(self.0) as *const CStr as *mut CStr) });
+        }
+    }
+}
+
+impl From<std::boxed::Box<CStr>> for BoxedCStr {
+    #[inline(always)]
+    fn from(value: std::boxed::Box<CStr>) -> Self {
+        Self::new(value)
+    }
+}
+
+impl From<CString> for BoxedCStr {
+    #[inline(always)]
+    fn from(value: CString) -> Self {
+        Self::new(value.into_boxed_c_str())
+    }
+}
+
+impl From<BoxedCStr> for std::boxed::Box<CStr> {
+    #[inline(always)]
+    fn from(value: BoxedCStr) -> Self {
+        value.into_boxed_c_str()
+    }
+}
+
+impl std::ops::Deref for BoxedCStr {
+    type Target = CStr;
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        unsafe { c_str(self.0) }
+    }
+}
+
+impl std::borrow::Borrow<CStr> for BoxedCStr {
+    #[inline(always)]
+    fn borrow(&self) -> &CStr {
+        self
+    }
+}
+
+impl std::fmt::Debug for BoxedCStr {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        (**self).fmt(f)
+    }
+}
+
+impl PartialEq for BoxedCStr {
+    #[inline]
+    fn eq(&self, other: &Self) -> bool {
+        **self == **other
+    }
+}
+
+impl Eq for BoxedCStr {}
+
+impl std::hash::Hash for BoxedCStr {
+    #[inline]
+    fn hash<H: std::hash::Hasher>(&self, state: &mut H) {
+        (**self).hash(state)
+    }
+}
+
+#[test]
+fn test_c_str() {
+    const HELLO: StrZRef = StrZRef::new(c"hello");
+    assert_eq!(HELLO.to_bytes(), b"hello");
+    assert_eq!(HELLO.0.len, 5);
+    assert_eq!(unsafe { *HELLO.as_ptr().add(5) }, 0);
+
+    let boxed = BoxedCStr::from(CString::new("world").unwrap());
+    assert_eq!(boxed.0.len, 5);
+    assert_eq!(&*boxed, c"world");
+    assert_eq!(&*boxed.into_boxed_c_str(), c"world");
+
+    // an empty string is not allocated
+    let empty = BoxedCStr::from(CString::default());
+    assert_eq!(empty.0.ptr as *const u8, EMPTY.as_ptr() as *const u8);
+    assert_eq!(empty.to_bytes_with_nul(), b"\0");
+    assert!(empty.into_boxed_c_str().is_empty());
+}
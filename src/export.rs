@@ -0,0 +1,157 @@
+//! Monomorphized drop functions of boxed types for C++ side.
+//!
+//! C++ owned types, e.g. `BoxedSlice<T>`, call `_drop()` to free the value in Rust side.
+//! [`export_drop!`](crate::export_drop) exports a drop function for each `T`,
+//! and [`cbindgen::DropExport`](crate::cbindgen::DropExport) emits the matching C++ `_drop()` specializations.
+
+/// Exports drop functions of boxed types of `T` to be called by C++ `_drop()`.
+///
+/// Each entry exports `<prefix>_drop`. `BoxedSlice<T>` also exports `<prefix>_drop_many` for `drop_all()`.
+/// Drops of `BoxedSlice<T>` follow the deferred mode of [`crate::reclaim`] as the byte slice drop does,
+/// which moves the values to the reclaimer thread, so `T` must be `Send + 'static`.
+/// Prefix the entry with `immediate` for other `T`, e.g. `#[repr(C)]` structs holding raw pointers,
+/// to drop the values in the calling thread even in the deferred mode.
+///
+/// ```ignore
+/// ffi_types::export_drop! {
+///     BoxedSlice<Item> as "my_crate_item_slice";
+///     immediate BoxedSlice<RawItem> as "my_crate_raw_item_slice";
+///     OptionBox<Item> as "my_crate_item_box";
+///     Vec<Item> as "my_crate_item_vec";
+///     Arc<Item> as "my_crate_item_arc";
+/// }
+/// ```
+#[macro_export]
+macro_rules! export_drop {
+    () => {};
+    (BoxedSlice<$t:ty> as $prefix:literal; $($rest:tt)*) => {
+        const _: () = {
+            #[export_name = concat!($prefix, "_drop")]
+            extern "C" fn drop(value: $crate::BoxedSlice<$t>) {
+                $crate::reclaim::drop_or_defer(value);
+            }
+
+            #[export_name = concat!($prefix, "_drop_many")]
+            unsafe extern "C" fn drop_many(values: $crate::MutSliceRef<$crate::BoxedSlice<$t>>) {
+                $crate::reclaim::drop_or_defer_many(values.into_mut_slice());
+            }
+        };
+        $crate::export_drop!($($rest)*);
+    };
+    (immediate BoxedSlice<$t:ty> as $prefix:literal; $($rest:tt)*) => {
+        const _: () = {
+            #[export_name = concat!($prefix, "_drop")]
+            extern "C" fn drop(_value: $crate::BoxedSlice<$t>) {}
+
+            #[export_name = concat!($prefix, "_drop_many")]
+            unsafe extern "C" fn drop_many(values: $crate::MutSliceRef<$crate::BoxedSlice<$t>>) {
+                ::std::ptr::drop_in_place(values.into_mut_slice());
+            }
+        };
+        $crate::export_drop!($($rest)*);
+    };
+    (OptionBox<$t:ty> as $prefix:literal; $($rest:tt)*) => {
+        const _: () = {
+            #[export_name = concat!($prefix, "_drop")]
+            extern "C" fn drop(value: $crate::OptionBox<$t>) {
+                // `OptionBox<T>` doesn't own the value until it is converted back.
+                ::std::mem::drop(value.into_box());
+            }
+        };
+        $crate::export_drop!($($rest)*);
+    };
+    (Vec<$t:ty> as $prefix:literal; $($rest:tt)*) => {
+        const _: () = {
+            #[export_name = concat!($prefix, "_drop")]
+            extern "C" fn drop(_value: $crate::Vec<$t>) {}
+        };
+        $crate::export_drop!($($rest)*);
+    };
+    (Arc<$t:ty> as $prefix:literal; $($rest:tt)*) => {
+        const _: () = {
+            #[export_name = concat!($prefix, "_drop")]
+            extern "C" fn drop(_value: $crate::Arc<$t>) {}
+        };
+        $crate::export_drop!($($rest)*);
+    };
+}
+
+#[cfg(test)]
+mod tests {
+    use crate::{BoxedSlice, MutSliceRef, OptionBox};
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    static DROPPED: AtomicUsize = AtomicUsize::new(0);
+
+    #[repr(C)]
+    struct Item(#[allow(dead_code)] u32);
+    impl Drop for Item {
+        fn drop(&mut self) {
+            DROPPED.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    /// Not `Send` as FFI structs holding raw pointers.
+    #[repr(C)]
+    struct RawItem(*const u8);
+    impl Drop for RawItem {
+        fn drop(&mut self) {
+            RAW_DROPPED.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    static RAW_DROPPED: AtomicUsize = AtomicUsize::new(0);
+
+    crate::export_drop! {
+        BoxedSlice<Item> as "_ffi_types_test_item_slice";
+        OptionBox<Item> as "_ffi_types_test_item_box";
+        immediate BoxedSlice<RawItem> as "_ffi_types_test_raw_item_slice";
+    }
+
+    extern "C" {
+        fn _ffi_types_test_item_slice_drop(value: BoxedSlice<Item>);
+        fn _ffi_types_test_item_slice_drop_many(values: MutSliceRef<BoxedSlice<Item>>);
+        fn _ffi_types_test_item_box_drop(value: OptionBox<Item>);
+        fn _ffi_types_test_raw_item_slice_drop(value: BoxedSlice<RawItem>);
+        fn _ffi_types_test_raw_item_slice_drop_many(values: MutSliceRef<BoxedSlice<RawItem>>);
+    }
+
+    #[test]
+    fn test_export_drop() {
+        let slice = BoxedSlice::from(vec![Item(1), Item(2)].into_boxed_slice());
+        unsafe { _ffi_types_test_item_slice_drop(slice) };
+        assert_eq!(DROPPED.load(Ordering::Relaxed), 2);
+
+        let mut slices = std::mem::ManuallyDrop::new(vec![
+            BoxedSlice::from(vec![Item(3)].into_boxed_slice()),
+            BoxedSlice::from(vec![Item(4), Item(5)].into_boxed_slice()),
+        ]);
+        unsafe { _ffi_types_test_item_slice_drop_many(MutSliceRef::new_unbound(&mut slices)) };
+        assert_eq!(DROPPED.load(Ordering::Relaxed), 5);
+        // the items are dropped, only the vector is freed
+        unsafe { slices.set_len(0) };
+        drop(std::mem::ManuallyDrop::into_inner(slices));
+
+        unsafe { _ffi_types_test_item_box_drop(OptionBox::new(Box::new(Item(6)))) };
+        assert_eq!(DROPPED.load(Ordering::Relaxed), 6);
+    }
+
+    #[test]
+    fn test_export_drop_immediate() {
+        // Values are dropped in the calling thread even in the deferred mode.
+        let previous = crate::reclaim::set_deferred(true);
+        let byte = 0u8;
+        let slice = BoxedSlice::from(vec![RawItem(&byte), RawItem(&byte)].into_boxed_slice());
+        unsafe { _ffi_types_test_raw_item_slice_drop(slice) };
+        assert_eq!(RAW_DROPPED.load(Ordering::Relaxed), 2);
+
+        let mut slices = std::mem::ManuallyDrop::new(vec![BoxedSlice::from(
+            vec![RawItem(&byte)].into_boxed_slice(),
+        )]);
+        unsafe { _ffi_types_test_raw_item_slice_drop_many(MutSliceRef::new_unbound(&mut slices)) };
+        assert_eq!(RAW_DROPPED.load(Ordering::Relaxed), 3);
+        crate::reclaim::set_deferred(previous);
+        unsafe { slices.set_len(0) };
+        drop(std::mem::ManuallyDrop::into_inner(slices));
+    }
+}
@@ -0,0 +1,200 @@
+//! Futures of Rust side polled by C++ side without blocking a thread.
+//!
+//! [`RustFuture<T>`] keeps a Rust future with a vtable to poll it by a waker of the caller.
+//! The waker is an object of foreign code starting with a pointer to its [`WakerVTable`],
+//! so polling allocates nothing. C++ `RustFuture<T>` is awaitable in C++20 coroutines.
+
+use std::ffi::c_void;
+use std::future::Future;
+use std::mem::MaybeUninit;
+use std::pin::Pin;
+use std::task::{Context, Poll, RawWaker, RawWakerVTable, Waker};
+
+/// Functions of a waker of foreign code. Same as C++ `_WakerVTable`.
+///
+/// `data` points to an object starting with a pointer to the vtable. The object is reference counted by the owner.
+#[repr(C)]
+pub struct WakerVTable {
+    /// Adds a reference to the waker.
+    pub clone: unsafe extern "C" fn(data: *const c_void),
+    /// Wakes the task without consuming a reference. May be called from any thread.
+    pub wake: unsafe extern "C" fn(data: *const c_void),
+    /// Removes a reference to the waker.
+    pub drop: unsafe extern "C" fn(data: *const c_void),
+}
+
+unsafe fn foreign_vtable(data: *const ()) -> &'static WakerVTable {
+    *(data as *const &'static WakerVTable)
+}
+
+const RAW_WAKER_VTABLE: RawWakerVTable = RawWakerVTable::new(
+    |data| unsafe {
+        (foreign_vtable(data).clone)(data as *const c_void);
+        RawWaker::new(data, &RAW_WAKER_VTABLE)
+    },
+    |data| unsafe {
+        let vtable = foreign_vtable(data);
+        (vtable.wake)(data as *const c_void);
+        (vtable.drop)(data as *const c_void);
+    },
+    |data| unsafe { (foreign_vtable(data).wake)(data as *const c_void) },
+    |data| unsafe { (foreign_vtable(data).drop)(data as *const c_void) },
+);
+
+/// Functions of a [`RustFuture<T>`]. Same as C++ `_FutureVTable<T>`.
+#[repr(C)]
+pub struct FutureVTable<T: 'static> {
+    /// Polls the future once with a borrowed `waker`. Returns `true` and moves the output to `out` when ready.
+    /// Otherwise `waker` is woken when the future should be polled again.
+    /// The future must not be polled after it is ready.
+    pub poll: unsafe extern "C" fn(
+        state: *mut c_void,
+        waker: *const c_void,
+        out: *mut MaybeUninit<T>,
+    ) -> bool,
+    /// Drops the future, even if it is not ready yet.
+    pub drop: unsafe extern "C" fn(state: *mut c_void),
+}
+
+/// A type-erased future of `T` polled by foreign wakers. Same as C++ `RustFuture<T>`.
+#[repr(C)]
+pub struct RustFuture<T: 'static> {
+    state: *mut c_void,
+    vtable: &'static FutureVTable<T>,
+}
+static_assertions::assert_eq_size!(RustFuture<u8>, [usize; 2]);
+
+// SAFETY: `RustFuture::new()` takes `Send` futures only.
+unsafe impl<T: Send> Send for RustFuture<T> {}
+
+struct Erased<F>(std::marker::PhantomData<F>);
+
+impl<F: Future> Erased<F>
+where
+    F::Output: 'static,
+{
+    const VTABLE: FutureVTable<F::Output> = FutureVTable {
+        poll: Self::poll,
+        drop: Self::drop,
+    };
+
+    unsafe extern "C" fn poll(
+        state: *mut c_void,
+        waker: *const c_void,
+        out: *mut MaybeUninit<F::Output>,
+    ) -> bool {
+        let future = &mut *(state as *mut Option<F>);
+        let Some(pinned) = future.as_mut() else {
+            debug_assert!(false, "polled after ready");
+            return false;
+        };
+        // The waker is borrowed for the call, so it is not dropped.
+        let waker = std::mem::ManuallyDrop::new(Waker::from_raw(RawWaker::new(
+            waker as *const (),
+            &RAW_WAKER_VTABLE,
+        )));
+        let mut cx = Context::from_waker(&waker);
+        // SAFETY: The future is boxed and never moved until it is dropped.
+        match Pin::new_unchecked(pinned).poll(&mut cx) {
+            Poll::Ready(output) => {
+                (*out).write(output);
+                // Resources of the future are released as soon as it is ready.
+                *future = None;
+                true
+            }
+            Poll::Pending => false,
+        }
+    }
+
+    unsafe extern "C" fn drop(state: *mut c_void) {
+        drop(std::boxed::Box::from_raw(state as *mut Option<F>));
+    }
+}
+
+impl<T> RustFuture<T> {
+    /// Erases the type of `future` to be polled by foreign code.
+    pub fn new<F: Future<Output = T> + Send + 'static>(future: F) -> Self {
+        let state = std::boxed::Box::into_raw(std::boxed::Box::new(Some(future)));
+        Self {
+            state: state as *mut c_void,
+            vtable: &Erased::<F>::VTABLE,
+        }
+    }
+
+    /// Polls the future once with a foreign waker. See [`FutureVTable::poll`].
+    ///
+    /// # Safety
+    /// `waker` must point to a live object starting with `&'static WakerVTable`.
+    /// The future must not be polled after it is ready.
+    #[inline]
+    pub unsafe fn poll_with(&mut self, waker: *const c_void) -> Option<T> {
+        let mut out = MaybeUninit::uninit();
+        (self.vtable.poll)(self.state, waker, &mut out).then(|| out.assume_init())
+    }
+}
+
+impl<T> Drop for RustFuture<T> {
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { (self.vtable.drop)(self.state) };
+    }
+}
+
+#[test]
+fn test_rust_future() {
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    #[repr(C)]
+    struct CountingWaker {
+        vtable: &'static WakerVTable,
+        refs: AtomicUsize,
+        wakes: AtomicUsize,
+    }
+    unsafe extern "C" fn clone(data: *const c_void) {
+        (*(data as *const CountingWaker))
+            .refs
+            .fetch_add(1, Ordering::Relaxed);
+    }
+    unsafe extern "C" fn wake(data: *const c_void) {
+        (*(data as *const CountingWaker))
+            .wakes
+            .fetch_add(1, Ordering::Relaxed);
+    }
+    unsafe extern "C" fn drop(data: *const c_void) {
+        (*(data as *const CountingWaker))
+            .refs
+            .fetch_sub(1, Ordering::Relaxed);
+    }
+    static VTABLE: WakerVTable = WakerVTable { clone, wake, drop };
+    let waker = CountingWaker {
+        vtable: &VTABLE,
+        refs: AtomicUsize::new(1),
+        wakes: AtomicUsize::new(0),
+    };
+    let data = &waker as *const CountingWaker as *const c_void;
+
+    // yields once, keeping a clone of the waker until it is ready
+    let mut kept = None;
+    let mut future = RustFuture::new(std::future::poll_fn(move |cx| {
+        if kept.is_none() {
+            kept = Some(cx.waker().clone());
+            cx.waker().wake_by_ref();
+            return Poll::Pending;
+        }
+        kept.take().unwrap().wake();
+        Poll::Ready(crate::BoxedStr::new("done".into()))
+    }));
+    assert!(unsafe { future.poll_with(data) }.is_none());
+    assert_eq!(waker.refs.load(Ordering::Relaxed), 2);
+    assert_eq!(waker.wakes.load(Ordering::Relaxed), 1);
+    assert_eq!(&*unsafe { future.poll_with(data) }.unwrap(), "done");
+    assert_eq!(waker.refs.load(Ordering::Relaxed), 1);
+    assert_eq!(waker.wakes.load(Ordering::Relaxed), 2);
+    std::mem::drop(future);
+
+    // a future is dropped before it is ready
+    let mut pending = RustFuture::new(std::future::pending::<u32>());
+    assert!(unsafe { pending.poll_with(data) }.is_none());
+    std::mem::drop(pending);
+    assert_eq!(waker.refs.load(Ordering::Relaxed), 1);
+}
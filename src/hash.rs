@@ -0,0 +1,168 @@
+use crate::StrRef;
+
+const K: u64 = 0x9e3779b97f4a7c15;
+
+/// Hashes bytes by the same function as C++ `ffi_types::hash_bytes()`.
+///
+/// The result is stable only in the same process. Words are loaded in native endian.
+#[inline]
+pub fn hash_bytes(bytes: &[u8]) -> u64 {
+    let mut h = (bytes.len() as u64).wrapping_mul(K);
+    let mut chunks = bytes.chunks_exact(8);
+    for chunk in &mut chunks {
+        let word = u64::from_ne_bytes(chunk.try_into().unwrap());
+        h = (h.rotate_left(5) ^ word).wrapping_mul(K);
+    }
+    let tail = chunks.remainder();
+    if !tail.is_empty() {
+        let mut buf = [0; 8];
+        buf[..tail.len()].copy_from_slice(tail);
+        h = (h.rotate_left(5) ^ u64::from_ne_bytes(buf)).wrapping_mul(K);
+    }
+    // finalizer of MurmurHash3
+    h ^= h >> 33;
+    h = h.wrapping_mul(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h = h.wrapping_mul(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+    h
+}
+
+/// A [`StrRef`] carrying its hash by [`hash_bytes`].
+///
+/// Rust `HashedStrRef` and C++ `HashedStrRef` share the layout and the hash function,
+/// so a key hashed once in either side is looked up in both sides without hashing it again.
+/// [`std::hash::Hash`] writes only the cached hash.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct HashedStrRef {
+    str: StrRef,
+    hash: u64,
+}
+
+impl HashedStrRef {
+    #[inline]
+    pub fn new(value: &'static str) -> Self {
+        Self {
+            str: StrRef::new(value),
+            hash: hash_bytes(value.as_bytes()),
+        }
+    }
+
+    /// # Safety
+    /// The returned object must not outlive the given string.
+    #[inline]
+    pub unsafe fn new_unbound(value: &'_ str) -> Self {
+        Self::new(crate::into_static(value))
+    }
+
+    #[inline(always)]
+    pub fn hash(&self) -> u64 {
+        self.hash
+    }
+
+    #[inline(always)]
+    pub const fn as_str(&self) -> &'static str {
+        self.str.into_str()
+    }
+
+    #[inline(always)]
+    pub fn as_str_ref(&self) -> StrRef {
+        self.str
+    }
+}
+
+impl PartialEq for HashedStrRef {
+    #[inline]
+    fn eq(&self, other: &Self) -> bool {
+        self.hash == other.hash && self.as_str() == other.as_str()
+    }
+}
+
+impl Eq for HashedStrRef {}
+
+impl std::hash::Hash for HashedStrRef {
+    #[inline]
+    fn hash<H: std::hash::Hasher>(&self, state: &mut H) {
+        state.write_u64(self.hash);
+    }
+}
+
+/// A [`std::hash::BuildHasher`] passing through the hash of [`HashedStrRef`].
+///
+/// `HashMap<HashedStrRef, V, BuildHashedStrHasher>` hashes no key bytes, same as C++ `StrHash` of `HashedStrRef`.
+#[derive(Clone, Copy, Debug, Default)]
+pub struct BuildHashedStrHasher;
+
+impl std::hash::BuildHasher for BuildHashedStrHasher {
+    type Hasher = HashedStrHasher;
+
+    #[inline(always)]
+    fn build_hasher(&self) -> Self::Hasher {
+        HashedStrHasher(0)
+    }
+}
+
+/// The hasher of [`BuildHashedStrHasher`]. A written `u64` is the hash as it is.
+///
+/// Other values are hashed by [`hash_bytes`], so keys other than `HashedStrRef` are still hashed correctly.
+#[derive(Clone, Copy, Debug, Default)]
+pub struct HashedStrHasher(u64);
+
+impl std::hash::Hasher for HashedStrHasher {
+    #[inline(always)]
+    fn finish(&self) -> u64 {
+        self.0
+    }
+
+    #[inline]
+    fn write(&mut self, bytes: &[u8]) {
+        self.0 = (self.0.rotate_left(5) ^ hash_bytes(bytes)).wrapping_mul(K);
+    }
+
+    #[inline(always)]
+    fn write_u64(&mut self, value: u64) {
+        if self.0 == 0 {
+            self.0 = value;
+        } else {
+            self.write(&value.to_ne_bytes());
+        }
+    }
+}
+
+impl std::ops::Deref for HashedStrRef {
+    type Target = str;
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_str()
+    }
+}
+
+#[test]
+fn test_hash_bytes() {
+    let text = "0123456789abcdefghijklmnopqrstuvwxyz";
+    let hashes: std::collections::HashSet<_> = (0..=text.len())
+        .map(|n| hash_bytes(&text.as_bytes()[..n]))
+        .collect();
+    assert_eq!(hashes.len(), text.len() + 1);
+    // the length is hashed
+    assert_ne!(hash_bytes(b""), hash_bytes(b"\0"));
+
+    let key = HashedStrRef::new("key");
+    assert_eq!(key.hash(), hash_bytes(b"key"));
+    assert!(key == HashedStrRef::new("key"));
+    assert!(key != HashedStrRef::new("kex"));
+
+    use std::hash::BuildHasher;
+    assert_eq!(BuildHashedStrHasher.hash_one(key), key.hash());
+    let mut map = std::collections::HashMap::with_hasher(BuildHashedStrHasher);
+    map.insert(key, 1);
+    assert_eq!(map.get(&HashedStrRef::new("key")), Some(&1));
+    assert_eq!(map.get(&HashedStrRef::new("kex")), None);
+    // other keys are hashed by their bytes
+    assert_ne!(
+        BuildHashedStrHasher.hash_one("key"),
+        BuildHashedStrHasher.hash_one("kex")
+    );
+}
@@ -0,0 +1,192 @@
+//! Counters of ownership transfers of C++ owned types to find leaks.
+//!
+//! A C-prefixed value in C++ leaks unless it is converted back to an owned type or consumed by Rust side.
+//! C++ code built with `FFI_TYPES_INSTRUMENT=1` counts values of `BoxedStr`, `BoxedSlice<T>` and `OptionBox<T>`
+//! entering and leaving C++ ownership, and [`snapshot`] sums the counters of every thread.
+//! A `live` counter growing over time means values are leaked in C-prefixed form or by `release()`.
+//!
+//! Each thread writes its own [`OwnershipShard`] by relaxed loads and stores, so counting adds no contention.
+//! Shards are kept after their threads exit because values are often dropped by other threads,
+//! and a new thread reuses the shard of an exited one, so the shards are bounded by the peak number of threads.
+
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+
+/// Counters of a C++ owned type. Same as C++ `OwnershipStats`.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct OwnershipStats {
+    /// Values taken by C++ owned types, e.g. by `operator()()` of C-prefixed types or C++ allocations.
+    pub acquired: u64,
+    /// Values converted to C-prefixed types by `into()`, e.g. to be passed to Rust side.
+    pub into: u64,
+    /// Values given up by `release()`.
+    pub released: u64,
+    /// Values dropped by `_drop()`.
+    pub dropped: u64,
+    /// Values owned by C++ side now.
+    pub live: i64,
+    /// Bytes of values owned by C++ side now. Values of `OptionBox<T>` have no bytes because `T` may be opaque.
+    pub live_bytes: i64,
+}
+
+/// Counters of every C++ owned type summed over all threads. Same as C++ `OwnershipSnapshot`.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct OwnershipSnapshot {
+    pub boxed_str: OwnershipStats,
+    pub boxed_slice: OwnershipStats,
+    pub option_box: OwnershipStats,
+}
+
+const KIND_COUNT: usize = 3;
+const COUNTER_COUNT: usize = 5;
+const ACQUIRED: usize = 0;
+const INTO: usize = 1;
+const RELEASED: usize = 2;
+const DROPPED: usize = 3;
+const LIVE_BYTES: usize = 4;
+
+/// Counters of a thread indexed by type and event. Same as C++ `OwnershipShard`, which writes them inline.
+///
+/// Only the owner thread writes a shard. `live_bytes` counters wrap to negative values
+/// when a thread drops more than it acquires.
+#[repr(C, align(64))]
+pub struct OwnershipShard {
+    counters: [[AtomicU64; COUNTER_COUNT]; KIND_COUNT],
+}
+
+impl OwnershipShard {
+    #[cfg(test)]
+    fn add(&self, kind: usize, counter: usize, n: u64) {
+        let value = &self.counters[kind][counter];
+        value.store(
+            value.load(Ordering::Relaxed).wrapping_add(n),
+            Ordering::Relaxed,
+        );
+    }
+
+    fn stats(&self, kind: usize) -> [u64; COUNTER_COUNT] {
+        std::array::from_fn(|counter| self.counters[kind][counter].load(Ordering::Relaxed))
+    }
+}
+
+static SHARDS: Mutex<std::vec::Vec<&'static OwnershipShard>> = Mutex::new(std::vec::Vec::new());
+/// Shards of exited threads. A reused shard keeps its counters, so the sums are not changed.
+static FREE_SHARDS: Mutex<std::vec::Vec<&'static OwnershipShard>> =
+    Mutex::new(std::vec::Vec::new());
+
+fn new_shard() -> &'static OwnershipShard {
+    let shard: &'static OwnershipShard =
+        std::boxed::Box::leak(std::boxed::Box::new(OwnershipShard {
+            counters: Default::default(),
+        }));
+    SHARDS.lock().unwrap_or_else(|e| e.into_inner()).push(shard);
+    shard
+}
+
+/// Gives the shard back to [`FREE_SHARDS`] when the thread exits.
+struct ThreadShard(&'static OwnershipShard);
+
+impl Drop for ThreadShard {
+    fn drop(&mut self) {
+        FREE_SHARDS
+            .lock()
+            .unwrap_or_else(|e| e.into_inner())
+            .push(self.0);
+    }
+}
+
+thread_local! {
+    static SHARD: ThreadShard = {
+        let free = FREE_SHARDS.lock().unwrap_or_else(|e| e.into_inner()).pop();
+        ThreadShard(free.unwrap_or_else(new_shard))
+    };
+}
+
+/// Returns the shard of the current thread.
+///
+/// C++ side caches the shard in a thread local, so values dropped by thread local destructors
+/// after the shard is given back may be counted in the shard of another thread racily.
+pub fn thread_shard() -> &'static OwnershipShard {
+    // A thread counting in its own exit gets a shard of its own.
+    SHARD
+        .try_with(|shard| shard.0)
+        .unwrap_or_else(|_| new_shard())
+}
+
+/// Sums the counters of every thread.
+///
+/// Counters of other threads are read without synchronization, so a snapshot may miss their latest events.
+pub fn snapshot() -> OwnershipSnapshot {
+    let shards = SHARDS.lock().unwrap_or_else(|e| e.into_inner());
+    let stats = |kind| {
+        let sum = shards.iter().fold([0u64; COUNTER_COUNT], |mut sum, shard| {
+            for (total, value) in sum.iter_mut().zip(shard.stats(kind)) {
+                *total = total.wrapping_add(value);
+            }
+            sum
+        });
+        OwnershipStats {
+            acquired: sum[ACQUIRED],
+            into: sum[INTO],
+            released: sum[RELEASED],
+            dropped: sum[DROPPED],
+            live: sum[ACQUIRED]
+                .wrapping_sub(sum[INTO])
+                .wrapping_sub(sum[RELEASED])
+                .wrapping_sub(sum[DROPPED]) as i64,
+            live_bytes: sum[LIVE_BYTES] as i64,
+        }
+    };
+    OwnershipSnapshot {
+        boxed_str: stats(0),
+        boxed_slice: stats(1),
+        option_box: stats(2),
+    }
+}
+
+#[test]
+fn test_snapshot() {
+    let before = snapshot();
+    // a string acquired by a thread and dropped by another
+    std::thread::spawn(|| {
+        thread_shard().add(0, ACQUIRED, 1);
+        thread_shard().add(0, LIVE_BYTES, 16);
+    })
+    .join()
+    .unwrap();
+    thread_shard().add(0, DROPPED, 1);
+    thread_shard().add(0, LIVE_BYTES, 16u64.wrapping_neg());
+    thread_shard().add(1, ACQUIRED, 2);
+    thread_shard().add(1, LIVE_BYTES, 100);
+    thread_shard().add(1, INTO, 1);
+    thread_shard().add(1, LIVE_BYTES, 40u64.wrapping_neg());
+
+    let after = snapshot();
+    assert_eq!(after.boxed_str.acquired - before.boxed_str.acquired, 1);
+    assert_eq!(after.boxed_str.dropped - before.boxed_str.dropped, 1);
+    assert_eq!(after.boxed_str.live, before.boxed_str.live);
+    assert_eq!(after.boxed_str.live_bytes, before.boxed_str.live_bytes);
+    assert_eq!(after.boxed_slice.live - before.boxed_slice.live, 1);
+    assert_eq!(
+        after.boxed_slice.live_bytes - before.boxed_slice.live_bytes,
+        60
+    );
+    assert_eq!(after.option_box, before.option_box);
+}
+
+#[test]
+fn test_shard_reuse() {
+    let count = || SHARDS.lock().unwrap().len();
+    let before = count();
+    for _ in 0..16 {
+        std::thread::spawn(|| {
+            thread_shard();
+        })
+        .join()
+        .unwrap();
+    }
+    // other tests may run threads at the same time
+    assert!(count() - before < 4);
+}
@@ -0,0 +1,171 @@
+//! A global string interner handing out [`Symbol`]s, compact IDs passed in place of strings.
+//!
+//! Interned strings live until the process exits. [`SymbolTable`] keeps them in segments which are never moved,
+//! so [`Symbol::as_str`] and C++ `Symbol::str()` resolve a symbol by an index without a lock or an FFI call.
+//! Interning looks up shards of a hash map by `hash_bytes`, and only a new string takes the write lock of its shard.
+
+use crate::{hash_bytes, StrRef};
+use std::collections::HashMap;
+use std::mem::MaybeUninit;
+use std::sync::atomic::{AtomicPtr, AtomicU32, Ordering};
+use std::sync::{Mutex, OnceLock, RwLock};
+
+/// The number of strings in the first segment. Segment `k` holds `FIRST_SEGMENT << k` strings.
+const FIRST_SEGMENT: usize = 1 << 10;
+const SEGMENT_COUNT: usize = 22;
+/// The maximum number of symbols.
+const MAX_SYMBOLS: usize = FIRST_SEGMENT * ((1 << SEGMENT_COUNT) - 1);
+const SHARD_COUNT: usize = 16;
+
+/// An interned string. Same as C++ `Symbol`.
+///
+/// Equal strings have the same symbol in the process, so comparing and hashing symbols touch no string.
+#[repr(transparent)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash, PartialOrd, Ord)]
+pub struct Symbol(u32);
+
+/// Segments of interned strings indexed by symbols. Same as C++ `SymbolTable`, which resolves symbols inline.
+#[repr(C)]
+pub struct SymbolTable {
+    segments: [AtomicPtr<StrRef>; SEGMENT_COUNT],
+}
+
+#[allow(clippy::declare_interior_mutable_const)]
+const NULL_SEGMENT: AtomicPtr<StrRef> = AtomicPtr::new(std::ptr::null_mut());
+static TABLE: SymbolTable = SymbolTable {
+    segments: [NULL_SEGMENT; SEGMENT_COUNT],
+};
+static NEXT: AtomicU32 = AtomicU32::new(0);
+/// Taken to allocate a segment.
+static GROW: Mutex<()> = Mutex::new(());
+
+type Shard = RwLock<HashMap<&'static str, Symbol>>;
+
+fn shards() -> &'static [Shard; SHARD_COUNT] {
+    static SHARDS: OnceLock<[Shard; SHARD_COUNT]> = OnceLock::new();
+    SHARDS.get_or_init(|| std::array::from_fn(|_| RwLock::new(HashMap::new())))
+}
+
+/// Returns the segment and the offset of `id`.
+#[inline(always)]
+fn locate(id: u32) -> (usize, usize) {
+    let block = id as usize / FIRST_SEGMENT + 1;
+    let segment = (usize::BITS - 1 - block.leading_zeros()) as usize;
+    (segment, id as usize - FIRST_SEGMENT * ((1 << segment) - 1))
+}
+
+fn segment(index: usize) -> *mut StrRef {
+    let segment = TABLE.segments[index].load(Ordering::Acquire);
+    if !segment.is_null() {
+        return segment;
+    }
+    let _guard = GROW.lock().unwrap_or_else(|e| e.into_inner());
+    let segment = TABLE.segments[index].load(Ordering::Acquire);
+    if !segment.is_null() {
+        return segment;
+    }
+    let slots = std::boxed::Box::<[MaybeUninit<StrRef>]>::new_uninit_slice(FIRST_SEGMENT << index);
+    let segment = std::boxed::Box::leak(slots).as_mut_ptr() as *mut StrRef;
+    TABLE.segments[index].store(segment, Ordering::Release);
+    segment
+}
+
+/// Returns the symbol of `s`, interning it if it is new.
+pub fn intern(s: &str) -> Symbol {
+    let shard = &shards()[hash_bytes(s.as_bytes()) as usize % SHARD_COUNT];
+    if let Some(&symbol) = shard.read().unwrap_or_else(|e| e.into_inner()).get(s) {
+        return symbol;
+    }
+    let mut map = shard.write().unwrap_or_else(|e| e.into_inner());
+    if let Some(&symbol) = map.get(s) {
+        return symbol;
+    }
+    let id = NEXT.fetch_add(1, Ordering::Relaxed);
+    assert!((id as usize) < MAX_SYMBOLS, "too many symbols");
+    let name: &'static str = std::boxed::Box::leak(s.into());
+    let (index, offset) = locate(id);
+    // SAFETY: Each id is written once before the symbol is returned.
+    unsafe { segment(index).add(offset).write(StrRef::new(name)) };
+    let symbol = Symbol(id);
+    map.insert(name, symbol);
+    symbol
+}
+
+/// Interns every string of `strs` into `out` of the same length.
+pub fn intern_all(strs: &[StrRef], out: &mut [Symbol]) {
+    assert_eq!(strs.len(), out.len(), "lengths must be the same");
+    for (s, symbol) in strs.iter().zip(out) {
+        *symbol = intern(s.as_str());
+    }
+}
+
+/// Returns the number of symbols.
+pub fn len() -> usize {
+    (NEXT.load(Ordering::Relaxed) as usize).min(MAX_SYMBOLS)
+}
+
+/// Returns the table to resolve symbols.
+pub fn table() -> &'static SymbolTable {
+    &TABLE
+}
+
+impl Symbol {
+    #[inline(always)]
+    pub fn id(self) -> u32 {
+        self.0
+    }
+
+    /// Returns the interned string.
+    #[inline]
+    pub fn as_str(self) -> &'static str {
+        let (index, offset) = locate(self.0);
+        // SAFETY: A symbol is created only after its string is written.
+        unsafe { (*TABLE.segments[index].load(Ordering::Acquire).add(offset)).as_str() }
+    }
+}
+
+#[test]
+fn test_locate() {
+    assert_eq!(locate(0), (0, 0));
+    assert_eq!(locate(FIRST_SEGMENT as u32 - 1), (0, FIRST_SEGMENT - 1));
+    assert_eq!(locate(FIRST_SEGMENT as u32), (1, 0));
+    assert_eq!(locate(3 * FIRST_SEGMENT as u32), (2, 0));
+    assert_eq!(
+        locate(MAX_SYMBOLS as u32 - 1),
+        (
+            SEGMENT_COUNT - 1,
+            (FIRST_SEGMENT << (SEGMENT_COUNT - 1)) - 1
+        )
+    );
+}
+
+#[test]
+fn test_intern() {
+    let id = intern("id");
+    assert_eq!(intern("id"), id);
+    assert_ne!(intern("name"), id);
+    assert_eq!(id.as_str(), "id");
+    assert_eq!(intern("").as_str(), "");
+
+    // symbols are stable while other threads intern strings over segments
+    let threads: std::vec::Vec<_> = (0..4)
+        .map(|t| {
+            std::thread::spawn(move || {
+                (0..2000)
+                    .map(|i| intern(&format!("column_{}", (i * 7 + t) % 3000)))
+                    .collect::<std::vec::Vec<_>>()
+            })
+        })
+        .collect();
+    for symbols in threads.into_iter().map(|t| t.join().unwrap()) {
+        for symbol in symbols {
+            assert_eq!(intern(symbol.as_str()), symbol);
+        }
+    }
+    assert!(len() >= 3002);
+
+    let strs = [StrRef::new("id"), StrRef::new("column_1")];
+    let mut out = [Symbol(0); 2];
+    intern_all(&strs, &mut out);
+    assert_eq!(out, [id, intern("column_1")]);
+}
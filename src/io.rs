@@ -0,0 +1,73 @@
+//! Vectored I/O over FFI slices.
+//!
+//! A list of FFI byte slices is passed to `writev(2)` or `io_uring` as is,
+//! because every byte slice type of this crate is laid out as `struct iovec` on unix.
+
+use crate::{BoxedSlice, BoxedStr, ByteSliceRef, SliceRef, StrRef};
+
+/// A list of byte slices for vectored I/O.
+///
+/// On unix, the elements have the same layout as `struct iovec` and [`std::io::IoSlice`].
+pub type IoSliceRef = SliceRef<ByteSliceRef>;
+
+#[cfg(unix)]
+static_assertions::assert_eq_size!(std::io::IoSlice<'static>, ByteSliceRef);
+#[cfg(unix)]
+static_assertions::assert_eq_align!(std::io::IoSlice<'static>, ByteSliceRef);
+
+/// Byte buffers laid out as `{ptr, len}`, which is the layout of `struct iovec` on unix.
+///
+/// # Safety
+/// The type must be a `#[repr(C)]` or `#[repr(transparent)]` wrapper of a pointer to initialized bytes
+/// followed by the length.
+pub unsafe trait IoBuf {}
+
+unsafe impl IoBuf for ByteSliceRef {}
+unsafe impl IoBuf for BoxedSlice<u8> {}
+unsafe impl IoBuf for StrRef {}
+unsafe impl IoBuf for BoxedStr {}
+#[cfg(all(unix, feature = "libc"))]
+unsafe impl IoBuf for crate::MmapSlice {}
+
+/// Views `bufs` as [`std::io::IoSlice`]s without copying, e.g. for [`std::io::Write::write_vectored`].
+#[cfg(unix)]
+#[inline(always)]
+pub fn as_io_slices<B: IoBuf>(bufs: &[B]) -> &[std::io::IoSlice<'_>] {
+    // SAFETY: `IoSlice` is ABI compatible with `struct iovec` on unix.
+    unsafe { std::slice::from_raw_parts(bufs.as_ptr() as *const std::io::IoSlice<'_>, bufs.len()) }
+}
+
+impl SliceRef<ByteSliceRef> {
+    /// Views the list as [`std::io::IoSlice`]s without copying.
+    #[cfg(unix)]
+    #[inline(always)]
+    pub fn as_io_slices(&self) -> &[std::io::IoSlice<'static>] {
+        as_io_slices(self.into_slice())
+    }
+}
+
+#[cfg(unix)]
+#[test]
+fn test_io_slices() {
+    use std::io::Write;
+
+    let chunks: std::vec::Vec<BoxedSlice<u8>> = ["GET ", "/index.html", " HTTP/1.1\r\n"]
+        .iter()
+        .map(|s| BoxedSlice::from(s.as_bytes().to_vec().into_boxed_slice()))
+        .collect();
+    let io_slices = as_io_slices(&chunks);
+    for (io_slice, chunk) in io_slices.iter().zip(&chunks) {
+        assert_eq!(io_slice.as_ptr(), chunk.as_ptr());
+        assert_eq!(io_slice.len(), chunk.len());
+    }
+
+    let mut out = std::vec::Vec::new();
+    let written = out.write_vectored(io_slices).unwrap();
+    assert_eq!(&out[..written], b"GET /index.html HTTP/1.1\r\n");
+
+    let refs = [ByteSliceRef::new(b"a"), ByteSliceRef::new(b"bc")];
+    let list = unsafe { IoSliceRef::new_unbound(&refs) };
+    let mut out = std::vec::Vec::new();
+    let written = out.write_vectored(list.as_io_slices()).unwrap();
+    assert_eq!(&out[..written], b"abc");
+}
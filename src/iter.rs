@@ -0,0 +1,131 @@
+//! Iterators streaming items of Rust side to C++ side in batches.
+//!
+//! Materializing a large result into a `BoxedSlice<T>` takes the memory of the whole result at once.
+//! [`RustIter<T>`] keeps the Rust iterator instead, and the owner pulls items into a buffer of its own
+//! by `next_batch`, so the memory is bounded by the buffer and a call crosses FFI once per batch.
+//! C++ `RustIter<T>` calls the vtable inline with a `MutSliceRef<T>` buffer.
+
+use crate::MutSliceRef;
+use std::ffi::c_void;
+use std::mem::MaybeUninit;
+
+/// Functions of a [`RustIter<T>`]. Same as C++ `_IterVTable<T>`.
+#[repr(C)]
+pub struct IterVTable<T: 'static> {
+    /// Moves up to `buffer.len()` items to the front of `buffer` and returns the count.
+    /// Zero means the end of the iterator. The moved items are owned by the caller.
+    pub next_batch:
+        unsafe extern "C" fn(state: *mut c_void, buffer: MutSliceRef<MaybeUninit<T>>) -> usize,
+    /// Drops the iterator with the items not moved yet.
+    pub drop: unsafe extern "C" fn(state: *mut c_void),
+}
+
+/// A type-erased iterator of `T` pulled in batches. Same as C++ `RustIter<T>`.
+#[repr(C)]
+pub struct RustIter<T: 'static> {
+    state: *mut c_void,
+    vtable: &'static IterVTable<T>,
+}
+static_assertions::assert_eq_size!(RustIter<u8>, [usize; 2]);
+
+// SAFETY: `RustIter::new()` takes `Send` iterators only.
+unsafe impl<T: Send> Send for RustIter<T> {}
+
+struct Erased<I>(std::marker::PhantomData<I>);
+
+impl<I: Iterator> Erased<I>
+where
+    I::Item: 'static,
+{
+    const VTABLE: IterVTable<I::Item> = IterVTable {
+        next_batch: Self::next_batch,
+        drop: Self::drop,
+    };
+
+    unsafe extern "C" fn next_batch(
+        state: *mut c_void,
+        buffer: MutSliceRef<MaybeUninit<I::Item>>,
+    ) -> usize {
+        let iter = &mut *(state as *mut I);
+        let buffer = buffer.into_mut_slice();
+        let mut count = 0;
+        // `zip` polls the buffer first not to take an item without a slot.
+        for (slot, item) in buffer.iter_mut().zip(iter) {
+            slot.write(item);
+            count += 1;
+        }
+        count
+    }
+
+    unsafe extern "C" fn drop(state: *mut c_void) {
+        drop(std::boxed::Box::from_raw(state as *mut I));
+    }
+}
+
+impl<T> RustIter<T> {
+    /// Erases the type of `iter`. The iterator is fused, so it keeps returning no item after the end.
+    pub fn new<I: Iterator<Item = T> + Send + 'static>(iter: I) -> Self {
+        let state = std::boxed::Box::into_raw(std::boxed::Box::new(iter.fuse()));
+        Self {
+            state: state as *mut c_void,
+            vtable: &Erased::<std::iter::Fuse<I>>::VTABLE,
+        }
+    }
+
+    /// Moves up to `buffer.len()` items to the front of `buffer` and returns the count.
+    /// Zero means the end of the iterator. The moved items are owned by the caller.
+    #[inline]
+    pub fn next_batch(&mut self, buffer: &mut [MaybeUninit<T>]) -> usize {
+        unsafe { (self.vtable.next_batch)(self.state, MutSliceRef::new_unbound(buffer)) }
+    }
+}
+
+impl<T> Iterator for RustIter<T> {
+    type Item = T;
+
+    #[inline]
+    fn next(&mut self) -> Option<T> {
+        let mut item = MaybeUninit::uninit();
+        (self.next_batch(std::slice::from_mut(&mut item)) == 1)
+            .then(|| unsafe { item.assume_init() })
+    }
+}
+
+impl<T> Drop for RustIter<T> {
+    #[inline]
+    fn drop(&mut self) {
+        unsafe { (self.vtable.drop)(self.state) };
+    }
+}
+
+#[test]
+fn test_rust_iter() {
+    let mut iter = RustIter::new((0..1000u32).map(|i| i * 2));
+    let mut buffer = [MaybeUninit::<u32>::uninit(); 256];
+    let mut sum = 0;
+    let mut batches = 0;
+    loop {
+        let count = iter.next_batch(&mut buffer);
+        if count == 0 {
+            break;
+        }
+        sum += buffer[..count]
+            .iter()
+            .map(|i| unsafe { i.assume_init() })
+            .sum::<u32>();
+        batches += 1;
+    }
+    assert_eq!(sum, 999 * 1000);
+    assert_eq!(batches, 4);
+    // fused
+    assert_eq!(iter.next_batch(&mut buffer), 0);
+    assert!(iter.next().is_none());
+
+    // items not pulled yet are dropped with the iterator
+    let mut strs = RustIter::new((0..10).map(|i| crate::BoxedStr::new(i.to_string().into())));
+    assert_eq!(&*strs.next().unwrap(), "0");
+    assert_eq!(strs.nth(2).as_deref(), Some("3"));
+    drop(strs);
+
+    assert!(RustIter::new(std::iter::empty::<u8>()).next().is_none());
+}
@@ -1,19 +1,54 @@
+mod arc;
+mod arena;
 mod boxed;
 #[cfg(feature = "cxx")]
 mod c;
 #[cfg(feature = "cxx")]
 pub mod cbindgen;
+pub mod channel;
+mod cow;
+mod cstr;
+mod export;
+mod future;
+mod hash;
+#[cfg(feature = "instrument")]
+pub mod instrument;
+pub mod interner;
+pub mod io;
+mod iter;
+#[cfg(all(unix, feature = "libc"))]
+mod mmap;
+mod option;
+pub mod pool;
+pub mod reclaim;
 mod slice;
 mod str;
 
+pub use arc::Arc;
+pub use arena::{Arena, ArenaSlice, ArenaStr};
 pub use boxed::{Box, OptionBox};
+#[cfg(all(unix, feature = "cxx"))]
+pub use c::CMmapSlice;
 #[cfg(feature = "cxx")]
 pub use c::{
-    CBox, CBoxedSlice, CBoxedStr, CByteSliceRef, COptionBox, CSliceRef, CStrRef, CharStrRef,
-    CXX_HEADER_CONTENT, CXX_HEADER_PATH, CXX_INCLUDE_PATH,
+    CArc, CArena, CBox, CBoxedCStr, CBoxedSlice, CBoxedStr, CByteSliceRef, CCompactStr, CCowSlice,
+    CCowStr, CForeignBoxedSlice, CIoSliceRef, CMutSliceRef, COptionBox, CRustFuture, CRustIter,
+    CSliceReceiver, CSliceRef, CSliceSender, CStrRef, CStrZRef, CVec, CharStrRef,
+    CXX_FWD_HEADER_PATH, CXX_HEADER_CONTENT, CXX_HEADER_PATH, CXX_INCLUDE_PATH, CXX_MODULE_PATH,
 };
-pub use slice::{BoxedSlice, ByteSliceRef, MutSliceRef, SliceRef};
-pub use str::{BoxedStr, StrRef};
+pub use channel::{SliceReceiver, SliceSender};
+pub use cow::{CowSlice, CowStr};
+pub use cstr::{BoxedCStr, StrZRef};
+pub use future::{FutureVTable, RustFuture, WakerVTable};
+pub use hash::{hash_bytes, BuildHashedStrHasher, HashedStrHasher, HashedStrRef};
+pub use interner::Symbol;
+pub use io::IoSliceRef;
+pub use iter::{IterVTable, RustIter};
+#[cfg(all(unix, feature = "libc"))]
+pub use mmap::{MmapAdvice, MmapSlice};
+pub use option::{COption, CResult, NullNiche};
+pub use slice::{BoxedSlice, ByteSliceRef, ForeignBoxedSlice, MutSliceRef, SliceRef, Vec};
+pub use str::{BoxedStr, CompactStr, StrRef};
 
 pub type Array<T, const N: usize> = [T; N];
 
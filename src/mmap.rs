@@ -0,0 +1,160 @@
+use crate::slice::SliceInner;
+
+/// Access pattern hints for [`MmapSlice::advise`]. Same as `madvise(2)`.
+#[repr(i32)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum MmapAdvice {
+    Normal = 0,
+    Random = 1,
+    Sequential = 2,
+    WillNeed = 3,
+    DontNeed = 4,
+}
+
+impl MmapAdvice {
+    #[inline]
+    fn as_raw(self) -> libc::c_int {
+        match self {
+            Self::Normal => libc::MADV_NORMAL,
+            Self::Random => libc::MADV_RANDOM,
+            Self::Sequential => libc::MADV_SEQUENTIAL,
+            Self::WillNeed => libc::MADV_WILLNEED,
+            Self::DontNeed => libc::MADV_DONTNEED,
+        }
+    }
+}
+
+/// A read-only memory-mapped file as an owned byte slice.
+///
+/// Rust and C++ share a single mapping by passing it through FFI. Dropping it unmaps the file.
+/// An empty file is not mapped and results in an empty slice.
+///
+/// The file is mapped by `MAP_SHARED`, so writes to the file by any process are visible through the slice,
+/// and truncating the file makes reading the truncated pages raise `SIGBUS`. See [`MmapSlice::open`].
+#[repr(C)]
+pub struct MmapSlice(pub(crate) SliceInner<u8>);
+static_assertions::assert_eq_size!(MmapSlice, &[u8]);
+
+// SAFETY: The mapping is read-only.
+unsafe impl Send for MmapSlice {}
+unsafe impl Sync for MmapSlice {}
+
+impl MmapSlice {
+    /// Maps the whole file of `path` as read-only.
+    ///
+    /// # Safety
+    /// The file must not be modified or truncated while the mapping is alive, by this or any other process.
+    /// Otherwise the bytes of the returned slice change behind `&[u8]`, or reading them raises `SIGBUS`.
+    pub unsafe fn open(path: impl AsRef<std::path::Path>) -> std::io::Result<Self> {
+        let file = std::fs::File::open(path)?;
+        Self::from_file(&file)
+    }
+
+    /// Maps the whole `file` as read-only. The mapping is valid after closing `file`.
+    ///
+    /// # Safety
+    /// Same as [`MmapSlice::open`].
+    pub unsafe fn from_file(file: &std::fs::File) -> std::io::Result<Self> {
+        use std::os::unix::io::AsRawFd;
+
+        let len = usize::try_from(file.metadata()?.len())
+            .map_err(|_| std::io::Error::from_raw_os_error(libc::EFBIG))?;
+        if len == 0 {
+            return Ok(Self(SliceInner::empty()));
+        }
+        let ptr = libc::mmap(
+            std::ptr::null_mut(),
+            len,
+            libc::PROT_READ,
+            libc::MAP_SHARED,
+            file.as_raw_fd(),
+            0,
+        );
+        if ptr == libc::MAP_FAILED {
+            return Err(std::io::Error::last_os_error());
+        }
+        Ok(Self(SliceInner {
+            ptr: ptr as *mut u8,
+            len,
+        }))
+    }
+
+    /// Gives a hint of the access pattern of the whole mapping.
+    #[inline]
+    pub fn advise(&self, advice: MmapAdvice) -> std::io::Result<()> {
+        advise(self.as_ref(), advice)
+    }
+
+    /// Asks the kernel to read `range` of the file ahead.
+    #[inline]
+    pub fn prefetch(&self, range: std::ops::Range<usize>) -> std::io::Result<()> {
+        advise(&self.as_ref()[range], MmapAdvice::WillNeed)
+    }
+}
+
+/// Gives a hint of the access pattern of `bytes`, which must be a part of a mapping.
+/// The range is extended to page boundaries.
+pub(crate) fn advise(bytes: &[u8], advice: MmapAdvice) -> std::io::Result<()> {
+    if bytes.is_empty() {
+        return Ok(());
+    }
+    let page = unsafe { libc::sysconf(libc::_SC_PAGESIZE) } as usize;
+    let start = bytes.as_ptr() as usize;
+    let aligned = start & !(page - 1);
+    let len = bytes.len() + (start - aligned);
+    if unsafe { libc::madvise(aligned as *mut libc::c_void, len, advice.as_raw()) } != 0 {
+        return Err(std::io::Error::last_os_error());
+    }
+    Ok(())
+}
+
+impl Drop for MmapSlice {
+    #[inline]
+    fn drop(&mut self) {
+        if self.0.len > 0 {
+            unsafe { libc::munmap(self.0.ptr as *mut libc::c_void, self.0.len) };
+        }
+    }
+}
+
+impl std::convert::AsRef<[u8]> for MmapSlice {
+    #[inline(always)]
+    fn as_ref(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.0.ptr, self.0.len) }
+    }
+}
+
+impl std::borrow::Borrow<[u8]> for MmapSlice {
+    #[inline(always)]
+    fn borrow(&self) -> &[u8] {
+        self.as_ref()
+    }
+}
+
+impl std::ops::Deref for MmapSlice {
+    type Target = [u8];
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_ref()
+    }
+}
+
+#[test]
+fn test_mmap_slice() {
+    let path = std::env::temp_dir().join(format!("ffi_types_test_mmap_{}", std::process::id()));
+    let content: std::vec::Vec<u8> = (0..100_000u32).map(|i| i as u8).collect();
+    std::fs::write(&path, &content).unwrap();
+
+    let mmap = unsafe { MmapSlice::open(&path) }.unwrap();
+    assert_eq!(&*mmap, &content[..]);
+    mmap.advise(MmapAdvice::Sequential).unwrap();
+    mmap.prefetch(5000..6000).unwrap();
+    drop(mmap);
+
+    std::fs::write(&path, b"").unwrap();
+    assert!(unsafe { MmapSlice::open(&path) }.unwrap().is_empty());
+    std::fs::remove_file(&path).unwrap();
+
+    assert!(unsafe { MmapSlice::open(&path) }.is_err());
+}
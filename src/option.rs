@@ -0,0 +1,196 @@
+//! `Option<T>` and `Result<T, E>` with C ABI compatible layout for by-value returns.
+//!
+//! [`COption<T>`] reuses the data pointer of `T` as the niche, which is never null for a valid value,
+//! so `COption<BoxedSlice<T>>` is still 2 words and returned in registers.
+//! [`CResult<T, E>`] is a tagged union same as C++ `CResult<T, E>`.
+
+use crate::{Arc, BoxedSlice, BoxedStr, ForeignBoxedSlice, MutSliceRef, SliceRef, StrRef, Vec};
+use std::mem::MaybeUninit;
+
+/// Types of which the first field is a data pointer never null for a valid value.
+///
+/// # Safety
+/// `Self` must start with a pointer field which is not null for any valid value.
+pub unsafe trait NullNiche: Sized {}
+
+// Slices and strings point `1 as *mut T` when empty. C++ `_wrap_null()` keeps the pointer non-null too.
+unsafe impl<T> NullNiche for SliceRef<T> {}
+unsafe impl<T> NullNiche for MutSliceRef<T> {}
+unsafe impl<T> NullNiche for BoxedSlice<T> {}
+unsafe impl<T> NullNiche for Vec<T> {}
+unsafe impl<T> NullNiche for ForeignBoxedSlice<T> {}
+unsafe impl NullNiche for StrRef {}
+unsafe impl NullNiche for BoxedStr {}
+unsafe impl<T> NullNiche for Arc<T> {}
+
+/// Rust wrapper for `Option<T>` of which `None` is a null data pointer of `T`. Same as C++ `COption<T>`.
+///
+/// Unlike `Option<T>`, the layout is guaranteed to be the one of `T`.
+#[repr(transparent)]
+pub struct COption<T: NullNiche>(MaybeUninit<T>);
+static_assertions::assert_eq_size!(COption<BoxedSlice<u8>>, BoxedSlice<u8>);
+
+impl<T: NullNiche> COption<T> {
+    #[inline(always)]
+    pub const fn some(value: T) -> Self {
+        Self(MaybeUninit::new(value))
+    }
+
+    #[inline(always)]
+    pub const fn none() -> Self {
+        let mut value = MaybeUninit::<T>::uninit();
+        unsafe { (value.as_mut_ptr() as *mut *const u8).write(std::ptr::null()) };
+        Self(value)
+    }
+
+    #[inline(always)]
+    pub fn is_some(&self) -> bool {
+        !unsafe { *(self.0.as_ptr() as *const *const u8) }.is_null()
+    }
+
+    #[inline(always)]
+    pub fn is_none(&self) -> bool {
+        !self.is_some()
+    }
+
+    #[inline]
+    pub fn as_ref(&self) -> Option<&T> {
+        // SAFETY: A non-null data pointer means a valid value.
+        self.is_some().then(|| unsafe { self.0.assume_init_ref() })
+    }
+
+    #[inline]
+    pub fn as_mut(&mut self) -> Option<&mut T> {
+        if self.is_some() {
+            Some(unsafe { self.0.assume_init_mut() })
+        } else {
+            None
+        }
+    }
+
+    #[inline]
+    pub fn into_option(self) -> Option<T> {
+        let this = std::mem::ManuallyDrop::new(self);
+        this.is_some().then(|| unsafe { this.0.assume_init_read() })
+    }
+}
+
+impl<T: NullNiche> Drop for COption<T> {
+    #[inline]
+    fn drop(&mut self) {
+        if self.is_some() {
+            unsafe { self.0.assume_init_drop() };
+        }
+    }
+}
+
+impl<T: NullNiche> Default for COption<T> {
+    #[inline(always)]
+    fn default() -> Self {
+        Self::none()
+    }
+}
+
+impl<T: NullNiche> From<Option<T>> for COption<T> {
+    #[inline]
+    fn from(value: Option<T>) -> Self {
+        match value {
+            Some(value) => Self::some(value),
+            None => Self::none(),
+        }
+    }
+}
+
+impl<T: NullNiche> From<COption<T>> for Option<T> {
+    #[inline]
+    fn from(value: COption<T>) -> Self {
+        value.into_option()
+    }
+}
+
+/// Rust wrapper for `Result<T, E>` as a tagged union. Same as C++ `CResult<T, E>`.
+///
+/// The tag is a byte before the union of `T` and `E`,
+/// so a result of 2-word `T` is 3 words and returned through memory.
+#[repr(C, u8)]
+pub enum CResult<T, E> {
+    Ok(T),
+    Err(E),
+}
+
+impl<T, E> CResult<T, E> {
+    #[inline(always)]
+    pub fn is_ok(&self) -> bool {
+        matches!(self, Self::Ok(_))
+    }
+
+    #[inline(always)]
+    pub fn is_err(&self) -> bool {
+        !self.is_ok()
+    }
+
+    #[inline]
+    pub fn into_result(self) -> Result<T, E> {
+        match self {
+            Self::Ok(value) => Ok(value),
+            Self::Err(error) => Err(error),
+        }
+    }
+}
+
+impl<T, E> From<Result<T, E>> for CResult<T, E> {
+    #[inline]
+    fn from(value: Result<T, E>) -> Self {
+        match value {
+            Ok(value) => Self::Ok(value),
+            Err(error) => Self::Err(error),
+        }
+    }
+}
+
+impl<T, E> From<CResult<T, E>> for Result<T, E> {
+    #[inline]
+    fn from(value: CResult<T, E>) -> Self {
+        value.into_result()
+    }
+}
+
+#[test]
+fn test_option() {
+    let some = COption::some(BoxedSlice::from(vec![1u32, 2].into_boxed_slice()));
+    assert!(some.is_some());
+    assert_eq!(some.as_ref().map(|s| &s[..]), Some(&[1u32, 2][..]));
+    // an empty slice is still some
+    let empty: COption<BoxedSlice<u8>> = Some(BoxedSlice::empty()).into();
+    assert!(empty.is_some());
+    let none = COption::<BoxedStr>::none();
+    assert!(none.is_none());
+    assert!(none.into_option().is_none());
+    assert_eq!(&*some.into_option().unwrap(), &[1, 2]);
+
+    extern "C" fn find(bytes: SliceRef<u8>, b: u8) -> COption<SliceRef<u8>> {
+        let bytes = bytes.into_slice();
+        bytes
+            .iter()
+            .position(|&c| c == b)
+            .map(|i| SliceRef::new(&bytes[i..]))
+            .into()
+    }
+    let found = find(SliceRef::new(b"hello"), b'l').into_option().unwrap();
+    assert_eq!(&*found, b"llo");
+    assert!(find(SliceRef::new(b"hello"), b'x').is_none());
+}
+
+#[test]
+fn test_result() {
+    let ok: CResult<BoxedStr, i32> = Ok(BoxedStr::new("ok".into())).into();
+    assert!(ok.is_ok());
+    assert_eq!(&*ok.into_result().unwrap(), "ok");
+    let err = CResult::<BoxedStr, i32>::Err(22);
+    assert!(err.is_err());
+    assert!(matches!(err.into_result(), Err(22)));
+    assert_eq!(
+        std::mem::size_of::<CResult<u32, i32>>(),
+        2 * std::mem::size_of::<u32>()
+    );
+}
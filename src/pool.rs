@@ -0,0 +1,188 @@
+//! Per-thread pools of byte buffers in size classes.
+//!
+//! Allocating and dropping many buffers of the same size, e.g. 4 KiB or 64 KiB, goes to the global allocator
+//! every time. [`alloc_uninit`] takes a buffer of a size class from the pool of the current thread instead,
+//! and the Rust drop functions of `BoxedSlice<u8>` return buffers of a size class to the pool of the dropping thread.
+//!
+//! A size class is a power of two from [`MIN_CLASS_SIZE`] to [`MAX_CLASS_SIZE`] bytes.
+//! A buffer of a size class has the same layout as any `BoxedSlice<u8>` of the length,
+//! so pooled buffers are dropped as usual when the pool is full or disabled.
+//! Pools are disabled until [`set_limit`] is called.
+
+use crate::BoxedSlice;
+use std::cell::RefCell;
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+/// The smallest size class.
+pub const MIN_CLASS_SIZE: usize = 1 << 10;
+/// The largest size class.
+pub const MAX_CLASS_SIZE: usize = 1 << 20;
+const CLASS_COUNT: usize =
+    (MAX_CLASS_SIZE.trailing_zeros() - MIN_CLASS_SIZE.trailing_zeros() + 1) as usize;
+
+/// The maximum bytes kept by a size class of a thread. Zero disables pools.
+static LIMIT: AtomicUsize = AtomicUsize::new(0);
+
+/// Counters of the pool of a thread to size the limit. Same as C++ `PoolStats`.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct PoolStats {
+    /// Allocations served by the pool.
+    pub hits: u64,
+    /// Allocations of a size class served by the global allocator.
+    pub misses: u64,
+    /// Buffers returned to the pool.
+    pub recycled: u64,
+    /// Buffers of a size class freed because the pool was full.
+    pub released: u64,
+}
+
+struct Pool {
+    classes: [std::vec::Vec<BoxedSlice<u8>>; CLASS_COUNT],
+    stats: PoolStats,
+}
+
+thread_local! {
+    static POOL: RefCell<Pool> = RefCell::new(Pool {
+        classes: std::array::from_fn(|_| std::vec::Vec::new()),
+        stats: PoolStats::default(),
+    });
+}
+
+#[inline]
+fn class_index(size: usize) -> Option<usize> {
+    if size.is_power_of_two() && (MIN_CLASS_SIZE..=MAX_CLASS_SIZE).contains(&size) {
+        Some((size.trailing_zeros() - MIN_CLASS_SIZE.trailing_zeros()) as usize)
+    } else {
+        None
+    }
+}
+
+/// Sets the maximum bytes kept by each size class of each thread. Zero disables pools.
+/// Returns the previous limit.
+///
+/// Buffers already pooled are kept until they are allocated again or [`clear`] is called.
+pub fn set_limit(bytes_per_class: usize) -> usize {
+    LIMIT.swap(bytes_per_class, Ordering::Relaxed)
+}
+
+/// Returns the maximum bytes kept by each size class of each thread.
+#[inline]
+pub fn limit() -> usize {
+    LIMIT.load(Ordering::Relaxed)
+}
+
+/// Allocates a byte slice of `size` bytes. A buffer of a size class is taken from the pool of the current thread
+/// if one is available.
+///
+/// # Safety
+/// The bytes are uninitialized. Every byte must be written before it is read.
+pub unsafe fn alloc_uninit(size: usize) -> BoxedSlice<u8> {
+    if let Some(class) = class_index(size).filter(|_| limit() >= size) {
+        let pooled = POOL
+            .try_with(|pool| {
+                let mut pool = pool.borrow_mut();
+                let pooled = pool.classes[class].pop();
+                if pooled.is_some() {
+                    pool.stats.hits += 1;
+                } else {
+                    pool.stats.misses += 1;
+                }
+                pooled
+            })
+            .ok()
+            .flatten();
+        if let Some(pooled) = pooled {
+            return pooled;
+        }
+    }
+    if size == 0 {
+        return BoxedSlice::from(std::boxed::Box::<[u8]>::default());
+    }
+    let layout = std::alloc::Layout::array::<u8>(size).expect("invalid layout");
+    let ptr = std::alloc::alloc(layout);
+    if ptr.is_null() {
+        std::alloc::handle_alloc_error(layout);
+    }
+    BoxedSlice::from(std::boxed::Box::from_raw(
+        std::ptr::slice_from_raw_parts_mut(ptr, size),
+    ))
+}
+
+/// Returns `value` to the pool of the current thread.
+/// Returns `value` back if it is not of a size class, pools are disabled or the pool is full.
+pub fn recycle(value: BoxedSlice<u8>) -> Result<(), BoxedSlice<u8>> {
+    let Some(class) = class_index(value.len()).filter(|_| limit() >= value.len()) else {
+        return Err(value);
+    };
+    let mut value = Some(value);
+    let _ = POOL.try_with(|pool| {
+        let mut pool = pool.borrow_mut();
+        let size = value.as_ref().unwrap().len();
+        if (pool.classes[class].len() + 1) * size > limit() {
+            pool.stats.released += 1;
+            return;
+        }
+        pool.classes[class].push(value.take().unwrap());
+        pool.stats.recycled += 1;
+    });
+    match value {
+        Some(value) => Err(value),
+        None => Ok(()),
+    }
+}
+
+/// Returns the counters of the pool of the current thread.
+pub fn thread_stats() -> PoolStats {
+    POOL.try_with(|pool| pool.borrow().stats)
+        .unwrap_or_default()
+}
+
+/// Frees every buffer in the pool of the current thread.
+pub fn clear() {
+    let _ = POOL.try_with(|pool| {
+        // drop outside of the borrow
+        let classes = std::mem::replace(
+            &mut pool.borrow_mut().classes,
+            std::array::from_fn(|_| std::vec::Vec::new()),
+        );
+        drop(classes);
+    });
+}
+
+#[test]
+fn test_pool() {
+    // pools are per thread, so other tests don't disturb the counters
+    std::thread::spawn(|| {
+        let previous = set_limit(2 * 4096);
+        let first = unsafe { alloc_uninit(4096) };
+        let first_ptr = first.as_ptr();
+        assert_eq!(first.len(), 4096);
+        assert!(recycle(first).is_ok());
+
+        let second = unsafe { alloc_uninit(4096) };
+        assert_eq!(second.as_ptr(), first_ptr);
+        let third = unsafe { alloc_uninit(4096) };
+        let fourth = unsafe { alloc_uninit(4096) };
+        assert!(recycle(second).is_ok());
+        assert!(recycle(third).is_ok());
+        // the class is full
+        assert!(recycle(fourth).is_err());
+        // not a size class
+        assert!(recycle(unsafe { alloc_uninit(4000) }).is_err());
+
+        assert_eq!(
+            thread_stats(),
+            PoolStats {
+                hits: 1,
+                misses: 3,
+                recycled: 3,
+                released: 1,
+            }
+        );
+        clear();
+        set_limit(previous);
+    })
+    .join()
+    .unwrap();
+}
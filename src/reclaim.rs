@@ -0,0 +1,181 @@
+//! Deferred reclamation of owned values.
+//!
+//! Dropping a large buffer can be expensive for a latency-sensitive thread.
+//! [`defer`] pushes the value to a lock-free queue instead, and a reclaimer thread drops it later.
+
+use std::cell::Cell;
+use std::ptr::null_mut;
+use std::sync::atomic::{AtomicPtr, AtomicUsize, Ordering};
+use std::sync::OnceLock;
+
+#[repr(C)]
+struct NodeHeader {
+    next: *mut NodeHeader,
+    drop: unsafe fn(*mut NodeHeader),
+}
+
+/// A single allocation holding both the queue link and the deferred value.
+#[repr(C)]
+struct Node<T> {
+    header: NodeHeader,
+    value: T,
+}
+
+unsafe fn drop_node<T>(header: *mut NodeHeader) {
+    drop(Box::from_raw(header as *mut Node<T>));
+}
+
+/// Treiber stack of deferred values. The reclaimer takes the whole stack at once, so it is ABA-free.
+static QUEUE: AtomicPtr<NodeHeader> = AtomicPtr::new(null_mut());
+/// Number of values deferred but not dropped yet.
+static PENDING: AtomicUsize = AtomicUsize::new(0);
+/// Number of values ever deferred.
+static DEFERRED_COUNT: AtomicUsize = AtomicUsize::new(0);
+static RECLAIMER: OnceLock<std::thread::Thread> = OnceLock::new();
+
+thread_local! {
+    static DEFERRED: Cell<bool> = const { Cell::new(false) };
+}
+
+fn reclaimer() -> &'static std::thread::Thread {
+    RECLAIMER.get_or_init(|| {
+        std::thread::Builder::new()
+            .name("ffi_types-reclaimer".to_owned())
+            .spawn(|| loop {
+                if !reclaim() {
+                    std::thread::park();
+                }
+            })
+            .expect("failed to spawn reclaimer thread")
+            .thread()
+            .clone()
+    })
+}
+
+/// Drops every value in the queue. Returns `false` if the queue was empty.
+fn reclaim() -> bool {
+    let mut node = QUEUE.swap(null_mut(), Ordering::Acquire);
+    if node.is_null() {
+        return false;
+    }
+    while !node.is_null() {
+        unsafe {
+            let next = (*node).next;
+            ((*node).drop)(node);
+            node = next;
+        }
+        PENDING.fetch_sub(1, Ordering::Release);
+    }
+    true
+}
+
+/// Drops `value` in the reclaimer thread.
+pub fn defer<T: Send + 'static>(value: T) {
+    let node = Box::into_raw(Box::new(Node {
+        header: NodeHeader {
+            next: null_mut(),
+            drop: drop_node::<T>,
+        },
+        value,
+    })) as *mut NodeHeader;
+    PENDING.fetch_add(1, Ordering::Relaxed);
+    DEFERRED_COUNT.fetch_add(1, Ordering::Relaxed);
+
+    let mut head = QUEUE.load(Ordering::Relaxed);
+    loop {
+        unsafe { (*node).next = head };
+        match QUEUE.compare_exchange_weak(head, node, Ordering::Release, Ordering::Relaxed) {
+            Ok(_) => break,
+            Err(current) => head = current,
+        }
+    }
+    // A non-empty queue already woke up the reclaimer.
+    if head.is_null() {
+        reclaimer().unpark();
+    }
+}
+
+/// Drops `value` by [`defer`] if deferred mode is enabled in the current thread. Otherwise drops it immediately.
+#[inline]
+pub fn drop_or_defer<T: Send + 'static>(value: T) {
+    if is_deferred() {
+        defer(value);
+    } else {
+        drop(value);
+    }
+}
+
+/// Drops every item of `items` in place by [`defer`] if deferred mode is enabled in the current thread.
+/// Otherwise drops them immediately.
+///
+/// # Safety
+/// `items` must not be used or dropped after this call.
+pub unsafe fn drop_or_defer_many<T: Send + 'static>(items: &mut [T]) {
+    if is_deferred() {
+        let items: std::vec::Vec<T> = items.iter().map(|item| std::ptr::read(item)).collect();
+        defer(items);
+    } else {
+        std::ptr::drop_in_place(items);
+    }
+}
+
+/// Returns `true` if deferred mode is enabled in the current thread.
+#[inline]
+pub fn is_deferred() -> bool {
+    DEFERRED.with(|deferred| deferred.get())
+}
+
+/// Enables or disables deferred mode in the current thread. Returns the previous state.
+#[inline]
+pub fn set_deferred(enabled: bool) -> bool {
+    DEFERRED.with(|deferred| deferred.replace(enabled))
+}
+
+/// Drops every deferred value in the calling thread and waits until no drop is pending in the reclaimer thread.
+pub fn flush() {
+    reclaim();
+    while PENDING.load(Ordering::Acquire) > 0 {
+        if !reclaim() {
+            std::thread::yield_now();
+        }
+    }
+}
+
+/// Returns the number of values deferred but not dropped yet.
+#[inline]
+pub fn pending() -> usize {
+    PENDING.load(Ordering::Acquire)
+}
+
+/// Returns the number of values ever deferred by [`defer`].
+#[inline]
+pub fn deferred_count() -> usize {
+    DEFERRED_COUNT.load(Ordering::Relaxed)
+}
+
+#[test]
+fn test_defer() {
+    use std::sync::Arc;
+
+    struct Guard(Arc<AtomicUsize>);
+    impl Drop for Guard {
+        fn drop(&mut self) {
+            self.0.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    let dropped = Arc::new(AtomicUsize::new(0));
+    let count = deferred_count();
+    let previous = set_deferred(true);
+    for _ in 0..100 {
+        drop_or_defer(Guard(dropped.clone()));
+    }
+    set_deferred(previous);
+    assert!(deferred_count() >= count + 100);
+    flush();
+    assert_eq!(dropped.load(Ordering::Relaxed), 100);
+    assert_eq!(pending(), 0);
+
+    drop_or_defer(Guard(dropped.clone()));
+    assert_eq!(dropped.load(Ordering::Relaxed), 101);
+}
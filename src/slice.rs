@@ -19,6 +19,41 @@ static_assertions::assert_eq_size!(MutSliceRef<u8>, &[u8]);
 pub struct BoxedSlice<T: 'static>(pub(crate) SliceInner<T>);
 static_assertions::assert_eq_size!(BoxedSlice<u8>, Box<[u8]>);
 
+// SAFETY: `BoxedSlice<T>` owns the slice as `Box<[T]>` does.
+unsafe impl<T: Send> Send for BoxedSlice<T> {}
+unsafe impl<T: Sync> Sync for BoxedSlice<T> {}
+
+/// Rust wrapper for Vec<T>.
+///
+/// Unlike [`BoxedSlice`], the capacity is kept to avoid reallocation when the value is converted from or to `Vec<T>`.
+/// The first 2 fields are layout compatible to slices.
+#[repr(C)]
+pub struct Vec<T: 'static> {
+    pub(crate) inner: SliceInner<T>,
+    pub(crate) cap: usize,
+}
+static_assertions::assert_eq_size!(Vec<u8>, std::vec::Vec<u8>);
+
+// SAFETY: `Vec<T>` owns the elements as `Vec<T>` does.
+unsafe impl<T: Send> Send for Vec<T> {}
+unsafe impl<T: Sync> Sync for Vec<T> {}
+
+/// A slice owned by foreign code, e.g. the storage of a C++ `std::vector<T>`.
+///
+/// Dropping it calls `drop(ctx)` back to the owner instead of the Rust global allocator.
+/// The owner is responsible for both the elements and the memory.
+/// The first 2 fields are layout compatible to slices.
+#[repr(C)]
+pub struct ForeignBoxedSlice<T: 'static> {
+    pub(crate) inner: SliceInner<T>,
+    pub(crate) drop: Option<unsafe extern "C" fn(ctx: *mut std::ffi::c_void)>,
+    pub(crate) ctx: *mut std::ffi::c_void,
+}
+
+// SAFETY: The owner must allow `drop` to be called from any thread.
+unsafe impl<T: Send> Send for ForeignBoxedSlice<T> {}
+unsafe impl<T: Sync> Sync for ForeignBoxedSlice<T> {}
+
 impl<T> Clone for SliceRef<T> {
     #[inline(always)]
     fn clone(&self) -> Self {
@@ -204,7 +239,8 @@ impl<T> BoxedSlice<T> {
     /// Inverse of [`BoxedSlice::new`].
     #[inline(always)]
     pub fn into_boxed_slice(self) -> std::boxed::Box<[T]> {
-        let union = self.0.union();
+        let this = std::mem::ManuallyDrop::new(self);
+        let union = this.0.union();
         std::mem::ManuallyDrop::into_inner(unsafe { union.boxed })
     }
 }
@@ -283,6 +319,255 @@ impl<T> std::ops::DerefMut for BoxedSlice<T> {
     }
 }
 
+impl<T> Drop for Vec<T> {
+    #[inline(always)]
+    fn drop(&mut self) {
+        let vec = std::mem::ManuallyDrop::into_inner(unsafe { self.as_vec() });
+        drop(vec);
+    }
+}
+
+impl<T> Vec<T> {
+    /// Create a new wrapper for a vector `Vec<T>`.
+    #[inline(always)]
+    pub fn new(vec: std::vec::Vec<T>) -> Self {
+        let mut vec = std::mem::ManuallyDrop::new(vec);
+        Self {
+            inner: SliceInner {
+                ptr: vec.as_mut_ptr(),
+                len: vec.len(),
+            },
+            cap: vec.capacity(),
+        }
+    }
+
+    #[inline(always)]
+    pub const fn empty() -> Self {
+        Self {
+            inner: SliceInner {
+                ptr: std::ptr::NonNull::dangling().as_ptr(),
+                len: 0,
+            },
+            cap: 0,
+        }
+    }
+
+    #[inline(always)]
+    pub fn capacity(&self) -> usize {
+        self.cap
+    }
+
+    /// Inverse of [`Vec::new`].
+    #[inline(always)]
+    pub fn into_vec(self) -> std::vec::Vec<T> {
+        let this = std::mem::ManuallyDrop::new(self);
+        std::mem::ManuallyDrop::into_inner(unsafe { this.as_vec() })
+    }
+
+    /// Run `f` with `Vec<T>` borrowed from the wrapper.
+    #[inline]
+    pub fn with_vec<R>(&mut self, f: impl FnOnce(&mut std::vec::Vec<T>) -> R) -> R {
+        let mut vec = unsafe { self.as_vec() };
+        let r = f(&mut vec);
+        self.inner = SliceInner {
+            ptr: vec.as_mut_ptr(),
+            len: vec.len(),
+        };
+        self.cap = vec.capacity();
+        r
+    }
+
+    /// # Safety
+    /// The returned value must not be dropped unless `self` is forgotten.
+    #[inline(always)]
+    unsafe fn as_vec(&self) -> std::mem::ManuallyDrop<std::vec::Vec<T>> {
+        // An empty vector from C++ side may have a dangling pointer not aligned for `T`.
+        let vec = if self.cap == 0 && std::mem::size_of::<T>() > 0 {
+            std::vec::Vec::new()
+        } else {
+            std::vec::Vec::from_raw_parts(self.inner.ptr, self.inner.len, self.cap)
+        };
+        std::mem::ManuallyDrop::new(vec)
+    }
+}
+
+impl<T> Default for Vec<T> {
+    #[inline(always)]
+    fn default() -> Self {
+        Self::empty()
+    }
+}
+
+impl<T> From<std::vec::Vec<T>> for Vec<T> {
+    #[inline]
+    fn from(value: std::vec::Vec<T>) -> Self {
+        Self::new(value)
+    }
+}
+
+impl<T> From<Vec<T>> for std::vec::Vec<T> {
+    #[inline(always)]
+    fn from(value: Vec<T>) -> Self {
+        value.into_vec()
+    }
+}
+
+impl<T> std::convert::AsRef<[T]> for Vec<T> {
+    #[inline(always)]
+    fn as_ref(&self) -> &[T] {
+        let union = self.inner.union();
+        unsafe { union.slice }
+    }
+}
+
+impl<T> std::convert::AsMut<[T]> for Vec<T> {
+    #[inline(always)]
+    fn as_mut(&mut self) -> &mut [T] {
+        let union = self.inner.union();
+        unsafe { union.mut_slice }
+    }
+}
+
+impl<T> std::borrow::Borrow<[T]> for Vec<T> {
+    #[inline(always)]
+    fn borrow(&self) -> &[T] {
+        self.as_ref()
+    }
+}
+
+impl<T> std::borrow::BorrowMut<[T]> for Vec<T> {
+    #[inline(always)]
+    fn borrow_mut(&mut self) -> &mut [T] {
+        self.as_mut()
+    }
+}
+
+impl<T> std::ops::Deref for Vec<T> {
+    type Target = [T];
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_ref()
+    }
+}
+
+impl<T> std::ops::DerefMut for Vec<T> {
+    #[inline(always)]
+    fn deref_mut(&mut self) -> &mut Self::Target {
+        self.as_mut()
+    }
+}
+
+impl<T> ForeignBoxedSlice<T> {
+    /// # Safety
+    /// `ptr` and `len` must be a valid slice until `drop(ctx)` is called. `drop` must be callable from any thread.
+    #[inline(always)]
+    pub unsafe fn from_raw_parts(
+        ptr: *mut T,
+        len: usize,
+        drop: Option<unsafe extern "C" fn(ctx: *mut std::ffi::c_void)>,
+        ctx: *mut std::ffi::c_void,
+    ) -> Self {
+        Self {
+            inner: SliceInner { ptr, len },
+            drop,
+            ctx,
+        }
+    }
+
+    #[inline(always)]
+    pub const fn empty() -> Self {
+        Self {
+            inner: SliceInner {
+                ptr: std::ptr::NonNull::dangling().as_ptr(),
+                len: 0,
+            },
+            drop: None,
+            ctx: std::ptr::null_mut(),
+        }
+    }
+}
+
+impl<T> Drop for ForeignBoxedSlice<T> {
+    #[inline]
+    fn drop(&mut self) {
+        // The elements are destroyed by the owner too.
+        if let Some(drop) = self.drop {
+            unsafe { drop(self.ctx) };
+        }
+    }
+}
+
+impl<T> Default for ForeignBoxedSlice<T> {
+    #[inline(always)]
+    fn default() -> Self {
+        Self::empty()
+    }
+}
+
+impl<T> std::convert::AsRef<[T]> for ForeignBoxedSlice<T> {
+    #[inline(always)]
+    fn as_ref(&self) -> &[T] {
+        let union = self.inner.union();
+        unsafe { union.slice }
+    }
+}
+
+impl<T> std::convert::AsMut<[T]> for ForeignBoxedSlice<T> {
+    #[inline(always)]
+    fn as_mut(&mut self) -> &mut [T] {
+        let union = self.inner.union();
+        unsafe { union.mut_slice }
+    }
+}
+
+impl<T> std::borrow::Borrow<[T]> for ForeignBoxedSlice<T> {
+    #[inline(always)]
+    fn borrow(&self) -> &[T] {
+        self.as_ref()
+    }
+}
+
+impl<T> std::borrow::BorrowMut<[T]> for ForeignBoxedSlice<T> {
+    #[inline(always)]
+    fn borrow_mut(&mut self) -> &mut [T] {
+        self.as_mut()
+    }
+}
+
+impl<T> std::ops::Deref for ForeignBoxedSlice<T> {
+    type Target = [T];
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_ref()
+    }
+}
+
+impl<T> std::ops::DerefMut for ForeignBoxedSlice<T> {
+    #[inline(always)]
+    fn deref_mut(&mut self) -> &mut Self::Target {
+        self.as_mut()
+    }
+}
+
+#[test]
+fn test_foreign_boxed_slice() {
+    unsafe extern "C" fn drop_vec(ctx: *mut std::ffi::c_void) {
+        drop(std::boxed::Box::from_raw(ctx as *mut std::vec::Vec<u32>));
+    }
+
+    let mut owner = std::boxed::Box::new(vec![1u32, 2, 3]);
+    let (ptr, len) = (owner.as_mut_ptr(), owner.len());
+    let ctx = std::boxed::Box::into_raw(owner) as *mut std::ffi::c_void;
+    let mut slice = unsafe { ForeignBoxedSlice::from_raw_parts(ptr, len, Some(drop_vec), ctx) };
+    slice[0] = 0;
+    assert_eq!(&*slice, &[0, 2, 3]);
+    drop(slice);
+
+    assert!(ForeignBoxedSlice::<u32>::empty().is_empty());
+}
+
 #[repr(C)]
 pub(crate) struct SliceInner<T> {
     pub(crate) ptr: *mut T,
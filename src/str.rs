@@ -14,9 +14,13 @@ static_assertions::assert_eq_size!(StrRef, &str);
 ///
 /// Since boxed types are only created from Rust side, the value is expected to be valid under safe operations.
 #[repr(C)]
-pub struct BoxedStr(SliceInner<u8>);
+pub struct BoxedStr(pub(crate) SliceInner<u8>);
 static_assertions::assert_eq_size!(BoxedStr, std::boxed::Box<str>);
 
+// SAFETY: `BoxedStr` owns the string as `Box<str>` does.
+unsafe impl Send for BoxedStr {}
+unsafe impl Sync for BoxedStr {}
+
 impl Clone for StrRef {
     #[inline(always)]
     fn clone(&self) -> Self {
@@ -94,6 +98,37 @@ impl std::ops::Deref for StrRef {
     }
 }
 
+impl PartialEq for StrRef {
+    #[inline]
+    fn eq(&self, other: &Self) -> bool {
+        **self == **other
+    }
+}
+
+impl Eq for StrRef {}
+
+impl PartialOrd for StrRef {
+    #[inline]
+    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl Ord for StrRef {
+    #[inline]
+    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
+        (**self).cmp(&**other)
+    }
+}
+
+/// Same as `str` to be consistent with `Borrow<str>`.
+impl std::hash::Hash for StrRef {
+    #[inline]
+    fn hash<H: std::hash::Hasher>(&self, state: &mut H) {
+        (**self).hash(state)
+    }
+}
+
 impl BoxedStr {
     /// Create a new wrapper for a `Box<str>`.
     #[inline(always)]
@@ -107,11 +142,21 @@ impl BoxedStr {
     /// Inverse of [`BoxedStr::new`].
     #[inline(always)]
     pub fn into_boxed_str(self) -> Box<str> {
-        let union = self.0.str_union();
+        let this = std::mem::ManuallyDrop::new(self);
+        let union = this.0.str_union();
         std::mem::ManuallyDrop::into_inner(unsafe { union.boxed })
     }
 }
 
+impl Drop for BoxedStr {
+    #[inline(always)]
+    fn drop(&mut self) {
+        let union = self.0.str_union();
+        let boxed: Box<str> = std::mem::ManuallyDrop::into_inner(unsafe { union.boxed });
+        drop(boxed);
+    }
+}
+
 impl From<std::boxed::Box<str>> for BoxedStr {
     #[inline(always)]
     fn from(value: std::boxed::Box<str>) -> Self {
@@ -157,6 +202,245 @@ impl std::ops::Deref for BoxedStr {
     }
 }
 
+impl PartialEq for BoxedStr {
+    #[inline]
+    fn eq(&self, other: &Self) -> bool {
+        **self == **other
+    }
+}
+
+impl Eq for BoxedStr {}
+
+impl PartialOrd for BoxedStr {
+    #[inline]
+    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl Ord for BoxedStr {
+    #[inline]
+    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
+        (**self).cmp(&**other)
+    }
+}
+
+impl std::hash::Hash for BoxedStr {
+    #[inline]
+    fn hash<H: std::hash::Hasher>(&self, state: &mut H) {
+        (**self).hash(state)
+    }
+}
+
+const COMPACT_STR_SIZE: usize = std::mem::size_of::<SliceInner<u8>>();
+const COMPACT_STR_TAG: usize = 1 << (usize::BITS - 1);
+const COMPACT_STR_LEN_SHIFT: u32 = usize::BITS - 8;
+
+/// A [`BoxedStr`] storing short strings inline.
+///
+/// A string up to [`CompactStr::INLINE_CAPACITY`] bytes is stored in the `(ptr, len)` footprint itself.
+/// The highest bit of `len` tags an inline string, and the rest of its highest byte is the length.
+/// Longer strings are exactly a `BoxedStr`.
+#[repr(C)]
+pub struct CompactStr(CompactStrUnion);
+static_assertions::assert_eq_size!(CompactStr, BoxedStr);
+
+#[repr(C)]
+union CompactStrUnion {
+    heap: SliceInner<u8>,
+    inline: [u8; COMPACT_STR_SIZE],
+}
+
+// SAFETY: `CompactStr` owns the string as `Box<str>` does.
+unsafe impl Send for CompactStr {}
+unsafe impl Sync for CompactStr {}
+
+impl CompactStr {
+    /// Inline strings need the tag byte at the end, which is only true for little-endian.
+    pub const INLINE_CAPACITY: usize = if cfg!(target_endian = "little") {
+        COMPACT_STR_SIZE - 1
+    } else {
+        0
+    };
+
+    /// Create a new string by copying `value`. Only long strings are allocated.
+    #[inline]
+    pub fn new(value: &str) -> Self {
+        if value.len() > Self::INLINE_CAPACITY {
+            return Self::from_boxed_str(value.into());
+        }
+        let mut inline = [0; COMPACT_STR_SIZE];
+        inline[..value.len()].copy_from_slice(value.as_bytes());
+        let mut this = Self(CompactStrUnion { inline });
+        unsafe { this.0.heap.len |= COMPACT_STR_TAG | (value.len() << COMPACT_STR_LEN_SHIFT) };
+        this
+    }
+
+    /// Create a new wrapper for a `Box<str>` without copying it.
+    #[inline(always)]
+    pub fn from_boxed_str(value: Box<str>) -> Self {
+        Self::from(BoxedStr::new(value))
+    }
+
+    #[inline(always)]
+    pub fn is_inline(&self) -> bool {
+        unsafe { self.0.heap.len & COMPACT_STR_TAG != 0 }
+    }
+
+    #[inline(always)]
+    pub fn as_str(&self) -> &str {
+        unsafe {
+            let bytes = if self.is_inline() {
+                let len = (self.0.heap.len >> COMPACT_STR_LEN_SHIFT) & 0x7f;
+                self.0.inline.get_unchecked(..len)
+            } else {
+                std::slice::from_raw_parts(self.0.heap.ptr, self.0.heap.len)
+            };
+            std::str::from_utf8_unchecked(bytes)
+        }
+    }
+
+    /// Converts to a `Box<str>`. Inline strings are allocated.
+    #[inline]
+    pub fn into_boxed_str(self) -> Box<str> {
+        if self.is_inline() {
+            return self.as_str().into();
+        }
+        let this = std::mem::ManuallyDrop::new(self);
+        BoxedStr(unsafe { this.0.heap }).into_boxed_str()
+    }
+}
+
+impl Drop for CompactStr {
+    #[inline(always)]
+    fn drop(&mut self) {
+        if !self.is_inline() {
+            drop(BoxedStr(unsafe { self.0.heap }));
+        }
+    }
+}
+
+impl Clone for CompactStr {
+    #[inline]
+    fn clone(&self) -> Self {
+        Self::new(self.as_str())
+    }
+}
+
+impl Default for CompactStr {
+    #[inline(always)]
+    fn default() -> Self {
+        Self::new("")
+    }
+}
+
+impl From<&str> for CompactStr {
+    #[inline(always)]
+    fn from(value: &str) -> Self {
+        Self::new(value)
+    }
+}
+
+impl From<std::boxed::Box<str>> for CompactStr {
+    #[inline(always)]
+    fn from(value: std::boxed::Box<str>) -> Self {
+        Self::from_boxed_str(value)
+    }
+}
+
+impl From<BoxedStr> for CompactStr {
+    #[inline(always)]
+    fn from(value: BoxedStr) -> Self {
+        let this = std::mem::ManuallyDrop::new(value);
+        Self(CompactStrUnion { heap: this.0 })
+    }
+}
+
+impl From<CompactStr> for std::boxed::Box<str> {
+    #[inline(always)]
+    fn from(value: CompactStr) -> Self {
+        value.into_boxed_str()
+    }
+}
+
+impl std::convert::AsRef<str> for CompactStr {
+    #[inline(always)]
+    fn as_ref(&self) -> &str {
+        self.as_str()
+    }
+}
+
+impl std::borrow::Borrow<str> for CompactStr {
+    #[inline(always)]
+    fn borrow(&self) -> &str {
+        self.as_ref()
+    }
+}
+
+impl std::ops::Deref for CompactStr {
+    type Target = str;
+
+    #[inline(always)]
+    fn deref(&self) -> &Self::Target {
+        self.as_ref()
+    }
+}
+
+impl PartialEq for CompactStr {
+    #[inline]
+    fn eq(&self, other: &Self) -> bool {
+        **self == **other
+    }
+}
+
+impl Eq for CompactStr {}
+
+impl PartialOrd for CompactStr {
+    #[inline]
+    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl Ord for CompactStr {
+    #[inline]
+    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
+        (**self).cmp(&**other)
+    }
+}
+
+impl std::hash::Hash for CompactStr {
+    #[inline]
+    fn hash<H: std::hash::Hasher>(&self, state: &mut H) {
+        (**self).hash(state)
+    }
+}
+
+#[test]
+fn test_compact_str() {
+    for s in [
+        "",
+        "a",
+        "0123456789abcde",
+        "0123456789abcdef",
+        "\u{ac00}\u{ac01}\u{ac02}\u{ac03}\u{ac04}",
+    ] {
+        let compact = CompactStr::new(s);
+        assert_eq!(compact.as_str(), s);
+        assert_eq!(compact.is_inline(), s.len() <= CompactStr::INLINE_CAPACITY);
+        assert_eq!(compact.clone().as_str(), s);
+        assert_eq!(&*compact.into_boxed_str(), s);
+
+        let boxed = CompactStr::from(BoxedStr::new(s.into()));
+        assert!(!boxed.is_inline());
+        assert_eq!(boxed.as_str(), s);
+    }
+    // 32-bit targets have 7 bytes of inline capacity
+    if cfg!(all(target_endian = "little", target_pointer_width = "64")) {
+        assert_eq!(CompactStr::INLINE_CAPACITY, 15);
+    }
+}
+
 pub(crate) union StrUnion {
     inner: SliceInner<u8>,
     str: &'static str,